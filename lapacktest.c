@@ -0,0 +1,17 @@
+
+/* checks that BLAS library includes LAPACK routines */
+
+extern void dsyevd_(const char* jobz, const char* uplo, const int* n, double* a,
+		    const int* lda, double* w, double* work, const int* lwork,
+		    int* iwork, const int* liwork, int* info);
+
+int main(void){
+  const char jobz = 'V', uplo = 'U';
+  const int n = 1, lwork = -1, liwork = -1;
+  double a = 1.0, w = 0.0, work = 0.0;
+  int iwork = 0, info = 0;
+  
+  dsyevd_(&jobz, &uplo, &n, &a, &n, &w, &work, &lwork, &iwork, &liwork, &info);
+  
+  return info;
+}
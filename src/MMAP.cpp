@@ -6,6 +6,9 @@
 
 #include <stdlib.h>
 #include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
 #include <string.h>
@@ -321,4 +324,59 @@ namespace whiteice
   }
   
   ////////////////////////////////////////////////////////////////////////////////
+  
+  FileMMAP::FileMMAP(const std::string& filename)
+  {
+    ptr = 0;
+    bytes = 0;
+    
+    fd = open(filename.c_str(), O_RDONLY);
+    
+    if(fd == -1)
+      throw std::invalid_argument("Cannot open file for memory mapping.");
+    
+    struct stat st;
+    
+    if(fstat(fd, &st) == -1){
+      close(fd);
+      throw std::invalid_argument("Cannot get file size.");
+    }
+    
+    bytes = (unsigned long long)st.st_size;
+    
+    if(bytes > (unsigned long long)((size_t)(-1))){
+      close(fd);
+      throw std::out_of_range("memory area too large");
+    }
+    
+    if(bytes > 0){
+      ptr = (unsigned char*)
+	mmap(0, (size_t)bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+      
+      if(ptr == MAP_FAILED){
+	ptr = 0;
+	close(fd);
+	throw std::length_error("Cannot create memory mapping.");
+      }
+    }
+  }
+  
+  
+  FileMMAP::FileMMAP(const FileMMAP& fmmap)
+  {
+    throw std::invalid_argument("Cannot create copy of FileMMAP.");
+  }
+  
+  
+  FileMMAP::~FileMMAP()
+  {
+    if(ptr) munmap(ptr, (size_t)bytes);
+    if(fd != -1) close(fd);
+    
+    ptr = 0;
+    bytes = 0;
+    fd = -1;
+  }
+  
+  ////////////////////////////////////////////////////////////////////////////////
 };
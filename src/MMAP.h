@@ -13,6 +13,7 @@
 
 #include <stdexcept>
 #include <exception>
+#include <string>
 #include <assert.h>
 
 // 1 GB page size
@@ -143,6 +144,39 @@ namespace whiteice
     int fd;
   };
   
+  
+  /*
+   * maps the whole existing file continuously to memory (64bit platforms).
+   * mapping is private (copy-on-write): changes to mapped memory are
+   * not written back to the file. used by dataset::load() to access
+   * data without copying it.
+   */
+  class FileMMAP
+  {
+  public:
+    FileMMAP(const std::string& filename);
+    FileMMAP(const FileMMAP& fmmap);
+    ~FileMMAP();
+    
+    unsigned long long size() const throw(){
+      return bytes;
+    }
+    
+    inline const unsigned char* data() const throw(){
+      return ptr;
+    }
+    
+    inline unsigned char* data() throw(){
+      return ptr;
+    }
+    
+  private:
+    unsigned char* ptr;
+    
+    unsigned long long bytes;
+    int fd;
+  };
+  
 };
 
 
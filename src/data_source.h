@@ -35,6 +35,30 @@ namespace whiteice
       virtual void flush() const = 0;
   };
   
+  
+  /*
+   * chunked data source interface for data which
+   * doesn't fit into memory (out-of-core data):
+   * consecutive items are read into chunk objects
+   * when needed instead of accessing them directly
+   */
+  template <typename chunk>
+    class chunked_data_source
+    {
+    public:
+      virtual ~chunked_data_source(){ }
+      
+      // number of items in data source
+      virtual unsigned long long size() const throw() = 0;
+      
+      // reads N items starting from index to c (thread-safe)
+      virtual bool read(const unsigned long long index,
+			const unsigned int N, chunk& c) const = 0;
+      
+      // returns if reading data can success
+      virtual bool good() const throw() = 0;
+  };
+  
 };
 
 #endif
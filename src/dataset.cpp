@@ -26,6 +26,8 @@
 #include "eig.h"
 #include "dataset.h"
 #include "blade_math.h"
+#include "MMAP.h"
+#include "float16.h"
 #include "Log.h"
 
 /**************************************************/
@@ -76,6 +78,23 @@ namespace whiteice
   }
   
   
+  template <typename T>
+  dataset<T>& dataset<T>::operator=(const dataset<T>& d)
+  {
+    if(this == &d) return *this;
+    
+    // copies data vectors to new memory first: vectors may be views
+    // to the memory mapped file which is released after copying
+    std::vector<cluster> c(d.clusters);
+    
+    clusters.swap(c);
+    namemapping = d.namemapping;
+    mapping.reset();
+    
+    return *this;
+  }
+  
+  
   template <typename T>
   dataset<T>::~dataset() throw(){
     clusters.clear();
@@ -668,6 +687,8 @@ namespace whiteice
     //  [Rxx]   : float[DIM]x[DIM]
     //  [ICA]   : float[DIM]x[DIM]
     //  data    : float[datasize]x[DIM]
+    //
+    // and memory mappable dataset formats = 2 and 3 (see save_mapped())
     
     if(filename.length() <= 0)
       return false;
@@ -714,12 +735,20 @@ namespace whiteice
       return false;
     }
     
-    if(version != 1){
+    if(version == 2 || version == 3){
+      const bool result = load_mapped(fp, filename, version, cnum);
+      fclose(fp);
+      return result;
+    }
+    else if(version != 1){
       fclose(fp);
       return false;
     }
     
     
+    // vectors of old clusters may be views to the mapped file
+    clusters.clear();
+    mapping.reset();
     clusters.resize(cnum);
 
     // reads names
@@ -886,38 +915,12 @@ namespace whiteice
 	
 	
 	// recalculates Wx and invWx vectors
-	math::matrix<T> D(clusters[i].Rxx);
-	math::matrix<T> V, Vt, invD;
-	
-	if(symmetric_eig(D, V) == false){
+	if(whitening_from_correlation(clusters[i]) == false){
 	  clusters.resize(0);
 	  fclose(fp);
 	  free(buffer);
 	  return false;
 	}
-	
-	invD = D;
-	
-	for(unsigned int j=0;j<D.ysize();j++){
-	  T d = invD(j,j);
-
-	  if(d > T(10e-8)){
-	      invD(j,j) = whiteice::math::sqrt(T(1.0)/whiteice::math::abs(d));
-	      D(j,j)    = whiteice::math::sqrt(whiteice::math::abs(d));
-	  }
-	  else{
-	    invD(j,j) = T(0.0f);
-	    D(j,j)    = T(0.0f);
-	  }
-	  
-	}
-	
-	Vt = V;
-	Vt.transpose();
-	
-	clusters[i].Wxx = V * invD * Vt;
-	clusters[i].invWxx = V * D * Vt;
-	
       }
 
 
@@ -990,12 +993,84 @@ namespace whiteice
     
     return true;
   }
-  
-  
+
+
+  template <typename T>
+  bool dataset<T>::loadHeader(const std::string& filename,
+			      std::vector<file_block>& blocks) throw()
+  {
+    if(filename.length() <= 0)
+      return false;
+
+    FILE* fp = (FILE*)fopen(filename.c_str(), "rb");
+    if(fp == 0) return false;
+
+    unsigned int version = 0xFFFFFFFF;
+    unsigned int cnum = 0;
+
+    {
+      char line[128] = "";
+      const size_t s = strlen(FILEID_STRING)+1;
+
+      if(fread(line, 1, s, fp) != s || strcmp(line, FILEID_STRING) != 0){
+	fclose(fp);
+	return false;
+      }
+    }
+
+    if(fread(&version, 4, 1, fp) != 1 || fread(&cnum, 4, 1, fp) != 1){
+      fclose(fp);
+      return false;
+    }
+
+    if(version != 2 && version != 3){ // only memory mapped format has data blocks
+      fclose(fp);
+      return false;
+    }
+
+    const bool result = load_mapped(fp, filename, version, cnum, &blocks);
+    fclose(fp);
+
+    return result;
+  }
+
+
+
+
+  template <typename T>
+  bool dataset<T>::save(const std::string& filename, const bool mmap_format,
+			const bool float16) const throw()
+  {
+    if(filename.length() <= 0)
+      return false;
+    
+    if(!mapping){
+      if(mmap_format) return save_mapped(filename, float16);
+      else return save_unmapped(filename);
+    }
+    
+    // data may be memory mapped from the target file: writes to temporary
+    // file first so the mapped file is not truncated while it is being read
+    const std::string tmpfile = filename + ".tmp";
+    
+    if(mmap_format){
+      if(save_mapped(tmpfile, float16) == false) return false;
+    }
+    else{
+      if(save_unmapped(tmpfile) == false) return false;
+    }
+    
+    if(rename(tmpfile.c_str(), filename.c_str()) != 0){
+      remove(tmpfile.c_str());
+      return false;
+    }
+    
+    return true;
+  }
   
   
   template <typename T>
-  bool dataset<T>::save(const std::string& filename) const throw()
+  bool dataset<T>::save_unmapped(const std::string& filename) const throw()
   {
     // dataset is saved as binary file in following format.
     // all data is either 32bit unsigned integers or 32bit floats
@@ -1255,6 +1330,508 @@ namespace whiteice
   }
   
 
+  template <typename T>
+  bool dataset<T>::whitening_from_correlation(cluster& c) const
+  {
+    math::matrix<T> D(c.Rxx);
+    math::matrix<T> V, Vt, invD;
+    
+    if(symmetric_eig(D, V) == false)
+      return false;
+    
+    invD = D;
+    
+    for(unsigned int j=0;j<D.ysize();j++){
+      T d = invD(j,j);
+      
+      if(d > T(10e-8)){
+	invD(j,j) = whiteice::math::sqrt(T(1.0)/whiteice::math::abs(d));
+	D(j,j)    = whiteice::math::sqrt(whiteice::math::abs(d));
+      }
+      else{
+	invD(j,j) = T(0.0f);
+	D(j,j)    = T(0.0f);
+      }
+    }
+    
+    Vt = V;
+    Vt.transpose();
+    
+    c.Wxx = V * invD * Vt;
+    c.invWxx = V * D * Vt;
+    
+    return true;
+  }
+  
+  
+  // size of T in file if T is float32 or float64 based real number (0 otherwise)
+  template <typename T>
+  static unsigned int dataset_native_elemsize()
+  {
+    if(typeid(T) == typeid(whiteice::math::blas_real<float>) || typeid(T) == typeid(float))
+      return 4;
+    else if(typeid(T) == typeid(whiteice::math::blas_real<double>) || typeid(T) == typeid(double))
+      return 8;
+    else
+      return 0;
+  }
+  
+  
+  // reads N float16/float32/float64 values to T array
+  template <typename T>
+  static bool dataset_read_elems(FILE* fp, const unsigned int elemsize,
+				 T* dst, const unsigned long long N)
+  {
+    if(N == 0) return true;
+    
+    if(elemsize == dataset_native_elemsize<T>())
+      return (fread(dst, elemsize, N, fp) == N);
+    
+    if(elemsize == 2){
+      std::vector<unsigned short> h(N);
+      if(fread(h.data(), 2, N, fp) != N) return false;
+      math::from_half(h.data(), dst, N);
+      return true;
+    }
+    
+    for(unsigned long long i=0;i<N;i++){
+      if(elemsize == 4){
+	float f = 0.0f;
+	if(fread(&f, 4, 1, fp) != 1) return false;
+	dst[i] = T(f);
+      }
+      else{
+	double d = 0.0;
+	if(fread(&d, 8, 1, fp) != 1) return false;
+	dst[i] = T(d);
+      }
+    }
+    
+    return true;
+  }
+  
+  
+  // writes N values of T array as float16/float32/float64 values
+  template <typename T>
+  static bool dataset_write_elems(FILE* fp, const unsigned int elemsize,
+				  const T* src, const unsigned long long N)
+  {
+    if(N == 0) return true;
+    
+    if(elemsize == dataset_native_elemsize<T>())
+      return (fwrite(src, elemsize, N, fp) == N);
+    
+    if(elemsize == 2){
+      std::vector<unsigned short> h(N);
+      math::to_half(src, h.data(), N);
+      return (fwrite(h.data(), 2, N, fp) == N);
+    }
+    
+    for(unsigned long long i=0;i<N;i++){
+      double d = 0.0;
+      math::convert(d, src[i]);
+      
+      if(elemsize == 4){
+	const float f = (float)d;
+	if(fwrite(&f, 4, 1, fp) != 1) return false;
+      }
+      else{
+	if(fwrite(&d, 8, 1, fp) != 1) return false;
+      }
+    }
+    
+    return true;
+  }
+  
+  
+  template <typename T>
+  bool dataset<T>::load_mapped(FILE* fp, const std::string& filename,
+				const unsigned int version, const unsigned int cnum,
+				std::vector<file_block>* blocks) throw()
+  {
+    // continues loading dataset format = 2 or 3 after cnum field (see save_mapped()).
+    // if the stored number format is same as T's, cluster data vectors are
+    // views to memory mapped file and no data is copied (preprocessing etc.
+    // changes to data are private and are not written back to the file)
+    //
+    // if blocks is non-null, data vectors are not loaded but their
+    // locations in the file are returned instead (see loadHeader())
+    
+    const unsigned long long ALIGNMENT = 8;
+    
+    unsigned int elemsize = 0, dataelemsize = 0;
+    unsigned int namesSectionSize = 0;
+    
+    if(fread(&elemsize, 4, 1, fp) != 1) return false;
+    if(elemsize != 4 && elemsize != 8) return false;
+    
+    if(version == 3){
+      if(fread(&dataelemsize, 4, 1, fp) != 1) return false;
+      if(dataelemsize != 2 && dataelemsize != 4 && dataelemsize != 8) return false;
+    }
+    else dataelemsize = elemsize;
+    
+    if(fread(&namesSectionSize, 4, 1, fp) != 1) return false;
+    
+    std::vector<cluster> c;
+    c.resize(cnum);
+    
+    // reads names
+    {
+      std::vector<char> names;
+      names.resize(namesSectionSize + 1);
+      
+      if(namesSectionSize > 0)
+	if(fread(names.data(), namesSectionSize, 1, fp) != 1)
+	  return false;
+      
+      names[namesSectionSize] = '\0';
+      
+      unsigned int index = 0;
+      unsigned int pos = 0;
+      
+      while(pos < namesSectionSize && index < c.size()){
+	c[index].cname = &(names[pos]); // copies string
+	pos += c[index].cname.length() + 1;
+	index++;
+      }
+      
+      if(index != c.size())
+	return false;
+    }
+    
+    // reads cluster headers
+    std::vector<unsigned long long> offsets, sizes;
+    offsets.resize(cnum);
+    sizes.resize(cnum);
+    
+    for(unsigned int i=0;i<c.size();i++){
+      unsigned long long datasize = 0;
+      unsigned int flags = 0;
+      double softmax = 0.0;
+      
+      if(fread(&datasize, 8, 1, fp) != 1) return false;
+      if(fread(&(offsets[i]), 8, 1, fp) != 1) return false;
+      if(fread(&(c[i].data_dimension), 4, 1, fp) != 1) return false;
+      if(fread(&flags, 4, 1, fp) != 1) return false;
+      if(fread(&softmax, 8, 1, fp) != 1) return false;
+      
+      const unsigned int dim = c[i].data_dimension;
+      
+      if(datasize > 0xFFFFFFFFULL) return false; // too many vectors
+      
+      sizes[i] = datasize;
+      
+      // empty vectors don't allocate memory so mapped data only needs
+      // O(N) vertex headers and no per vector allocations
+      if(blocks == nullptr) c[i].data.resize(datasize, math::vertex<T>(0));
+      c[i].softmax_parameter = T(softmax);
+      
+      if(flags & 0x02)
+	c[i].preprocessings.push_back(dnSoftMax);
+      if(flags & 0x01)
+	c[i].preprocessings.push_back(dnMeanVarianceNormalization);
+      if(flags & 0x04)
+	c[i].preprocessings.push_back(dnCorrelationRemoval);
+      if(flags & 0x08)
+	c[i].preprocessings.push_back(dnLinearICA);
+      
+      if((flags & 0x01) && dim > 0){
+	c[i].mean.resize(dim);
+	c[i].variance.resize(dim);
+	
+	if(dataset_read_elems(fp, elemsize, &(c[i].mean[0]), dim) == false)
+	  return false;
+	
+	if(dataset_read_elems(fp, elemsize, &(c[i].variance[0]), dim) == false)
+	  return false;
+      }
+      
+      if((flags & 0x04) && dim > 0){
+	c[i].Rxx.resize(dim, dim);
+	
+	if(dataset_read_elems(fp, elemsize, &(c[i].Rxx(0,0)), dim*dim) == false)
+	  return false;
+	
+	if(whitening_from_correlation(c[i]) == false)
+	  return false;
+      }
+      
+      if((flags & 0x08) && dim > 0){
+	c[i].ICA.resize(dim, dim);
+	
+	if(dataset_read_elems(fp, elemsize, &(c[i].ICA(0,0)), dim*dim) == false)
+	  return false;
+	
+	c[i].invICA = c[i].ICA;
+	if(c[i].invICA.inv() == false)
+	  return false; // calculating inverse of ICA failed.
+      }
+      
+      // skips padding
+      const long pos = ftell(fp);
+      if(pos < 0) return false;
+      if(pos % ALIGNMENT)
+	if(fseek(fp, ALIGNMENT - (pos % ALIGNMENT), SEEK_CUR) != 0)
+	  return false;
+    }
+    
+    
+    // maps data (or reads it if number format is not T's)
+    std::shared_ptr<FileMMAP> m;
+    unsigned long long filesize = 0;
+    
+    if(dataelemsize == dataset_native_elemsize<T>() && blocks == nullptr){
+      try{
+	m = std::make_shared<FileMMAP>(filename);
+	filesize = m->size();
+      }
+      catch(std::exception& e){
+	m.reset(); // reads data instead
+      }
+    }
+    
+    if(!m){
+      if(fseeko(fp, 0, SEEK_END) != 0) return false;
+      filesize = (unsigned long long)ftello(fp);
+    }
+    
+    for(unsigned int i=0;i<c.size();i++){
+      const unsigned int dim = c[i].data_dimension;
+      const unsigned long long bytes = sizes[i]*dim*dataelemsize;
+      
+      if(offsets[i] + bytes > filesize)
+	return false; // truncated file
+      
+      if(blocks){
+	continue;
+      }
+      else if(m){
+	T* base = (T*)(m->data() + offsets[i]);
+	
+	for(unsigned int a=0;a<c[i].data.size();a++)
+	  c[i].data[a].view(base + ((unsigned long long)a)*dim, dim);
+      }
+      else if(dim > 0){
+	if(fseeko(fp, (off_t)offsets[i], SEEK_SET) != 0)
+	  return false;
+	
+	for(unsigned int a=0;a<c[i].data.size();a++){
+	  c[i].data[a].resize(dim);
+	  
+	  if(dataset_read_elems(fp, dataelemsize, &(c[i].data[a][0]), dim) == false)
+	    return false;
+	}
+      }
+    }
+    
+    if(ferror(fp))
+      return false;
+    
+    if(blocks){
+      blocks->resize(c.size());
+      
+      for(unsigned int i=0;i<c.size();i++){
+	(*blocks)[i].N = sizes[i];
+	(*blocks)[i].offset = offsets[i];
+	(*blocks)[i].elemsize = dataelemsize;
+      }
+    }
+    
+    // sets up rest of data structures
+    clusters.swap(c);
+    mapping = m;
+    namemapping.clear();
+    
+    for(unsigned int i=0;i<clusters.size();i++){
+      clusters[i].cindex = i;
+      namemapping[clusters[i].cname] = i;
+    }
+    
+    return true;
+  }
+  
+  
+  template <typename T>
+  bool dataset<T>::save_mapped(const std::string& filename, const bool float16) const throw()
+  {
+    // memory mappable dataset format = 2. integers are 32bit unsigned
+    // integers except datasize and offset which are 64bit. ELEM is
+    // float32 or float64 (number format of T if possible, otherwise float64).
+    // data of each cluster is a single page aligned row-major block
+    // so load() can use it directly from memory mapped file.
+    // format = 3 has additional dataelem field and DATA is stored as
+    // float16 numbers (preprocessing parameters are still ELEMs)
+    //
+    //  FILEID_STRING : char[]
+    //  version : INT  (= 2 or 3)
+    //  cnum    : INT  number of clusters
+    //  elemsize: INT  size of ELEM (4 or 8)
+    //  [dataelem]: INT size of DATA numbers (2), only in format 3
+    //  namelen : INT  length of names section in bytes (includes padding)
+    //  names   : [list of NULL terminated strings] (cnum names)
+    //  padding : (=> address dividable by 8)
+    //  clusters: [list of CLUSTER]
+    //  data    : [list of DATA]
+    //
+    // CLUSTER:
+    //  datasize: INT64 number of data vectors
+    //  offset  : INT64 file offset of DATA of this cluster
+    //  dimen.  : INT
+    //  NORMFLAG: INT  normalization flags
+    //  softmax : float64
+    //  [mean]  : ELEM[DIM]
+    //  [var]   : ELEM[DIM]
+    //  [Rxx]   : ELEM[DIM]x[DIM]
+    //  [ICA]   : ELEM[DIM]x[DIM]
+    //  padding : (=> address dividable by 8)
+    //
+    // DATA:
+    //  padding : (=> address dividable by 4096)
+    //  data    : ELEM[datasize]x[DIM] (float16 in format 3)
+    
+    if(filename.length() <= 0)
+      return false;
+    
+    const unsigned long long ALIGNMENT = 8;
+    const unsigned long long DATA_ALIGNMENT = 4096;
+    
+    const unsigned int version = float16 ? 3 : 2;
+    const unsigned int cnum = clusters.size();
+    const unsigned int elemsize =
+      dataset_native_elemsize<T>() ? dataset_native_elemsize<T>() : 8;
+    const unsigned int dataelemsize = float16 ? 2 : elemsize;
+    
+    std::vector<unsigned int> flags;
+    flags.resize(cnum);
+    
+    for(unsigned int i=0;i<cnum;i++){
+      flags[i] = 0;
+      
+      for(unsigned int j=0;j<clusters[i].preprocessings.size();j++){
+	if(clusters[i].preprocessings[j] == dnMeanVarianceNormalization)
+	  flags[i] |= 0x01;
+	else if(clusters[i].preprocessings[j] == dnSoftMax)
+	  flags[i] |= 0x02;
+	else if(clusters[i].preprocessings[j] == dnCorrelationRemoval)
+	  flags[i] |= 0x04;
+	else if(clusters[i].preprocessings[j] == dnLinearICA)
+	  flags[i] |= 0x08;
+      }
+    }
+    
+    // calculates layout of the file
+    unsigned long long pos = strlen(FILEID_STRING) + 1 + 4*4 + (float16 ? 4 : 0);
+    unsigned int namesSectionSize = 0;
+    
+    for(unsigned int i=0;i<cnum;i++)
+      namesSectionSize += clusters[i].cname.length() + 1;
+    
+    namesSectionSize =
+      ((pos + namesSectionSize + ALIGNMENT - 1)/ALIGNMENT)*ALIGNMENT - pos;
+    pos += namesSectionSize;
+    
+    for(unsigned int i=0;i<cnum;i++){
+      const unsigned long long dim = clusters[i].data_dimension;
+      
+      pos += 8 + 8 + 4 + 4 + 8;
+      if(flags[i] & 0x01) pos += 2*dim*elemsize;
+      if(flags[i] & 0x04) pos += dim*dim*elemsize;
+      if(flags[i] & 0x08) pos += dim*dim*elemsize;
+      
+      pos = ((pos + ALIGNMENT - 1)/ALIGNMENT)*ALIGNMENT;
+    }
+    
+    std::vector<unsigned long long> offsets;
+    offsets.resize(cnum);
+    
+    for(unsigned int i=0;i<cnum;i++){
+      pos = ((pos + DATA_ALIGNMENT - 1)/DATA_ALIGNMENT)*DATA_ALIGNMENT;
+      offsets[i] = pos;
+      pos += ((unsigned long long)clusters[i].data.size())*
+	clusters[i].data_dimension*dataelemsize;
+    }
+    
+    
+    FILE* fp = (FILE*)fopen(filename.c_str(), "wb");
+    
+    if(fp == 0) return false;
+    if(ferror(fp)){ fclose(fp); return false; }
+    
+    const char zeros[DATA_ALIGNMENT] = { 0 };
+    bool ok = true;
+    
+    ok = ok && (fwrite(FILEID_STRING, 1, strlen(FILEID_STRING)+1, fp) == strlen(FILEID_STRING)+1);
+    ok = ok && (fwrite(&version, 4, 1, fp) == 1);
+    ok = ok && (fwrite(&cnum, 4, 1, fp) == 1);
+    ok = ok && (fwrite(&elemsize, 4, 1, fp) == 1);
+    if(float16) ok = ok && (fwrite(&dataelemsize, 4, 1, fp) == 1);
+    ok = ok && (fwrite(&namesSectionSize, 4, 1, fp) == 1);
+    
+    if(ok){
+      std::vector<char> names;
+      names.resize(namesSectionSize, '\0');
+      
+      unsigned int p = 0;
+      for(unsigned int i=0;i<cnum;i++){
+	memcpy(&(names[p]), clusters[i].cname.c_str(), clusters[i].cname.length()+1);
+	p += clusters[i].cname.length() + 1;
+      }
+      
+      if(namesSectionSize > 0)
+	ok = (fwrite(names.data(), namesSectionSize, 1, fp) == 1);
+    }
+    
+    for(unsigned int i=0;i<cnum && ok;i++){
+      const unsigned long long datasize = clusters[i].data.size();
+      const unsigned int dim = clusters[i].data_dimension;
+      double softmax = 0.0;
+      math::convert(softmax, clusters[i].softmax_parameter);
+      
+      ok = ok && (fwrite(&datasize, 8, 1, fp) == 1);
+      ok = ok && (fwrite(&(offsets[i]), 8, 1, fp) == 1);
+      ok = ok && (fwrite(&dim, 4, 1, fp) == 1);
+      ok = ok && (fwrite(&(flags[i]), 4, 1, fp) == 1);
+      ok = ok && (fwrite(&softmax, 8, 1, fp) == 1);
+      
+      if((flags[i] & 0x01) && dim > 0){
+	ok = ok && dataset_write_elems(fp, elemsize, &(clusters[i].mean[0]), dim);
+	ok = ok && dataset_write_elems(fp, elemsize, &(clusters[i].variance[0]), dim);
+      }
+      
+      if((flags[i] & 0x04) && dim > 0)
+	ok = ok && dataset_write_elems(fp, elemsize, &(clusters[i].Rxx(0,0)), dim*dim);
+      
+      if((flags[i] & 0x08) && dim > 0)
+	ok = ok && dataset_write_elems(fp, elemsize, &(clusters[i].ICA(0,0)), dim*dim);
+      
+      const long p = ftell(fp);
+      if(ok && p >= 0 && (p % ALIGNMENT))
+	ok = (fwrite(zeros, ALIGNMENT - (p % ALIGNMENT), 1, fp) == 1);
+    }
+    
+    for(unsigned int i=0;i<cnum && ok;i++){
+      const off_t p = ftello(fp);
+      
+      if(p < 0 || (unsigned long long)p > offsets[i]){ ok = false; break; }
+      if((unsigned long long)p < offsets[i])
+	ok = (fwrite(zeros, offsets[i] - p, 1, fp) == 1);
+      
+      for(unsigned int a=0;a<clusters[i].data.size() && ok && clusters[i].data_dimension > 0;a++)
+	ok = dataset_write_elems(fp, dataelemsize, &(clusters[i].data[a][0]),
+				 clusters[i].data_dimension);
+    }
+    
+    if(ferror(fp)) ok = false;
+    
+    fclose(fp);
+    
+    if(!ok) remove(filename.c_str());
+    
+    return ok;
+  }
+  
+  
   template <typename T>
   bool dataset<T>::exportAscii(const std::string& filename, bool writeHeaders, bool raw) const throw()
   {
@@ -1640,8 +2217,10 @@ namespace whiteice
 	  if(preprocess(index, dnMeanVarianceNormalization) == false)
 	    return false;
 	
-	// we can use autocorrelation because mean is already zero
-	if(autocorrelation(clusters[index].Rxx, clusters[index].data) == false){
+	// covariance is computed in a single parallel pass over data
+	math::vertex<T> m;
+	
+	if(mean_covariance_estimate(m, clusters[index].Rxx, clusters[index].data) == false){
 		clusters[index].Rxx.resize(clusters[index].data_dimension, clusters[index].data_dimension);
 		clusters[index].Rxx.identity();
 	}
@@ -1709,7 +2288,7 @@ namespace whiteice
 	  if(preprocess(index, dnCorrelationRemoval) == false)
 	    return false;
 
-	if(math::ica(clusters[index].data, clusters[index].ICA) == false){
+	if(math::ica(clusters[index].data, clusters[index].ICA, false, math::ICA_SYMMETRIC) == false){
 	  std::cout << "Calculating independent component analysis failed."
 		    << std::endl;
 	  return false;
@@ -18,11 +18,14 @@
 #include <exception>
 #include <string>
 #include <map>
+#include <memory>
+#include <stdio.h>
 
 
 
 namespace whiteice
 {
+  class FileMMAP;
   
   template <typename T = math::blas_real<float> >
     class dataset
@@ -35,6 +38,8 @@ namespace whiteice
       dataset(unsigned int dimension) throw(std::out_of_range);
       dataset(const dataset<T>& d);
       ~dataset() throw();
+      
+      dataset<T>& operator=(const dataset<T>& d);
 
       
       bool createCluster(const std::string& name, const unsigned int dimension);
@@ -123,9 +128,35 @@ namespace whiteice
        * Datasets are saved in own binary format
        * documented in dataset::load() (dataset.cpp)
        * 
+       * if mmap_format is true data is saved using aligned format (version 2)
+       * which load() memory maps: data vectors then refer directly to the
+       * mapped file without copying (dataset::save_mapped() in dataset.cpp)
+       * 
+       * if float16 is also true data vectors are stored as half precision
+       * numbers (version 3) which are converted to T when data is loaded
+       * or read by file_minibatch_source (half the disk and memory bandwidth)
        */
       bool load(const std::string& filename) throw();
-      bool save(const std::string& filename) const throw();
+      bool save(const std::string& filename, const bool mmap_format = false,
+		const bool float16 = false) const throw();
+      
+      // location of cluster's data in memory mapped format (version 2 or 3) file:
+      // N row-major vectors of float32 (elemsize = 4), float64 (elemsize = 8)
+      // or float16 (elemsize = 2) numbers starting from file offset
+      struct file_block {
+	unsigned long long N;
+	unsigned long long offset;
+	unsigned int elemsize;
+      };
+      
+      /*
+       * loads clusters and their preprocessing parameters from
+       * memory mapped format (version 2 or 3) file without any data vectors.
+       * blocks tell where data of each cluster is stored so it can be
+       * read from the disk later (out-of-core data sources)
+       */
+      bool loadHeader(const std::string& filename,
+		      std::vector<file_block>& blocks) throw();
       
       /*
        * exports dataset values as ascii data without preprocessing (all clusters)
@@ -270,10 +301,25 @@ namespace whiteice
 	math::matrix<T> invICA;
       };
       
+      // calculates Wxx and invWxx from the correlation matrix Rxx
+      bool whitening_from_correlation(cluster& c) const;
+      
+      // saves dataset format (version 1)
+      bool save_unmapped(const std::string& filename) const throw();
+      
+      // loads and saves aligned memory mappable dataset format (version 2 or 3)
+      bool load_mapped(FILE* fp, const std::string& filename,
+		       const unsigned int version, const unsigned int cnum,
+		       std::vector<file_block>* blocks = nullptr) throw();
+      bool save_mapped(const std::string& filename, const bool float16) const throw();
+      
       
       std::vector<cluster> clusters;
       std::map<std::string, unsigned int> namemapping;
       
+      // memory mapped data file (data vectors of clusters are views to it)
+      std::shared_ptr<FileMMAP> mapping;
+      
       
       
       // fileformat tag
@@ -156,6 +156,8 @@
 #include "SHA.h"
 
 #include "dataset.h"
+#include "minibatch_source.h"
+#include "thread_pool.h"
 #include "activation_function.h"
 #include "backpropagation.h"
 #include "neuralnetwork.h"
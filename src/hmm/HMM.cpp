@@ -23,6 +23,7 @@ namespace whiteice {
   {
     this->numVisible = 1;
     this->numHidden  = 1;
+    this->engine     = ARBITRARY_PRECISION;
 
     precision = 256; // 256 bits [4 x double]
 	
@@ -58,10 +59,12 @@ namespace whiteice {
   }
 
   
-  HMM::HMM(unsigned int visStates, unsigned int hidStates) throw(std::logic_error)
+  HMM::HMM(unsigned int visStates, unsigned int hidStates,
+	   engine_type engine_) throw(std::logic_error)
   {
     this->numVisible = visStates;
     this->numHidden  = hidStates;
+    this->engine     = engine_;
 
     if(numVisible == 0 || numHidden == 0)
       throw std::logic_error("whiteice::HMM ctor - number of visible or hidden states cannot be zero");
@@ -105,6 +108,7 @@ namespace whiteice {
     this->numVisible = hmm.numVisible;
     this->numHidden  = hmm.numHidden;
     this->precision  = hmm.precision;
+    this->engine     = hmm.engine;
 
     this->ph = hmm.ph;
     this->A  = hmm.A;
@@ -123,6 +127,7 @@ namespace whiteice {
     this->numVisible = hmm.numVisible;
     this->numHidden  = hmm.numHidden;
     this->precision  = hmm.precision;
+    this->engine     = hmm.engine;
 
     this->ph = hmm.ph;
     this->A  = hmm.A;
@@ -237,6 +242,11 @@ namespace whiteice {
     // uses Baum-Welch algorithm
 
     if(MAXITERS == 0) return 0.0;
+
+    if(engine == DOUBLE_PRECISION){
+      const std::vector< std::vector<unsigned int> > sequences(1, observations);
+      return train_double(sequences, MAXITERS, verbose);
+    }
     
     bool converged = false;
     std::list<realnumber> pdata;
@@ -564,18 +574,24 @@ namespace whiteice {
   double HMM::ml_states(std::vector<unsigned int>& hidden,
 			const std::vector<unsigned int>& observations) const throw (std::invalid_argument)
   {
+    if(engine == DOUBLE_PRECISION)
+      return ml_states_double(hidden, observations);
+    
     std::vector<realnumber> d(ph);
     std::vector<realnumber> dnext(ph);
-    
-    realnumber phidden(0.0, precision);
 
-    const unsigned int T = observations.size()-1;
+    const unsigned int T = observations.size();
+
+    // psi[t][j] is the best previous state of state j at time t
+    std::vector< std::vector<unsigned int> > psi(T);
     
-    for(unsigned int t=1;t<=(T+1);t++){
+    for(unsigned int t=1;t<=T;t++){
+      auto& o = observations[t-1];
+      psi[t-1].resize(numHidden);
+      
       for(unsigned int j=0;j<numHidden;j++){
 	realnumber max(0.0, precision);
 	unsigned int max_i = 0;
-	auto& o = observations[t-1];
 
 	for(unsigned int i=0;i<numHidden;i++){
 	  
@@ -593,9 +609,28 @@ namespace whiteice {
 	}
 	
 	dnext[j] = max;
-	phidden  = max;
-	hidden.push_back(max_i);
+	psi[t-1][j] = max_i;
       }
+
+      d = dnext;
+    }
+
+    // backtracks the best path
+    realnumber phidden(0.0, precision);
+    unsigned int h = 0;
+
+    for(unsigned int j=0;j<numHidden;j++){
+      if(d[j] > phidden){
+	phidden = d[j];
+	h = j;
+      }
+    }
+
+    hidden.resize(T);
+    
+    for(unsigned int t=T;t>=1;t--){
+      hidden[t-1] = h;
+      h = psi[t-1][h];
     }
 
     auto logp = log(phidden);
@@ -663,6 +698,9 @@ namespace whiteice {
    */
   double HMM::logprobability(const std::vector<unsigned int>& observations) const throw (std::invalid_argument)
   {
+    if(engine == DOUBLE_PRECISION)
+      return logprobability_double(observations);
+    
     // uses forward procedure
     
     std::vector<realnumber> alpha(ph);
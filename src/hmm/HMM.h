@@ -23,11 +23,23 @@ namespace whiteice {
    * (math::realnumber)
    * for analyzing and generating neuromancer/resonanz eeg sequences
    *
+   * DOUBLE_PRECISION engine computes train(), ml_states() and
+   * logprobability() using scaled forward-backward and Viterbi
+   * recursions in double precision (no underflow), parameters are
+   * still stored as realnumbers. ARBITRARY_PRECISION is slow but
+   * can be used to verify results.
    */
   class HMM {
   public:
+
+    enum engine_type {
+      ARBITRARY_PRECISION = 0,
+      DOUBLE_PRECISION = 1
+    };
+    
     HMM();
-    HMM(unsigned int visibleStates, unsigned int hiddenStates)
+    HMM(unsigned int visibleStates, unsigned int hiddenStates,
+	engine_type engine = ARBITRARY_PRECISION)
       throw(std::logic_error);
     
     HMM(const HMM& hmm);
@@ -59,6 +71,19 @@ namespace whiteice {
 		 const bool verbose = true)
       throw (std::invalid_argument);
 
+    /**
+     * trains HMM parameters from a collection of independent
+     * observation sequences (Baum-Welch with statistics accumulated
+     * over all sequences). sequences are processed in parallel and
+     * computations are always done in double precision
+     *
+     * returns log(probability) per observation of training data
+     */
+    double train(const std::vector< std::vector<unsigned int> >& sequences,
+		 const unsigned int MAXITERS = 1000,
+		 const bool verbose = true)
+      throw (std::invalid_argument);
+
     
     /**
      * samples given length observation stream from HMM
@@ -71,6 +96,8 @@ namespace whiteice {
      * as well as possible by using viterbi algorithm:
      * max(h) p(v|h)
      *
+     * hidden[t] is the hidden state after emitting observations[t]
+     *
      * returns log(probability) of the optimum hidden states
      */
     double ml_states(std::vector<unsigned int>& hidden,
@@ -93,6 +120,14 @@ namespace whiteice {
     double logprobability(const std::vector<unsigned int>& observations) const
       throw (std::invalid_argument);
 
+    /*
+     * calculates log(probability) of each sequence in parallel,
+     * logp[i] == logprobability(sequences[i]) (zero for empty sequences)
+     */
+    void logprobability(const std::vector< std::vector<unsigned int> >& sequences,
+			std::vector<double>& logp) const
+      throw (std::invalid_argument);
+
     
     std::vector< whiteice::math::realnumber >& getPI(){ return ph; }
     const std::vector< whiteice::math::realnumber >& getPI() const { return ph; }
@@ -106,6 +141,8 @@ namespace whiteice {
     unsigned int getNumVisibleStates() const throw() { return numVisible; }
     unsigned int getNumHiddenStates() const throw() { return numHidden; }
 
+    engine_type getEngine() const throw() { return engine; }
+
     
     // saves and loads HMM to binary file
     bool load(const std::string& filename) throw();
@@ -114,6 +151,30 @@ namespace whiteice {
   private:
     // normalizes parameters by ordering hidden states according to probabilities
     void normalize_parameters();
+
+    // double precision engine (HMM_double.cpp)
+    double train_double(const std::vector< std::vector<unsigned int> >& sequences,
+			const unsigned int MAXITERS, const bool verbose)
+      throw (std::invalid_argument);
+    
+    double ml_states_double(std::vector<unsigned int>& hidden,
+			    const std::vector<unsigned int>& observations) const
+      throw (std::invalid_argument);
+    
+    double logprobability_double(const std::vector<unsigned int>& observations) const
+      throw (std::invalid_argument);
+
+    // copies parameters between realnumbers and double arrays
+    // (A is H x H, B is H x H x V row-major array)
+    void export_double(std::vector<double>& pi,
+		       std::vector<double>& A,
+		       std::vector<double>& B) const;
+    
+    void import_double(const std::vector<double>& pi,
+		       const std::vector<double>& A,
+		       const std::vector<double>& B);
+
+    engine_type engine;
     
     // number of visible and hidden states
     unsigned int numVisible, numHidden;
@@ -0,0 +1,550 @@
+/*
+ * HMM_double.cpp
+ *
+ * double precision engine of HMM: scaled forward-backward (Baum-Welch)
+ * and scaled Viterbi recursions. alpha/beta/delta vectors are normalized
+ * at each step and log(probability) is accumulated from the scaling
+ * coefficients so long sequences do not underflow.
+ *
+ * collections of sequences are processed in parallel (OpenMP) over
+ * sequences with per-thread statistics reduced once per EM iteration.
+ *
+ * transition and emission probabilities are combined to
+ * AB[o][i][j] = A[i][j]*B[i][j][o] so each step is a vector-matrix
+ * product over hidden states (inner loops are vectorized).
+ */
+
+#include "HMM.h"
+
+#include <vector>
+#include <list>
+#include <string>
+#include <algorithm>
+#include <stdio.h>
+#include <math.h>
+
+#include "linear_ETA.h"
+
+
+namespace whiteice {
+
+  // AB[(o*H + i)*H + j] = A[i*H + j]*B[(i*H + j)*V + o]
+  static void hmm_emissions(const std::vector<double>& A,
+			    const std::vector<double>& B,
+			    const unsigned int H, const unsigned int V,
+			    std::vector<double>& AB)
+  {
+    AB.resize(V*H*H);
+
+    for(unsigned int o=0;o<V;o++)
+      for(unsigned int ij=0;ij<H*H;ij++)
+	AB[o*H*H + ij] = A[ij]*B[ij*V + o];
+  }
+
+
+  // scaled forward procedure, alpha is (T+1) x H and c[t] scaling coefficients.
+  // returns log(p(observations)) or throws if probability is zero
+  static double hmm_forward(const std::vector<double>& pi,
+			    const std::vector<double>& AB,
+			    const std::vector<unsigned int>& observations,
+			    const unsigned int H, const unsigned int V,
+			    std::vector<double>& alpha,
+			    std::vector<double>& c)
+  {
+    const unsigned int T = observations.size();
+
+    alpha.resize((T+1)*H);
+    c.resize(T+1);
+
+    double sum = 0.0;
+    for(unsigned int i=0;i<H;i++){
+      alpha[i] = pi[i];
+      sum += pi[i];
+    }
+
+    if(sum <= 0.0)
+      throw std::invalid_argument("HMM: initial state probabilities are zero");
+
+    for(unsigned int i=0;i<H;i++)
+      alpha[i] /= sum;
+
+    c[0] = sum;
+    double logp = log(sum);
+
+    for(unsigned int t=1;t<=T;t++){
+      const unsigned int o = observations[t-1];
+
+      if(o >= V){
+	char buffer[128];
+	snprintf(buffer, 128, "HMM: observed state out of range (%d)", o);
+	throw std::invalid_argument(buffer);
+      }
+
+      const double* a  = &(alpha[(t-1)*H]);
+      double* an = &(alpha[t*H]);
+      const double* M = &(AB[o*H*H]);
+
+      for(unsigned int j=0;j<H;j++)
+	an[j] = 0.0;
+
+      for(unsigned int i=0;i<H;i++){
+	const double ai = a[i];
+	const double* Mi = M + i*H;
+
+#pragma omp simd
+	for(unsigned int j=0;j<H;j++)
+	  an[j] += ai*Mi[j];
+      }
+
+      sum = 0.0;
+
+#pragma omp simd reduction(+:sum)
+      for(unsigned int j=0;j<H;j++)
+	sum += an[j];
+
+      if(sum <= 0.0)
+	throw std::invalid_argument("HMM: observations have zero probability");
+
+      const double inv = 1.0/sum;
+
+#pragma omp simd
+      for(unsigned int j=0;j<H;j++)
+	an[j] *= inv;
+
+      c[t] = sum;
+      logp += log(sum);
+    }
+
+    return logp;
+  }
+
+
+  // scaled backward procedure, accumulates expected transition counts
+  // xi[(o*H + i)*H + j] += p(h(t-1)=i, h(t)=j, o(t)=o | observations)
+  // and initial state probabilities to pi_acc
+  static void hmm_backward(const std::vector<double>& AB,
+			   const std::vector<unsigned int>& observations,
+			   const unsigned int H,
+			   const std::vector<double>& alpha,
+			   const std::vector<double>& c,
+			   double* xi, double* pi_acc)
+  {
+    const unsigned int T = observations.size();
+
+    std::vector<double> beta(H, 1.0), bprev(H);
+
+    for(unsigned int t=T;t>=1;t--){
+      const unsigned int o = observations[t-1];
+      const double* a = &(alpha[(t-1)*H]);
+      const double* M = &(AB[o*H*H]);
+      double* X = xi + o*H*H;
+      const double inv = 1.0/c[t];
+
+      for(unsigned int i=0;i<H;i++){
+	const double* Mi = M + i*H;
+	double* Xi = X + i*H;
+	const double ai = a[i]*inv;
+	double s = 0.0;
+
+#pragma omp simd reduction(+:s)
+	for(unsigned int j=0;j<H;j++){
+	  const double mb = Mi[j]*beta[j];
+	  Xi[j] += ai*mb;
+	  s += mb;
+	}
+
+	bprev[i] = s*inv;
+
+	if(t == 1) pi_acc[i] += a[i]*s*inv;
+      }
+
+      std::swap(beta, bprev);
+    }
+  }
+
+
+  // M-step of Baum-Welch from accumulated statistics,
+  // keeps old parameter values if there are no statistics
+  static void hmm_maximize(const double* pi_acc, const double* xi,
+			   const unsigned int H, const unsigned int V,
+			   std::vector<double>& pi,
+			   std::vector<double>& A,
+			   std::vector<double>& B)
+  {
+    double sum = 0.0;
+    for(unsigned int i=0;i<H;i++)
+      sum += pi_acc[i];
+
+    if(sum > 0.0)
+      for(unsigned int i=0;i<H;i++)
+	pi[i] = pi_acc[i]/sum;
+
+    std::vector<double> n(H*H, 0.0);
+
+    for(unsigned int o=0;o<V;o++)
+      for(unsigned int ij=0;ij<H*H;ij++)
+	n[ij] += xi[o*H*H + ij];
+
+    for(unsigned int i=0;i<H;i++){
+      double y = 0.0;
+      for(unsigned int j=0;j<H;j++)
+	y += n[i*H + j];
+
+      for(unsigned int j=0;j<H;j++){
+	const unsigned int ij = i*H + j;
+
+	if(y > 0.0) A[ij] = n[ij]/y;
+
+	if(n[ij] > 0.0)
+	  for(unsigned int o=0;o<V;o++)
+	    B[ij*V + o] = xi[o*H*H + ij]/n[ij];
+      }
+    }
+  }
+
+
+  void HMM::export_double(std::vector<double>& pi,
+			  std::vector<double>& Ad,
+			  std::vector<double>& Bd) const
+  {
+    const unsigned int H = numHidden, V = numVisible;
+
+    pi.resize(H);
+    Ad.resize(H*H);
+    Bd.resize(H*H*V);
+
+    for(unsigned int i=0;i<H;i++){
+      pi[i] = ph[i].getDouble();
+
+      for(unsigned int j=0;j<H;j++){
+	Ad[i*H + j] = A[i][j].getDouble();
+
+	for(unsigned int k=0;k<V;k++)
+	  Bd[(i*H + j)*V + k] = B[i][j][k].getDouble();
+      }
+    }
+  }
+
+
+  void HMM::import_double(const std::vector<double>& pi,
+			  const std::vector<double>& Ad,
+			  const std::vector<double>& Bd)
+  {
+    const unsigned int H = numHidden, V = numVisible;
+
+    for(unsigned int i=0;i<H;i++){
+      ph[i] = pi[i];
+
+      for(unsigned int j=0;j<H;j++){
+	A[i][j] = Ad[i*H + j];
+
+	for(unsigned int k=0;k<V;k++)
+	  B[i][j][k] = Bd[(i*H + j)*V + k];
+      }
+    }
+  }
+
+
+  // E-step over all sequences, parallel over sequences with per-thread
+  // accumulators which are reduced once. returns sum of log(probability)
+  static double hmm_expectation(const std::vector<double>& pi,
+				const std::vector<double>& AB,
+				const std::vector< std::vector<unsigned int> >& sequences,
+				const unsigned int H, const unsigned int V,
+				std::vector<double>& xi,
+				std::vector<double>& pi_acc)
+  {
+    std::fill(xi.begin(), xi.end(), 0.0);
+    std::fill(pi_acc.begin(), pi_acc.end(), 0.0);
+
+    double logp = 0.0;
+    std::string error;
+
+#pragma omp parallel
+    {
+      std::vector<double> alpha, c;
+      std::vector<double> xi_local(V*H*H, 0.0), pi_local(H, 0.0);
+      double logp_local = 0.0;
+      std::string error_local;
+
+#pragma omp for schedule(dynamic) nowait
+      for(unsigned int n=0;n<sequences.size();n++){
+	if(sequences[n].size() == 0 || error_local.size() > 0) continue;
+
+	try{
+	  logp_local += hmm_forward(pi, AB, sequences[n], H, V, alpha, c);
+	  hmm_backward(AB, sequences[n], H, alpha, c, &(xi_local[0]), &(pi_local[0]));
+	}
+	catch(std::invalid_argument& e){
+	  error_local = e.what();
+	}
+      }
+
+#pragma omp critical
+      {
+	for(unsigned int i=0;i<V*H*H;i++)
+	  xi[i] += xi_local[i];
+
+	for(unsigned int i=0;i<H;i++)
+	  pi_acc[i] += pi_local[i];
+
+	logp += logp_local;
+
+	if(error_local.size() > 0) error = error_local;
+      }
+    }
+
+    if(error.size() > 0)
+      throw std::invalid_argument(error);
+
+    return logp;
+  }
+
+
+  double HMM::train(const std::vector< std::vector<unsigned int> >& sequences,
+		    const unsigned int MAXITERS, const bool verbose)
+    throw (std::invalid_argument)
+  {
+    if(MAXITERS == 0) return 0.0;
+
+    return train_double(sequences, MAXITERS, verbose);
+  }
+
+
+  double HMM::train_double(const std::vector< std::vector<unsigned int> >& sequences,
+			   const unsigned int MAXITERS, const bool verbose)
+    throw (std::invalid_argument)
+  {
+    const unsigned int H = numHidden, V = numVisible;
+
+    double T = 0.0; // total number of observations
+    for(const auto& s : sequences)
+      T += (double)s.size();
+
+    if(T == 0.0)
+      throw std::invalid_argument("HMM::train() - no observations");
+
+    std::vector<double> pi, Ad, Bd, AB;
+    std::vector<double> xi(V*H*H), pi_acc(H);
+
+    export_double(pi, Ad, Bd);
+
+    bool converged = false;
+    std::list<double> pdata;
+    unsigned int iteration = 0;
+    double plast = 0.0;
+
+    linear_ETA<float> eta;
+    eta.start((float)iteration, (float)MAXITERS);
+
+    if(verbose)
+    {
+      hmm_emissions(Ad, Bd, H, V, AB);
+      
+      printf("ITER %d. Log(probability) = %f\n", iteration,
+	     hmm_expectation(pi, AB, sequences, H, V, xi, pi_acc)/T);
+      fflush(stdout);
+    }
+
+    while(!converged && iteration < MAXITERS)
+    {
+      hmm_emissions(Ad, Bd, H, V, AB);
+
+      // E-step
+      const double logp = hmm_expectation(pi, AB, sequences, H, V, xi, pi_acc);
+
+      // M-step
+      hmm_maximize(&(pi_acc[0]), &(xi[0]), H, V, pi, Ad, Bd);
+
+      // E[p(o)] = p(observations)**(1/length(observations)) of previous parameters
+      const double po = exp(logp/T);
+
+      plast = logp/T;
+      pdata.push_back(po);
+
+      iteration++;
+      eta.update((float)iteration);
+
+      if(verbose)
+      {
+	printf("ITER %d. Log(probability) = %f [ETA %f minutes]\n",
+	       iteration, plast, eta.estimate()/60.0f);
+	fflush(stdout);
+      }
+
+      // estimates convergence (st.dev/mean of the latest values)
+      {
+	if(pdata.size() < 10)
+	  continue;
+
+	while(pdata.size() > 30)
+	  pdata.pop_front();
+
+	double m = 0.0, s = 0.0;
+
+	for(auto& p : pdata){
+	  m += p;
+	  s += p*p;
+	}
+
+	m /= (double)pdata.size();
+	s /= (double)pdata.size();
+	s = sqrt(fabs(s - m*m));
+
+	if(s/m <= 0.00001)
+	  converged = true;
+      }
+    }
+
+    import_double(pi, Ad, Bd);
+    normalize_parameters();
+
+    return plast;
+  }
+
+
+  double HMM::ml_states_double(std::vector<unsigned int>& hidden,
+			       const std::vector<unsigned int>& observations) const
+    throw (std::invalid_argument)
+  {
+    const unsigned int H = numHidden, V = numVisible;
+    const unsigned int T = observations.size();
+
+    std::vector<double> pi, Ad, Bd, AB;
+    export_double(pi, Ad, Bd);
+    hmm_emissions(Ad, Bd, H, V, AB);
+
+    // scaled delta: max of each step is normalized to one
+    std::vector<double> d(pi), dnext(H);
+    std::vector<unsigned int> psi(T*H);
+    double logp = 0.0;
+
+    for(unsigned int t=1;t<=T;t++){
+      const unsigned int o = observations[t-1];
+
+      if(o >= V)
+	throw std::invalid_argument("HMM::ml_states() - observed state out of range");
+
+      const double* M = &(AB[o*H*H]);
+      unsigned int* p = &(psi[(t-1)*H]);
+
+      for(unsigned int j=0;j<H;j++){
+	dnext[j] = 0.0;
+	p[j] = 0;
+      }
+
+      for(unsigned int i=0;i<H;i++){
+	const double di = d[i];
+	const double* Mi = M + i*H;
+
+#pragma omp simd
+	for(unsigned int j=0;j<H;j++){
+	  const double v = di*Mi[j];
+	  if(v > dnext[j]){
+	    dnext[j] = v;
+	    p[j] = i;
+	  }
+	}
+      }
+
+      double max = 0.0;
+      for(unsigned int j=0;j<H;j++)
+	if(dnext[j] > max) max = dnext[j];
+
+      if(max <= 0.0)
+	throw std::invalid_argument("HMM::ml_states() - observations have zero probability");
+
+      for(unsigned int j=0;j<H;j++)
+	d[j] = dnext[j]/max;
+
+      logp += log(max);
+    }
+
+    // backtracks the best path (max(d) is one after scaling)
+    unsigned int h = 0;
+    double max = 0.0;
+
+    for(unsigned int j=0;j<H;j++){
+      if(d[j] > max){
+	max = d[j];
+	h = j;
+      }
+    }
+
+    if(T == 0){
+      hidden.clear();
+      return log(max);
+    }
+
+    hidden.resize(T);
+
+    for(unsigned int t=T;t>=1;t--){
+      hidden[t-1] = h;
+      h = psi[(t-1)*H + h];
+    }
+
+    return logp;
+  }
+
+
+  double HMM::logprobability_double(const std::vector<unsigned int>& observations) const
+    throw (std::invalid_argument)
+  {
+    const unsigned int H = numHidden, V = numVisible;
+
+    std::vector<double> pi, Ad, Bd, AB;
+    std::vector<double> alpha, c;
+
+    export_double(pi, Ad, Bd);
+    hmm_emissions(Ad, Bd, H, V, AB);
+
+    const double logp = hmm_forward(pi, AB, observations, H, V, alpha, c);
+
+    return logp/((double)observations.size());
+  }
+
+
+  void HMM::logprobability(const std::vector< std::vector<unsigned int> >& sequences,
+			   std::vector<double>& logp) const
+    throw (std::invalid_argument)
+  {
+    const unsigned int H = numHidden, V = numVisible;
+
+    logp.resize(sequences.size());
+
+    std::vector<double> pi, Ad, Bd, AB;
+    std::string error;
+
+    if(engine == DOUBLE_PRECISION){
+      export_double(pi, Ad, Bd);
+      hmm_emissions(Ad, Bd, H, V, AB);
+    }
+
+#pragma omp parallel
+    {
+      std::vector<double> alpha, c;
+
+#pragma omp for schedule(dynamic)
+      for(unsigned int n=0;n<sequences.size();n++){
+	logp[n] = 0.0;
+	if(sequences[n].size() == 0) continue;
+
+	try{
+	  if(engine == DOUBLE_PRECISION)
+	    logp[n] = hmm_forward(pi, AB, sequences[n], H, V, alpha, c)/
+	      ((double)sequences[n].size());
+	  else
+	    logp[n] = logprobability(sequences[n]);
+	}
+	catch(std::invalid_argument& e){
+#pragma omp critical
+	  error = e.what();
+	}
+      }
+    }
+
+    if(error.size() > 0)
+      throw std::invalid_argument(error);
+  }
+
+} /* namespace whiteice */
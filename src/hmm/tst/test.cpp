@@ -4,10 +4,12 @@
 #include <stdlib.h>
 #include <time.h>
 #include <assert.h>
+#include <math.h>
 
 #include "HMM.h"
 
 #include <vector>
+#include <cmath>
 
 
 
@@ -269,5 +271,124 @@ void hmm_test()
     
     printf("HMM LOAD() & SAVE() TESTS PASSED\n");
   }
+
+
+  {
+    printf("HMM - DOUBLE PRECISION ENGINE TEST\n");
+
+    // double precision engine must give the same results as arbitrary precision
+    whiteice::HMM hmm1(4, 3, whiteice::HMM::ARBITRARY_PRECISION);
+    whiteice::HMM hmm2(4, 3, whiteice::HMM::DOUBLE_PRECISION);
+
+    hmm1.randomize();
+    hmm2.getPI() = hmm1.getPI();
+    hmm2.getA() = hmm1.getA();
+    hmm2.getB() = hmm1.getB();
+
+    std::vector<unsigned int> data;
+    assert(hmm1.sample(500, data) == true);
+
+    double p1 = hmm1.logprobability(data);
+    double p2 = hmm2.logprobability(data);
+
+    if(fabs(p1 - p2) > 1e-9){
+      printf("ERROR: logprobability() mismatch between engines: %f %f\n", p1, p2);
+      return;
+    }
+
+    std::vector<unsigned int> h1, h2;
+    p1 = hmm1.ml_states(h1, data);
+    p2 = hmm2.ml_states(h2, data);
+
+    if(fabs(p1 - p2) > 1e-6*fabs(p1) || h1 != h2 || h1.size() != data.size()){
+      printf("ERROR: ml_states() mismatch between engines: %f %f\n", p1, p2);
+      return;
+    }
+
+    p1 = hmm1.train(data, 5, false);
+    p2 = hmm2.train(data, 5, false);
+
+    if(fabs(p1 - p2) > 1e-9){
+      printf("ERROR: train() mismatch between engines: %f %f\n", p1, p2);
+      return;
+    }
+
+    double error = 0.0;
+
+    for(unsigned int i=0;i<3;i++){
+      error += fabs((hmm1.getPI()[i] - hmm2.getPI()[i]).getDouble());
+      for(unsigned int j=0;j<3;j++){
+	error += fabs((hmm1.getA()[i][j] - hmm2.getA()[i][j]).getDouble());
+	for(unsigned int k=0;k<4;k++)
+	  error += fabs((hmm1.getB()[i][j][k] - hmm2.getB()[i][j][k]).getDouble());
+      }
+    }
+
+    if(error > 1e-6){
+      printf("ERROR: trained parameters mismatch between engines: %e\n", error);
+      return;
+    }
+
+    // long sequence does not underflow in double precision
+    assert(hmm2.sample(200000, data) == true);
+    p2 = hmm2.logprobability(data);
+
+    if(std::isfinite(p2) == false || p2 >= 0.0){
+      printf("ERROR: bad logprobability() for long sequence: %f\n", p2);
+      return;
+    }
+    
+    printf("HMM DOUBLE PRECISION ENGINE TESTS PASSED\n");
+  }
+
+
+  {
+    printf("HMM - MANY SEQUENCES TEST\n");
+
+    whiteice::HMM hmm1(5, 3, whiteice::HMM::DOUBLE_PRECISION);
+    whiteice::HMM hmm2(5, 3, whiteice::HMM::DOUBLE_PRECISION);
+    hmm1.randomize();
+    hmm2.randomize();
+
+    std::vector< std::vector<unsigned int> > data(500);
+    
+    for(auto& d : data)
+      assert(hmm1.sample(rand() % 30 + 1, d) == true);
+
+    // batch scoring must equal scoring of individual sequences
+    std::vector<double> logp;
+    hmm1.logprobability(data, logp);
+
+    for(unsigned int i=0;i<data.size();i++){
+      if(fabs(logp[i] - hmm1.logprobability(data[i])) > 1e-9){
+	printf("ERROR: batch logprobability() mismatch (%d)\n", i);
+	return;
+      }
+    }
+
+    // training from all sequences must improve model fit
+    double total1 = 0.0, total2 = 0.0, N = 0.0;
+
+    hmm2.logprobability(data, logp);
+    for(unsigned int i=0;i<data.size();i++){
+      total1 += logp[i]*data[i].size();
+      N += data[i].size();
+    }
+
+    const double r = hmm2.train(data, 200, false);
+
+    hmm2.logprobability(data, logp);
+    for(unsigned int i=0;i<data.size();i++)
+      total2 += logp[i]*data[i].size();
+
+    printf("MODEL FIT (logp): %f => %f (train %f)\n", total1/N, total2/N, r);
+
+    if(total2 <= total1 || fabs(r - total2/N) > 0.01){
+      printf("ERROR: training from many sequences failed\n");
+      return;
+    }
+
+    printf("HMM MANY SEQUENCES TESTS PASSED\n");
+  }
   
 }
@@ -1,6 +1,7 @@
 
 #include "LBFGS.h"
 #include "linear_equations.h"
+#include "Log.h"
 #include <iostream>
 #include <list>
 #include <functional>
@@ -27,7 +28,6 @@ namespace whiteice
 		thread_running = false;
 		sleep_mode = false;
 		solution_converged = false;
-		optimizer_thread = nullptr;
 		this->overfit = overfit;
     }
     
@@ -45,11 +45,8 @@ namespace whiteice
     		// thread_is_running_cond.wait_for(lock, std::chrono::milliseconds(1000)); // 1 second
     	}
 
-    	if(optimizer_thread){
-	        optimizer_thread->join();
-		delete optimizer_thread;
-	}
-    	optimizer_thread = nullptr;
+    	try{ optimizer_thread.join(); }
+    	catch(...){ } // destructor must not throw
 
     	thread_mutex.unlock();
     }
@@ -60,7 +57,7 @@ namespace whiteice
     {
     	thread_mutex.lock();
 
-    	if(thread_running || optimizer_thread != nullptr){
+    	if(thread_running || optimizer_thread.joinable()){
     		thread_mutex.unlock();
     		return false;
     	}
@@ -71,7 +68,14 @@ namespace whiteice
     		heuristics(x0);
 
     		this->bestx = x0;
-    		this->besty = getError(x0);
+    		
+    		try{ this->besty = getError(x0); }
+    		catch(std::exception& e){
+    			whiteice::logging.error(std::string("LBFGS: unexpected exception: ") + e.what());
+    			solution_mutex.unlock();
+    			thread_mutex.unlock();
+    			return false;
+    		}
 
     		iterations  = 0;
     	}
@@ -84,10 +88,8 @@ namespace whiteice
 
     	try{
     		optimizer_thread =
-		  new thread(std::bind(&LBFGS<T>::optimizer_loop,
-				       this));
-		
-    		// optimizer_thread->detach();
+		  whiteice::thread_pool::global().start(std::bind(&LBFGS<T>::optimizer_loop,
+								  this));
     	}
     	catch(std::exception& e){
     		thread_running = false;
@@ -162,11 +164,7 @@ namespace whiteice
     	// std::unique_lock<std::mutex> lock(thread_is_running_mutex);
     	// thread_is_running_cond.wait_for(lock, std::chrono::milliseconds(1000)); // 1 sec
 
-    	if(optimizer_thread){
-	        optimizer_thread->join();
-    		delete optimizer_thread;
-	}
-    	optimizer_thread = nullptr;
+    	optimizer_thread.join();
 
     	thread_mutex.unlock();
 
@@ -497,9 +495,9 @@ namespace whiteice
     			iterations++;
     		}
     		catch(std::exception& e){
-    			std::cout << "ERROR: Unexpected exception: "
-    					<< e.what() << std::endl;
-    			fflush(stdout);
+    			// U() or Ugrad() failed, stops optimization
+    			whiteice::logging.error(std::string("LBFGS: unexpected exception: ") + e.what());
+    			break;
     		}
 
     		////////////////////////////////////////////////////////////
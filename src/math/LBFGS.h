@@ -10,6 +10,7 @@
 
 #include "dinrhiw_blas.h"
 #include "vertex.h"
+#include "thread_pool.h"
 
 
 #ifndef LBFGS_h
@@ -91,7 +92,7 @@ namespace whiteice
         mutable std::mutex thread_is_running_mutex;
         mutable std::condition_variable thread_is_running_cond;
         
-        std::thread* optimizer_thread;
+        whiteice::thread_pool::job optimizer_thread;
         mutable std::mutex sleep_mutex, thread_mutex, solution_mutex;
 	
       private:
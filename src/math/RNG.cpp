@@ -14,6 +14,7 @@
 #include <math.h>
 #include <time.h>
 #include <stdlib.h>
+#include <string.h>
 
 // Ziggurat code is almost directly from the paper of George Marsaglia:
 // "The Ziggurat Method for Generating Random Variableas" (2000)
@@ -21,7 +22,7 @@
 namespace whiteice {
 
 template <typename T>
-RNG<T>::RNG(const bool usehw)
+RNG<T>::RNG(const bool usehw) : philox_counter(0)
 {
   // uses CPUID to check for RDRAND instruction
   bool has_rdrand = false;
@@ -65,6 +66,65 @@ RNG<T>::RNG(const bool usehw)
   calculate_ziggurat_tables();
 }
 
+
+template <typename T>
+RNG<T>::RNG(const unsigned long long seed, const unsigned long long stream) :
+  philox_seed(seed), philox_stream(stream), philox_counter(0)
+{
+  rdrand32 = &whiteice::RNG<T>::_philox32;
+  rdrand64 = &whiteice::RNG<T>::_philox64;
+
+  calculate_ziggurat_tables();
+}
+
+
+template <typename T>
+RNG<T>::RNG(const RNG<T>& rng) : philox_counter(0)
+{
+  *this = rng;
+}
+
+
+template <typename T>
+RNG<T>& RNG<T>::operator=(const RNG<T>& rng)
+{
+  if(this == &rng) return *this;
+
+  memcpy(kn, rng.kn, sizeof(kn));
+  memcpy(ke, rng.ke, sizeof(ke));
+  memcpy(wn, rng.wn, sizeof(wn));
+  memcpy(fn, rng.fn, sizeof(fn));
+  memcpy(we, rng.we, sizeof(we));
+  memcpy(fe, rng.fe, sizeof(fe));
+
+  rdrand32 = rng.rdrand32;
+  rdrand64 = rng.rdrand64;
+
+  philox_seed = rng.philox_seed;
+  philox_stream = rng.philox_stream;
+  philox_counter = rng.philox_counter.load();
+
+  return *this;
+}
+
+
+template <typename T>
+RNG<T> RNG<T>::stream(const unsigned long long id) const
+{
+  if(isCounterBased())
+    return RNG<T>(philox_seed, id);
+  else
+    return RNG<T>(rand64(), id);
+}
+
+
+template <typename T>
+bool RNG<T>::isCounterBased() const throw()
+{
+  return (rdrand32 == &whiteice::RNG<T>::_philox32);
+}
+
+
 template <typename T>
 unsigned int RNG<T>::rand() const{ return (this->*rdrand32)(); }
 
@@ -83,12 +143,7 @@ T RNG<T>::uniform() const // [0,1]
 
 template <typename T>
 void RNG<T>::uniform(math::vertex<T>& u) const{
-  // const double MAX = (double)((unsigned long long)(-1LL)); // 2**64 - 1
-  
-  for(unsigned int i=0;i<u.size();i++){
-    // u[i] = T(rdrand64()/MAX);
-    u[i] = T(unid());
-  }
+  if(u.size() > 0) uniform(&(u[0]), u.size());
 }
 
 
@@ -101,8 +156,7 @@ T RNG<T>::normal() const{
 template <typename T>
 void RNG<T>::normal(math::vertex<T>& n) const
 {
-  for(unsigned int i=0;i<n.size();i++)
-    n[i] = T(rnor());
+  if(n.size() > 0) normal(&(n[0]), n.size());
 }
 
 
@@ -118,9 +172,173 @@ T RNG<T>::exp() const
 template <typename T>
 void RNG<T>::exp(math::vertex<T>& ev) const
 {
-  for(unsigned int i=0;i<ev.size();i++){
-    const float e = rexp();
-    ev[i] = T(e >= 0.0f ? e : (-e));
+  if(ev.size() > 0) exp(&(ev[0]), ev.size());
+}
+
+
+// number of 32bit words generated at once by vector fills
+#define RNG_BULK_WORDS 256
+
+
+template <typename T>
+void RNG<T>::uniform(T* u, const unsigned int N) const
+{
+  if(!isCounterBased()){
+    for(unsigned int i=0;i<N;i++)
+      u[i] = T(unid());
+    return;
+  }
+
+  unsigned int r[RNG_BULK_WORDS];
+
+  for(unsigned int i=0;i<N;i+=RNG_BULK_WORDS){
+    const unsigned int n = (N - i < RNG_BULK_WORDS) ? (N - i) : RNG_BULK_WORDS;
+    philox_words(r, n);
+
+    for(unsigned int j=0;j<n;j++) // (0,1) interval
+      u[i+j] = T((r[j] + 0.5)*2.3283064365386963e-10);
+  }
+}
+
+
+template <typename T>
+void RNG<T>::normal(T* nv, const unsigned int N) const
+{
+  if(!isCounterBased()){
+    for(unsigned int i=0;i<N;i++)
+      nv[i] = T(rnor());
+    return;
+  }
+
+  unsigned int r[RNG_BULK_WORDS];
+
+  for(unsigned int i=0;i<N;i+=RNG_BULK_WORDS){
+    const unsigned int n = (N - i < RNG_BULK_WORDS) ? (N - i) : RNG_BULK_WORDS;
+    philox_words(r, n);
+
+    // ziggurat fast path, rare rejections are handled by nfix()
+    for(unsigned int j=0;j<n;j++){
+      const int hz = (int)r[j];
+      const unsigned int iz = hz & 127;
+      const unsigned int ahz = (hz < 0) ? (0U - (unsigned int)hz) : (unsigned int)hz;
+
+      if(ahz < kn[iz]) nv[i+j] = T(hz*wn[iz]);
+      else nv[i+j] = T(nfix(hz, iz));
+    }
+  }
+}
+
+
+template <typename T>
+void RNG<T>::exp(T* ev, const unsigned int N) const
+{
+  if(!isCounterBased()){
+    for(unsigned int i=0;i<N;i++){
+      const float e = rexp();
+      ev[i] = T(e >= 0.0f ? e : (-e));
+    }
+    return;
+  }
+
+  unsigned int r[RNG_BULK_WORDS];
+
+  for(unsigned int i=0;i<N;i+=RNG_BULK_WORDS){
+    const unsigned int n = (N - i < RNG_BULK_WORDS) ? (N - i) : RNG_BULK_WORDS;
+    philox_words(r, n);
+
+    for(unsigned int j=0;j<n;j++){
+      const int jz = (int)r[j];
+      const unsigned int iz = jz & 255;
+
+      const float e = (jz < (signed)ke[iz]) ? (jz*we[iz]) : efix(jz, iz);
+      ev[i+j] = T(e >= 0.0f ? e : (-e));
+    }
+  }
+}
+
+
+template <typename T>
+void RNG<T>::philox(const unsigned int counter[4], const unsigned int key[2],
+		    unsigned int out[4]) throw()
+{
+  unsigned int c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+  unsigned int k0 = key[0], k1 = key[1];
+
+  for(unsigned int round=0;round<10;round++){
+    const unsigned long long p0 = 0xD2511F53ULL*c0;
+    const unsigned long long p1 = 0xCD9E8D57ULL*c2;
+
+    c0 = ((unsigned int)(p1 >> 32)) ^ c1 ^ k0;
+    c1 = (unsigned int)p1;
+    c2 = ((unsigned int)(p0 >> 32)) ^ c3 ^ k1;
+    c3 = (unsigned int)p0;
+
+    k0 += 0x9E3779B9U;
+    k1 += 0xBB67AE85U;
+  }
+
+  out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+}
+
+
+template <typename T>
+void RNG<T>::philox_words(unsigned int* r, const unsigned int N) const
+{
+  // reserves whole 4 word blocks from the counter
+  const unsigned long long blocks = (N + 3)/4;
+  unsigned long long block = (philox_counter.fetch_add(4*blocks + 3) + 3)/4;
+
+  const unsigned int key0 = (unsigned int)philox_seed;
+  const unsigned int key1 = (unsigned int)(philox_seed >> 32);
+  const unsigned int s0 = (unsigned int)philox_stream;
+  const unsigned int s1 = (unsigned int)(philox_stream >> 32);
+
+  // lanes are independent so compiler can vectorize the rounds
+  const unsigned int B = 64;
+  unsigned int c0[B], c1[B], c2[B], c3[B];
+
+  for(unsigned int i=0;i<N;i+=4*B){
+    const unsigned int nb = ((N - i + 3)/4 < B) ? ((N - i + 3)/4) : B;
+
+    for(unsigned int j=0;j<nb;j++){
+      c0[j] = (unsigned int)(block + j);
+      c1[j] = (unsigned int)((block + j) >> 32);
+      c2[j] = s0;
+      c3[j] = s1;
+    }
+
+    unsigned int k0 = key0, k1 = key1;
+
+    for(unsigned int round=0;round<10;round++){
+      for(unsigned int j=0;j<nb;j++){
+	const unsigned long long p0 = 0xD2511F53ULL*c0[j];
+	const unsigned long long p1 = 0xCD9E8D57ULL*c2[j];
+
+	c0[j] = ((unsigned int)(p1 >> 32)) ^ c1[j] ^ k0;
+	c1[j] = (unsigned int)p1;
+	c2[j] = ((unsigned int)(p0 >> 32)) ^ c3[j] ^ k1;
+	c3[j] = (unsigned int)p0;
+      }
+
+      k0 += 0x9E3779B9U;
+      k1 += 0xBB67AE85U;
+    }
+
+    const unsigned int n = (N - i < 4*B) ? (N - i) : 4*B;
+
+    for(unsigned int j=0;j<n/4;j++){
+      r[i+4*j+0] = c0[j];
+      r[i+4*j+1] = c1[j];
+      r[i+4*j+2] = c2[j];
+      r[i+4*j+3] = c3[j];
+    }
+
+    for(unsigned int j=(n/4)*4;j<n;j++){
+      const unsigned int c[4] = { c0[j/4], c1[j/4], c2[j/4], c3[j/4] };
+      r[i+j] = c[j & 3];
+    }
+
+    block += nb;
   }
 }
 
@@ -138,28 +356,35 @@ float RNG<T>::rnor() const
 		return hz*wn[iz];
 	}
 	else{
-		// nfix()
-		const float r = 3.442620f;
-		float x, y;
-
-		for(;;){
-			x=hz*wn[iz];
+		return nfix(hz, iz);
+	}
+}
 
-			if(iz==0){
-				do{ x=-math::log(unid())*0.2904764; y=-math::log(unid()); } while(y+y<x*x);
 
-				return (hz>0) ? r+x : -r-x;
-			}
+// rnor() rejection step for the first random number hz
+template <typename T>
+float RNG<T>::nfix(int hz, unsigned int iz) const
+{
+	const float r = 3.442620f;
+	float x, y;
 
-			if( fn[iz]+unid()*(fn[iz-1]-fn[iz]) < math::exp(-.5*x*x) )
-				return x;
+	for(;;){
+		x=hz*wn[iz];
 
-			hz=(signed)(this->*rdrand32)();
-			iz=hz&127;
+		if(iz==0){
+			do{ x=-math::log(unid())*0.2904764; y=-math::log(unid()); } while(y+y<x*x);
 
-			if((unsigned int)math::abs(hz)<kn[iz])
-				return (hz*wn[iz]);
+			return (hz>0) ? r+x : -r-x;
 		}
+
+		if( fn[iz]+unid()*(fn[iz-1]-fn[iz]) < math::exp(-.5*x*x) )
+			return x;
+
+		hz=(signed)(this->*rdrand32)();
+		iz=hz&127;
+
+		if((unsigned int)math::abs(hz)<kn[iz])
+			return (hz*wn[iz]);
 	}
 }
 
@@ -174,23 +399,30 @@ float RNG<T>::rexp() const
 		return jz*we[iz];
 	}
 	else{
-		// efix()
-		float x;
+		return efix(jz, iz);
+	}
+}
 
-		for(;;){
-			if(iz==0)
-				return (7.69711-math::log(unid()));
 
-			x=jz*we[iz];
-			if( fe[iz]+unid()*(fe[iz-1]-fe[iz]) < math::exp(-x) )
-				return (x);
+// rexp() rejection step for the first random number jz
+template <typename T>
+float RNG<T>::efix(int jz, unsigned int iz) const
+{
+	float x;
 
-			jz=(this->*rdrand32)();
-			iz=(jz&255);
+	for(;;){
+		if(iz==0)
+			return (7.69711-math::log(unid()));
 
-			if(jz<(signed)ke[iz]) // added (signed)
-				return (jz*we[iz]);
-		}
+		x=jz*we[iz];
+		if( fe[iz]+unid()*(fe[iz-1]-fe[iz]) < math::exp(-x) )
+			return (x);
+
+		jz=(this->*rdrand32)();
+		iz=(jz&255);
+
+		if(jz<(signed)ke[iz]) // added (signed)
+			return (jz*we[iz]);
 	}
 }
 
@@ -300,6 +532,31 @@ unsigned long long RNG<T>::_rand64() const
   return ((r1) ^ (r2 << 16) ^ (r3 << 32) ^ (r4 << 48));
 }
 
+template <typename T>
+unsigned int RNG<T>::_philox32() const
+{
+  const unsigned long long w = philox_counter.fetch_add(1);
+  const unsigned long long block = w >> 2;
+
+  const unsigned int counter[4] = { (unsigned int)block, (unsigned int)(block >> 32),
+				    (unsigned int)philox_stream, (unsigned int)(philox_stream >> 32) };
+  const unsigned int key[2] = { (unsigned int)philox_seed, (unsigned int)(philox_seed >> 32) };
+  unsigned int out[4];
+
+  philox(counter, key, out);
+
+  return out[w & 3];
+}
+
+template <typename T>
+unsigned long long RNG<T>::_philox64() const
+{
+  const unsigned long long r1 = _philox32();
+  const unsigned long long r2 = _philox32();
+
+  return ((r1 << 32) | r2);
+}
+
 template <typename T>
 void RNG<T>::cpuid(unsigned int leaf, unsigned int subleaf, unsigned int regs[4])
 {
@@ -11,6 +11,7 @@
 #include <exception>
 #include <stdexcept>
 #include <random>
+#include <atomic>
 
 #include "vertex.h"
 
@@ -26,6 +27,12 @@ namespace whiteice {
    *       normally distributed variables than this when using software RNG.
    *       => Currently only use this when thread-safety is an issue.
    *       => Study C++ normal distribution random number generation in detail.
+   *
+   * RNG(seed, stream) creates counter based Philox4x32-10 generator instead.
+   * Streams with the same seed and different stream ids are independent and
+   * reproducible so each thread of a sampler can have its own stream
+   * (see stream()). Counter is atomic so generator can also be shared
+   * between threads. Vector fills generate random numbers in blocks.
    */
   template <typename T=math::blas_real<float> >
     class RNG {
@@ -33,7 +40,21 @@ namespace whiteice {
 
   // uses regular rand() if rdrand is not supported or usehw = false
   RNG(const bool usehw = false); 
+
+  // counter based generator: stream of random numbers keyed by (seed, stream)
+  RNG(const unsigned long long seed, const unsigned long long stream);
+
+  RNG(const RNG<T>& rng);
   virtual ~RNG(){ }
+
+  RNG<T>& operator=(const RNG<T>& rng);
+
+  // returns counter based generator for independent stream id, streams are
+  // keyed by seed of this generator (or by a random seed if this generator
+  // is not counter based)
+  RNG<T> stream(const unsigned long long id) const;
+
+  bool isCounterBased() const throw();
   
   unsigned int rand() const; // 32bit
   unsigned long long rand64() const; // 64bit
@@ -46,8 +67,24 @@ namespace whiteice {
   
   T exp() const; // Exp(lambda=2) [not lambda != 1]
   void exp(math::vertex<T>& e) const;
+
+  // fills N values in bulk
+  void uniform(T* u, const unsigned int N) const;
+  void normal(T* n, const unsigned int N) const;
+  void exp(T* e, const unsigned int N) const;
+
+  // Philox4x32-10 block function: out = philox(counter, key)
+  static void philox(const unsigned int counter[4], const unsigned int key[2],
+		     unsigned int out[4]) throw();
   
   protected:
+
+  // generates N 32bit random numbers (counter based generator)
+  void philox_words(unsigned int* r, const unsigned int N) const;
+
+  unsigned long long philox_seed = 0;
+  unsigned long long philox_stream = 0;
+  mutable std::atomic<unsigned long long> philox_counter; // next 32bit word
   
   // ziggurat method lookup tables (read-only)
   unsigned int kn[128], ke[256];
@@ -55,6 +92,8 @@ namespace whiteice {
   
   float rnor() const;
   float rexp() const;
+  float nfix(int hz, unsigned int iz) const;
+  float efix(int jz, unsigned int iz) const;
   void calculate_ziggurat_tables();
   
   double unid() const;
@@ -71,6 +110,10 @@ namespace whiteice {
   // rand() using instructions to use if RDRAND is not available
   virtual unsigned int _rand32() const;
   virtual unsigned long long _rand64() const;
+
+  // counter based generator
+  unsigned int _philox32() const;
+  unsigned long long _philox64() const;
   
   void cpuid(unsigned int leaf, unsigned int subleaf, unsigned int regs[4]);
   };
@@ -0,0 +1,117 @@
+/*
+ * row-major general matrix multiplication for raw data arrays
+ * (float, double, blas_real<float> and blas_real<double> use BLAS)
+ */
+
+#ifndef blas_gemm_h
+#define blas_gemm_h
+
+#include "blas_primitives.h"
+
+
+namespace whiteice
+{
+  namespace math
+  {
+    // C = alpha*op(A)*op(B) + beta*C, op(A) is M x K and op(B) is K x N.
+    // C is not read when beta is zero. overloads select BLAS at compile time
+    // so each number format only compiles its own pointer conversions
+
+    inline void gemm(const bool transA, const bool transB,
+		     const unsigned int M, const unsigned int N, const unsigned int K,
+		     const float alpha,
+		     const float* A, const unsigned int lda,
+		     const float* B, const unsigned int ldb,
+		     const float beta,
+		     float* C, const unsigned int ldc)
+    {
+      if(M == 0 || N == 0) return;
+
+      cblas_sgemm(CblasRowMajor,
+		  transA ? CblasTrans : CblasNoTrans,
+		  transB ? CblasTrans : CblasNoTrans,
+		  M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+    }
+
+
+    inline void gemm(const bool transA, const bool transB,
+		     const unsigned int M, const unsigned int N, const unsigned int K,
+		     const float alpha,
+		     const double* A, const unsigned int lda,
+		     const double* B, const unsigned int ldb,
+		     const float beta,
+		     double* C, const unsigned int ldc)
+    {
+      if(M == 0 || N == 0) return;
+
+      cblas_dgemm(CblasRowMajor,
+		  transA ? CblasTrans : CblasNoTrans,
+		  transB ? CblasTrans : CblasNoTrans,
+		  M, N, K, (double)alpha, A, lda, B, ldb, (double)beta, C, ldc);
+    }
+
+
+    // blas_real<> has the same memory layout as its number type
+    // (packed struct, pointer conversions are safe)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Waddress-of-packed-member"
+
+    inline void gemm(const bool transA, const bool transB,
+		     const unsigned int M, const unsigned int N, const unsigned int K,
+		     const float alpha,
+		     const blas_real<float>* A, const unsigned int lda,
+		     const blas_real<float>* B, const unsigned int ldb,
+		     const float beta,
+		     blas_real<float>* C, const unsigned int ldc)
+    {
+      gemm(transA, transB, M, N, K, alpha,
+	   (const float*)A, lda, (const float*)B, ldb, beta, (float*)C, ldc);
+    }
+
+
+    inline void gemm(const bool transA, const bool transB,
+		     const unsigned int M, const unsigned int N, const unsigned int K,
+		     const float alpha,
+		     const blas_real<double>* A, const unsigned int lda,
+		     const blas_real<double>* B, const unsigned int ldb,
+		     const float beta,
+		     blas_real<double>* C, const unsigned int ldc)
+    {
+      gemm(transA, transB, M, N, K, alpha,
+	   (const double*)A, lda, (const double*)B, ldb, beta, (double*)C, ldc);
+    }
+
+#pragma GCC diagnostic pop
+
+
+    // other number types use loops
+    template <typename T>
+      inline void gemm(const bool transA, const bool transB,
+		       const unsigned int M, const unsigned int N, const unsigned int K,
+		       const float alpha,
+		       const T* A, const unsigned int lda,
+		       const T* B, const unsigned int ldb,
+		       const float beta,
+		       T* C, const unsigned int ldc)
+    {
+      for(unsigned int j=0;j<M;j++){
+	for(unsigned int i=0;i<N;i++){
+	  T sum = T(0.0f);
+
+	  for(unsigned int k=0;k<K;k++){
+	    const T& a = transA ? A[k*lda + j] : A[j*lda + k];
+	    const T& b = transB ? B[i*ldb + k] : B[k*ldb + i];
+	    sum += a*b;
+	  }
+
+	  if(beta == 0.0f) C[j*ldc + i] = T(alpha)*sum;
+	  else C[j*ldc + i] = T(alpha)*sum + T(beta)*C[j*ldc + i];
+	}
+      }
+    }
+
+  };
+};
+
+
+#endif
@@ -9,6 +9,7 @@
 #include "eig.h"
 
 #include <typeinfo>
+#include <algorithm>
 #include <string.h>
 
 namespace whiteice
@@ -16,6 +17,119 @@ namespace whiteice
   namespace math
   {
     
+    // S += X^t*X (upper triangle), X is n x D matrix. overloads select
+    // BLAS at compile time (real-only casts are not compiled for complex T)
+    static void correlation_syrk(const unsigned int D, const unsigned int n,
+				 const float* X, float* S)
+    {
+      cblas_ssyrk(CblasRowMajor, CblasUpper, CblasTrans, D, n,
+		  1.0f, X, D, 1.0f, S, D);
+    }
+    
+    static void correlation_syrk(const unsigned int D, const unsigned int n,
+				 const double* X, double* S)
+    {
+      cblas_dsyrk(CblasRowMajor, CblasUpper, CblasTrans, D, n,
+		  1.0, X, D, 1.0, S, D);
+    }
+    
+    template <typename T>
+    static void correlation_syrk(const unsigned int D, const unsigned int n,
+				 const T* X, T* S)
+    {
+      for(unsigned int k=0;k<n;k++)
+	for(unsigned int j=0;j<D;j++)
+	  for(unsigned int i=j;i<D;i++)
+	    S[j*D + i] += X[k*D + j]*X[k*D + i];
+    }
+    
+    
+    // S += alpha*x*x^t (upper triangle)
+    static void correlation_syr(const unsigned int D, const float& alpha,
+				const float* x, float* S)
+    {
+      cblas_ssyr(CblasRowMajor, CblasUpper, D, alpha, x, 1, S, D);
+    }
+    
+    static void correlation_syr(const unsigned int D, const double& alpha,
+				const double* x, double* S)
+    {
+      cblas_dsyr(CblasRowMajor, CblasUpper, D, alpha, x, 1, S, D);
+    }
+    
+    template <typename T>
+    static void correlation_syr(const unsigned int D, const T& alpha,
+				const T* x, T* S)
+    {
+      for(unsigned int j=0;j<D;j++)
+	for(unsigned int i=j;i<D;i++)
+	  S[j*D + i] += alpha*x[j]*x[i];
+    }
+    
+    
+    // blas_real<> has the same memory layout as its number type
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Waddress-of-packed-member"
+    
+    static void correlation_syrk(const unsigned int D, const unsigned int n,
+				 const blas_real<float>* X, blas_real<float>* S)
+    {
+      correlation_syrk(D, n, (const float*)X, (float*)S);
+    }
+    
+    static void correlation_syrk(const unsigned int D, const unsigned int n,
+				 const blas_real<double>* X, blas_real<double>* S)
+    {
+      correlation_syrk(D, n, (const double*)X, (double*)S);
+    }
+    
+    static void correlation_syr(const unsigned int D, const blas_real<float>& alpha,
+				const blas_real<float>* x, blas_real<float>* S)
+    {
+      correlation_syr(D, alpha.c[0], (const float*)x, (float*)S);
+    }
+    
+    static void correlation_syr(const unsigned int D, const blas_real<double>& alpha,
+				const blas_real<double>* x, blas_real<double>* S)
+    {
+      correlation_syr(D, alpha.c[0], (const double*)x, (double*)S);
+    }
+    
+#pragma GCC diagnostic pop
+    
+    
+    // fills accumulator from data using blocks of vectors in parallel threads
+    template <typename T>
+    static bool correlation_accumulate(covariance_accumulator<T>& acc,
+				       const std::vector< vertex<T> >& data)
+    {
+      const unsigned int BLOCKSIZE = 256;
+      const unsigned int NBLOCKS = (data.size() + BLOCKSIZE - 1)/BLOCKSIZE;
+      bool ok = true;
+      
+#pragma omp parallel shared(ok)
+      {
+	covariance_accumulator<T> local(acc.dimension());
+	bool local_ok = true;
+	
+#pragma omp for nowait schedule(dynamic)
+	for(unsigned int b=0;b<NBLOCKS;b++){
+	  const unsigned int end = (b+1)*BLOCKSIZE < data.size() ? (b+1)*BLOCKSIZE : data.size();
+	  if(local.add(data, b*BLOCKSIZE, end) == false)
+	    local_ok = false;
+	}
+	
+#pragma omp critical
+	{
+	  if(local_ok == false || acc.merge(local) == false)
+	    ok = false;
+	}
+      }
+      
+      return ok;
+    }
+    
+    
     // calculates autocorrelation matrix from the given data
     template <typename T>
     bool autocorrelation(matrix<T>& R, const std::vector< vertex<T> >& data)
@@ -32,27 +146,49 @@ namespace whiteice
       T s = T(1.0f) / T(data.size());
       
       
-      if(typeid(T) == typeid(blas_real<float>)){	
-	
-	while(i != data.end()){
-	  cblas_sspr(CblasRowMajor, CblasUpper, N, 
-		     *((float*)&s), (float*)(i->data), 1, (float*)R.data);
-	  i++;
+      if(typeid(T) == typeid(float) || typeid(T) == typeid(double) ||
+	 typeid(T) == typeid(blas_real<float>) || typeid(T) == typeid(blas_real<double>)){
+	
+	// blocks of vectors are multiplied with SYRK in parallel threads
+	const unsigned int BLOCKSIZE = 256;
+	const unsigned int NBLOCKS = (data.size() + BLOCKSIZE - 1)/BLOCKSIZE;
+	bool ok = true;
+	
+#pragma omp parallel shared(ok)
+	{
+	  matrix<T> B(BLOCKSIZE, N), Rl(N, N);
+	  bool local_ok = true;
+	  Rl.zero();
+	  
+#pragma omp for nowait schedule(dynamic)
+	  for(unsigned int b=0;b<NBLOCKS;b++){
+	    const unsigned int begin = b*BLOCKSIZE;
+	    const unsigned int end = begin + BLOCKSIZE < data.size() ? begin + BLOCKSIZE : data.size();
+	    
+	    for(unsigned int k=begin;k<end;k++){
+	      if(data[k].size() != N){ local_ok = false; break; }
+	      std::copy(data[k].data, data[k].data + N, &(B.data[(k-begin)*N]));
+	    }
+	    
+	    if(local_ok)
+	      correlation_syrk(N, end - begin, B.data, Rl.data);
+	  }
+	  
+#pragma omp critical
+	  {
+	    if(local_ok) R += Rl;
+	    else ok = false;
+	  }
 	}
 	
-	// converts symmetric matrix results into regular matrix data format
-	for(unsigned int i=0;i<=(N-1);i++){ // (N-i):th row
-	  unsigned int r = N - i - 1;
-	  memcpy(&(R.data[r*N + r]),
-		 &(R.data[((N+1)*N)/2 - ((i+1)*(i+2))/2]),
-		 sizeof(T) * (i+1));
-	}
+	if(!ok) return false;
 	
-	// copy data from upper triangular part to lower
-	for(unsigned int i=0;i<(N-1);i++)
-	  cblas_scopy(N - i - 1, 
-		      (float*)&(R.data[i*N + 1 + i]), 1,
-		      (float*)&(R.data[(i+1)*N + i]), N);
+	for(unsigned int j=0;j<N;j++){
+	  for(unsigned int i=j;i<N;i++){
+	    R(j,i) *= s;
+	    R(i,j) = R(j,i);
+	  }
+	}
       }
       else if(typeid(T) == typeid(blas_complex<float>)){
 	
@@ -76,28 +212,6 @@ namespace whiteice
 		      (float*)&(R.data[i*N + 1 + i]), 1,
 		      (float*)&(R.data[(i+1)*N + i]), N);
       }
-      else if(typeid(T) == typeid(blas_real<double>)){
-	
-	while(i != data.end()){
-	  cblas_dspr(CblasRowMajor, CblasUpper, N, 
-		     *((double*)&s), (double*)(i->data), 1, (double*)(R.data));
-	  i++;
-	}
-	
-	// converts symmetric matrix results into regular matrix data format
-	for(unsigned int i=0;i<(N-1);i++){ // (N-i):th row
-	  unsigned int r = N - i - 1;
-	  memcpy(&(R.data[r*N + r]),
-		 &(R.data[((N+1)*N)/2 - ((i+1)*(i+2))/2]),
-		 sizeof(T) * (i+1));
-	}
-	
-	// copy data from upper triangular part to lower
-	for(unsigned int i=0;i<(N-1);i++)
-	  cblas_dcopy(N - i - 1, 
-		      (double*)&(R.data[i*N + 1 + i]), 1,
-		      (double*)&(R.data[(i+1)*N + i]), N);
-      }
       else if(typeid(T) == typeid(blas_complex<double>)){
 	
 	while(i != data.end()){
@@ -242,30 +356,16 @@ namespace whiteice
       T s = T(1.0f) / T(data.size());
 
       
-      if(typeid(T) == typeid(blas_real<float>)){	
+      if(typeid(T) == typeid(float) || typeid(T) == typeid(double) ||
+	 typeid(T) == typeid(blas_real<float>) || typeid(T) == typeid(blas_real<double>)){
 	
-	while(i != data.end()){
-	  cblas_sspr(CblasRowMajor, CblasUpper, N, 
-		     *((float*)&s), (float*)(i->data), 1, (float*)R.data);
-	  m += *i;
-	  
-	  i++;
-	}
-
-	// converts packed symmetric matrix results into regular matrix data format
-	for(unsigned int i=0;i<=(N-1);i++){ // (N-i):th row
-	  unsigned int r = N - i - 1;
-	  memcpy(&(R.data[r*N + r]),
-		 &(R.data[((N+1)*N)/2 - ((i+1)*(i+2))/2]),
-		 sizeof(T) * (i+1));
-	}
-
-	for(unsigned int i=0;i<(N-1);i++)
-	  cblas_scopy(N - i - 1, 
-		      (float*)&(R.data[i*N + 1 + i]), 1,
-		      (float*)&(R.data[(i+1)*N + i]), N);
-
-	m *= s;
+	// single parallel pass over data using streaming estimators
+	covariance_accumulator<T> acc(N);
+	
+	if(correlation_accumulate(acc, data) == false)
+	  return false;
+	
+	return (acc.getMean(m) && acc.getCovariance(R));
       }
       else if(typeid(T) == typeid(blas_complex<float>)){
 	
@@ -293,32 +393,6 @@ namespace whiteice
 	
 	m *= s;
       }
-      else if(typeid(T) == typeid(blas_real<double>)){
-	
-	while(i != data.end()){
-	  cblas_dspr(CblasRowMajor, CblasUpper, N, 
-		     *((double*)&s), (double*)(i->data), 1, (double*)(R.data));
-	  m += *i;
-	  
-	  i++;
-	}
-	
-	// converts symmetric matrix results into regular matrix data format
-	for(unsigned int i=0;i<=(N-1);i++){ // (N-i):th row
-	  unsigned int r = N - i - 1;
-	  memcpy(&(R.data[r*N + r]),
-		 &(R.data[((N+1)*N)/2 - ((i+1)*(i+2))/2]),
-		 sizeof(T) * (i+1));
-	}
-	
-	// copy data from upper triangular part to lower
-	for(unsigned int i=0;i<(N-1);i++)
-	  cblas_dcopy(N - i - 1, 
-		      (double*)&(R.data[i*N + 1 + i]), 1,
-		      (double*)&(R.data[(i+1)*N + i]), N);
-	
-	m *= s;
-      }
       else if(typeid(T) == typeid(blas_complex<double>)){
 	
 	while(i != data.end()){
@@ -480,6 +554,184 @@ namespace whiteice
     
     
     
+    
+    template <typename T>
+    covariance_accumulator<T>::covariance_accumulator(const unsigned int dimension)
+    {
+      reset(dimension);
+    }
+    
+    
+    template <typename T>
+    void covariance_accumulator<T>::reset(const unsigned int dimension)
+    {
+      D = dimension;
+      N = 0;
+      
+      if(D > 0){
+	mean.resize(D);
+	mean.zero();
+	S.resize(D, D);
+	S.zero();
+      }
+    }
+    
+    
+    template <typename T>
+    bool covariance_accumulator<T>::add(const vertex<T>& x)
+    {
+      if(x.size() != D || D == 0) return false;
+      
+      // Welford: mean += (x - mean)/N, S += (N-1)/N * (x - mean)(x - mean)^t
+      N++;
+      
+      vertex<T> delta(x);
+      delta -= mean;
+      
+      const T n = T((double)N);
+      
+      correlation_syr(D, T((double)(N-1))/n, &(delta[0]), &(S(0,0)));
+      
+      delta /= n;
+      mean += delta;
+      
+      return true;
+    }
+    
+    
+    template <typename T>
+    bool covariance_accumulator<T>::add(const matrix<T>& X)
+    {
+      if(X.xsize() != D || D == 0) return false;
+      if(X.ysize() == 0) return true;
+      
+      block = X;
+      add_block(X.ysize());
+      
+      return true;
+    }
+    
+    
+    template <typename T>
+    bool covariance_accumulator<T>::add(const std::vector< vertex<T> >& data,
+					const unsigned int begin, const unsigned int end)
+    {
+      if(end > data.size() || begin > end || D == 0) return false;
+      if(begin == end) return true;
+      
+      if(block.ysize() < end - begin || block.xsize() != D)
+	if(block.resize(end - begin, D) == false) return false;
+      
+      for(unsigned int k=begin;k<end;k++){
+	if(data[k].size() != D) return false;
+	block.rowcopyfrom(data[k], k-begin);
+      }
+      
+      add_block(end - begin);
+      
+      return true;
+    }
+    
+    
+    template <typename T>
+    void covariance_accumulator<T>::add_block(const unsigned int n)
+    {
+      // block statistics: mean and SYRK of centered rows
+      vertex<T> mb(D);
+      mb.zero();
+      
+      for(unsigned int k=0;k<n;k++){
+	const T* x = &(block(k,0));
+	for(unsigned int i=0;i<D;i++) mb[i] += x[i];
+      }
+      
+      mb /= T((double)n);
+      
+      for(unsigned int k=0;k<n;k++){
+	T* x = &(block(k,0));
+	for(unsigned int i=0;i<D;i++) x[i] -= mb[i];
+      }
+      
+      correlation_syrk(D, n, &(block(0,0)), &(S(0,0)));
+      
+      // combines with previous statistics (Chan et al.)
+      const T na = T((double)N);
+      const T nb = T((double)n);
+      
+      mb -= mean; // delta
+      
+      if(N > 0)
+	correlation_syr(D, na*nb/(na + nb), &(mb[0]), &(S(0,0)));
+      
+      mb *= nb/(na + nb);
+      mean += mb;
+      
+      N += n;
+    }
+    
+    
+    template <typename T>
+    bool covariance_accumulator<T>::merge(const covariance_accumulator<T>& acc)
+    {
+      if(acc.N == 0) return true;
+      if(acc.D != D) return false;
+      
+      if(N == 0){
+	mean = acc.mean;
+	S = acc.S;
+	N = acc.N;
+	return true;
+      }
+      
+      const T na = T((double)N);
+      const T nb = T((double)acc.N);
+      
+      vertex<T> delta(acc.mean);
+      delta -= mean;
+      
+      S += acc.S;
+      correlation_syr(D, na*nb/(na + nb), &(delta[0]), &(S(0,0)));
+      
+      delta *= nb/(na + nb);
+      mean += delta;
+      
+      N += acc.N;
+      
+      return true;
+    }
+    
+    
+    template <typename T>
+    bool covariance_accumulator<T>::getMean(vertex<T>& m) const
+    {
+      if(N == 0) return false;
+      
+      m = mean;
+      
+      return true;
+    }
+    
+    
+    template <typename T>
+    bool covariance_accumulator<T>::getCovariance(matrix<T>& R) const
+    {
+      if(N == 0) return false;
+      
+      if(R.resize(D, D) == false) return false;
+      
+      const T s = T(1.0) / T((double)N);
+      
+      for(unsigned int j=0;j<D;j++){
+	for(unsigned int i=j;i<D;i++){
+	  R(j,i) = s*S(j,i);
+	  R(i,j) = R(j,i);
+	}
+      }
+      
+      return true;
+    }
+    
+    
     // explicit template instantations
     
     template bool autocorrelation<float>(matrix<float>& R, const std::vector< vertex<float> >& data);
@@ -596,6 +848,12 @@ namespace whiteice
        math::vertex< blas_real<double> >& m,
        blas_real<double>& original_var, blas_real<double>& reduced_var);
     
+    
+    template class covariance_accumulator< float >;
+    template class covariance_accumulator< double >;
+    template class covariance_accumulator< blas_real<float> >;
+    template class covariance_accumulator< blas_real<double> >;
+    
   };
 };
 
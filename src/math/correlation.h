@@ -53,6 +53,57 @@ namespace whiteice
 	       math::vertex<T>& m,
 	       T& original_var, T& reduced_var);
     
+    
+    /*
+     * streaming mean and covariance estimator. data is added one vector
+     * at a time (rank-1 Welford update) or in blocks of rows (SYRK update
+     * of the centered block). estimators of disjoint parts of data
+     * (for example computed by different threads) can be merged using
+     * Chan et al. pairwise update. only upper triangle of the sum of
+     * centered outer products is kept up to date.
+     */
+    template <typename T>
+      class covariance_accumulator
+      {
+      public:
+	covariance_accumulator(const unsigned int dimension = 0);
+	
+	// removes all data and sets data dimension
+	void reset(const unsigned int dimension);
+	
+	unsigned int dimension() const throw(){ return D; }
+	unsigned long long size() const throw(){ return N; }
+	
+	bool add(const vertex<T>& x);
+	
+	// adds rows of X as data vectors
+	bool add(const matrix<T>& X);
+	
+	// adds data[begin..end-1]
+	bool add(const std::vector< vertex<T> >& data,
+		 const unsigned int begin, const unsigned int end);
+	
+	// merges statistics of other (disjoint) data into this one
+	bool merge(const covariance_accumulator<T>& acc);
+	
+	bool getMean(vertex<T>& m) const;
+	
+	// covariance matrix E[(x-mean)(x-mean)^t]
+	bool getCovariance(matrix<T>& R) const;
+	
+      private:
+	// adds first n rows of block
+	void add_block(const unsigned int n);
+	
+	unsigned int D;
+	unsigned long long N;
+	
+	vertex<T> mean;
+	matrix<T> S; // sum of (x-mean)(x-mean)^t (upper triangle)
+	
+	matrix<T> block; // centered block of rows
+      };
+    
   }
 }
 
@@ -178,6 +229,12 @@ namespace whiteice
        math::vertex< blas_real<double> >& m,
        blas_real<double>& original_var, blas_real<double>& reduced_var);
     
+    
+    extern template class covariance_accumulator< float >;
+    extern template class covariance_accumulator< double >;
+    extern template class covariance_accumulator< blas_real<float> >;
+    extern template class covariance_accumulator< blas_real<double> >;
+    
   }
 }
 
@@ -19,6 +19,7 @@ extern "C" {
 }
 
 #include "blas_primitives.h"
+#include "blas_gemm.h"
 
 
 
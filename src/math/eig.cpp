@@ -10,6 +10,8 @@
 #include "dinrhiw_blas.h"
 
 #include <map>
+#include <vector>
+#include <algorithm>
 #include <assert.h>
 
 
@@ -464,139 +466,458 @@ namespace whiteice
     
     /***********************************************************************************/
     
+    // machine epsilon of (float or double based) number type T
     template <typename T>
-    inline bool symmetric_eig(matrix<T>& A, matrix<T>& X, bool sort)
+    static inline T eig_epsilon()
     {
-      try{
-	if(A.xsize() != A.ysize())
-	  return false;
-	
-	if(X.resize(A.xsize(),A.xsize()) == false)
-	  return false;
-	
-	T TOLERANCE = T(0.000001);
-	T EPSILON   = T(0.000001);
-	unsigned int N = A.xsize();
-	
-	// special cases for small matrices
-	if(N == 1){
-	  X[0] = T(1.0f);
-	  
-	  return true;
+      if(typeid(T) == typeid(float) || typeid(T) == typeid(blas_real<float>))
+	return T(1.19e-07);
+      else
+	return T(2.22e-16);
+    }
+
+
+    // sorts eigenvalues d and columns of X to descending order
+    template <typename T>
+    static void eig_sort(std::vector<T>& d, matrix<T>& X)
+    {
+      const unsigned int N = d.size();
+      std::vector<unsigned int> order(N);
+
+      for(unsigned int i=0;i<N;i++) order[i] = i;
+
+      std::stable_sort(order.begin(), order.end(),
+		       [&d](unsigned int a, unsigned int b){ return (d[b] < d[a]); });
+
+      matrix<T> XX(X);
+      std::vector<T> dd(d);
+
+      for(unsigned int i=0;i<N;i++){
+	d[i] = dd[order[i]];
+	for(unsigned int j=0;j<N;j++)
+	  X(j,i) = XX(j,order[i]);
+      }
+    }
+
+    
+#ifdef LAPACK
+#ifndef INTELMKL
+    // LAPACK routines (column-major fortran interface, included in OpenBLAS)
+    extern "C" {
+      void ssyevd_(const char* jobz, const char* uplo, const int* n, float* a, const int* lda,
+		   float* w, float* work, const int* lwork, int* iwork, const int* liwork,
+		   int* info);
+      void dsyevd_(const char* jobz, const char* uplo, const int* n, double* a, const int* lda,
+		   double* w, double* work, const int* lwork, int* iwork, const int* liwork,
+		   int* info);
+      void sgesdd_(const char* jobz, const int* m, const int* n, float* a, const int* lda,
+		   float* s, float* u, const int* ldu, float* vt, const int* ldvt,
+		   float* work, const int* lwork, int* iwork, int* info);
+      void dgesdd_(const char* jobz, const int* m, const int* n, double* a, const int* lda,
+		   double* s, double* u, const int* ldu, double* vt, const int* ldvt,
+		   double* work, const int* lwork, int* iwork, int* info);
+    };
+#endif
+
+    static inline void lapack_syevd(int n, float* a, float* w, float* work, int lwork,
+				    int* iwork, int liwork, int& info)
+    {
+      const char jobz = 'V', uplo = 'U';
+      ssyevd_(&jobz, &uplo, &n, a, &n, w, work, &lwork, iwork, &liwork, &info);
+    }
+    
+    static inline void lapack_syevd(int n, double* a, double* w, double* work, int lwork,
+				    int* iwork, int liwork, int& info)
+    {
+      const char jobz = 'V', uplo = 'U';
+      dsyevd_(&jobz, &uplo, &n, a, &n, w, work, &lwork, iwork, &liwork, &info);
+    }
+
+    static inline void lapack_gesdd(int m, int n, float* a, float* s, float* u, float* vt,
+				    float* work, int lwork, int* iwork, int& info)
+    {
+      const char jobz = 'A';
+      sgesdd_(&jobz, &m, &n, a, &m, s, u, &m, vt, &n, work, &lwork, iwork, &info);
+    }
+
+    static inline void lapack_gesdd(int m, int n, double* a, double* s, double* u, double* vt,
+				    double* work, int lwork, int* iwork, int& info)
+    {
+      const char jobz = 'A';
+      dgesdd_(&jobz, &m, &n, a, &m, s, u, &m, vt, &n, work, &lwork, iwork, &info);
+    }
+    
+
+    // symmetric EVD using LAPACK (divide and conquer), R is float or double.
+    // symmetric A is the same in row-major and column-major order
+    template <typename T, typename R>
+    static bool lapack_symmetric_eig(matrix<T>& A, matrix<T>& X, std::vector<T>& d)
+    {
+      const int N = (int)A.ysize();
+      std::vector<R> a(N*N), w(N);
+
+      for(int i=0;i<N*N;i++)
+	convert(a[i], A[i]);
+
+      // workspace query
+      R wsize = R(0);
+      int isize = 0, info = 0;
+      lapack_syevd(N, &(a[0]), &(w[0]), &wsize, -1, &isize, -1, info);
+      if(info != 0) return false;
+
+      std::vector<R> work((int)wsize + 1);
+      std::vector<int> iwork(isize + 1);
+
+      lapack_syevd(N, &(a[0]), &(w[0]), &(work[0]), (int)work.size(),
+		   &(iwork[0]), (int)iwork.size(), info);
+      if(info != 0) return false;
+
+      // eigenvectors are columns of column-major a
+      d.resize(N);
+      
+      for(int i=0;i<N;i++){
+	d[i] = T(w[i]);
+	for(int j=0;j<N;j++)
+	  X(j,i) = T(a[i*N + j]);
+      }
+
+      return true;
+    }
+
+
+    // SVD using LAPACK (divide and conquer), R is float or double.
+    // row-major M x N A is column-major N x M matrix A^t = U2*S*V2^t
+    // so that A = V2*S*U2^t
+    template <typename T, typename R>
+    static bool lapack_svd(matrix<T>& A, matrix<T>& U, matrix<T>& V)
+    {
+      const int M = (int)A.ysize(), N = (int)A.xsize();
+      const int K = (M < N) ? M : N;
+
+      std::vector<R> a(M*N), s(K), u(N*N), vt(M*M);
+      std::vector<int> iwork(8*K + 1);
+
+      for(int i=0;i<M*N;i++)
+	convert(a[i], A[i]);
+
+      R wsize = R(0);
+      int info = 0;
+      lapack_gesdd(N, M, &(a[0]), &(s[0]), &(u[0]), &(vt[0]), &wsize, -1, &(iwork[0]), info);
+      if(info != 0) return false;
+
+      std::vector<R> work((int)wsize + 1);
+
+      lapack_gesdd(N, M, &(a[0]), &(s[0]), &(u[0]), &(vt[0]),
+		   &(work[0]), (int)work.size(), &(iwork[0]), info);
+      if(info != 0) return false;
+
+      if(U.resize(M,M) == false || V.resize(N,N) == false)
+	return false;
+
+      for(int i=0;i<M*M;i++)
+	U[i] = T(vt[i]);
+
+      for(int j=0;j<N;j++)
+	for(int i=0;i<N;i++)
+	  V(j,i) = T(u[i*N + j]);
+
+      A.zero();
+      for(int i=0;i<K;i++)
+	A(i,i) = T(s[i]);
+
+      return true;
+    }
+#endif
+
+    
+    /*
+     * reduces symmetric A to tridiagonal form A = Q*T*Q^t (A is overwritten).
+     * blocked householder reduction: NB reflectors are collected to V and W
+     * and the trailing matrix is updated only once per block
+     * (A -= V*W^t + W*V^t) so the matrix is streamed through cache N/NB times.
+     * d is diagonal and e subdiagonal of T, Qt = Q^t.
+     */
+    template <typename T>
+    static void tridiagonal_reduction(matrix<T>& A, std::vector<T>& d,
+				      std::vector<T>& e, matrix<T>& Qt)
+    {
+      const unsigned int N = A.ysize();
+      const unsigned int NB = 32;
+      T* a = &(A(0,0));
+
+      d.resize(N);
+      e.resize(N);
+      for(auto& ei : e) ei = T(0.0);
+
+      std::vector<T> tau(N, T(0.0));
+      std::vector<T> V(N*NB), W(N*NB);
+      std::vector<T> v(N), t1(NB), t2(NB);
+
+      for(unsigned int k0=0;k0+2<N;k0+=NB){
+	const unsigned int kb = (N-2-k0 < NB) ? (N-2-k0) : NB;
+
+	for(unsigned int i=k0*NB;i<N*NB;i++){
+	  V[i] = T(0.0);
+	  W[i] = T(0.0);
 	}
-	else if(N == 2){
-	  vertex<T> d;
-	  if(!eig2x2matrix(A, d, X, false))
-	    return false;
+
+	for(unsigned int i=0;i<kb;i++){
+	  const unsigned int c = k0 + i;
+
+	  // applies previous reflectors of the block to column c
+	  for(unsigned int r=c;r<N;r++){
+	    T s = T(0.0);
+	    for(unsigned int p=0;p<i;p++)
+	      s += V[r*NB+p]*W[c*NB+p] + W[r*NB+p]*V[c*NB+p];
+	    a[r*N+c] -= s;
+	  }
+
+	  d[c] = a[c*N+c];
+
+	  // householder reflector H = I - tau*v*v^t zeroing A(c+2:N,c)
+	  const T alpha = a[(c+1)*N+c];
+	  T sigma = T(0.0);
+	  for(unsigned int r=c+2;r<N;r++)
+	    sigma += a[r*N+c]*a[r*N+c];
+
+	  v[c+1] = T(1.0);
 	  
-	  A(0,0) = d[0];
-	  A(0,1) = T(0.0);
-	  A(1,0) = T(0.0);
-	  A(1,1) = d[1];
+	  if(sigma == T(0.0)){
+	    tau[c] = T(0.0);
+	    e[c] = alpha;
+	    for(unsigned int r=c+2;r<N;r++) v[r] = T(0.0);
+	  }
+	  else{
+	    T beta = whiteice::math::sqrt(alpha*alpha + sigma);
+	    if(alpha > T(0.0)) beta = -beta;
+
+	    tau[c] = (beta - alpha)/beta;
+	    const T scale = T(1.0)/(alpha - beta);
+
+	    for(unsigned int r=c+2;r<N;r++){
+	      v[r] = a[r*N+c]*scale;
+	      a[r*N+c] = v[r]; // reflector is stored below subdiagonal
+	    }
+
+	    e[c] = beta;
+	  }
+
+	  for(unsigned int r=c+1;r<N;r++)
+	    V[r*NB+i] = v[r];
+
+	  if(tau[c] == T(0.0)) continue;
+
+	  // w = tau*(A*v - V*W^t*v - W*V^t*v), w -= 0.5*tau*(w^t*v)*v
+	  for(unsigned int p=0;p<i;p++){
+	    t1[p] = T(0.0);
+	    t2[p] = T(0.0);
+	    for(unsigned int r=c+1;r<N;r++){
+	      t1[p] += W[r*NB+p]*v[r];
+	      t2[p] += V[r*NB+p]*v[r];
+	    }
+	  }
+
+	  T vw = T(0.0);
 	  
-	  // return true; (need to sort eigenvalues)..
+	  for(unsigned int r=c+1;r<N;r++){
+	    const T* ar = a + r*N;
+	    T s = T(0.0);
+	    
+	    for(unsigned int k=c+1;k<N;k++)
+	      s += ar[k]*v[k];
+	    
+	    for(unsigned int p=0;p<i;p++)
+	      s -= V[r*NB+p]*t1[p] + W[r*NB+p]*t2[p];
+
+	    W[r*NB+i] = tau[c]*s;
+	    vw += W[r*NB+i]*v[r];
+	  }
+
+	  vw *= T(-0.5)*tau[c];
+
+	  for(unsigned int r=c+1;r<N;r++)
+	    W[r*NB+i] += vw*v[r];
 	}
-	else{
+
+	// updates trailing matrix with the whole block
+	const unsigned int k1 = k0 + kb;
 	
-	  // calculates first hessenberg reduction of A
-	  if(!hessenberg_reduction(A, X))
-	    return false;
-	  
-	  // keeps zeroing below diagonal entries,
-	  // because of symmetry A is symmetric and diagonal
-	  // when algorithm converges (only if A really is symmetric)
-	  
-	  unsigned int iter = 0;
-	  unsigned int f1 = 0, f2 = N-2;
-	  unsigned int e1 = 0, e2 = N-2;
-	  T error = 0;
-	  
-	  for(unsigned int k=0;k<(N-1);k++)
-	    if(whiteice::math::abs(A(k+1,k)) > error)
-	      error = whiteice::math::abs(A(k+1,k));
-	  
+	for(unsigned int r=k1;r<N;r++){
+	  const T* Vr = &(V[r*NB]);
+	  const T* Wr = &(W[r*NB]);
+	  T* ar = a + r*N;
 	  
-	  while(error > TOLERANCE){
-	    // finds submatrix
-	    
-	    for(unsigned int k=0;k<e2;k++){
-	      if(whiteice::math::abs(A(k+1,k)) > EPSILON){
-		e1 = k;
-		break;
-	      }
-	    }
+	  for(unsigned int k=k1;k<N;k++){
+	    const T* Vk = &(V[k*NB]);
+	    const T* Wk = &(W[k*NB]);
+	    T s = T(0.0);
 	    
-	    for(unsigned int k=(N-2);k>=e1;k--){
-	      if(whiteice::math::abs(A(k+1,k)) > EPSILON){
-		e2 = k+1;
+	    for(unsigned int p=0;p<kb;p++)
+	      s += Vr[p]*Wk[p] + Wr[p]*Vk[p];
+
+	    ar[k] -= s;
+	  }
+	}
+      }
+
+      if(N >= 2){
+	d[N-2] = a[(N-2)*N+(N-2)];
+	e[N-2] = a[(N-1)*N+(N-2)];
+      }
+      
+      d[N-1] = a[(N-1)*N+(N-1)];
+      e[N-1] = T(0.0);
+
+      // Q^t = H(N-3)*...*H(0), reflectors are applied to rows of Qt
+      Qt.resize(N,N);
+      Qt.identity();
+
+      for(int c=((int)N)-3;c>=0;c--){
+	if(tau[c] == T(0.0)) continue;
+
+	v[c+1] = T(1.0);
+	for(unsigned int r=c+2;r<N;r++)
+	  v[r] = a[r*N+c];
+
+	for(unsigned int r=c+1;r<N;r++){
+	  T* q = &(Qt(r,0));
+	  T s = T(0.0);
+	  
+	  for(unsigned int k=c+1;k<N;k++)
+	    s += q[k]*v[k];
+
+	  s *= tau[c];
+
+	  for(unsigned int k=c+1;k<N;k++)
+	    q[k] -= s*v[k];
+	}
+      }
+    }
+
+
+    /*
+     * implicit QL iterations with wilkinson shifts for symmetric
+     * tridiagonal matrix (d diagonal, e subdiagonal). rotations are applied
+     * to rows of Zt (eigenvectors are rows of Zt). d is overwritten with
+     * eigenvalues.
+     */
+    template <typename T>
+    static bool tridiagonal_ql(std::vector<T>& d, std::vector<T>& e, matrix<T>& Zt)
+    {
+      const int N = (int)d.size();
+      const unsigned int M = Zt.xsize();
+      const T eps = eig_epsilon<T>();
+
+      for(int l=0;l<N;l++){
+	unsigned int iter = 0;
+	int m = l;
+
+	do{
+	  for(m=l;m<N-1;m++){
+	    const T dd = whiteice::math::abs(d[m]) + whiteice::math::abs(d[m+1]);
+	    if(whiteice::math::abs(e[m]) <= eps*dd) break;
+	  }
+
+	  if(m != l){
+	    if(iter++ >= 60) return false;
+
+	    T g = (d[l+1] - d[l])/(T(2.0)*e[l]);
+	    T r = whiteice::math::sqrt(g*g + T(1.0));
+	    g = d[m] - d[l] + e[l]/(g + ((g >= T(0.0)) ? r : -r));
+
+	    T s = T(1.0), c = T(1.0), p = T(0.0);
+	    int i = 0;
+
+	    for(i=m-1;i>=l;i--){
+	      T f = s*e[i];
+	      const T b = c*e[i];
+	      r = whiteice::math::sqrt(f*f + g*g);
+	      e[i+1] = r;
+
+	      if(r == T(0.0)){
+		d[i+1] -= p;
+		e[m] = T(0.0);
 		break;
 	      }
-	    }
-	    
-	    
-	    // calculates qr step for the non-diagonal submatrix
-	    if(!implicit_symmetric_qrstep_wilkinson(A, X, e1, (e2 - e1)+1)){
-	      std::cout << "IMPLICIT SHIFT FAILED" << std::endl;
-	    }
 
-	    
-	    if(f1 == e1 && f2 == e2){
-	      iter++;
+	      s = f/r;
+	      c = g/r;
+	      g = d[i+1] - p;
+	      r = (d[i] - g)*s + T(2.0)*c*b;
+	      p = s*r;
+	      d[i+1] = g + p;
+	      g = c*r - b;
+
+	      // rotates rows i and i+1 of eigenvectors
+	      T* z0 = &(Zt(i,0));
+	      T* z1 = &(Zt(i+1,0));
 	      
-	      if(iter > 10){ // was 50 iterations (was 5)
-		TOLERANCE *= 2.0f; // increases TOLERANCE
-		EPSILON   *= 2.0f;
-		
-		iter = 0;
-		f1 = e1;
-		f2 = e2;
+	      for(unsigned int k=0;k<M;k++){
+		f = z1[k];
+		z1[k] = s*z0[k] + c*f;
+		z0[k] = c*z0[k] - s*f;
 	      }
 	    }
-	    else{
-	      iter = 0;
-	      f1 = e1;
-	      f2 = e2;
-	      
-	    }
 
-	    
-	    error = T(0.0);
-	    for(unsigned int k=e1;k<e2;k++){
-	      if(whiteice::math::abs(A(k+1,k)) > error)
-		error = whiteice::math::abs(A(k+1,k));
-	    }
-	    
+	    if(r == T(0.0) && i >= l) continue;
+
+	    d[l] -= p;
+	    e[l] = g;
+	    e[m] = T(0.0);
 	  }
 	}
+	while(m != l);
+      }
+
+      return true;
+    }
+    
+
+    template <typename T>
+    inline bool symmetric_eig(matrix<T>& A, matrix<T>& X, bool sort)
+    {
+      try{
+	if(A.xsize() != A.ysize())
+	  return false;
 	
+	if(X.resize(A.xsize(),A.xsize()) == false)
+	  return false;
 	
+	const unsigned int N = A.xsize();
+	std::vector<T> d;
 
-	// sorts eigenvectors according to their variances
-	if(sort){
-	  std::multimap<T, int> var;
-	  
-	  for(unsigned int j=0;j<A.xsize();j++)
-	    var.insert(std::pair<T, int>(A(j,j), j));
-	  
-	  int index = A.xsize() - 1;
-	  math::vertex<T> t;
-	  
-	  // this is slow [write faster code]
-	  math::matrix<T> XX(X);
-	  
-	  for(auto& v : var){ // from smallest to the largest eigenvalue
-	    
-	    if(v.second != index){ // we need to move v.second index to index
-	      A(index,index) = v.first;
-	      
-	      XX.colcopyto(t, v.second);
-	      X.colcopyfrom(t, index);
-	    }
-	    
-	    index--;
-	  }
+	if(N == 0) return true;
+
+	bool solved = false;
+
+#ifdef LAPACK
+	if(typeid(T) == typeid(float) || typeid(T) == typeid(blas_real<float>))
+	  solved = lapack_symmetric_eig<T, float>(A, X, d);
+	else if(typeid(T) == typeid(double) || typeid(T) == typeid(blas_real<double>))
+	  solved = lapack_symmetric_eig<T, double>(A, X, d);
+#endif
+
+	if(!solved){
+	  // blocked tridiagonal reduction + implicit QL iterations
+	  std::vector<T> e;
+	  matrix<T> Zt;
+
+	  tridiagonal_reduction(A, d, e, Zt);
+
+	  if(tridiagonal_ql(d, e, Zt) == false)
+	    return false;
+
+	  for(unsigned int j=0;j<N;j++)
+	    for(unsigned int i=0;i<N;i++)
+	      X(j,i) = Zt(i,j);
 	}
-	
+
+	// sorts eigenvectors according to their variances
+	if(sort) eig_sort(d, X);
+
+	A.zero();
+	for(unsigned int i=0;i<N;i++)
+	  A(i,i) = d[i];
 	
 	return true;
       }
@@ -608,123 +929,195 @@ namespace whiteice
     
     
     /***********************************************************************************/
+
+
+    // completes orthonormal rows 0..r-1 of Ut to orthonormal basis
+    template <typename T>
+    static void complete_basis(matrix<T>& Ut, unsigned int r)
+    {
+      const unsigned int M = Ut.xsize();
+      vertex<T> w(M);
+
+      for(unsigned int i=0;i<M && r<M;i++){
+	w.zero();
+	w[i] = T(1.0);
+
+	for(unsigned int iter=0;iter<2;iter++){ // reorthogonalization
+	  for(unsigned int k=0;k<r;k++){
+	    T s = T(0.0);
+	    for(unsigned int j=0;j<M;j++) s += Ut(k,j)*w[j];
+	    for(unsigned int j=0;j<M;j++) w[j] -= s*Ut(k,j);
+	  }
+	}
+
+	T n = T(0.0);
+	for(unsigned int j=0;j<M;j++) n += w[j]*w[j];
+	n = whiteice::math::sqrt(n);
+
+	if(n > T(0.1)){
+	  for(unsigned int j=0;j<M;j++)
+	    Ut(r,j) = w[j]/n;
+	  r++;
+	}
+      }
+    }
     
-    
+
     /*
-     * calculates singular value decomposition of A = U*S*V^T
-     * A will be overwriten with singular values.
-     *
-     *
-     * NOTE: this implementation is simple but slow.
-     * AA^t = U*S*S*U^T (eig/evd solves U)
-     * A^tA = V*S*S*V^T (eig/evd solves V)
-     * S = U^T*A*V
-     *
-     * One must calculate two symmetric evd:s to
-     * solve svd.
-     *
-     * - there are better methods.
+     * one-sided jacobi SVD A = U*S*V^t for M x N matrix A (M >= N).
+     * rotations orthogonalize columns of A which are kept
+     * as rows of B = A^t so that rotated vectors are contiguous.
      */
     template <typename T>
-    inline bool svd(matrix<T>& A, matrix<T>& U, matrix<T>& V)
+    static bool jacobi_svd(matrix<T>& A, matrix<T>& U, matrix<T>& V)
     {
-      // std::cout << "SVD IN: " << A << std::endl;
-      
-      auto Ah = A;
-      Ah.hermite();
-      
-      auto AAh = A*Ah;
-      
-      if(symmetric_eig(AAh,U,true) == false)
-	return false;
+      const unsigned int M = A.ysize(), N = A.xsize();
+      const T eps = eig_epsilon<T>();
 
-      // std::cout << "AAh = " << AAh << std::endl;
+      matrix<T> B(A), Vt(N,N);
+      B.transpose();
+      Vt.identity();
 
-      auto AhA = Ah*A;
+      bool rotated = true;
       
-      if(symmetric_eig(AhA,V,true) == false)
-	return false;
+      for(unsigned int sweep=0;sweep<100 && rotated;sweep++){
+	rotated = false;
+	
+	for(unsigned int j=0;j<N;j++){
+	  for(unsigned int k=j+1;k<N;k++){
+	    T* bj = &(B(j,0));
+	    T* bk = &(B(k,0));
+	    T alpha = T(0.0), beta = T(0.0), gamma = T(0.0);
 
-      // std::cout << "AhA = " << AhA << std::endl;
+	    for(unsigned int i=0;i<M;i++){
+	      alpha += bj[i]*bj[i];
+	      beta  += bk[i]*bk[i];
+	      gamma += bj[i]*bk[i];
+	    }
 
-      auto Uh = U;
-      U.hermite();
+	    if(gamma == T(0.0) ||
+	       whiteice::math::abs(gamma) <= T(10.0)*eps*whiteice::math::sqrt(alpha*beta))
+	      continue;
 
-      A = Uh*A*V; // singular values
+	    rotated = true;
 
-      std::cout << "S = " << A << std::endl;
+	    const T zeta = (beta - alpha)/(T(2.0)*gamma);
+	    T t = T(1.0)/(whiteice::math::abs(zeta) + whiteice::math::sqrt(T(1.0) + zeta*zeta));
+	    if(zeta < T(0.0)) t = -t;
+	    const T c = T(1.0)/whiteice::math::sqrt(T(1.0) + t*t);
+	    const T s = c*t;
 
-      // FIXME: we must reorder A to be diagonal matrix again (+ EIG should have more numeric accuracy to be useful..)
+	    for(unsigned int i=0;i<M;i++){
+	      const T x = bj[i];
+	      bj[i] = c*x - s*bk[i];
+	      bk[i] = s*x + c*bk[i];
+	    }
 
-#if 0
-      {
-	auto Vh = V;
-	Vh.hermite();
-	std::cout << "SVD OUT: " << (U*A*Vh) << std::endl;
+	    T* vj = &(Vt(j,0));
+	    T* vk = &(Vt(k,0));
+
+	    for(unsigned int i=0;i<N;i++){
+	      const T x = vj[i];
+	      vj[i] = c*x - s*vk[i];
+	      vk[i] = s*x + c*vk[i];
+	    }
+	  }
+	}
       }
-#endif
 
-      return true;
+      if(rotated) return false; // no convergence
 
-#if 0
-      // the code below cannot function because US and VS terms cannot be separated because S is non-square singular matrix..
+      // singular values are norms of rows of B
+      std::vector<T> sv(N);
+      for(unsigned int j=0;j<N;j++){
+	T n = T(0.0);
+	for(unsigned int i=0;i<M;i++) n += B(j,i)*B(j,i);
+	sv[j] = whiteice::math::sqrt(n);
+      }
+
+      std::vector<unsigned int> order(N);
+      for(unsigned int i=0;i<N;i++) order[i] = i;
       
-      // A = [N1 x N2]matrix
-      const unsigned int N1 = A.ysize();
-      const unsigned int N2 = A.xsize();
+      std::stable_sort(order.begin(), order.end(),
+		       [&sv](unsigned int a, unsigned int b){ return (sv[b] < sv[a]); });
+
+      // U's columns are normalized columns of A*V (rows of Ut)
+      matrix<T> Ut(M,M);
+      Ut.zero();
+      unsigned int r = 0;
       
-      if(N1 >= N2){
-	matrix<T> AA(A);
-	AA.transpose();
-	AA *= A; // AA = A^t * A
-	
-	if(symmetric_eig(AA,V) == false)
-	  return false;
-	
-	U = A*V; // result = U S V^t * V = U S [N1 x N1] [N1 x N2] (N2 <= N1)
-	A = AA; // A = S^2 (singular values)
-	
-	for(unsigned int j=0;j<N2;j++){
-	  // S^2 -> S (S is diagonal)
-	  A(j,j) = whiteice::math::sqrt(whiteice::math::abs(A(j,j)));
+      const T tolerance = T(M)*eps*sv[order[0]];
 
-	  T scaling = T(1.0);
-	  if(A(j,j) != T(0.0))
-	    scaling = T(1.0) / A(j,j);
-	  
-	  for(unsigned int i=0;i<N1;i++) // multiplies U's column. 
-	    U(i,j) *= scaling;           // (optimize: matrix::colscale(), matrix::rowscale() )
-	}
-	
-	return true;
+      for(unsigned int j=0;j<N;j++){
+	const T s = sv[order[j]];
+	if(s <= tolerance || s == T(0.0)) break;
+
+	for(unsigned int i=0;i<M;i++)
+	  Ut(j,i) = B(order[j],i)/s;
+	r++;
       }
-      else{
-	matrix<T> AA(A);
-	AA.transpose();
-	AA = A * AA; // AA = A * A^t = USV^t * VSU^t = U S^2 U^t
-                     // optimize: this is slow (code templated atlas sped up: A = A*A')
-	
-	if(symmetric_eig(AA,U) == false)
+
+      complete_basis(Ut, r);
+
+      U = Ut;
+      U.transpose();
+
+      if(V.resize(N,N) == false) return false;
+      
+      for(unsigned int j=0;j<N;j++)
+	for(unsigned int i=0;i<N;i++)
+	  V(i,j) = Vt(order[j],i);
+
+      A.zero();
+      for(unsigned int j=0;j<N;j++)
+	A(j,j) = sv[order[j]];
+
+      return true;
+    }
+    
+    
+    /*
+     * calculates singular value decomposition of A = U*S*V^T
+     * A will be overwriten with singular values
+     * (sorted to descending order).
+     *
+     * uses LAPACK (gesdd) when available and
+     * one-sided jacobi iteration otherwise.
+     */
+    template <typename T>
+    inline bool svd(matrix<T>& A, matrix<T>& U, matrix<T>& V)
+    {
+      try{
+	if(A.xsize() == 0 || A.ysize() == 0)
 	  return false;
 	
-	A.transpose(); // slow, code matrix::transposemulti, B = this^t * A
-	V = A * U;     // result = VSU^T * U = VS [N2 x N2] [N2 x N1] (N1 < N2)
-	A = AA; // A = S^2
-	
-	for(unsigned int j=0;j<N1;j++){
-	  A(j,j) = whiteice::math::sqrt(whiteice::math::abs(A(j,j)));
+#ifdef LAPACK
+	if(typeid(T) == typeid(float) || typeid(T) == typeid(blas_real<float>)){
+	  if(lapack_svd<T, float>(A, U, V)) return true;
+	}
+	else if(typeid(T) == typeid(double) || typeid(T) == typeid(blas_real<double>)){
+	  if(lapack_svd<T, double>(A, U, V)) return true;
+	}
+#endif
+
+	if(A.ysize() >= A.xsize()){
+	  return jacobi_svd(A, U, V);
+	}
+	else{
+	  // A^t = U2*S*V2^t => A = V2*S^t*U2^t
+	  A.transpose();
 	  
-	  T scaling = T(1.0);
-	  if(A(j,j) != T(0.0))
-	    scaling = T(1.0) / A(j,j);
+	  if(jacobi_svd(A, V, U) == false)
+	    return false;
 
-	  for(unsigned int i=0;i<N2;i++)
-	    V(i,j) *= scaling;
+	  A.transpose();
+	  return true;
 	}
-	
-	return true;
       }
-#endif 
+      catch(std::exception& e){
+	std::cout << "SVD SOLVER. FATAL ERROR: " << e.what() << std::endl;
+	return false;
+      }
     }
     
     
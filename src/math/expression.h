@@ -0,0 +1,428 @@
+/*
+ * element-wise expression templates for vertex and matrix
+ *
+ * lazy(x) wraps vertex or matrix x into an expression. +, -, unary -
+ * and scalar * and / of expressions build expression trees instead of
+ * temporary vertexes/matrices. the whole expression is evaluated in
+ * a single loop when it is assigned (=, +=, -=) to vertex/matrix:
+ *
+ *   x  = lazy(a) - b;                 // no temporaries
+ *   p -= T(0.5f)*epsilon*lazy(grad);  // axpy
+ *
+ * normal operators of vertex and matrix still return vertexes and
+ * matrices so existing code (auto variables etc.) works as before.
+ *
+ * expressions refer to lvalue operands so they must be evaluated
+ * before the operands change (don't keep them in auto variables).
+ * rvalue operands of lazy() are moved into the expression.
+ */
+
+#ifndef math_expression_h
+#define math_expression_h
+
+#include "dinrhiw_blas.h"
+#include "ownexception.h"
+
+#include <memory>
+#include <assert.h>
+#include <typeinfo>
+#include <stdexcept>
+
+
+namespace whiteice
+{
+  namespace math
+  {
+    template <typename T> class vertex;
+    template <typename T> class matrix;
+
+    struct vertex_kind { };
+    struct matrix_kind { };
+
+
+    // base class of expressions, E is the derived class
+    template <typename K, typename T, typename E>
+      class expression
+      {
+      public:
+	inline const E& self() const throw(){ return static_cast<const E&>(*this); }
+
+	inline unsigned int ysize() const throw(){ return self().ysize(); }
+	inline unsigned int xsize() const throw(){ return self().xsize(); }
+	inline unsigned int size() const throw(){ return self().ysize()*self().xsize(); }
+
+      };
+
+
+    // data of vertex or matrix (row-major)
+    template <typename K, typename T>
+      class expression_leaf : public expression< K, T, expression_leaf<K,T> >
+      {
+      public:
+	expression_leaf(const T* data_, const unsigned int rows_, const unsigned int cols_,
+			const std::shared_ptr<const void>& owner_ = std::shared_ptr<const void>()) throw() :
+	  data(data_), rows(rows_), cols(cols_), owner(owner_) { }
+
+	inline unsigned int ysize() const throw(){ return rows; }
+	inline unsigned int xsize() const throw(){ return cols; }
+	inline const T& operator[](const unsigned int i) const throw(){ return data[i]; }
+	inline const T* ptr() const throw(){ return data; }
+
+      private:
+	const T* data;
+	unsigned int rows, cols;
+
+	std::shared_ptr<const void> owner; // keeps lazy(rvalue) data alive
+      };
+
+
+    struct expression_add {
+      template <typename T>
+      static inline T apply(const T& a, const T& b){ return a + b; }
+    };
+
+    struct expression_sub {
+      template <typename T>
+      static inline T apply(const T& a, const T& b){ return a - b; }
+    };
+
+
+    template <typename K, typename T, typename L, typename R, typename OP>
+      class expression_binary :
+      public expression< K, T, expression_binary<K,T,L,R,OP> >
+      {
+      public:
+	expression_binary(const L& l, const R& r) throw(illegal_operation) :
+	  left(l), right(r)
+	{
+	  if(l.ysize() != r.ysize() || l.xsize() != r.xsize()){
+	    assert(0);
+	    throw illegal_operation("expression: dimension mismatch");
+	  }
+	}
+
+	inline unsigned int ysize() const throw(){ return left.ysize(); }
+	inline unsigned int xsize() const throw(){ return left.xsize(); }
+	inline T operator[](const unsigned int i) const throw(){
+	  return OP::apply(T(left[i]), T(right[i]));
+	}
+
+	const L left;
+	const R right;
+      };
+
+
+    // s*e
+    template <typename K, typename T, typename E>
+      class expression_scale : public expression< K, T, expression_scale<K,T,E> >
+      {
+      public:
+	expression_scale(const T& s_, const E& e_) throw() : s(s_), e(e_) { }
+
+	inline unsigned int ysize() const throw(){ return e.ysize(); }
+	inline unsigned int xsize() const throw(){ return e.xsize(); }
+	inline T operator[](const unsigned int i) const throw(){ return s*e[i]; }
+
+	const T s;
+	const E e;
+      };
+
+
+    // scalar parameters are not used to deduce T so that
+    // 0.5f*lazy(x) works with blas_real<float> etc.
+    template <typename T>
+      struct expression_scalar { typedef T type; };
+
+
+    //////////////////////////////////////////////////////////////////////
+    // lazy()
+
+    template <typename T>
+      inline expression_leaf<vertex_kind,T> lazy(const vertex<T>& v) throw()
+      {
+	return expression_leaf<vertex_kind,T>(v.size() ? &(v[0]) : nullptr, v.size(), 1);
+      }
+
+    template <typename T>
+      inline expression_leaf<vertex_kind,T> lazy(vertex<T>&& v)
+      {
+	std::shared_ptr< const vertex<T> > p = std::make_shared< const vertex<T> >(std::move(v));
+	return expression_leaf<vertex_kind,T>(p->size() ? &((*p)[0]) : nullptr, p->size(), 1, p);
+      }
+
+    template <typename T>
+      inline expression_leaf<matrix_kind,T> lazy(const matrix<T>& m) throw()
+      {
+	return expression_leaf<matrix_kind,T>(m.ysize()*m.xsize() ? &(m[0]) : nullptr,
+					      m.ysize(), m.xsize());
+      }
+
+    template <typename T>
+      inline expression_leaf<matrix_kind,T> lazy(matrix<T>&& m)
+      {
+	std::shared_ptr< const matrix<T> > p = std::make_shared< const matrix<T> >(std::move(m));
+	return expression_leaf<matrix_kind,T>(p->ysize()*p->xsize() ? &((*p)[0]) : nullptr,
+					      p->ysize(), p->xsize(), p);
+      }
+
+
+    //////////////////////////////////////////////////////////////////////
+    // operators
+
+#define DINRHIW_EXPRESSION_BINARY(OPERATOR, OP)				\
+    template <typename K, typename T, typename L, typename R>		\
+      inline expression_binary<K,T,L,R,OP>				\
+      operator OPERATOR(const expression<K,T,L>& a, const expression<K,T,R>& b) \
+      {									\
+	return expression_binary<K,T,L,R,OP>(a.self(), b.self());	\
+      }									\
+									\
+    template <typename T, typename L>					\
+      inline expression_binary<vertex_kind,T,L,expression_leaf<vertex_kind,T>,OP> \
+      operator OPERATOR(const expression<vertex_kind,T,L>& a, const vertex<T>& b) \
+      {									\
+	return expression_binary<vertex_kind,T,L,expression_leaf<vertex_kind,T>,OP> \
+	  (a.self(), lazy(b));						\
+      }									\
+									\
+    template <typename T, typename R>					\
+      inline expression_binary<vertex_kind,T,expression_leaf<vertex_kind,T>,R,OP> \
+      operator OPERATOR(const vertex<T>& a, const expression<vertex_kind,T,R>& b) \
+      {									\
+	return expression_binary<vertex_kind,T,expression_leaf<vertex_kind,T>,R,OP> \
+	  (lazy(a), b.self());						\
+      }									\
+									\
+    template <typename T, typename L>					\
+      inline expression_binary<matrix_kind,T,L,expression_leaf<matrix_kind,T>,OP> \
+      operator OPERATOR(const expression<matrix_kind,T,L>& a, const matrix<T>& b) \
+      {									\
+	return expression_binary<matrix_kind,T,L,expression_leaf<matrix_kind,T>,OP> \
+	  (a.self(), lazy(b));						\
+      }									\
+									\
+    template <typename T, typename R>					\
+      inline expression_binary<matrix_kind,T,expression_leaf<matrix_kind,T>,R,OP> \
+      operator OPERATOR(const matrix<T>& a, const expression<matrix_kind,T,R>& b) \
+      {									\
+	return expression_binary<matrix_kind,T,expression_leaf<matrix_kind,T>,R,OP> \
+	  (lazy(a), b.self());						\
+      }
+
+    DINRHIW_EXPRESSION_BINARY(+, expression_add)
+    DINRHIW_EXPRESSION_BINARY(-, expression_sub)
+
+#undef DINRHIW_EXPRESSION_BINARY
+
+
+    template <typename K, typename T, typename E>
+      inline expression_scale<K,T,E>
+      operator*(const typename expression_scalar<T>::type& s, const expression<K,T,E>& e) throw()
+      {
+	return expression_scale<K,T,E>(s, e.self());
+      }
+
+    template <typename K, typename T, typename E>
+      inline expression_scale<K,T,E>
+      operator*(const expression<K,T,E>& e, const typename expression_scalar<T>::type& s) throw()
+      {
+	return expression_scale<K,T,E>(s, e.self());
+      }
+
+    // s*(t*e) = (s*t)*e
+    template <typename K, typename T, typename E>
+      inline expression_scale<K,T,E>
+      operator*(const typename expression_scalar<T>::type& s, const expression_scale<K,T,E>& e) throw()
+      {
+	return expression_scale<K,T,E>(s*e.s, e.e);
+      }
+
+    template <typename K, typename T, typename E>
+      inline expression_scale<K,T,E>
+      operator*(const expression_scale<K,T,E>& e, const typename expression_scalar<T>::type& s) throw()
+      {
+	return expression_scale<K,T,E>(e.s*s, e.e);
+      }
+
+    template <typename K, typename T, typename E>
+      inline expression_scale<K,T,E>
+      operator/(const expression<K,T,E>& e, const typename expression_scalar<T>::type& s) throw()
+      {
+	return expression_scale<K,T,E>(T(1.0f)/s, e.self());
+      }
+
+    template <typename K, typename T, typename E>
+      inline expression_scale<K,T,E>
+      operator-(const expression<K,T,E>& e) throw()
+      {
+	return expression_scale<K,T,E>(T(-1.0f), e.self());
+      }
+
+
+    //////////////////////////////////////////////////////////////////////
+    // evaluation (used by vertex and matrix)
+
+    // y += a*x
+    template <typename T>
+      inline void expression_axpy(const unsigned int n, const T& a, const T* x, T* y) throw()
+      {
+	if(typeid(T) == typeid(blas_real<float>)){
+	  cblas_saxpy(n, *((float*)&a), (float*)x, 1, (float*)y, 1);
+	}
+	else if(typeid(T) == typeid(blas_complex<float>)){
+	  cblas_caxpy(n, (const float*)&a, (float*)x, 1, (float*)y, 1);
+	}
+	else if(typeid(T) == typeid(blas_real<double>)){
+	  cblas_daxpy(n, *((double*)&a), (double*)x, 1, (double*)y, 1);
+	}
+	else if(typeid(T) == typeid(blas_complex<double>)){
+	  cblas_zaxpy(n, (const double*)&a, (double*)x, 1, (double*)y, 1);
+	}
+	else{
+	  for(unsigned int i=0;i<n;i++)
+	    y[i] += a*x[i];
+	}
+      }
+
+
+    // y = e
+    template <typename K, typename T, typename E>
+      inline void expression_assign(T* y, const expression<K,T,E>& e) throw()
+      {
+	const E& x = e.self();
+	const unsigned int n = x.size();
+
+	for(unsigned int i=0;i<n;i++)
+	  y[i] = x[i];
+      }
+
+    // y += sign*e
+    template <typename K, typename T, typename E>
+      inline void expression_accumulate(T* y, const expression<K,T,E>& e, const bool negate) throw()
+      {
+	const E& x = e.self();
+	const unsigned int n = x.size();
+
+	if(negate){
+	  for(unsigned int i=0;i<n;i++)
+	    y[i] -= x[i];
+	}
+	else{
+	  for(unsigned int i=0;i<n;i++)
+	    y[i] += x[i];
+	}
+      }
+
+    template <typename K, typename T>
+      inline void expression_accumulate(T* y, const expression_leaf<K,T>& e, const bool negate) throw()
+      {
+	expression_axpy(e.size(), negate ? T(-1.0f) : T(1.0f), e.ptr(), y);
+      }
+
+    template <typename K, typename T>
+      inline void expression_accumulate
+      (T* y, const expression_scale< K,T,expression_leaf<K,T> >& e, const bool negate) throw()
+      {
+	expression_axpy(e.size(), negate ? T(-1.0f)*e.s : e.s, e.e.ptr(), y);
+      }
+
+
+    //////////////////////////////////////////////////////////////////////
+    // vertex and matrix members
+
+    template <typename T>
+    template <typename E>
+      vertex<T>::vertex(const expression<vertex_kind,T,E>& e) : vertex(e.size())
+      {
+	expression_assign(data, e);
+      }
+
+    template <typename T>
+    template <typename E>
+      vertex<T>& vertex<T>::operator=(const expression<vertex_kind,T,E>& e) throw(illegal_operation)
+      {
+	if(dataSize != e.size())
+	  if(this->resize(e.size()) != e.size())
+	    throw illegal_operation("vertex: out of memory");
+
+	expression_assign(data, e);
+	return (*this);
+      }
+
+    template <typename T>
+    template <typename E>
+      vertex<T>& vertex<T>::operator+=(const expression<vertex_kind,T,E>& e) throw(illegal_operation)
+      {
+	if(dataSize != e.size()){
+	  assert(0);
+	  throw illegal_operation("vector op: vector dim. mismatch");
+	}
+
+	expression_accumulate(data, e.self(), false);
+	return (*this);
+      }
+
+    template <typename T>
+    template <typename E>
+      vertex<T>& vertex<T>::operator-=(const expression<vertex_kind,T,E>& e) throw(illegal_operation)
+      {
+	if(dataSize != e.size()){
+	  assert(0);
+	  throw illegal_operation("vector op: vector dim. mismatch");
+	}
+
+	expression_accumulate(data, e.self(), true);
+	return (*this);
+      }
+
+
+    template <typename T>
+    template <typename E>
+      matrix<T>::matrix(const expression<matrix_kind,T,E>& e) : matrix(e.ysize(), e.xsize())
+      {
+	expression_assign(data, e);
+      }
+
+    template <typename T>
+    template <typename E>
+      matrix<T>& matrix<T>::operator=(const expression<matrix_kind,T,E>& e) throw(illegal_operation)
+      {
+	if(numRows != e.ysize() || numCols != e.xsize())
+	  if(this->resize(e.ysize(), e.xsize()) == false)
+	    throw illegal_operation("matrix: out of memory");
+
+	expression_assign(data, e);
+	return (*this);
+      }
+
+    template <typename T>
+    template <typename E>
+      matrix<T>& matrix<T>::operator+=(const expression<matrix_kind,T,E>& e) throw(illegal_operation)
+      {
+	if(numRows != e.ysize() || numCols != e.xsize()){
+	  assert(0);
+	  throw illegal_operation("matrix: dimension mismatch");
+	}
+
+	expression_accumulate(data, e.self(), false);
+	return (*this);
+      }
+
+    template <typename T>
+    template <typename E>
+      matrix<T>& matrix<T>::operator-=(const expression<matrix_kind,T,E>& e) throw(illegal_operation)
+      {
+	if(numRows != e.ysize() || numCols != e.xsize()){
+	  assert(0);
+	  throw illegal_operation("matrix: dimension mismatch");
+	}
+
+	expression_accumulate(data, e.self(), true);
+	return (*this);
+      }
+
+  };
+};
+
+
+#endif
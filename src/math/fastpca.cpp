@@ -1,12 +1,54 @@
 
 #include "fastpca.h"
 #include "correlation.h"
+#include "eig.h"
+#include "RNG.h"
 
 
 namespace whiteice
 {
   namespace math
   {
+    
+    template <typename T>
+    static bool fastpca_randomized(const chunked_data_source< math::matrix<T> >& source,
+				   const unsigned int dimensions,
+				   math::matrix<T>& PCA,
+				   const unsigned int powerIterations,
+				   const unsigned int chunksize);
+    
+    
+    // in-memory data vectors as a chunked data source
+    template <typename T>
+    class fastpca_vector_source : public chunked_data_source< math::matrix<T> >
+    {
+    public:
+      fastpca_vector_source(const std::vector< vertex<T> >& data_) : data(data_){ }
+      
+      unsigned long long size() const throw(){ return data.size(); }
+      
+      bool read(const unsigned long long index,
+		const unsigned int N, math::matrix<T>& c) const
+      {
+	if(index + N > data.size()) return false;
+	const unsigned int D = data[0].size();
+	
+	if(c.resize(N, D) == false) return false;
+	
+	for(unsigned int j=0;j<N;j++){
+	  if(data[index+j].size() != D) return false;
+	  c.rowcopyfrom(data[index+j], j);
+	}
+	
+	return true;
+      }
+      
+      bool good() const throw(){ return (data.size() > 0); }
+      
+    private:
+      const std::vector< vertex<T> >& data;
+    };
+    
 
     /*
      * Extracts first "dimensions" PCA vectors from data
@@ -15,12 +57,18 @@ namespace whiteice
     template <typename T>
     bool fastpca(const std::vector< vertex<T> >& data, 
 		 const unsigned int dimensions,
-		 math::matrix<T>& PCA)
+		 math::matrix<T>& PCA,
+		 const fastpca_method method)
     {
       if(data.size() == 0) return false;
       if(data[0].size() < dimensions) return false;
       if(dimensions == 0) return false;
       
+      if(method == FASTPCA_RANDOMIZED){
+	fastpca_vector_source<T> source(data);
+	return fastpca_randomized(source, dimensions, PCA, 2, 4096);
+      }
+      
       // TODO: compute eigenvectors directly into PCA matrix
       
       math::vertex<T> m;
@@ -72,7 +120,7 @@ namespace whiteice
 	  
 	  iters++;
 	}
-	while(convergence > epsilon || iters >= 100);
+	while(convergence > epsilon && iters < 100);
 	
 	if(iters >= 100)
 	  std::cout << "WARN: fastpca maximum number of iterations reached without convergence." << std::endl;
@@ -91,19 +139,229 @@ namespace whiteice
       return true;
     }
     
+    
+    
+    template <typename T>
+    bool fastpca(const chunked_data_source< math::matrix<T> >& source,
+		 const unsigned int dimensions,
+		 math::matrix<T>& PCA,
+		 const unsigned int powerIterations,
+		 const unsigned int chunksize)
+    {
+      if(source.size() == 0 || source.good() == false) return false;
+      if(dimensions == 0 || chunksize == 0) return false;
+      
+      return fastpca_randomized(source, dimensions, PCA,
+				powerIterations, chunksize);
+    }
+    
+    
+    // orthonormalizes rows of Q (modified Gram-Schmidt done twice),
+    // rows that are linearly dependent are replaced with random vectors
+    template <typename T>
+    static void fastpca_orthonormalize(math::matrix<T>& Q, const RNG<T>& rng)
+    {
+      const unsigned int K = Q.ysize(), D = Q.xsize();
+      
+      for(unsigned int k=0;k<K;k++){
+	T* q = &(Q(k,0));
+	
+	for(unsigned int tries=0;tries<10;tries++){
+	  T norm0 = T(0.0f);
+	  for(unsigned int i=0;i<D;i++) norm0 += q[i]*q[i];
+	  
+	  for(unsigned int pass=0;pass<2;pass++){
+	    for(unsigned int l=0;l<k;l++){
+	      const T* p = &(Q(l,0));
+	      T s = T(0.0f);
+	      for(unsigned int i=0;i<D;i++) s += p[i]*q[i];
+	      for(unsigned int i=0;i<D;i++) q[i] -= s*p[i];
+	    }
+	  }
+	  
+	  T norm = T(0.0f);
+	  for(unsigned int i=0;i<D;i++) norm += q[i]*q[i];
+	  
+	  if(norm > T(1e-10f)*norm0 && norm > T(0.0f)){
+	    norm = T(1.0f)/whiteice::math::sqrt(norm);
+	    for(unsigned int i=0;i<D;i++) q[i] *= norm;
+	    break;
+	  }
+	  
+	  rng.normal(q, D);
+	}
+      }
+    }
+    
+    
+    /*
+     * computes Y = Q*Cxx (Y^t = Cxx*Q^t) from data in chunks, Q and Y are K x D.
+     * if mean m is empty it is computed during the same pass and the product
+     * is centered afterwards: Q*Cxx = Q*E[xx^t] - (Q*m)*m^t
+     */
+    template <typename T>
+    static bool fastpca_covariance_product(const chunked_data_source< math::matrix<T> >& source,
+					   const unsigned int chunksize,
+					   math::vertex<T>& m,
+					   const math::matrix<T>& Q,
+					   math::matrix<T>& Y)
+    {
+      const unsigned long long N = source.size();
+      const unsigned int K = Q.ysize(), D = Q.xsize();
+      const bool center = (m.size() == D);
+      
+      math::matrix<T> B, Z;
+      Y.resize(K, D);
+      Y.zero();
+      
+      if(!center){
+	m.resize(D);
+	m.zero();
+      }
+      
+      for(unsigned long long index=0;index<N;index+=chunksize){
+	const unsigned int n =
+	  (N - index < chunksize) ? (unsigned int)(N - index) : chunksize;
+	
+	if(source.read(index, n, B) == false) return false;
+	if(B.ysize() != n || B.xsize() != D) return false;
+	
+	for(unsigned int j=0;j<n;j++){
+	  T* b = &(B(j,0));
+	  
+	  if(center) for(unsigned int i=0;i<D;i++) b[i] -= m[i];
+	  else for(unsigned int i=0;i<D;i++) m[i] += b[i];
+	}
+	
+	// Z = (X - m)*Q^t, Y += Z^t*(X - m)
+	Z.resize(n, K);
+	gemm(false, true, n, K, D, 1.0f, &(B(0,0)), D, &(Q(0,0)), D, 0.0f, &(Z(0,0)), K);
+	gemm(true, false, K, D, n, 1.0f, &(Z(0,0)), K, &(B(0,0)), D, 1.0f, &(Y(0,0)), D);
+      }
+      
+      Y *= T(1.0f/(float)N);
+      
+      if(!center){
+	m /= T((float)N);
+	
+	for(unsigned int k=0;k<K;k++){
+	  const T* q = &(Q(k,0));
+	  T* y = &(Y(k,0));
+	  
+	  T qm = T(0.0f);
+	  for(unsigned int i=0;i<D;i++) qm += q[i]*m[i];
+	  for(unsigned int i=0;i<D;i++) y[i] -= qm*m[i];
+	}
+      }
+      
+      return true;
+    }
+    
+    
+    /*
+     * randomized PCA: subspace iteration Q = orth(Q*Cxx) starting from
+     * random gaussian Q and Rayleigh-Ritz projection S = Q*Cxx*Q^t which is
+     * small K x K eigenvalue problem. Cxx is never computed, data is used
+     * only through GEMM products of data chunks.
+     */
+    template <typename T>
+    static bool fastpca_randomized(const chunked_data_source< math::matrix<T> >& source,
+				   const unsigned int dimensions,
+				   math::matrix<T>& PCA,
+				   const unsigned int powerIterations,
+				   const unsigned int chunksize)
+    {
+      if(source.size() == 0) return false;
+      
+      // gets data dimension from the first data vector
+      math::matrix<T> B;
+      
+      if(source.read(0, 1, B) == false) return false;
+      
+      const unsigned int D = B.xsize();
+      if(D < dimensions) return false;
+      
+      // oversampling improves accuracy of the smallest extracted components
+      const unsigned int K = (dimensions + 10 < D) ? (dimensions + 10) : D;
+      
+      RNG<T> rng;
+      math::vertex<T> m; // mean is computed during the first pass
+      math::matrix<T> Q(K, D), Y;
+      
+      rng.normal(&(Q(0,0)), K*D);
+      fastpca_orthonormalize(Q, rng);
+      
+      for(unsigned int iter=0;iter<=powerIterations;iter++){
+	if(fastpca_covariance_product(source, chunksize, m, Q, Y) == false)
+	  return false;
+	
+	std::swap(Q, Y);
+	fastpca_orthonormalize(Q, rng);
+      }
+      
+      // Rayleigh-Ritz: S = Q*Cxx*Q^t = W*L*W^t, PCA = W^t*Q
+      if(fastpca_covariance_product(source, chunksize, m, Q, Y) == false)
+	return false;
+      
+      math::matrix<T> S(K, K), W;
+      gemm(false, true, K, K, D, 1.0f, &(Q(0,0)), D, &(Y(0,0)), D, 0.0f, &(S(0,0)), K);
+      
+      for(unsigned int j=0;j<K;j++){
+	for(unsigned int i=0;i<j;i++){
+	  S(j,i) = T(0.5f)*(S(j,i) + S(i,j));
+	  S(i,j) = S(j,i);
+	}
+      }
+      
+      if(symmetric_eig(S, W, true) == false)
+	return false;
+      
+      if(PCA.resize(dimensions, D) == false) return false;
+      
+      gemm(true, false, dimensions, D, K, 1.0f, &(W(0,0)), K, &(Q(0,0)), D, 0.0f, &(PCA(0,0)), D);
+      
+      return true;
+    }
+    
+
 
     template bool fastpca<float>(const std::vector< vertex<float> >& data, 
 				 const unsigned int dimensions,
-				 math::matrix<float>& PCA);
+				 math::matrix<float>& PCA,
+				 const fastpca_method method);
     template bool fastpca<double>(const std::vector< vertex<double> >& data, 
 				  const unsigned int dimensions,
-				  math::matrix<double>& PCA);
+				  math::matrix<double>& PCA,
+				  const fastpca_method method);
     template bool fastpca< blas_real<float> >(const std::vector< vertex< blas_real<float> > >& data, 
 					      const unsigned int dimensions,
-					      math::matrix< blas_real<float> >& PCA);
+					      math::matrix< blas_real<float> >& PCA,
+					      const fastpca_method method);
     template bool fastpca< blas_real<double> >(const std::vector< vertex< blas_real<double> > >& data, 
 					       const unsigned int dimensions,
-					       math::matrix< blas_real<double> >& PCA);
+					       math::matrix< blas_real<double> >& PCA,
+					       const fastpca_method method);
+    
+    template bool fastpca<float>(const chunked_data_source< math::matrix<float> >& source,
+				 const unsigned int dimensions,
+				 math::matrix<float>& PCA,
+				 const unsigned int powerIterations,
+				 const unsigned int chunksize);
+    template bool fastpca<double>(const chunked_data_source< math::matrix<double> >& source,
+				  const unsigned int dimensions,
+				  math::matrix<double>& PCA,
+				  const unsigned int powerIterations,
+				  const unsigned int chunksize);
+    template bool fastpca< blas_real<float> >(const chunked_data_source< math::matrix< blas_real<float> > >& source,
+					      const unsigned int dimensions,
+					      math::matrix< blas_real<float> >& PCA,
+					      const unsigned int powerIterations,
+					      const unsigned int chunksize);
+    template bool fastpca< blas_real<double> >(const chunked_data_source< math::matrix< blas_real<double> > >& source,
+					       const unsigned int dimensions,
+					       math::matrix< blas_real<double> >& PCA,
+					       const unsigned int powerIterations,
+					       const unsigned int chunksize);
     
     
   };
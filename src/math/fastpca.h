@@ -6,6 +6,12 @@
  *
  * Tomas Ukkonen 2014
  *
+ * randomized PCA (range finder with power iterations) as described in:
+ *
+ * "Finding structure with randomness: Probabilistic algorithms for
+ *  constructing approximate matrix decompositions."
+ * N. Halko, P.G. Martinsson, J.A. Tropp (2011)
+ *
  */
 
 #ifndef __fastpca_h
@@ -13,6 +19,7 @@
 
 #include "matrix.h"
 #include "vertex.h"
+#include "data_source.h"
 
 #include <vector>
 
@@ -22,29 +29,73 @@ namespace whiteice
   namespace math
   {
     
+    enum fastpca_method { FASTPCA_FIXEDPOINT = 0, FASTPCA_RANDOMIZED = 1 };
+    
     /*
      * Extracts first "dimensions" PCA vectors from data
      * PCA = X^t when Cxx = E{(x-m)(x-m)^t} = X*L*X^t
+     *
+     * FASTPCA_FIXEDPOINT computes Cxx and extracts vectors one by one,
+     * FASTPCA_RANDOMIZED uses randomized PCA which doesn't compute Cxx
+     * (faster when dimensions is much smaller than data dimension)
      */
     template <typename T>
       bool fastpca(const std::vector< vertex<T> >& data, 
 		   const unsigned int dimensions,
-		   math::matrix<T>& PCA);
-
+		   math::matrix<T>& PCA,
+		   const fastpca_method method = FASTPCA_FIXEDPOINT);
+    
+    /*
+     * Randomized PCA of out-of-core data. Rows of the matrices read
+     * from the source are data vectors. Data is read in chunks of
+     * chunksize vectors and it is passed through 2 + powerIterations
+     * times. Only (dimensions + 10) x D matrices are kept in memory.
+     */
+    template <typename T>
+      bool fastpca(const chunked_data_source< math::matrix<T> >& source,
+		   const unsigned int dimensions,
+		   math::matrix<T>& PCA,
+		   const unsigned int powerIterations = 2,
+		   const unsigned int chunksize = 4096);
+    
     
     extern template bool fastpca<float>(const std::vector< vertex<float> >& data, 
 					const unsigned int dimensions,
-					math::matrix<float>& PCA);
+					math::matrix<float>& PCA,
+					const fastpca_method method);
     extern template bool fastpca<double>(const std::vector< vertex<double> >& data, 
 					 const unsigned int dimensions,
-					 math::matrix<double>& PCA);
+					 math::matrix<double>& PCA,
+					 const fastpca_method method);
     extern template bool fastpca< blas_real<float> >(const std::vector< vertex< blas_real<float> > >& data, 
 						     const unsigned int dimensions,
-						     math::matrix< blas_real<float> >& PCA);
+						     math::matrix< blas_real<float> >& PCA,
+						     const fastpca_method method);
     extern template bool fastpca< blas_real<double> >(const std::vector< vertex< blas_real<double> > >& data, 
 						      const unsigned int dimensions,
-						      math::matrix< blas_real<double> >& PCA);
-	
+						      math::matrix< blas_real<double> >& PCA,
+						      const fastpca_method method);
+    
+    extern template bool fastpca<float>(const chunked_data_source< math::matrix<float> >& source,
+					const unsigned int dimensions,
+					math::matrix<float>& PCA,
+					const unsigned int powerIterations,
+					const unsigned int chunksize);
+    extern template bool fastpca<double>(const chunked_data_source< math::matrix<double> >& source,
+					 const unsigned int dimensions,
+					 math::matrix<double>& PCA,
+					 const unsigned int powerIterations,
+					 const unsigned int chunksize);
+    extern template bool fastpca< blas_real<float> >(const chunked_data_source< math::matrix< blas_real<float> > >& source,
+						     const unsigned int dimensions,
+						     math::matrix< blas_real<float> >& PCA,
+						     const unsigned int powerIterations,
+						     const unsigned int chunksize);
+    extern template bool fastpca< blas_real<double> >(const chunked_data_source< math::matrix< blas_real<double> > >& source,
+						      const unsigned int dimensions,
+						      math::matrix< blas_real<double> >& PCA,
+						      const unsigned int powerIterations,
+						      const unsigned int chunksize);
     
     
     
@@ -0,0 +1,142 @@
+/*
+ * float16 array conversions: generic implementation, F16C
+ * implementation and runtime selection between them
+ */
+
+#include "float16.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define FLOAT16_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+
+namespace whiteice
+{
+  namespace math
+  {
+    namespace float16_generic
+    {
+      static void float_to_half(const float* src, unsigned short* dst,
+				const unsigned long long N)
+      {
+	for(unsigned long long i=0;i<N;i++)
+	  dst[i] = whiteice::math::float_to_half(src[i]);
+      }
+
+      static void half_to_float(const unsigned short* src, float* dst,
+				const unsigned long long N)
+      {
+	for(unsigned long long i=0;i<N;i++)
+	  dst[i] = whiteice::math::half_to_float(src[i]);
+      }
+    };
+
+
+#ifdef FLOAT16_X86
+
+    // code below is compiled for AVX and F16C instruction sets
+#ifdef __clang__
+#pragma clang attribute push (__attribute__((target("avx,f16c"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx,f16c")
+#endif
+
+    namespace float16_f16c
+    {
+      static void float_to_half(const float* src, unsigned short* dst,
+				const unsigned long long N)
+      {
+	unsigned long long i = 0;
+
+	for(;i+8<=N;i+=8){
+	  const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i),
+					    _MM_FROUND_TO_NEAREST_INT);
+	  _mm_storeu_si128((__m128i*)(dst + i), h);
+	}
+
+	for(;i<N;i++)
+	  dst[i] = whiteice::math::float_to_half(src[i]);
+      }
+
+      static void half_to_float(const unsigned short* src, float* dst,
+				const unsigned long long N)
+      {
+	unsigned long long i = 0;
+
+	for(;i+8<=N;i+=8){
+	  const __m128i h = _mm_loadu_si128((const __m128i*)(src + i));
+	  _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+	}
+
+	for(;i<N;i++)
+	  dst[i] = whiteice::math::half_to_float(src[i]);
+      }
+    };
+
+#ifdef __clang__
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#endif
+
+
+    // selects implementation once using CPUID
+    struct float16_table
+    {
+      void (*to_half)(const float*, unsigned short*, const unsigned long long);
+      void (*to_float)(const unsigned short*, float*, const unsigned long long);
+      const char* name;
+
+      float16_table()
+      {
+	to_half = &float16_generic::float_to_half;
+	to_float = &float16_generic::half_to_float;
+	name = "generic";
+
+#ifdef FLOAT16_X86
+	unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+	__builtin_cpu_init();
+
+	// avx check also tests that OS saves YMM registers
+	if(__get_cpuid(1, &eax, &ebx, &ecx, &edx) &&
+	   (ecx & bit_F16C) && __builtin_cpu_supports("avx")){
+	  to_half = &float16_f16c::float_to_half;
+	  to_float = &float16_f16c::half_to_float;
+	  name = "f16c";
+	}
+#endif
+      }
+    };
+
+    static const float16_table& float16_kernels()
+    {
+      static const float16_table table;
+      return table;
+    }
+
+
+    void float_to_half(const float* src, unsigned short* dst,
+		       const unsigned long long N) throw()
+    {
+      float16_kernels().to_half(src, dst, N);
+    }
+
+    void half_to_float(const unsigned short* src, float* dst,
+		       const unsigned long long N) throw()
+    {
+      float16_kernels().to_float(src, dst, N);
+    }
+
+    const char* float16_instruction_set() throw()
+    {
+      return float16_kernels().name;
+    }
+
+  };
+};
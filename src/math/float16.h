@@ -0,0 +1,220 @@
+/*
+ * IEEE 754 half precision (16 bit) floating point conversions
+ * used to store parameters and data in a compact form.
+ * calculations are always done in single or double precision.
+ *
+ * array conversions use F16C instructions when CPU supports them
+ * (selected at runtime, float16.cpp) and float16_vector stores
+ * vertex<T> values in half precision.
+ */
+
+#ifndef math_float16_h
+#define math_float16_h
+
+#include <string.h>
+#include <vector>
+
+#include "blade_math.h"
+#include "vertex.h"
+
+
+namespace whiteice
+{
+  namespace math
+  {
+    // converts float to half precision (rounds to nearest even)
+    inline unsigned short float_to_half(const float f) throw()
+    {
+      unsigned int x;
+      memcpy(&x, &f, sizeof(x));
+
+      const unsigned int sign = (x >> 16) & 0x8000;
+      const unsigned int e = (x >> 23) & 0xFF;
+      unsigned int m = x & 0x7FFFFF;
+
+      if(e == 0xFF) // infinity or NaN
+	return (unsigned short)(sign | 0x7C00 | (m ? (0x200 | (m >> 13)) : 0));
+
+      const int exp = (int)e - 127 + 15;
+
+      if(exp >= 0x1F) // overflow
+	return (unsigned short)(sign | 0x7C00);
+
+      if(exp <= 0){ // subnormal half or zero
+	if(exp < -10) return (unsigned short)sign;
+
+	m |= 0x800000;
+	const unsigned int shift = 14 - exp;
+	unsigned int h = m >> shift;
+	const unsigned int rem = m & ((1U << shift) - 1);
+	const unsigned int half = 1U << (shift - 1);
+
+	if(rem > half || (rem == half && (h & 1))) h++;
+
+	return (unsigned short)(sign | h);
+      }
+
+      unsigned int h = (((unsigned int)exp) << 10) | (m >> 13);
+      const unsigned int rem = m & 0x1FFF;
+
+      // rounding may carry to exponent (and to infinity) which is correct
+      if(rem > 0x1000 || (rem == 0x1000 && (h & 1))) h++;
+
+      return (unsigned short)(sign | h);
+    }
+
+
+    // converts half precision number to float (exact)
+    inline float half_to_float(const unsigned short h) throw()
+    {
+      const unsigned int sign = (((unsigned int)h) & 0x8000) << 16;
+      int e = (h >> 10) & 0x1F;
+      unsigned int m = h & 0x3FF;
+      unsigned int x;
+
+      if(e == 0x1F){ // infinity or NaN
+	x = sign | 0x7F800000 | (m << 13);
+      }
+      else if(e == 0){
+	if(m == 0){
+	  x = sign;
+	}
+	else{ // subnormal: normalizes mantissa
+	  e = 1;
+	  while((m & 0x400) == 0){ m <<= 1; e--; }
+	  m &= 0x3FF;
+	  x = sign | (((unsigned int)(e + 127 - 15)) << 23) | (m << 13);
+	}
+      }
+      else{
+	x = sign | (((unsigned int)(e + 127 - 15)) << 23) | (m << 13);
+      }
+
+      float f;
+      memcpy(&f, &x, sizeof(f));
+      return f;
+    }
+
+
+    // converts N values between float and half precision arrays
+    void float_to_half(const float* src, unsigned short* dst,
+		       const unsigned long long N) throw();
+    void half_to_float(const unsigned short* src, float* dst,
+		       const unsigned long long N) throw();
+
+    // instruction set selected at runtime: "f16c" or "generic"
+    const char* float16_instruction_set() throw();
+
+
+    // converts N values of float or double based number type T
+    // (float, double, blas_real<float>, blas_real<double>). overloads
+    // select direct conversion of float arrays at compile time
+    template <typename T>
+    inline void to_half(const T* src, unsigned short* dst,
+			const unsigned long long N) throw()
+    {
+      float buf[256];
+
+      for(unsigned long long i=0;i<N;i+=256){
+	const unsigned int n = (N - i < 256) ? (N - i) : 256;
+
+	for(unsigned int j=0;j<n;j++)
+	  convert(buf[j], src[i+j]);
+
+	float_to_half(buf, dst + i, n);
+      }
+    }
+
+
+    template <typename T>
+    inline void from_half(const unsigned short* src, T* dst,
+			  const unsigned long long N) throw()
+    {
+      float buf[256];
+
+      for(unsigned long long i=0;i<N;i+=256){
+	const unsigned int n = (N - i < 256) ? (N - i) : 256;
+
+	half_to_float(src + i, buf, n);
+
+	for(unsigned int j=0;j<n;j++)
+	  dst[i+j] = T(buf[j]);
+      }
+    }
+
+
+    inline void to_half(const float* src, unsigned short* dst,
+			const unsigned long long N) throw()
+    {
+      float_to_half(src, dst, N);
+    }
+
+
+    inline void from_half(const unsigned short* src, float* dst,
+			  const unsigned long long N) throw()
+    {
+      half_to_float(src, dst, N);
+    }
+
+
+    // blas_real<float> has the same memory layout as float
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Waddress-of-packed-member"
+
+    inline void to_half(const blas_real<float>* src, unsigned short* dst,
+			const unsigned long long N) throw()
+    {
+      float_to_half((const float*)src, dst, N);
+    }
+
+
+    inline void from_half(const unsigned short* src, blas_real<float>* dst,
+			  const unsigned long long N) throw()
+    {
+      half_to_float(src, (float*)dst, N);
+    }
+
+#pragma GCC diagnostic pop
+
+
+    // vector stored in half precision (compact storage of parameters,
+    // samples and data), values are converted from/to vertex<T> when used
+    class float16_vector
+    {
+    public:
+      float16_vector(){ }
+
+      template <typename T>
+	float16_vector(const vertex<T>& v){ importdata(v); }
+
+      unsigned int size() const throw(){ return h.size(); }
+
+      const unsigned short* data() const throw(){ return h.data(); }
+      unsigned short* data() throw(){ return h.data(); }
+
+      void resize(const unsigned int N){ h.resize(N); }
+
+      template <typename T>
+	void importdata(const vertex<T>& v)
+      {
+	h.resize(v.size());
+	if(v.size() > 0) to_half(&(v[0]), h.data(), v.size());
+      }
+
+      template <typename T>
+	bool exportdata(vertex<T>& v) const
+      {
+	if(v.resize(h.size()) != h.size()) return false;
+	if(h.size() > 0) from_half(h.data(), &(v[0]), h.size());
+	return true;
+      }
+
+    private:
+      std::vector<unsigned short> h;
+    };
+
+  };
+};
+
+
+#endif
@@ -9,6 +9,7 @@
 #include "correlation.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 
 namespace whiteice
@@ -17,22 +18,22 @@ namespace whiteice
   {
     
     template bool ica< blas_real<float> >
-      (const matrix< blas_real<float> >& D, matrix< blas_real<float> >& W, bool verbose) throw();
+      (const matrix< blas_real<float> >& D, matrix< blas_real<float> >& W, bool verbose, const ica_method method) throw();
     template bool ica< blas_real<double> >
-      (const matrix< blas_real<double> >& D, matrix< blas_real<double> >& W, bool verbose) throw();
+      (const matrix< blas_real<double> >& D, matrix< blas_real<double> >& W, bool verbose, const ica_method method) throw();
     template bool ica< float >
-      (const matrix<float>& D, matrix<float>& W, bool verbose) throw();
+      (const matrix<float>& D, matrix<float>& W, bool verbose, const ica_method method) throw();
     template bool ica< double >
-      (const matrix<double>& D, matrix<double>& W, bool verbose) throw();
+      (const matrix<double>& D, matrix<double>& W, bool verbose, const ica_method method) throw();
 
     template bool ica< blas_real<float> >
-      (const std::vector< math::vertex< blas_real<float> > >& data, matrix< blas_real<float> >& W, bool verbose) throw();
+      (const std::vector< math::vertex< blas_real<float> > >& data, matrix< blas_real<float> >& W, bool verbose, const ica_method method) throw();
     template bool ica< blas_real<double> >
-      (const std::vector< math::vertex< blas_real<double> > >& data, matrix< blas_real<double> >& W, bool verbose) throw();
+      (const std::vector< math::vertex< blas_real<double> > >& data, matrix< blas_real<double> >& W, bool verbose, const ica_method method) throw();
     template bool ica< float >
-      (const std::vector< math::vertex<float> >& data, matrix<float>& W, bool verbose) throw();
+      (const std::vector< math::vertex<float> >& data, matrix<float>& W, bool verbose, const ica_method method) throw();
     template bool ica< double >
-      (const std::vector< math::vertex<double> >& data, matrix<double>& W, bool verbose) throw();    
+      (const std::vector< math::vertex<double> >& data, matrix<double>& W, bool verbose, const ica_method method) throw();    
     
     template <typename T>
     void __ica_project(vertex<T>& w, const unsigned int n, const matrix<T>& W);
@@ -47,76 +48,205 @@ namespace whiteice
       (vertex<double>& w, const unsigned int n, const matrix<double>& W);
     
     
+    /*
+     * computes fixed-point iteration expectations for rows w_k of W:
+     * G(k,:) = E[x * g(w_k^t x)] and dg[k] = E[g'(w_k^t x)] where
+     * g(u) = u*exp(-u^2/2). blocks of samples are processed in parallel
+     * threads: Y = X_b*W^t and G += g(Y)^t*X_b are GEMMs.
+     */
     template <typename T>
-    bool ica(const std::vector< math::vertex<T> >& data, matrix<T>& W, bool verbose) throw()
+    static void ica_expectations(const matrix<T>& X, const matrix<T>& W,
+				 matrix<T>& G, vertex<T>& dg)
     {
-      // this is interface class that simply makes dataset<> calls work, does an costly data format transformation here
-      // as the data types are not compatible (TODO: write code that uses DIRECTLY std::vector<> datasets
-
+      const unsigned int BLOCKSIZE = 1024;
+      const unsigned int num = X.ysize(), dim = X.xsize(), K = W.ysize();
+      const unsigned int NBLOCKS = (num + BLOCKSIZE - 1)/BLOCKSIZE;
+      
+      G.resize(K, dim);
+      G.zero();
+      dg.resize(K);
+      dg.zero();
+      
+#pragma omp parallel
+      {
+	matrix<T> Y(BLOCKSIZE, K), Gl(K, dim);
+	vertex<T> dgl(K);
+	Gl.zero();
+	dgl.zero();
+	
+#pragma omp for nowait schedule(dynamic)
+	for(unsigned int b=0;b<NBLOCKS;b++){
+	  const unsigned int begin = b*BLOCKSIZE;
+	  const unsigned int n = (num - begin < BLOCKSIZE) ? (num - begin) : BLOCKSIZE;
+	  const T* Xb = &(X(begin, 0));
+	  T* y = &(Y(0,0));
+	  
+	  gemm(false, true, n, K, dim, 1.0f, Xb, dim, &(W(0,0)), dim, 0.0f, y, K);
+	  
+	  for(unsigned int j=0;j<n;j++){
+	    for(unsigned int k=0;k<K;k++){
+	      const T u = y[j*K + k];
+	      const T e = whiteice::math::exp(-T(0.5f)*u*u);
+	      
+	      dgl[k] += (T(1.0f) - u*u)*e;
+	      y[j*K + k] = u*e;
+	    }
+	  }
+	  
+	  gemm(true, false, K, dim, n, 1.0f, y, K, Xb, dim, 1.0f, &(Gl(0,0)), dim);
+	}
+	
+#pragma omp critical
+	{
+	  G += Gl;
+	  dg += dgl;
+	}
+      }
+      
+      const T scaling = T(1.0f)/T((float)num);
+      
+      G *= scaling;
+      dg *= scaling;
+    }
+    
+    
+    // symmetric decorrelation W = (W*W^t)^-0.5 * W
+    template <typename T>
+    static bool ica_decorrelate(matrix<T>& W)
+    {
+      const unsigned int K = W.ysize(), dim = W.xsize();
+      matrix<T> C(K, K), E, F(K, K);
+      
+      gemm(false, true, K, K, dim, 1.0f, &(W(0,0)), dim, &(W(0,0)), dim, 0.0f, &(C(0,0)), K);
+      
+      if(symmetric_eig(C, E) == false)
+	return false;
+      
+      // F = E * D^-0.5 * E^t
+      matrix<T> ED(E);
+      
+      for(unsigned int k=0;k<K;k++){
+	if(C(k,k) <= T(0.0f)) return false;
+	
+	const T s = T(1.0f)/whiteice::math::sqrt(C(k,k));
+	for(unsigned int j=0;j<K;j++) ED(j,k) *= s;
+      }
+      
+      gemm(false, true, K, K, K, 1.0f, &(ED(0,0)), K, &(E(0,0)), K, 0.0f, &(F(0,0)), K);
+      
+      matrix<T> V(W);
+      gemm(false, false, K, dim, K, 1.0f, &(F(0,0)), K, &(V(0,0)), dim, 0.0f, &(W(0,0)), dim);
+      
+      return true;
+    }
+    
+    
+    template <typename T>
+    bool ica(const std::vector< math::vertex<T> >& data, matrix<T>& W,
+	     bool verbose, const ica_method method) throw()
+    {
+      // copies data vectors to rows of matrix
       if(data.size() <= 0) return false;
 
+      const unsigned int dim = data[0].size();
       matrix<T> DATA;
 
-      DATA.resize(data.size(), data[0].size());
-
-      for(unsigned int j=0;j<DATA.ysize();j++)
-	for(unsigned int i=0;i<DATA.xsize();i++)
-	  DATA(j, i) = data[j][i];
+      if(DATA.resize(data.size(), dim) == false) return false;
+      
+      for(unsigned int j=0;j<data.size();j++){
+	if(data[j].size() != dim) return false;
+	DATA.rowcopyfrom(data[j], j);
+      }
 
-      return ica(DATA, W, verbose);
+      return ica(DATA, W, verbose, method);
     }
 
     
     template <typename T>
-    bool ica(const matrix<T>& D, matrix<T>& W, bool verbose) throw()
+    bool ica(const matrix<T>& D, matrix<T>& W, bool verbose,
+	     const ica_method method) throw()
     {
       try{
 	
 	const unsigned int num = D.ysize();
 	const unsigned int dim = D.xsize();
 	
-	// data MUST be already white (PCA preprocessed)
-
-	const matrix<T>& X = D; // X = (V * D')'
+	if(num == 0 || dim == 0) return false;
 	
-	/*
-	matrix<T> V;
-	
-	{
-	  matrix<T> Rxx;
-	  if(autocorrelation(Rxx, D) == false)
-	    return false;
-	  
-	  if(symmetric_eig(Rxx, V) == false)
-	    return false;
-	  
-	  // calculates V = D**(-0.5) * V.transpose()
-	  V.transpose();
-	  
-	  for(unsigned int j=0;j<dim;j++){
-	    T scaling = T(1.0) / whiteice::math::sqrt(Rxx(j,j));
-	    for(unsigned int i=0;i<dim;i++)
-	      V(j,i) *= scaling;
-	  }
-	}
-	
-	V.transpose();
-	matrix<T> X = D * V; // X = (V * D')'
-	V.transpose();
-	*/
+	// data MUST be already white (PCA preprocessed)
+	const matrix<T>& X = D;
 	
 	const T TOLERANCE = T(0.0001);
 	const unsigned int MAXITERS = 200;
 	
-	// matrix<T> W;
 	W.resize(dim,dim);
 	
 	for(unsigned int j=0;j<dim;j++)
 	  for(unsigned int i=0;i<dim;i++)
 	    W(j,i) = T((float)rand()) / T((float)RAND_MAX);
 	
+	matrix<T> G;
+	vertex<T> dg;
+	
+	if(method == ICA_SYMMETRIC){
+	  // solves all ICs at once, initial W must be well-conditioned
+	  for(unsigned int j=0;j<dim;j++)
+	    for(unsigned int i=0;i<dim;i++)
+	      W(j,i) = T(2.0f*((float)rand())/((float)RAND_MAX) - 1.0f);
+	  
+	  if(ica_decorrelate(W) == false)
+	    return false;
+	  
+	  bool convergence = false;
+	  unsigned int iter = 0;
+	  matrix<T> W_old;
+	  
+	  while(convergence == false && iter < MAXITERS){
+	    W_old = W;
+	    
+	    // w_k = E[x * g(w_k^t x)] - E[g'(w_k^t x)] * w_k
+	    ica_expectations(X, W, G, dg);
+	    
+	    for(unsigned int k=0;k<dim;k++)
+	      for(unsigned int i=0;i<dim;i++)
+		W(k,i) = G(k,i) - dg[k]*W(k,i);
+	    
+	    if(ica_decorrelate(W) == false)
+	      return false;
+	    
+	    // checks that all w_k stay in the same direction
+	    T delta = T(0.0f);
+	    
+	    for(unsigned int k=0;k<dim;k++){
+	      T dot = T(0.0f);
+	      for(unsigned int i=0;i<dim;i++)
+		dot += W(k,i)*W_old(k,i);
+	      
+	      dot = T(1.0f) - whiteice::math::abs(dot);
+	      if(dot > delta) delta = dot;
+	    }
+	    
+	    if(delta < TOLERANCE)
+	      convergence = true;
+	    
+	    iter++;
+	  }
+	  
+	  if(verbose){
+	    if(convergence)
+	      std::cout << "ICs converged after " << iter << " iterations." << std::endl;
+	    else
+	      std::cout << "Warning: ICs didn't converge" << std::endl;
+	  }
+	  
+	  return true;
+	}
+	
+	
 	vertex<T> w;
-	w.resize(dim);            
+	w.resize(dim);
+	
+	matrix<T> W1(1, dim);
 	
 	// solves each IC separatedly (deflate method)
 	for(unsigned int n=0;n<dim;n++){
@@ -129,47 +259,19 @@ namespace whiteice
 	  
 	  bool convergence = 0;
 	  unsigned int iter = 0;
-	  vertex<T> w_old, y;
-	  T scaling = T(1.0) / T(num);
-	  
-	  vertex<T> x; x.resize(dim);
-	  vertex<T> xgy; xgy.resize(dim); // E[x * g(w * x)]
-	  T dgy; // E[g'(w * x)]
+	  vertex<T> w_old;
 	  
 	  while(convergence == false){
 	    
 	    // updates w vector
 	    w_old = w;
 	    
-	    y = X * w;
+	    W1.rowcopyfrom(w, 0);
+	    ica_expectations(X, W1, G, dg);
 	    
-	    if((iter % 2) == 0){ // tanh non-linearity
-	      for(unsigned int i=0;i<dim;i++) xgy[i] = T(0.0);
-	      dgy = 0;
-	      
-	      for(unsigned int i=0;i<num;i++){
-		X.rowcopyto(x, i);
-		T temp = whiteice::math::exp(-(y[i]*y[i])/T(2.0));
-		
-		xgy += scaling * ((y[i] * temp) * x);
-		dgy += scaling * (temp - (y[i]*y[i])*temp);
-	      }
-	    }
-	    else{ // u*exp(-u**2/2) non-linearity
-	      
-	      for(unsigned int i=0;i<dim;i++) xgy[i] = T(0.0);
-	      dgy = 0;
-	      
-	      for(unsigned int i=0;i<num;i++){
-		X.rowcopyto(x, i);
-		T temp = whiteice::math::exp(-(y[i]*y[i])/T(2.0));
-		
-		xgy += scaling * ((y[i] * temp) * x);
-		dgy += scaling * (temp - (y[i]*y[i])*temp);
-	      }
-	    }
+	    for(unsigned int i=0;i<dim;i++)
+	      w[i] = G(0,i) - dg[0]*w[i];
 	    
-	    w = xgy - dgy*w;
 	    w.normalize();
 	    __ica_project(w, n, W); // projection
 	    
@@ -13,13 +13,19 @@ namespace whiteice
   namespace math
   {
     
+    // ICA_DEFLATION solves ICs one by one, ICA_SYMMETRIC solves
+    // all ICs at once using symmetric decorrelation W = (W*W^t)^-0.5 * W
+    enum ica_method { ICA_DEFLATION = 0, ICA_SYMMETRIC = 1 };
+    
     // solves independent components from the data and saves
-    // dependacy removal matrix to W. Uses deflate method.
+    // dependacy removal matrix to W. data must be white (E[xx^t] = I)
     template <typename T>
-      bool ica(const matrix<T>& D, matrix<T>& W, bool verbose = false) throw();
+      bool ica(const matrix<T>& D, matrix<T>& W, bool verbose = false,
+	       const ica_method method = ICA_DEFLATION) throw();
 
     template <typename T>
-      bool ica(const std::vector< math::vertex<T> >& data, matrix<T>& W, bool verbose = false) throw();
+      bool ica(const std::vector< math::vertex<T> >& data, matrix<T>& W, bool verbose = false,
+	       const ica_method method = ICA_DEFLATION) throw();
 
 
     
@@ -29,23 +35,23 @@ namespace whiteice
     // grouped and PCAed so that the gaussian subspace is also solved as well as possible
     
     extern template bool ica< blas_real<float> >
-      (const matrix< blas_real<float> >& D, matrix< blas_real<float> >& W, bool verbose) throw();
+      (const matrix< blas_real<float> >& D, matrix< blas_real<float> >& W, bool verbose, const ica_method method) throw();
     extern template bool ica< blas_real<double> >
-      (const matrix< blas_real<double> >& D, matrix< blas_real<double> >& W, bool verbose) throw();
+      (const matrix< blas_real<double> >& D, matrix< blas_real<double> >& W, bool verbose, const ica_method method) throw();
     extern template bool ica< float >
-      (const matrix<float>& D, matrix<float>& W, bool verbose) throw();
+      (const matrix<float>& D, matrix<float>& W, bool verbose, const ica_method method) throw();
     extern template bool ica< double >
-      (const matrix<double>& D, matrix<double>& W, bool verbose) throw();
+      (const matrix<double>& D, matrix<double>& W, bool verbose, const ica_method method) throw();
 
     
     extern template bool ica< blas_real<float> >
-      (const std::vector< math::vertex< blas_real<float> > >& data, matrix< blas_real<float> >& W, bool verbose) throw();
+      (const std::vector< math::vertex< blas_real<float> > >& data, matrix< blas_real<float> >& W, bool verbose, const ica_method method) throw();
     extern template bool ica< blas_real<double> >
-      (const std::vector< math::vertex< blas_real<double> > >& data, matrix< blas_real<double> >& W, bool verbose) throw();
+      (const std::vector< math::vertex< blas_real<double> > >& data, matrix< blas_real<double> >& W, bool verbose, const ica_method method) throw();
     extern template bool ica< float >
-      (const std::vector< math::vertex<float> >& data, matrix<float>& W, bool verbose) throw();
+      (const std::vector< math::vertex<float> >& data, matrix<float>& W, bool verbose, const ica_method method) throw();
     extern template bool ica< double >
-      (const std::vector< math::vertex<double> >& data, matrix<double>& W, bool verbose) throw();    
+      (const std::vector< math::vertex<double> >& data, matrix<double>& W, bool verbose, const ica_method method) throw();    
     
   };
 };
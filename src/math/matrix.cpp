@@ -101,9 +101,10 @@ namespace whiteice
       compressor = M.compressor;
     }
     
-#if 0    
+    
+    // makes direct copy of temporal value
     template <typename T>
-    matrix<T>::matrix(matrix<T>&& t)
+    matrix<T>::matrix(matrix<T>&& t) throw()
     {
       this->data = t.data;
       this->numRows = t.numRows;
@@ -111,9 +112,10 @@ namespace whiteice
       this->compressor = t.compressor;
       
       t.data = nullptr;
+      t.numRows = 0;
+      t.numCols = 0;
       t.compressor = nullptr;
     }
-#endif
     
     template <typename T>
     matrix<T>::matrix(const vertex<T>& diagonal)
@@ -433,28 +435,28 @@ namespace whiteice
       return (*this);
     }
     
-#if 0    
+    
+    // moves data from temporary matrix (no memory allocation and copying)
     template <typename T>
     matrix<T>& matrix<T>::operator=(matrix<T>&& t) throw(illegal_operation)
     {
       if(this == &t) return *this; // self-assignment
       
-      // printf("matrix&& operator=\n"); fflush(stdout);
-      
       if(this->data) free(this->data);
       if(this->compressor) delete (this->compressor);
       
-      this->data = std::move(t.data);
-      this->numRows = std::move(t.numRows);
-      this->numCols = std::move(t.numCols);
-      this->compressor = std::move(t.compressor);
+      this->data = t.data;
+      this->numRows = t.numRows;
+      this->numCols = t.numCols;
+      this->compressor = t.compressor;
       
       t.data = nullptr;
+      t.numRows = 0;
+      t.numCols = 0;
       t.compressor = nullptr;
       
       return *this;
     }
-#endif
     
     
     
@@ -912,8 +914,8 @@ namespace whiteice
       
       const unsigned int xleft = A.xsize() & 0x0F;
       const unsigned int yleft = A.ysize() & 0x0F;
-      const unsigned int ys = A.ysize() & 0xF0;
-      const unsigned int xs = A.xsize() & 0xF0;
+      const unsigned int ys = A.ysize() & ~0x0F;
+      const unsigned int xs = A.xsize() & ~0x0F;
       
       // transposes block by block
       // (so we hopefully are all the time within cache limits)
@@ -34,6 +34,9 @@ namespace whiteice
     
     template <typename T> class vertex;
     template <typename T> class matrix;
+    
+    struct matrix_kind;
+    template <typename K, typename T, typename E> class expression;
       
         
     template <typename T> bool gramschmidt
@@ -73,8 +76,13 @@ namespace whiteice
       matrix(const unsigned int size_y = 4,
 	     const unsigned int size_x = 4);
       matrix(const matrix<T>& M);
-      //matrix(matrix<T>&& t);
+      matrix(matrix<T>&& t) throw(); // moves data of temporary matrix
       matrix(const vertex<T>& diagonal);
+      
+      // evaluates element-wise expression (see expression.h)
+      template <typename E>
+      matrix(const expression<matrix_kind, T, E>& e);
+      
       virtual ~matrix();
       
       
@@ -91,7 +99,15 @@ namespace whiteice
       matrix<T>& operator/=(const matrix<T>&) throw(illegal_operation);
       
       matrix<T>& operator=(const matrix<T>&) throw(illegal_operation);
-      //matrix<T>& operator=(matrix<T>&& t) throw(illegal_operation);
+      matrix<T>& operator=(matrix<T>&& t) throw(illegal_operation);
+      
+      // element-wise expressions are evaluated in a single loop
+      template <typename E>
+      matrix<T>& operator=(const expression<matrix_kind, T, E>& e) throw(illegal_operation);
+      template <typename E>
+      matrix<T>& operator+=(const expression<matrix_kind, T, E>& e) throw(illegal_operation);
+      template <typename E>
+      matrix<T>& operator-=(const expression<matrix_kind, T, E>& e) throw(illegal_operation);
       
       bool operator==(const matrix<T>&) const throw(uncomparable);
       bool operator!=(const matrix<T>&) const throw(uncomparable);
@@ -401,5 +417,7 @@ namespace whiteice
 };
 
 
+#include "expression.h"
+
 #endif
 
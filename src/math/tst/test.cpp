@@ -57,6 +57,9 @@ void own_terminate();
 void own_unexpected();
 
 void rng_test();
+void eig_test();
+void covariance_accumulator_test();
+void expression_test();
 
 void vertex_test();
 void outerproduct_test();
@@ -248,8 +251,308 @@ void rng_test()
 	std::cout << "Exponential RNG [samples/ms]: " << ((double)SAMPLES)/own_exp_time << std::endl;
 	std::cout << "C++ Normal RNG  [samples/ms]: " << ((double)SAMPLES)/cpp_nrm_time << std::endl;
 
+
+	// counter based generator: known answer tests of Philox4x32-10 (Random123)
+	{
+		const unsigned int c1[4] = { 0, 0, 0, 0 }, k1[2] = { 0, 0 };
+		const unsigned int c2[4] = { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 };
+		const unsigned int k2[2] = { 0xa4093822, 0x299f31d0 };
+		const unsigned int r1[4] = { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 };
+		const unsigned int r2[4] = { 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 };
+		unsigned int out1[4], out2[4];
+
+		RNG<>::philox(c1, k1, out1);
+		RNG<>::philox(c2, k2, out2);
+
+		if(memcmp(out1, r1, sizeof(r1)) != 0 || memcmp(out2, r2, sizeof(r2)) != 0)
+			std::cout << "ERROR: Philox4x32-10 known answer test FAILED." << std::endl;
+	}
+
+	// streams are reproducible and independent
+	{
+		RNG<> p1(12345, 0), p2(12345, 0);
+		RNG<> p3 = p1.stream(1);
+
+		math::vertex<> v1(1001), v2(1001), v3(1001);
+
+		p1.normal(v1);
+		p2.normal(v2);
+		p3.normal(v3);
+
+		if((v1 - v2).norm() != 0.0f)
+			std::cout << "ERROR: RNG stream is not reproducible." << std::endl;
+
+		if((v1 - v3).norm() < 1.0f)
+			std::cout << "ERROR: RNG streams are not independent." << std::endl;
+
+		v.resize(SAMPLES);
+
+		t0=std::chrono::high_resolution_clock::now();
+		p1.normal(v);
+		t1=std::chrono::high_resolution_clock::now();
+		auto ph_nrm_time = std::chrono::duration_cast<std::chrono::milliseconds>(t1-t0).count();
+
+		double pm = 0.0, ps = 0.0; // float sums are inaccurate with 10.000.000 samples
+
+		for(unsigned int i=0;i<v.size();i++){
+			pm += v[i].c[0];
+			ps += v[i].c[0]*v[i].c[0];
+		}
+
+		pm /= v.size();
+		ps /= v.size();
+		ps -= pm*pm;
+
+		if(fabs(pm) > 0.01 || fabs(ps - 1.0) > 0.01)
+			std::cout << "ERROR: Philox normal distribution mean/var: "
+				  << pm << " " << ps << std::endl;
+
+		std::cout << "Philox Normal RNG [samples/ms]: " << ((double)SAMPLES)/(ph_nrm_time + 1) << std::endl;
+	}
+
+}
+
+
+//////////////////////////////////////////////////////////////////////
+
+void eig_test()
+{
+	RNG< blas_real<double> > rng;
+
+	// symmetric_eig(): A = X*D*X^t, X^t*X = I, descending eigenvalues
+	for(const unsigned int N : {1, 2, 5, 40, 300}){
+		matrix< blas_real<double> > A(N,N), D, X, Xt;
+
+		for(unsigned int j=0;j<N;j++)
+			for(unsigned int i=0;i<=j;i++){
+				A(j,i) = rng.normal();
+				A(i,j) = A(j,i);
+			}
+
+		D = A;
+
+		auto t0=std::chrono::high_resolution_clock::now();
+
+		if(symmetric_eig(D, X, true) == false){
+			std::cout << "ERROR: symmetric_eig() failed (N = " << N << ")" << std::endl;
+			continue;
+		}
+
+		auto t1=std::chrono::high_resolution_clock::now();
+		auto eig_time = std::chrono::duration_cast<std::chrono::milliseconds>(t1-t0).count();
+
+		Xt = X;
+		Xt.transpose();
+
+		auto R = X*D*Xt - A;
+		auto I = Xt*X;
+
+		for(unsigned int i=0;i<N;i++)
+			I(i,i) -= 1.0;
+
+		if(frobenius_norm(R) > 1e-8*(frobenius_norm(A) + 1.0))
+			std::cout << "ERROR: symmetric_eig() reconstruction error: "
+				  << frobenius_norm(R) << " (N = " << N << ")" << std::endl;
+
+		if(frobenius_norm(I) > 1e-8*N)
+			std::cout << "ERROR: symmetric_eig() eigenvectors are not orthonormal: "
+				  << frobenius_norm(I) << " (N = " << N << ")" << std::endl;
+
+		for(unsigned int i=1;i<N;i++)
+			if(D(i,i) > D(i-1,i-1)){
+				std::cout << "ERROR: symmetric_eig() eigenvalues are not sorted (N = "
+					  << N << ")" << std::endl;
+				break;
+			}
+
+		std::cout << "symmetric_eig() N = " << N << ": " << eig_time << " ms" << std::endl;
+	}
+
+	// svd(): A = U*S*V^t for tall, wide and square matrices
+	const unsigned int sizes[3][2] = { {7, 4}, {4, 7}, {30, 30} };
+
+	for(unsigned int k=0;k<3;k++){
+		const unsigned int M = sizes[k][0], N = sizes[k][1];
+		matrix< blas_real<double> > A(M,N), S, U, V, Ut, Vt;
+
+		for(unsigned int i=0;i<M*N;i++)
+			A[i] = rng.normal();
+
+		S = A;
+
+		if(svd(S, U, V) == false){
+			std::cout << "ERROR: svd() failed (" << M << "x" << N << ")" << std::endl;
+			continue;
+		}
+
+		if(S.ysize() != M || S.xsize() != N ||
+		   U.ysize() != M || U.xsize() != M ||
+		   V.ysize() != N || V.xsize() != N){
+			std::cout << "ERROR: svd() returned bad matrix sizes ("
+				  << M << "x" << N << ")" << std::endl;
+			continue;
+		}
+
+		Ut = U;
+		Ut.transpose();
+		Vt = V;
+		Vt.transpose();
+
+		auto R = U*S*Vt - A;
+		auto IU = Ut*U;
+		auto IV = Vt*V;
+
+		for(unsigned int i=0;i<M;i++) IU(i,i) -= 1.0;
+		for(unsigned int i=0;i<N;i++) IV(i,i) -= 1.0;
+
+		if(frobenius_norm(R) > 1e-8*frobenius_norm(A))
+			std::cout << "ERROR: svd() reconstruction error: " << frobenius_norm(R)
+				  << " (" << M << "x" << N << ")" << std::endl;
+
+		if(frobenius_norm(IU) > 1e-8*M || frobenius_norm(IV) > 1e-8*N)
+			std::cout << "ERROR: svd() singular vectors are not orthonormal ("
+				  << M << "x" << N << ")" << std::endl;
+
+		for(unsigned int i=0;i<M && i<N;i++){
+			if(S(i,i) < 0.0 || (i > 0 && S(i,i) > S(i-1,i-1))){
+				std::cout << "ERROR: svd() singular values are not sorted ("
+					  << M << "x" << N << ")" << std::endl;
+				break;
+			}
+		}
+	}
+
+	std::cout << "EIGENVALUE DECOMPOSITION AND SVD TEST DONE" << std::endl;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+void covariance_accumulator_test()
+{
+	RNG< blas_real<double> > rng;
+
+	const unsigned int D = 17;
+	const unsigned int N = 3001;
+
+	std::vector< vertex< blas_real<double> > > data;
+	vertex< blas_real<double> > x(D);
+
+	for(unsigned int n=0;n<N;n++){
+		rng.normal(x);
+		for(unsigned int i=0;i<D;i++)
+			x[i] = x[i]*(i + 1.0) + 100.0; // large mean
+		if(n > 0) x[1] += data[n-1][0];  // correlations
+		data.push_back(x);
+	}
+
+	// reference: two-pass estimate
+	vertex< blas_real<double> > m0(D), m;
+	matrix< blas_real<double> > R0(D,D), R;
+	m0.zero();
+	R0.zero();
+
+	for(const auto& v : data) m0 += v;
+	m0 /= blas_real<double>(N);
+
+	for(const auto& v : data){
+		auto d = v - m0;
+		for(unsigned int j=0;j<D;j++)
+			for(unsigned int i=0;i<D;i++)
+				R0(j,i) += d[j]*d[i];
+	}
+
+	R0 /= blas_real<double>(N);
+
+	// vector, block and merged updates must give the same estimates
+	covariance_accumulator< blas_real<double> > a1(D), a2(D), a3(D);
+
+	for(unsigned int n=0;n<1000;n++)
+		a1.add(data[n]);
+
+	a2.add(data, 1000, 1500);
+	a2.add(data, 1500, 2999);
+	a3.add(data, 2999, N);
+
+	if(a1.merge(a2) == false || a1.merge(a3) == false)
+		std::cout << "ERROR: covariance_accumulator::merge() failed" << std::endl;
+
+	if(a1.size() != N)
+		std::cout << "ERROR: covariance_accumulator has wrong number of samples" << std::endl;
+
+	if(a1.getMean(m) == false || a1.getCovariance(R) == false)
+		std::cout << "ERROR: covariance_accumulator has no estimates" << std::endl;
+
+	if((m - m0).norm() > 1e-9 || norm_inf(matrix< blas_real<double> >(R - R0)) > 1e-8)
+		std::cout << "ERROR: covariance_accumulator estimates differ from two-pass estimates" << std::endl;
+
+	if(mean_covariance_estimate(m, R, data) == false)
+		std::cout << "ERROR: mean_covariance_estimate() failed" << std::endl;
+
+	if((m - m0).norm() > 1e-9 || norm_inf(matrix< blas_real<double> >(R - R0)) > 1e-8)
+		std::cout << "ERROR: mean_covariance_estimate() differs from two-pass estimates" << std::endl;
+
+	std::cout << "COVARIANCE ACCUMULATOR TEST DONE" << std::endl;
 }
 
+//////////////////////////////////////////////////////////////////////
+
+void expression_test()
+{
+	RNG< blas_real<float> > rng;
+	typedef blas_real<float> T;
+
+	vertex<T> a(101), b(101), c(101), x, y(101), r;
+	rng.normal(a);
+	rng.normal(b);
+	rng.normal(c);
+	rng.normal(y);
+
+	// lazy expressions must give the same results as normal operators
+	x = lazy(a) - b + T(2.0f)*c;
+	r = a - b + T(2.0f)*c;
+
+	if((x - r).norm() > 1e-5)
+		std::cout << "ERROR: vertex expression assignment is wrong" << std::endl;
+
+	r = y - T(1.5f)*a;
+	y -= 0.5f*lazy(a)*T(3.0f); // axpy
+
+	if((y - r).norm() > 1e-5)
+		std::cout << "ERROR: vertex expression -= is wrong" << std::endl;
+
+	vertex<T> z = -lazy(a + b)/T(2.0f); // rvalue operand
+	r = (a + b)*T(-0.5f);
+
+	if((z - r).norm() > 1e-5)
+		std::cout << "ERROR: vertex expression constructor is wrong" << std::endl;
+
+	r = x*T(3.0f);
+	x = lazy(x)*T(2.0f) + x; // aliasing
+
+	if((x - r).norm() > 1e-4)
+		std::cout << "ERROR: vertex expression with aliasing is wrong" << std::endl;
+
+	matrix<T> A(5,7), B(5,7), C;
+
+	for(unsigned int i=0;i<A.ysize()*A.xsize();i++){
+		A[i] = rng.normal();
+		B[i] = rng.normal();
+	}
+
+	C = lazy(A) - T(2.0f)*lazy(B);
+
+	if(C.ysize() != 5 || C.xsize() != 7 ||
+	   norm_inf(matrix<T>(C - (A - T(2.0f)*B))) > 1e-5)
+		std::cout << "ERROR: matrix expression assignment is wrong" << std::endl;
+
+	C += lazy(B);
+	C -= lazy(A);
+
+	if(norm_inf(matrix<T>(C + B)) > 1e-5)
+		std::cout << "ERROR: matrix expression += and -= are wrong" << std::endl;
+
+	std::cout << "EXPRESSION TEST DONE" << std::endl;
+}
 
 //////////////////////////////////////////////////////////////////////
 
@@ -285,6 +588,15 @@ int main()
     std::cout << "RNG TEST" << std::endl;
     rng_test();
 
+    std::cout << "EIGENVALUE DECOMPOSITION AND SVD TEST" << std::endl;
+    eig_test();
+
+    std::cout << "COVARIANCE ACCUMULATOR TEST" << std::endl;
+    covariance_accumulator_test();
+
+    std::cout << "EXPRESSION TEST" << std::endl;
+    expression_test();
+
     return 0; // temp disable rest of the tests
 
     std::cout << "MATRIX TEST" << std::endl;
@@ -1580,7 +1892,36 @@ void vertex_test()
     std::cout << v << " * " << w << " = " << a << std::endl;
     a = w * v;
     std::cout << w << " * " << v << " = " << a << std::endl;
-    
+
+    // in-place fused operations and move semantics
+    {
+      vertex<double> x(4), y(4), z;
+
+      x = v; y = w;
+      x.add_scaled(w, 2.0);
+
+      for(unsigned int i=0;i<x.size();i++)
+	if(whiteice::math::abs(x[i] - (v[i] + 2.0*w[i])) > 1e-12)
+	  std::cout << "ERROR: vertex::add_scaled() incorrect result." << std::endl;
+
+      v.sub_into(w, z);
+
+      for(unsigned int i=0;i<z.size();i++)
+	if(whiteice::math::abs(z[i] - (v[i] - w[i])) > 1e-12)
+	  std::cout << "ERROR: vertex::sub_into() incorrect result." << std::endl;
+
+      vertex<double> m(std::move(z));
+
+      if(m.size() != 4 || z.size() != 0)
+	std::cout << "ERROR: vertex move constructor incorrect." << std::endl;
+
+      z = std::move(m);
+
+      if(z.size() != 4 || m.size() != 0 ||
+	 whiteice::math::abs(z[0] - (v[0] - w[0])) > 1e-12)
+	std::cout << "ERROR: vertex move assignment incorrect." << std::endl;
+    }
+
   }
   catch(whiteice::exception& e){
     std::cout << "exception: " << e.what() << std::endl;
@@ -448,6 +448,42 @@ void test_pca_tests()
       }
     }
     
+    
+    // randomized PCA: the first vector must be the largest eigenvector
+    {
+      math::matrix<> RPCA;
+      
+      start = std::chrono::system_clock::now();
+      
+      if(fastpca(data, 10, RPCA, FASTPCA_RANDOMIZED) == false)
+	std::cout << "ERROR: randomized fastpca failed" << std::endl;
+      
+      end   = std::chrono::system_clock::now();
+      secs = end - start;
+      
+      std::cout << "randomized fastpca (10 vectors): milliseconds: "
+		<< 1000.0*secs.count() << std::endl;
+      
+      unsigned int best_index_evd = 0;
+      
+      for(unsigned int j=0;j<eigD.ysize();j++)
+	if(eigD(j,j) > eigD(best_index_evd,best_index_evd))
+	  best_index_evd = j;
+      
+      math::vertex<> evd_e1, pca_e1;
+      
+      Xt.rowcopyto(evd_e1, best_index_evd);
+      RPCA.rowcopyto(pca_e1, 0);
+      
+      auto err1 = evd_e1 - pca_e1;
+      auto err2 = evd_e1 + pca_e1; // signs of the vectors might change
+      
+      if(err1.norm() > 0.1f && err2.norm() > 0.1f){
+	std::cout << "ERROR: results mismatch between randomized PCA and EVD"
+		  << std::endl;
+      }
+    }
+    
   }
   catch(std::exception& e){
     std::cout << "Error fastpca tests" << std::endl;
@@ -1878,6 +1914,48 @@ void test_ica()
     else{
       std::cout << "ICA solved." << std::endl;
     }
+    
+    // symmetric ICA of whitened data: W*V*AX must be scaled permutation
+    {
+      matrix< blas_real<float> > C, E, V, Vt, Z, WS;
+      
+      autocorrelation(C, XDATA);
+      symmetric_eig(C, E);
+      
+      V = E;
+      V.transpose();
+      
+      for(unsigned int j=0;j<3;j++)
+	for(unsigned int i=0;i<3;i++)
+	  V(j,i) /= whiteice::math::sqrt(C(j,j));
+      
+      Vt = V;
+      Vt.transpose();
+      Z = XDATA * Vt;
+      
+      if(ica(Z, WS, true, ICA_SYMMETRIC) == false){
+	std::cout << "ERROR: symmetric ICA failed" << std::endl;
+      }
+      else{
+	auto P = WS * V * AX;
+	
+	for(unsigned int j=0;j<3;j++){
+	  blas_real<float> maxp = 0.0f, sump = 0.0f;
+	  
+	  for(unsigned int i=0;i<3;i++){
+	    sump += whiteice::math::abs(P(j,i));
+	    if(whiteice::math::abs(P(j,i)) > maxp)
+	      maxp = whiteice::math::abs(P(j,i));
+	  }
+	  
+	  if(maxp < 0.9f*sump){
+	    std::cout << "ERROR: symmetric ICA didn't separate sources" << std::endl;
+	    std::cout << "W*V*A = " << P << std::endl;
+	    break;
+	  }
+	}
+      }
+    }
 
     
     //////////////////////////////////////////////////
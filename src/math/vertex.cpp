@@ -27,14 +27,109 @@ namespace whiteice
   namespace math
   {
     
+    /*
+     * per-thread cache of freed vertex memory blocks. Inner loops of samplers
+     * and optimizers create and destroy temporaries of the same size all the time
+     * so freed blocks are kept for reuse instead of returning them to malloc().
+     * Define DINRHIW_NO_VERTEX_CACHE to disable caching.
+     */
+    struct vertex_block_cache
+    {
+      static const unsigned int MAXBLOCKS = 8;
+      static const size_t MAXBYTES = 64*1024*1024; // max memory kept per thread
+      
+      void* block[MAXBLOCKS];
+      size_t bytes[MAXBLOCKS];
+      unsigned int N;
+      size_t total;
+    };
+    
+    static thread_local vertex_block_cache* vcache = nullptr;
+    static thread_local bool vcache_dead = false;
+    
+    // frees cached blocks when the thread exits
+    struct vertex_block_cache_guard
+    {
+      ~vertex_block_cache_guard(){
+	if(vcache){
+	  for(unsigned int i=0;i<vcache->N;i++)
+	    free(vcache->block[i]);
+	  
+	  delete vcache;
+	  vcache = nullptr;
+	}
+	
+	vcache_dead = true;
+      }
+    };
+    
+    static thread_local vertex_block_cache_guard vcache_guard;
+    
+    
+    static inline void* vertex_malloc(size_t bytes)
+    {
+#ifndef DINRHIW_NO_VERTEX_CACHE
+      if(vcache){
+	for(unsigned int i=0;i<vcache->N;i++){
+	  if(vcache->bytes[i] == bytes){
+	    void* ptr = vcache->block[i];
+	    vcache->N--;
+	    vcache->block[i] = vcache->block[vcache->N];
+	    vcache->bytes[i] = vcache->bytes[vcache->N];
+	    vcache->total -= bytes;
+	    return ptr;
+	  }
+	}
+      }
+#endif
+      
+      return malloc(bytes);
+    }
+    
+    
+    static inline void vertex_free(void* ptr, size_t bytes)
+    {
+      if(ptr == nullptr) return;
+      
+#ifndef DINRHIW_NO_VERTEX_CACHE
+      if(vcache == nullptr && vcache_dead == false){
+	(void)&vcache_guard; // registers cleanup of the cache at thread exit
+	vcache = new (std::nothrow) vertex_block_cache;
+	if(vcache){ vcache->N = 0; vcache->total = 0; }
+      }
+      
+      if(vcache && bytes > 0 && vcache->total + bytes <= vertex_block_cache::MAXBYTES){
+	if(vcache->N >= vertex_block_cache::MAXBLOCKS){
+	  // evicts an arbitrary cached block (order is not kept
+	  // because blocks are removed by swapping with the last one)
+	  free(vcache->block[0]);
+	  vcache->total -= vcache->bytes[0];
+	  vcache->N--;
+	  vcache->block[0] = vcache->block[vcache->N];
+	  vcache->bytes[0] = vcache->bytes[vcache->N];
+	}
+	
+	vcache->block[vcache->N] = ptr;
+	vcache->bytes[vcache->N] = bytes;
+	vcache->N++;
+	vcache->total += bytes;
+	return;
+      }
+#endif
+      
+      free(ptr);
+    }
+    
+    
     template <typename T>
     vertex<T>::vertex()
     {
       this->compressor = nullptr;
+      this->viewdata = false;
       this->dataSize = 0;      
       this->data = nullptr;
       
-      this->data = (T*)malloc(sizeof(T));
+      this->data = (T*)vertex_malloc(sizeof(T));
       if(this->data == nullptr) throw std::bad_alloc();
       
       memset(this->data, 0, sizeof(T));
@@ -47,6 +142,7 @@ namespace whiteice
     vertex<T>::vertex(unsigned int i)
     {
       this->compressor = nullptr;
+      this->viewdata = false;
       this->dataSize = 0;
       this->data = nullptr;
       
@@ -57,7 +153,7 @@ namespace whiteice
 		       (8/whiteice::gcd<unsigned int>(8,sizeof(void*)))*sizeof(void*),
 		       i*sizeof(T));
 #else
-	this->data = (T*)malloc(i*sizeof(T));
+	this->data = (T*)vertex_malloc(i*sizeof(T));
 #endif
 	
 	if(this->data == 0)
@@ -77,6 +173,7 @@ namespace whiteice
     vertex<T>::vertex(const vertex<T>& v)
     {
       this->compressor = 0;
+      this->viewdata = false;
       this->dataSize = 0;
       this->data = 0;
       
@@ -90,7 +187,7 @@ namespace whiteice
 		       (8/whiteice::gcd<unsigned int>(8,sizeof(void*)))*sizeof(void*),
 		       v.dataSize*sizeof(T));
 #else
-	this->data = (T*)malloc(v.dataSize*sizeof(T));
+	this->data = (T*)vertex_malloc(v.dataSize*sizeof(T));
 #endif
 	
 	if(this->data == 0)
@@ -127,18 +224,19 @@ namespace whiteice
     
     
     // makes direct copy of temporal value
-#if 0    
     template <typename T>
-    vertex<T>::vertex(vertex<T>&& t)
+    vertex<T>::vertex(vertex<T>&& t) throw()
     {
       this->data = t.data;
       this->dataSize = t.dataSize;
+      this->viewdata = t.viewdata;
       this->compressor = t.compressor;
       
       t.data = nullptr;
+      t.dataSize = 0;
+      t.viewdata = false;
       t.compressor = nullptr;
     }
-#endif
     
     
     // vertex ctor - makes copy of v
@@ -146,6 +244,7 @@ namespace whiteice
     vertex<T>::vertex(const std::vector<T>& v)
     {
       this->compressor = 0;
+      this->viewdata = false;
       this->dataSize = 0;
       this->data = 0;
       
@@ -155,7 +254,7 @@ namespace whiteice
 		       (8/whiteice::gcd<unsigned int>(8,sizeof(void*)))*sizeof(void*),
 		       v.size()*sizeof(T));
 #else
-	this->data = (T*)malloc(v.size()*sizeof(T));
+	this->data = (T*)vertex_malloc(v.size()*sizeof(T));
 #endif
 	
 	if(this->data == 0)
@@ -176,7 +275,7 @@ namespace whiteice
     vertex<T>::~vertex()
     {
       if(this->compressor) delete (this->compressor);
-      if(this->data) free(this->data);      
+      if(this->data && !viewdata) vertex_free(this->data, this->dataSize*sizeof(T));
     }
     
     /***************************************************/
@@ -191,9 +290,29 @@ namespace whiteice
     unsigned int vertex<T>::resize(unsigned int d) throw()
     {
       if(d == 0){
-	free(data);
+	if(!viewdata) vertex_free(data, dataSize*sizeof(T));
 	data = 0;
 	dataSize = 0;
+	viewdata = false;
+      }
+      else if(viewdata){
+	// copies viewed data to vertex's own memory (also when size is same)
+	T* new_area = (T*)vertex_malloc(sizeof(T)*d);
+	
+	if(new_area == 0)
+	  return dataSize; // mem. alloc failure
+	
+	memcpy(new_area, data, sizeof(T)*((dataSize < d) ? dataSize : d));
+	
+	for(unsigned int s = dataSize;s<d;s++)
+	  new_area[s] = T(0.0);
+	
+	data = new_area;
+	dataSize = d;
+	viewdata = false;
+      }
+      else if(d == dataSize && data != 0){
+	return dataSize; // nothing to do
       }
       else{
 	T* new_area = 0;
@@ -202,7 +321,7 @@ namespace whiteice
 	  new_area = (T*)realloc(data, sizeof(T)*d);
 	}
 	else{
-	  new_area = (T*)malloc(sizeof(T)*d);
+	  new_area = (T*)vertex_malloc(sizeof(T)*d);
 	}
 	  
 	if(new_area == 0)
@@ -683,27 +802,28 @@ namespace whiteice
       return *this;
     }
 
-#if 0    
+    
+    // moves data from temporary vertex (no memory allocation and copying)
     template <typename T>
     vertex<T>& vertex<T>::operator=(vertex<T>&& t) throw(illegal_operation)
     {
       if(this == &t) return *this; // self-assignment
       
-      // printf("vertex&& operator=\n"); fflush(stdout);
-      
-      if(this->data) free(data);
+      if(this->data && !viewdata) vertex_free(this->data, this->dataSize*sizeof(T));
       if(this->compressor) delete compressor;
       
-      this->data = std::move(t.data);
-      this->dataSize = std::move(t.dataSize);
-      this->compressor = std::move(t.compressor);
+      this->data = t.data;
+      this->dataSize = t.dataSize;
+      this->viewdata = t.viewdata;
+      this->compressor = t.compressor;
       
       t.data = nullptr;
+      t.dataSize = 0;
+      t.viewdata = false;
       t.compressor = nullptr;
       
       return *this;
     }
-#endif
     
     /***************************************************/
 
@@ -1187,6 +1307,58 @@ namespace whiteice
     }
     
     
+    // calculates this += a*x without temporaries
+    template <typename T>
+    vertex<T>& vertex<T>::add_scaled(const vertex<T>& x, const T& a) throw(illegal_operation)
+    {
+      if(this->dataSize != x.dataSize){
+	assert(0);
+	throw illegal_operation("vector op: vector dim. mismatch");
+      }
+      
+      if(typeid(T) == typeid(blas_real<float>)){
+	
+	cblas_saxpy(dataSize, *((float*)&a), (float*)x.data, 1, (float*)data, 1);
+      }
+      else if(typeid(T) == typeid(blas_complex<float>)){
+	
+	cblas_caxpy(dataSize, (const float*)&a, (float*)x.data, 1, (float*)data, 1);
+      }
+      else if(typeid(T) == typeid(blas_real<double>)){
+	
+	cblas_daxpy(dataSize, *((double*)&a), (double*)x.data, 1, (double*)data, 1);
+      }
+      else if(typeid(T) == typeid(blas_complex<double>)){
+	
+	cblas_zaxpy(dataSize, (const double*)&a, (double*)x.data, 1, (double*)data, 1);
+      }
+      else{ // "normal implementation"
+	for(unsigned int i=0;i<dataSize;i++)
+	  data[i] += a*x.data[i];
+      }
+      
+      return (*this);
+    }
+    
+    
+    // calculates out = this - b, out's memory is reused
+    template <typename T>
+    void vertex<T>::sub_into(const vertex<T>& b, vertex<T>& out) const throw(illegal_operation)
+    {
+      if(this->dataSize != b.dataSize){
+	assert(0);
+	throw illegal_operation("vector op: vector dim. mismatch");
+      }
+      
+      if(out.dataSize != dataSize)
+	if(out.resize(dataSize) != dataSize)
+	  throw illegal_operation("vertex sub_into(): out of memory");
+      
+      for(unsigned int i=0;i<dataSize;i++)
+	out.data[i] = data[i] - b.data[i];
+    }
+    
+    
     template <typename T>
     bool vertex<T>::subvertex(vertex<T>& v,
 			      unsigned int x0,
@@ -1285,6 +1457,7 @@ namespace whiteice
     bool vertex<T>::compress() throw()
     {
       if(compressor != 0) return false; // already compressed
+      if(viewdata) return false; // external memory cannot be compressed
       
       compressor = new MemoryCompressor();
       
@@ -1383,6 +1556,23 @@ namespace whiteice
       return true;
     }
 
+    
+    // vertex becomes view to external memory (not owned by vertex)
+    template <typename T>
+    bool vertex<T>::view(T* data_, unsigned int len) throw()
+    {
+      if(compressor != 0) return false;
+      if(data_ == 0 && len > 0) return false;
+      
+      if(this->data && !viewdata) vertex_free(this->data, this->dataSize*sizeof(T));
+      
+      this->data = data_;
+      this->dataSize = len;
+      this->viewdata = (data_ != 0);
+      
+      return true;
+    }
+
 
     template <typename T>
     void vertex<T>::toString(std::string& line) const throw()
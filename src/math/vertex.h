@@ -37,6 +37,9 @@ namespace whiteice
     template <typename T> class matrix;
     template <typename T> class quaternion;
     
+    struct vertex_kind;
+    template <typename K, typename T, typename E> class expression;
+    
     
     
     template <typename T> bool gramschmidt
@@ -78,8 +81,13 @@ namespace whiteice
       vertex();
       explicit vertex(unsigned int i);
       vertex(const vertex<T>& v);
-      //vertex(vertex<T>&& t);
+      vertex(vertex<T>&& t) throw(); // moves data of temporary vertex
       vertex(const std::vector<T>& v);
+      
+      // evaluates element-wise expression (see expression.h)
+      template <typename E>
+      vertex(const expression<vertex_kind, T, E>& e);
+      
       virtual ~vertex();
       
 #if 0
@@ -119,7 +127,15 @@ namespace whiteice
       vertex<T>& operator/=(const vertex<T>& v) throw(illegal_operation);
       
       vertex<T>& operator=(const vertex<T>& v) throw(illegal_operation);      
-      //vertex<T>& operator=(vertex<T>&& t) throw(illegal_operation);      
+      vertex<T>& operator=(vertex<T>&& t) throw(illegal_operation);      
+      
+      // element-wise expressions are evaluated in a single loop
+      template <typename E>
+      vertex<T>& operator=(const expression<vertex_kind, T, E>& e) throw(illegal_operation);
+      template <typename E>
+      vertex<T>& operator+=(const expression<vertex_kind, T, E>& e) throw(illegal_operation);
+      template <typename E>
+      vertex<T>& operator-=(const expression<vertex_kind, T, E>& e) throw(illegal_operation);
       
       bool operator==(const vertex<T>& v) const throw(uncomparable);
       bool operator!=(const vertex<T>& v) const throw(uncomparable);
@@ -154,6 +170,14 @@ namespace whiteice
       // element-wise multiplication of vector elements
       vertex<T>& dotmulti(const vertex<T>& v) throw(illegal_operation);
       
+      // in-place fused operations which don't allocate temporaries
+      
+      // calculates this += a*x (axpy)
+      vertex<T>& add_scaled(const vertex<T>& x, const T& a) throw(illegal_operation);
+      
+      // calculates out = this - b, reuses out's memory if it has correct size
+      void sub_into(const vertex<T>& b, vertex<T>& out) const throw(illegal_operation);
+      
       
       inline T& operator[](const unsigned int& index) throw(std::out_of_range, illegal_operation)
       {
@@ -208,6 +232,12 @@ namespace whiteice
       // copies data[0:(len-1)] = vertex[start:(start+len-1)]
       bool exportData(T* data, unsigned int len=0, unsigned int start=0) const throw();
       
+      // makes vertex a view to external memory area of size len (no copying).
+      // memory must stay valid while vertex uses it. resizing copies data
+      // to vertex's own memory [used by memory mapped datasets]
+      bool view(T* data, unsigned int len) throw();
+      bool isview() const throw(){ return viewdata; }
+      
       //////////////////////////////////////////////////
       
       // friend list
@@ -249,6 +279,7 @@ namespace whiteice
       
       T* data;      
       unsigned int dataSize;
+      bool viewdata; // data is external memory not owned by vertex
       
       MemoryCompressor* compressor;
       
@@ -359,4 +390,6 @@ namespace whiteice{
 
 
 
+#include "expression.h"
+
 #endif
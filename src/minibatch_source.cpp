@@ -0,0 +1,459 @@
+#include "minibatch_source.h"
+#include "float16.h"
+
+#include <typeinfo>
+#include <algorithm>
+#include <functional>
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+
+namespace whiteice
+{
+  template <typename T>
+  dataset_minibatch_source<T>::dataset_minibatch_source(const dataset<T>& d) : data(d)
+  {
+  }
+
+  template <typename T>
+  dataset_minibatch_source<T>::~dataset_minibatch_source()
+  {
+  }
+
+  template <typename T>
+  unsigned long long dataset_minibatch_source<T>::size() const throw()
+  {
+    if(data.getNumberOfClusters() < 2) return 0;
+    return data.size(0);
+  }
+
+  template <typename T>
+  unsigned int dataset_minibatch_source<T>::input_size() const throw()
+  {
+    if(data.getNumberOfClusters() < 2) return 0;
+    return data.dimension(0);
+  }
+
+  template <typename T>
+  unsigned int dataset_minibatch_source<T>::output_size() const throw()
+  {
+    if(data.getNumberOfClusters() < 2) return 0;
+    return data.dimension(1);
+  }
+
+  template <typename T>
+  bool dataset_minibatch_source<T>::read(const unsigned long long index,
+					 const unsigned int N, minibatch<T>& batch) const
+  {
+    if(good() == false) return false;
+    if(N == 0 || index + N > data.size(0)) return false;
+
+    const unsigned int IN = data.dimension(0);
+    const unsigned int OUT = data.dimension(1);
+
+    batch.input.resize(N, IN);
+    batch.output.resize(N, OUT);
+
+    for(unsigned int n=0;n<N;n++){
+      const auto& x = data.access(0, index + n);
+      const auto& y = data.access(1, index + n);
+
+      for(unsigned int i=0;i<IN;i++) batch.input(n, i) = x[i];
+      for(unsigned int i=0;i<OUT;i++) batch.output(n, i) = y[i];
+    }
+
+    return true;
+  }
+
+  template <typename T>
+  bool dataset_minibatch_source<T>::good() const throw()
+  {
+    return (data.getNumberOfClusters() >= 2 && data.size(0) == data.size(1));
+  }
+
+
+  //////////////////////////////////////////////////////////////////////
+
+
+  template <typename T>
+  file_minibatch_source<T>::file_minibatch_source()
+  {
+    fd = -1;
+  }
+
+  template <typename T>
+  file_minibatch_source<T>::file_minibatch_source(const std::string& filename)
+  {
+    fd = -1;
+    open(filename);
+  }
+
+  template <typename T>
+  file_minibatch_source<T>::~file_minibatch_source()
+  {
+    close();
+  }
+
+
+  template <typename T>
+  bool file_minibatch_source<T>::open(const std::string& filename) throw()
+  {
+    close();
+
+    if(header.loadHeader(filename, blocks) == false){
+      blocks.clear();
+      return false;
+    }
+
+    if(blocks.size() < 2 || blocks[0].N != blocks[1].N){
+      blocks.clear();
+      return false;
+    }
+
+    fd = ::open(filename.c_str(), O_RDONLY);
+
+    if(fd < 0){
+      blocks.clear();
+      return false;
+    }
+
+    return true;
+  }
+
+
+  template <typename T>
+  void file_minibatch_source<T>::close() throw()
+  {
+    if(fd >= 0) ::close(fd);
+    fd = -1;
+    blocks.clear();
+  }
+
+
+  template <typename T>
+  unsigned long long file_minibatch_source<T>::size() const throw()
+  {
+    if(good() == false) return 0;
+    return blocks[0].N;
+  }
+
+  template <typename T>
+  unsigned int file_minibatch_source<T>::input_size() const throw()
+  {
+    if(good() == false) return 0;
+    return header.dimension(0);
+  }
+
+  template <typename T>
+  unsigned int file_minibatch_source<T>::output_size() const throw()
+  {
+    if(good() == false) return 0;
+    return header.dimension(1);
+  }
+
+
+  template <typename T>
+  bool file_minibatch_source<T>::read(const unsigned long long index,
+				      const unsigned int N, minibatch<T>& batch) const
+  {
+    if(good() == false) return false;
+    if(N == 0 || index + N > blocks[0].N) return false;
+
+    if(read_rows(blocks[0], header.dimension(0), index, N, batch.input) == false)
+      return false;
+
+    if(read_rows(blocks[1], header.dimension(1), index, N, batch.output) == false)
+      return false;
+
+    return true;
+  }
+
+
+  template <typename T>
+  bool file_minibatch_source<T>::good() const throw()
+  {
+    return (fd >= 0 && blocks.size() >= 2);
+  }
+
+
+  // reads all len bytes starting from file offset
+  static bool minibatch_pread(int fd, char* buf, unsigned long long len,
+			      unsigned long long offset)
+  {
+    while(len > 0){
+      const ssize_t r = pread(fd, buf, len, (off_t)offset);
+
+      if(r < 0){
+	if(errno == EINTR) continue;
+	return false;
+      }
+      else if(r == 0){
+	return false; // unexpected end of file
+      }
+
+      buf += r;
+      offset += r;
+      len -= r;
+    }
+
+    return true;
+  }
+
+
+  template <typename T>
+  bool file_minibatch_source<T>::read_rows(const typename dataset<T>::file_block& block,
+					   const unsigned int dim,
+					   const unsigned long long index,
+					   const unsigned int N, math::matrix<T>& M) const
+  {
+    if(dim == 0) return false;
+
+    if(M.resize(N, dim) == false) return false;
+
+    const unsigned long long elems = ((unsigned long long)N)*dim;
+    const unsigned long long offset =
+      block.offset + index*dim*block.elemsize;
+
+    // reads data directly into matrix if T has the same number format
+    if((block.elemsize == 4 &&
+	(typeid(T) == typeid(float) ||
+	 typeid(T) == typeid(math::blas_real<float>))) ||
+       (block.elemsize == 8 &&
+	(typeid(T) == typeid(double) ||
+	 typeid(T) == typeid(math::blas_real<double>))))
+    {
+      return minibatch_pread(fd, (char*)&(M(0,0)), elems*block.elemsize, offset);
+    }
+
+    T* dst = &(M(0,0));
+
+    if(block.elemsize == 4){
+      std::vector<float> buf(elems);
+
+      if(minibatch_pread(fd, (char*)buf.data(), elems*4, offset) == false)
+	return false;
+
+      for(unsigned long long i=0;i<elems;i++)
+	dst[i] = T(buf[i]);
+    }
+    else if(block.elemsize == 8){
+      std::vector<double> buf(elems);
+
+      if(minibatch_pread(fd, (char*)buf.data(), elems*8, offset) == false)
+	return false;
+
+      for(unsigned long long i=0;i<elems;i++)
+	dst[i] = T(buf[i]);
+    }
+    else if(block.elemsize == 2){ // float16 data (dataset format 3)
+      std::vector<unsigned short> buf(elems);
+
+      if(minibatch_pread(fd, (char*)buf.data(), elems*2, offset) == false)
+	return false;
+
+      math::from_half(buf.data(), dst, elems);
+    }
+    else return false;
+
+    return true;
+  }
+
+
+  //////////////////////////////////////////////////////////////////////
+
+
+  template <typename T>
+  minibatch_prefetcher<T>::minibatch_prefetcher(const minibatch_source<T>& src,
+						const unsigned int bsize,
+						const bool shuf,
+						const unsigned int csize,
+						const unsigned long long b,
+						const unsigned long long e) :
+    source(src), batchsize(bsize ? bsize : 1),
+    chunksize(csize >= batchsize ? csize : batchsize), shuffle(shuf)
+  {
+    begin = b;
+    end = e ? e : source.size();
+    if(end > source.size()) end = source.size();
+    if(begin > end) begin = end;
+
+    position = 0;
+    buffered = 0;
+    running = true;
+    failed = false;
+
+    loader = new std::thread(std::bind(&minibatch_prefetcher<T>::loader_loop, this));
+  }
+
+
+  template <typename T>
+  minibatch_prefetcher<T>::~minibatch_prefetcher()
+  {
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex);
+      running = false;
+      queue_cond.notify_all();
+    }
+
+    loader->join();
+    delete loader;
+  }
+
+
+  template <typename T>
+  bool minibatch_prefetcher<T>::next(minibatch<T>& batch)
+  {
+    if(!current || position >= current->size()){
+      std::unique_lock<std::mutex> lock(queue_mutex);
+
+      while(ready.empty() && !failed)
+	queue_cond.wait(lock);
+
+      if(ready.empty()) return false; // reading data has failed
+
+      current = ready.front();
+      ready.pop_front();
+      if(current) buffered--;
+      position = 0;
+
+      queue_cond.notify_all();
+
+      if(!current) return false; // end of epoch (or failure)
+    }
+
+    const unsigned int N =
+      (position + batchsize <= current->size()) ? batchsize : (current->size() - position);
+
+    const unsigned int IN = current->input.xsize();
+    const unsigned int OUT = current->output.xsize();
+
+    batch.input.resize(N, IN);
+    batch.output.resize(N, OUT);
+
+    const T* in = &(current->input(position,0));
+    const T* out = &(current->output(position,0));
+    
+    std::copy(in, in + N*IN, &(batch.input(0,0)));
+    std::copy(out, out + N*OUT, &(batch.output(0,0)));
+
+    position += N;
+
+    return true;
+  }
+
+
+  template <typename T>
+  bool minibatch_prefetcher<T>::good() const
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    return !failed;
+  }
+
+
+  template <typename T>
+  void minibatch_prefetcher<T>::loader_loop()
+  {
+    const unsigned long long NCHUNKS = (end - begin + chunksize - 1)/chunksize;
+    std::vector<unsigned long long> order(NCHUNKS);
+
+    for(unsigned long long i=0;i<NCHUNKS;i++)
+      order[i] = i;
+
+    while(1){
+      if(shuffle){
+	for(unsigned long long i=NCHUNKS;i>1;i--)
+	  std::swap(order[i-1], order[rng.rand() % i]);
+      }
+
+      for(unsigned long long c=0;c<NCHUNKS;c++){
+	// waits until the previously read chunk has been taken into use
+	{
+	  std::unique_lock<std::mutex> lock(queue_mutex);
+
+	  while(running && buffered >= 1)
+	    queue_cond.wait(lock);
+
+	  if(!running) return;
+	}
+
+	const unsigned long long index = begin + order[c]*chunksize;
+	const unsigned int N =
+	  (index + chunksize <= end) ? chunksize : (unsigned int)(end - index);
+
+	std::shared_ptr< minibatch<T> > chunk(new minibatch<T>);
+
+	if(source.read(index, N, *chunk) == false){
+	  std::lock_guard<std::mutex> lock(queue_mutex);
+	  failed = true;
+	  running = false;
+	  ready.push_back(nullptr);
+	  queue_cond.notify_all();
+	  return;
+	}
+
+	if(shuffle){
+	  const unsigned int IN = chunk->input.xsize();
+	  const unsigned int OUT = chunk->output.xsize();
+
+	  for(unsigned int i=N;i>1;i--){
+	    const unsigned int j = rng.rand() % i;
+
+	    if(j != i-1){
+	      std::swap_ranges(&(chunk->input(i-1,0)), &(chunk->input(i-1,0)) + IN,
+			       &(chunk->input(j,0)));
+	      std::swap_ranges(&(chunk->output(i-1,0)), &(chunk->output(i-1,0)) + OUT,
+			       &(chunk->output(j,0)));
+	    }
+	  }
+	}
+
+	{
+	  std::lock_guard<std::mutex> lock(queue_mutex);
+	  ready.push_back(chunk);
+	  buffered++;
+	  queue_cond.notify_all();
+	}
+      }
+
+      // marks end of epoch
+      {
+	std::unique_lock<std::mutex> lock(queue_mutex);
+
+	while(running && buffered >= 1)
+	  queue_cond.wait(lock);
+
+	if(!running) return;
+
+	ready.push_back(nullptr);
+	queue_cond.notify_all();
+
+	// next epoch is not read before it is needed
+	while(running && ready.empty() == false)
+	  queue_cond.wait(lock);
+
+	if(!running) return;
+      }
+    }
+  }
+
+
+  template class dataset_minibatch_source< float >;
+  template class dataset_minibatch_source< double >;
+  template class dataset_minibatch_source< math::blas_real<float> >;
+  template class dataset_minibatch_source< math::blas_real<double> >;
+
+  template class file_minibatch_source< float >;
+  template class file_minibatch_source< double >;
+  template class file_minibatch_source< math::blas_real<float> >;
+  template class file_minibatch_source< math::blas_real<double> >;
+
+  template class minibatch_prefetcher< float >;
+  template class minibatch_prefetcher< double >;
+  template class minibatch_prefetcher< math::blas_real<float> >;
+  template class minibatch_prefetcher< math::blas_real<double> >;
+};
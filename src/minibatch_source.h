@@ -0,0 +1,228 @@
+/*
+ * out-of-core minibatch data sources
+ *
+ * minibatch_source gives (input, output) pairs of training data
+ * (clusters 0 and 1 of dataset) as blocks of consecutive samples.
+ * file_minibatch_source reads blocks directly from dataset file
+ * (memory mapped format, version 2 or 3) so data don't need to fit into
+ * memory. minibatch_prefetcher reads shuffled minibatches from a
+ * source in a background thread while optimizer is computing.
+ */
+
+#ifndef minibatch_source_h
+#define minibatch_source_h
+
+#include <vector>
+#include <string>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "data_source.h"
+#include "dataset.h"
+#include "vertex.h"
+#include "matrix.h"
+#include "RNG.h"
+
+
+namespace whiteice
+{
+  template <typename T = math::blas_real<float> >
+    struct minibatch
+    {
+      math::matrix<T> input;  // rows are input samples
+      math::matrix<T> output; // rows are corresponding outputs
+
+      unsigned int size() const throw(){ return input.ysize(); }
+    };
+
+
+  template <typename T = math::blas_real<float> >
+    class minibatch_source : public chunked_data_source< minibatch<T> >
+    {
+    public:
+      virtual ~minibatch_source(){ }
+
+      virtual unsigned int input_size() const throw() = 0;
+      virtual unsigned int output_size() const throw() = 0;
+    };
+
+
+  /*
+   * input rows of minibatch source as chunks of matrix rows so that
+   * out-of-core data can be given to math::fastpca() etc.
+   */
+  template <typename T = math::blas_real<float> >
+    class minibatch_input_source : public chunked_data_source< math::matrix<T> >
+    {
+    public:
+      minibatch_input_source(const minibatch_source<T>& s) : source(s){ }
+      virtual ~minibatch_input_source(){ }
+
+      unsigned long long size() const throw(){ return source.size(); }
+
+      bool read(const unsigned long long index,
+		const unsigned int N, math::matrix<T>& c) const
+      {
+	minibatch<T> batch;
+	if(source.read(index, N, batch) == false) return false;
+
+	c = std::move(batch.input);
+	return true;
+      }
+
+      bool good() const throw(){ return source.good(); }
+
+    private:
+      const minibatch_source<T>& source;
+    };
+
+
+  /*
+   * minibatches from clusters 0 (input) and 1 (output) of dataset in memory
+   */
+  template <typename T = math::blas_real<float> >
+    class dataset_minibatch_source : public minibatch_source<T>
+    {
+    public:
+      dataset_minibatch_source(const dataset<T>& data);
+      virtual ~dataset_minibatch_source();
+
+      unsigned long long size() const throw();
+      unsigned int input_size() const throw();
+      unsigned int output_size() const throw();
+
+      bool read(const unsigned long long index,
+		const unsigned int N, minibatch<T>& batch) const;
+
+      bool good() const throw();
+
+    private:
+      const dataset<T>& data;
+    };
+
+
+  /*
+   * minibatches read on demand from clusters 0 (input) and 1 (output)
+   * of dataset file saved using dataset::save(filename, true). float16
+   * data (dataset::save(filename, true, true)) is converted to T when read
+   */
+  template <typename T = math::blas_real<float> >
+    class file_minibatch_source : public minibatch_source<T>
+    {
+    public:
+      file_minibatch_source();
+      file_minibatch_source(const std::string& filename);
+      virtual ~file_minibatch_source();
+
+      bool open(const std::string& filename) throw();
+      void close() throw();
+
+      // dataset with clusters and preprocessings of
+      // the file but without any data vectors
+      const dataset<T>& getHeader() const throw(){ return header; }
+
+      unsigned long long size() const throw();
+      unsigned int input_size() const throw();
+      unsigned int output_size() const throw();
+
+      bool read(const unsigned long long index,
+		const unsigned int N, minibatch<T>& batch) const;
+
+      bool good() const throw();
+
+    private:
+      file_minibatch_source(const file_minibatch_source<T>&);
+      file_minibatch_source<T>& operator=(const file_minibatch_source<T>&);
+
+      // reads N rows of cluster's data block starting from row index
+      bool read_rows(const typename dataset<T>::file_block& block,
+		     const unsigned int dim,
+		     const unsigned long long index,
+		     const unsigned int N, math::matrix<T>& M) const;
+
+      int fd;
+      dataset<T> header;
+      std::vector<typename dataset<T>::file_block> blocks;
+    };
+
+
+  /*
+   * double buffered reading of shuffled minibatches: background thread
+   * reads the next chunk of samples while minibatches are taken from the
+   * current one. Order of chunks and samples inside a chunk are
+   * shuffled every epoch (if shuffle is true).
+   *
+   * samples [begin, end) of the source are used (end = 0 means all samples)
+   */
+  template <typename T = math::blas_real<float> >
+    class minibatch_prefetcher
+    {
+    public:
+      minibatch_prefetcher(const minibatch_source<T>& source,
+			   const unsigned int batchsize,
+			   const bool shuffle = true,
+			   const unsigned int chunksize = 65536,
+			   const unsigned long long begin = 0,
+			   const unsigned long long end = 0);
+      ~minibatch_prefetcher();
+
+      // gets the next minibatch (blocks until data has been read),
+      // returns false when epoch has ended (the next call
+      // starts a new epoch) or reading data failed
+      bool next(minibatch<T>& batch);
+
+      // false if reading data from source has failed
+      bool good() const;
+
+      // number of samples in an epoch
+      unsigned long long size() const throw(){ return (end - begin); }
+
+    private:
+      minibatch_prefetcher(const minibatch_prefetcher<T>&);
+      minibatch_prefetcher<T>& operator=(const minibatch_prefetcher<T>&);
+
+      void loader_loop();
+
+      const minibatch_source<T>& source;
+      const unsigned int batchsize;
+      const unsigned int chunksize;
+      const bool shuffle;
+      unsigned long long begin, end;
+
+      // chunks that have been read and are waiting to be used,
+      // null chunk marks the end of an epoch
+      std::deque< std::shared_ptr< minibatch<T> > > ready;
+      std::shared_ptr< minibatch<T> > current;
+      unsigned int position; // next unused sample of current chunk
+      unsigned int buffered; // number of chunks in ready queue
+
+      bool running, failed;
+      mutable std::mutex queue_mutex;
+      std::condition_variable queue_cond;
+      std::thread* loader;
+
+      whiteice::RNG<T> rng;
+    };
+
+
+  extern template class dataset_minibatch_source< float >;
+  extern template class dataset_minibatch_source< double >;
+  extern template class dataset_minibatch_source< math::blas_real<float> >;
+  extern template class dataset_minibatch_source< math::blas_real<double> >;
+
+  extern template class file_minibatch_source< float >;
+  extern template class file_minibatch_source< double >;
+  extern template class file_minibatch_source< math::blas_real<float> >;
+  extern template class file_minibatch_source< math::blas_real<double> >;
+
+  extern template class minibatch_prefetcher< float >;
+  extern template class minibatch_prefetcher< double >;
+  extern template class minibatch_prefetcher< math::blas_real<float> >;
+  extern template class minibatch_prefetcher< math::blas_real<double> >;
+};
+
+
+#endif
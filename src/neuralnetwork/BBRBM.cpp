@@ -11,8 +11,14 @@
 #include "Log.h"
 
 #include "LBFGS_BBRBM.h"
+#include "RBM_minibatch.h"
+#include "thread_pool.h"
 
 #include <unistd.h>
+#include <string.h>
+
+#include <random>
+#include <algorithm>
 
 
 namespace whiteice {
@@ -839,6 +845,192 @@ T BBRBM<T>::learnWeights2(const std::vector< math::vertex<T> >& samples,
   return besterror;
 }
 
+
+// minibatch CD-k/PCD learning, states of the minibatch are B x N matrices
+template <typename T>
+T BBRBM<T>::learnWeightsBatch(const std::vector< math::vertex<T> >& samples,
+			      const unsigned int EPOCHS,
+			      const unsigned int CDk,
+			      const bool persistent,
+			      const unsigned int batchsize,
+			      const T lrate,
+			      const int verbose, const bool* running)
+{
+  if(samples.size() <= 0 || batchsize == 0 || CDk == 0) return T(INFINITY);
+  if(samples[0].size() != v.size()) return T(INFINITY); // silent failure
+
+  const unsigned int NV = v.size();
+  const unsigned int NH = h.size();
+  const unsigned int B = (batchsize < samples.size()) ? batchsize : samples.size();
+  const T momentum = T(0.9);
+
+  whiteice::thread_pool& pool = whiteice::thread_pool::global();
+
+  // minibatch rows are divided into chunks processed by separate threads
+  const unsigned int SLOTS = pool.concurrency();
+  const unsigned int CHUNK = (B + SLOTS - 1)/SLOTS;
+
+  // minibatch states (one sample per row)
+  std::vector<T> V0(B*NV), H0(B*NH), Vk(B*NV), Hk(B*NH);
+  std::vector<T> chain; // fantasy particles of persistent CD
+
+  // per-thread gradients and random number generators
+  std::vector< std::vector<T> > gW(SLOTS), ga(SLOTS), gb(SLOTS);
+  std::vector< RNG<T> > gen;
+  const unsigned long long seed = rng.rand64();
+
+  for(unsigned int s=0;s<SLOTS;s++){
+    gW[s].resize(NH*NV);
+    ga[s].resize(NV);
+    gb[s].resize(NH);
+    gen.push_back(RNG<T>(seed, s));
+  }
+
+  // parameter velocities
+  std::vector<T> dW(NH*NV, T(0.0f)), da(NV, T(0.0f)), db(NH, T(0.0f));
+
+  std::vector<unsigned int> order(samples.size());
+  for(unsigned int i=0;i<order.size();i++) order[i] = i;
+
+  std::mt19937 shuffler(rng.rand());
+
+  T latestError = reconstructionError(samples, 1000, a, b, W);
+
+  if(verbose == 1){
+    double error = 0.0;
+    math::convert(error, latestError);
+    printf("BBRBM::learnWeightsBatch(): %d/%d START. R: %f\n", 0, EPOCHS, error);
+  }
+  else if(verbose == 2){
+    char buffer[128];
+    double error = 0.0;
+    math::convert(error, latestError);
+    snprintf(buffer, 128, "BBRBM::learnWeightsBatch(): %d/%d START. R: %f", 0, EPOCHS, error);
+    whiteice::logging.info(buffer);
+  }
+
+
+  for(unsigned int e=0;e<EPOCHS;e++){
+
+    if(running) if(*running == false) break;
+
+    std::shuffle(order.begin(), order.end(), shuffler);
+
+    for(unsigned int s0=0;s0<samples.size();s0+=B){
+
+      if(running) if(*running == false) break;
+
+      const unsigned int N = (samples.size() - s0 < B) ? (samples.size() - s0) : B;
+
+      if(persistent && chain.size() == 0){ // chains start from data
+	chain.resize(B*NV);
+
+	for(unsigned int n=0;n<B;n++)
+	  memcpy(&(chain[n*NV]), &(samples[order[n]][0]), NV*sizeof(T));
+      }
+
+      const T* Wp = &(W(0,0));
+
+      pool.parallel_for(0, N, CHUNK, [&](unsigned int slot, unsigned long long r0)
+      {
+	const unsigned int rows = (N - r0 < CHUNK) ? (N - r0) : CHUNK;
+
+	T* v0 = &(V0[r0*NV]);
+	T* h0 = &(H0[r0*NH]);
+	T* vk = &(Vk[r0*NV]);
+	T* hk = &(Hk[r0*NH]);
+
+	for(unsigned int n=0;n<rows;n++)
+	  memcpy(v0 + n*NV, &(samples[order[s0 + r0 + n]][0]), NV*sizeof(T));
+
+	// positive phase: h0 = sigmoid(v0*W^t + b)
+	math::gemm(false, true, rows, NH, NV, 1.0f, v0, NV, Wp, NV, 0.0f, h0, NH);
+	rbm_minibatch::sigmoid(h0, &(b[0]), rows, NH);
+
+	math::gemm(true, false, NH, NV, rows, 1.0f, h0, NH, v0, NV, 1.0f, &(gW[slot][0]), NV);
+	rbm_minibatch::colsum(v0, rows, NV, &(ga[slot][0]));
+	rbm_minibatch::colsum(h0, rows, NH, &(gb[slot][0]));
+
+	// negative phase: k Gibbs steps from data or from persistent chains
+	if(persistent){
+	  memcpy(vk, &(chain[r0*NV]), rows*NV*sizeof(T));
+	  math::gemm(false, true, rows, NH, NV, 1.0f, vk, NV, Wp, NV, 0.0f, hk, NH);
+	  rbm_minibatch::sigmoid(hk, &(b[0]), rows, NH);
+	}
+	else{
+	  memcpy(hk, h0, rows*NH*sizeof(T));
+	}
+
+	for(unsigned int k=0;k<CDk;k++){
+	  rbm_minibatch::bernoulli(hk, rows*NH, gen[slot]);
+
+	  math::gemm(false, false, rows, NV, NH, 1.0f, hk, NH, Wp, NV, 0.0f, vk, NV);
+	  rbm_minibatch::sigmoid(vk, &(a[0]), rows, NV);
+	  rbm_minibatch::bernoulli(vk, rows*NV, gen[slot]);
+
+	  math::gemm(false, true, rows, NH, NV, 1.0f, vk, NV, Wp, NV, 0.0f, hk, NH);
+	  rbm_minibatch::sigmoid(hk, &(b[0]), rows, NH);
+	}
+
+	math::gemm(true, false, NH, NV, rows, -1.0f, hk, NH, vk, NV, 1.0f, &(gW[slot][0]), NV);
+	rbm_minibatch::colsum(vk, rows, NV, &(ga[slot][0]), T(-1.0f));
+	rbm_minibatch::colsum(hk, rows, NH, &(gb[slot][0]), T(-1.0f));
+
+	if(persistent)
+	  memcpy(&(chain[r0*NV]), vk, rows*NV*sizeof(T));
+      }, SLOTS);
+
+      // sums per-thread gradients and updates parameters
+      const T rate = lrate/T(N);
+      T* Wq = &(W(0,0));
+
+      for(unsigned int s=0;s<SLOTS;s++){
+	for(unsigned int i=0;i<NH*NV;i++){
+	  if(s == 0) dW[i] *= momentum;
+	  dW[i] += rate*gW[s][i];
+	  gW[s][i] = T(0.0f);
+	}
+
+	for(unsigned int i=0;i<NV;i++){
+	  if(s == 0) da[i] *= momentum;
+	  da[i] += rate*ga[s][i];
+	  ga[s][i] = T(0.0f);
+	}
+
+	for(unsigned int i=0;i<NH;i++){
+	  if(s == 0) db[i] *= momentum;
+	  db[i] += rate*gb[s][i];
+	  gb[s][i] = T(0.0f);
+	}
+      }
+
+      for(unsigned int i=0;i<NH*NV;i++) Wq[i] += dW[i];
+      for(unsigned int i=0;i<NV;i++) a[i] += da[i];
+      for(unsigned int i=0;i<NH;i++) b[i] += db[i];
+    }
+
+    safebox(a, b, W);
+
+    latestError = reconstructionError(samples, 1000, a, b, W);
+
+    if(verbose == 1){
+      double error = 0.0;
+      math::convert(error, latestError);
+      printf("BBRBM::learnWeightsBatch(): %d/%d EPOCH. R: %f\n", e+1, EPOCHS, error);
+    }
+    else if(verbose == 2){
+      char buffer[128];
+      double error = 0.0;
+      math::convert(error, latestError);
+      snprintf(buffer, 128, "BBRBM::learnWeightsBatch(): %d/%d epoch. reconstruction error: %f",
+	       e+1, EPOCHS, error);
+      whiteice::logging.info(buffer);
+    }
+  }
+
+  return latestError;
+}
+
   
 // mean error per element per sample (does not increase if dimensions or number of samples increase)
 template <typename T>
@@ -88,6 +88,19 @@ class BBRBM {
 		  const unsigned int EPOCHS=1,
 		  const int verbose = 0,
 		  const bool* running = NULL);
+
+  // minibatch CD-k (or persistent CD if persistent = true) using momentum
+  // gradient descent. minibatch states are matrices and W*v and h*W are
+  // calculated using GEMM, minibatch is divided between threads.
+  // returns reconstruction error
+  T learnWeightsBatch(const std::vector< math::vertex<T> >& samples,
+		      const unsigned int EPOCHS = 1,
+		      const unsigned int CDk = 1,
+		      const bool persistent = false,
+		      const unsigned int batchsize = 128,
+		      const T lrate = T(0.05),
+		      const int verbose = 0,
+		      const bool* running = NULL);
   
 
   T reconstructionError(const std::vector< math::vertex<T> >& samples,
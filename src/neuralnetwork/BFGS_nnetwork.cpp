@@ -65,7 +65,7 @@ namespace whiteice
     for(unsigned int i=0;i<dtest.size(0);i++){
       nnet.input() = dtest.access(0, i);
       nnet.calculate(false);
-      err = dtest.access(1, i) - nnet.output();
+      err = math::lazy(dtest.access(1, i)) - nnet.output();
       T inv = T(1.0f/err.size());
       err = inv*(err*err);
       e += T(0.5f)*err[0];
@@ -91,7 +91,7 @@ namespace whiteice
     for(unsigned int i=0;i<dtrain.size(0);i++){
       nnet.input() = dtrain.access(0, i);
       nnet.calculate(false);
-      err = dtrain.access(1, i) - nnet.output();
+      err = math::lazy(dtrain.access(1, i)) - nnet.output();
       // T inv = T(1.0f/err.size());
       err = (err*err);
       e += T(0.5f)*err[0];
@@ -123,7 +123,7 @@ namespace whiteice
     for(unsigned int i=0;i<dtrain.size(0);i++){
       nnet.input() = dtrain.access(0, i);
       nnet.calculate(true);
-      err = dtrain.access(1,i) - nnet.output();
+      err = math::lazy(dtrain.access(1,i)) - nnet.output();
       
       if(nnet.gradient(err, grad) == false){
 	std::cout << "gradient failed." << std::endl;
@@ -357,6 +357,10 @@ namespace whiteice
     // increase after the whole learning process works..
     const unsigned int ITERLIMIT = 50;
     const unsigned int EPOCH_STEPS = 2;
+
+    // layers are trained using minibatch CD-1
+    const unsigned int CDk = 1;
+    const unsigned int BATCHSIZE = 128;
     
     std::vector< math::vertex<T> > in = samples;
     std::vector< math::vertex<T> > out;
@@ -374,7 +378,7 @@ namespace whiteice
       }
       
       
-      while((error = gb_input.learnWeights(in, EPOCH_STEPS, verbose, running)) >= errorLevel
+      while((error = gb_input.learnWeightsBatch(in, EPOCH_STEPS, CDk, false, BATCHSIZE, T(0.01), verbose, running)) >= errorLevel
 	    && iters < ITERLIMIT)
       {
 	if(running) if(*running == false) return false; // stop execution
@@ -458,7 +462,7 @@ namespace whiteice
 		  << std::endl;
       }
       
-      while((error = bb_input.learnWeights2(in, EPOCH_STEPS, verbose)) >= errorLevel
+      while((error = bb_input.learnWeightsBatch(in, EPOCH_STEPS, CDk, false, BATCHSIZE, T(0.05), verbose, running)) >= errorLevel
 	    && iters < ITERLIMIT)
       {
 	if(running) if(*running == false) return false; // stop execution
@@ -547,7 +551,7 @@ namespace whiteice
       errors.clear();
 	    
       // mean error per element per sample (does not increase if dimensions or number of samples increase)
-      while((error = layers[i].learnWeights2(in, EPOCH_STEPS, verbose, running)) >= errorLevel &&
+      while((error = layers[i].learnWeightsBatch(in, EPOCH_STEPS, CDk, false, BATCHSIZE, T(0.05), verbose, running)) >= errorLevel &&
 	    iters < ITERLIMIT)
       {
 	if(running) if(*running == false) return false; // stops execution
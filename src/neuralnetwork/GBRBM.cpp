@@ -8,16 +8,20 @@
 #include "GBRBM.h"
 #include "dataset.h"
 #include "LBFGS_GBRBM.h"
+#include "RBM_minibatch.h"
+#include "thread_pool.h"
 #include "linear_ETA.h"
 #include "Log.h"
 
 #include <unistd.h>
+#include <string.h>
 
 #include <chrono>
 #include <random>
 #include <time.h>
 #include <math.h>
 #include <cmath>
+#include <algorithm>
 
 namespace whiteice {
 
@@ -689,6 +693,241 @@ T GBRBM<T>::learnWeights(const std::vector< math::vertex<T> >& samples,
   
   return besterror;
 }
+
+
+// minibatch CD-k/PCD learning, states of the minibatch are B x N matrices
+template <typename T>
+T GBRBM<T>::learnWeightsBatch(const std::vector< math::vertex<T> >& samples,
+			      const unsigned int EPOCHS,
+			      const unsigned int CDk,
+			      const bool persistent,
+			      const unsigned int batchsize,
+			      const T lrate,
+			      const int verbose, const bool* running)
+{
+  if(EPOCHS <= 0 || CDk == 0 || batchsize == 0) return T(INFINITY);
+  if(samples.size() <= 0) return T(INFINITY);
+  if(samples[0].size() != getVisibleNodes()) return T(INFINITY);
+
+  const unsigned int NV = getVisibleNodes();
+  const unsigned int NH = getHiddenNodes();
+  const unsigned int B = (batchsize < samples.size()) ? batchsize : samples.size();
+  const T momentum = T(0.9);
+
+  whiteice::thread_pool& pool = whiteice::thread_pool::global();
+
+  // minibatch rows are divided into chunks processed by separate threads
+  const unsigned int SLOTS = pool.concurrency();
+  const unsigned int CHUNK = (B + SLOTS - 1)/SLOTS;
+
+  // minibatch states (one sample per row), X = exp(-z/2)*v and M = h*W^t
+  std::vector<T> V0(B*NV), X0(B*NV), H0(B*NH), M(B*NV), Vk(B*NV), Xk(B*NV), Hk(B*NH);
+  std::vector<T> chain; // fantasy particles of persistent CD
+
+  // per-thread gradients and random number generators
+  std::vector< std::vector<T> > gW(SLOTS), ga(SLOTS), gb(SLOTS), gz(SLOTS);
+  std::vector< RNG<T> > gen;
+  const unsigned long long seed = rng.rand64();
+
+  for(unsigned int s=0;s<SLOTS;s++){
+    gW[s].resize(NV*NH);
+    ga[s].resize(NV);
+    gb[s].resize(NH);
+    gz[s].resize(NV);
+    gen.push_back(RNG<T>(seed, s));
+  }
+
+  // parameter velocities
+  std::vector<T> dW(NV*NH, T(0.0f)), da(NV, T(0.0f)), db(NH, T(0.0f)), dz(NV, T(0.0f));
+
+  // variance terms exp(-z), exp(-z/2) and exp(z/2)
+  std::vector<T> ivar(NV), istd(NV), sd(NV);
+
+  std::vector<unsigned int> order(samples.size());
+  for(unsigned int i=0;i<order.size();i++) order[i] = i;
+
+  std::mt19937 shuffler(rng.rand());
+
+  T latestError = reconstruct_gbrbm_data_error(samples, 1000, W, a, b, z, 1);
+
+  if(verbose == 1){
+    std::cout << "GBRBM::learnWeightsBatch(): START. error = "
+	      << latestError << std::endl;
+  }
+  else if(verbose == 2){
+    char buffer[128];
+    double tmp = 0.0;
+    whiteice::math::convert(tmp, latestError);
+    snprintf(buffer, 128, "GBRBM::learnWeightsBatch(): start: error = %f", tmp);
+    whiteice::logging.info(buffer);
+  }
+
+
+  for(unsigned int e=0;e<EPOCHS;e++){
+
+    if(running) if(*running == false) break;
+
+    std::shuffle(order.begin(), order.end(), shuffler);
+
+    for(unsigned int s0=0;s0<samples.size();s0+=B){
+
+      if(running) if(*running == false) break;
+
+      const unsigned int N = (samples.size() - s0 < B) ? (samples.size() - s0) : B;
+
+      if(persistent && chain.size() == 0){ // chains start from data
+	chain.resize(B*NV);
+
+	for(unsigned int n=0;n<B;n++)
+	  memcpy(&(chain[n*NV]), &(samples[order[n]][0]), NV*sizeof(T));
+      }
+
+      for(unsigned int i=0;i<NV;i++){
+	ivar[i] = math::exp(-z[i]);
+	istd[i] = math::exp(-z[i]/T(2.0f));
+	sd[i]   = math::exp(z[i]/T(2.0f));
+      }
+
+      const T* Wp = &(W(0,0));
+
+      pool.parallel_for(0, N, CHUNK, [&](unsigned int slot, unsigned long long r0)
+      {
+	const unsigned int rows = (N - r0 < CHUNK) ? (N - r0) : CHUNK;
+
+	T* v0 = &(V0[r0*NV]);
+	T* x0 = &(X0[r0*NV]);
+	T* h0 = &(H0[r0*NH]);
+	T* m  = &(M[r0*NV]);
+	T* vk = &(Vk[r0*NV]);
+	T* xk = &(Xk[r0*NV]);
+	T* hk = &(Hk[r0*NH]);
+
+	T* ga_ = &(ga[slot][0]);
+	T* gz_ = &(gz[slot][0]);
+
+	for(unsigned int n=0;n<rows;n++){
+	  memcpy(v0 + n*NV, &(samples[order[s0 + r0 + n]][0]), NV*sizeof(T));
+
+	  for(unsigned int i=0;i<NV;i++)
+	    x0[n*NV + i] = istd[i]*v0[n*NV + i];
+	}
+
+	// positive phase: h0 = sigmoid(x0*W + b)
+	math::gemm(false, false, rows, NH, NV, 1.0f, x0, NV, Wp, NH, 0.0f, h0, NH);
+	rbm_minibatch::sigmoid(h0, &(b[0]), rows, NH);
+
+	math::gemm(false, true, rows, NV, NH, 1.0f, h0, NH, Wp, NH, 0.0f, m, NV);
+
+	math::gemm(true, false, NV, NH, rows, 1.0f, x0, NV, h0, NH, 1.0f, &(gW[slot][0]), NH);
+	rbm_minibatch::colsum(h0, rows, NH, &(gb[slot][0]));
+
+	for(unsigned int n=0;n<rows;n++){
+	  for(unsigned int i=0;i<NV;i++){
+	    const T d = v0[n*NV + i] - a[i];
+	    ga_[i] += ivar[i]*d;
+	    gz_[i] += T(0.5f)*(ivar[i]*d*d - x0[n*NV + i]*m[n*NV + i]);
+	  }
+	}
+
+	// negative phase: k Gibbs steps from data or from persistent chains
+	if(persistent){
+	  memcpy(vk, &(chain[r0*NV]), rows*NV*sizeof(T));
+
+	  for(unsigned int j=0;j<rows*NV;j++)
+	    xk[j] = istd[j % NV]*vk[j];
+
+	  math::gemm(false, false, rows, NH, NV, 1.0f, xk, NV, Wp, NH, 0.0f, hk, NH);
+	  rbm_minibatch::sigmoid(hk, &(b[0]), rows, NH);
+	}
+	else{
+	  memcpy(hk, h0, rows*NH*sizeof(T));
+	}
+
+	for(unsigned int k=0;k<CDk;k++){
+	  rbm_minibatch::bernoulli(hk, rows*NH, gen[slot]);
+
+	  // v = exp(z/2)*(W*h + e) + a, e ~ N(0,I)
+	  math::gemm(false, true, rows, NV, NH, 1.0f, hk, NH, Wp, NH, 0.0f, m, NV);
+	  gen[slot].normal(vk, rows*NV);
+
+	  for(unsigned int j=0;j<rows*NV;j++){
+	    const unsigned int i = j % NV;
+	    vk[j] = sd[i]*(m[j] + vk[j]) + a[i];
+	    xk[j] = istd[i]*vk[j];
+	  }
+
+	  math::gemm(false, false, rows, NH, NV, 1.0f, xk, NV, Wp, NH, 0.0f, hk, NH);
+	  rbm_minibatch::sigmoid(hk, &(b[0]), rows, NH);
+	}
+
+	math::gemm(false, true, rows, NV, NH, 1.0f, hk, NH, Wp, NH, 0.0f, m, NV);
+
+	math::gemm(true, false, NV, NH, rows, -1.0f, xk, NV, hk, NH, 1.0f, &(gW[slot][0]), NH);
+	rbm_minibatch::colsum(hk, rows, NH, &(gb[slot][0]), T(-1.0f));
+
+	for(unsigned int n=0;n<rows;n++){
+	  for(unsigned int i=0;i<NV;i++){
+	    const T d = vk[n*NV + i] - a[i];
+	    ga_[i] -= ivar[i]*d;
+	    gz_[i] -= T(0.5f)*(ivar[i]*d*d - xk[n*NV + i]*m[n*NV + i]);
+	  }
+	}
+
+	if(persistent)
+	  memcpy(&(chain[r0*NV]), vk, rows*NV*sizeof(T));
+      }, SLOTS);
+
+      // sums per-thread gradients and updates parameters
+      const T rate = lrate/T(N);
+      T* Wq = &(W(0,0));
+
+      for(unsigned int s=0;s<SLOTS;s++){
+	for(unsigned int i=0;i<NV*NH;i++){
+	  if(s == 0) dW[i] *= momentum;
+	  dW[i] += rate*gW[s][i];
+	  gW[s][i] = T(0.0f);
+	}
+
+	for(unsigned int i=0;i<NV;i++){
+	  if(s == 0){ da[i] *= momentum; dz[i] *= momentum; }
+	  da[i] += rate*ga[s][i];
+	  dz[i] += T(0.1f)*rate*gz[s][i];
+	  ga[s][i] = T(0.0f);
+	  gz[s][i] = T(0.0f);
+	}
+
+	for(unsigned int i=0;i<NH;i++){
+	  if(s == 0) db[i] *= momentum;
+	  db[i] += rate*gb[s][i];
+	  gb[s][i] = T(0.0f);
+	}
+      }
+
+      for(unsigned int i=0;i<NV*NH;i++) Wq[i] += dW[i];
+      for(unsigned int i=0;i<NV;i++){ a[i] += da[i]; z[i] += dz[i]; }
+      for(unsigned int i=0;i<NH;i++) b[i] += db[i];
+    }
+
+    safebox(a, b, z, W);
+
+    latestError = reconstruct_gbrbm_data_error(samples, 1000, W, a, b, z, 1);
+
+    if(verbose == 1){
+      std::cout << "GBRBM::learnWeightsBatch(): EPOCH " << (e+1) << "/" << EPOCHS
+		<< ": error = " << latestError << std::endl;
+    }
+    else if(verbose == 2){
+      char buffer[128];
+      double tmp = 0.0;
+      whiteice::math::convert(tmp, latestError);
+      snprintf(buffer, 128, "GBRBM::learnWeightsBatch(): epoch %d/%d: error = %f",
+	       e+1, EPOCHS, tmp);
+      whiteice::logging.info(buffer);
+    }
+  }
+
+  return latestError;
+}
   
 
 #if 0
@@ -1129,34 +1368,55 @@ T GBRBM<T>::learnWeights(const std::vector< math::vertex<T> >& samples,
 template <typename T>
 T GBRBM<T>::logProbability(const std::vector< math::vertex<T> >& samples)
 {
-	// calculates mean and variance from the samples
-	if(samples.size() <= 1)
-		return T(-INFINITY);
+	T stderror = T(0.0);
+	return logProbability(samples, stderror);
+}
 
-	math::vertex<T> m(samples[0].size()), s(samples[0].size());
-	{
-		m.zero();
-		s.zero();
 
-		for(auto& x : samples){
-			m += x;
-			for(unsigned int i=0;i<s.size();i++)
-				s[i] += x[i]*x[i];
-		}
+// calculates mean and sample variance of the data (AIS base distribution)
+template <typename T>
+static bool gbrbm_data_statistics(const std::vector< math::vertex<T> >& samples,
+				  math::vertex<T>& m, math::vertex<T>& s)
+{
+	if(samples.size() <= 1)
+		return false;
 
-		m /= T(samples.size());
-		s /= T(samples.size());
+	m.resize(samples[0].size());
+	s.resize(samples[0].size());
+	m.zero();
+	s.zero();
 
+	for(auto& x : samples){
+		m += x;
 		for(unsigned int i=0;i<s.size();i++)
-			s[i] -= m[i]*m[i];
-
-		s *= T(samples.size())/T(samples.size() - 1); // sample variance and not direct variance (divide by N-1 !!)
+			s[i] += x[i]*x[i];
 	}
 
+	m /= T(samples.size());
+	s /= T(samples.size());
+
+	for(unsigned int i=0;i<s.size();i++)
+		s[i] -= m[i]*m[i];
+
+	s *= T(samples.size())/T(samples.size() - 1); // sample variance and not direct variance (divide by N-1 !!)
+
+	return true;
+}
+
+
+template <typename T>
+T GBRBM<T>::logProbability(const std::vector< math::vertex<T> >& samples, T& stderror)
+{
+	// calculates mean and variance from the samples
+	math::vertex<T> m, s;
+
+	if(gbrbm_data_statistics(samples, m, s) == false)
+		return T(-INFINITY);
+
 	// calculates partition function Z
 	T logZ = T(0.0);
 
-	ais(logZ, m, s, W, a, b, z);
+	ais(logZ, stderror, m, s, W, a, b, z);
 
 	T logP = T(0.0);
 
@@ -1170,6 +1430,24 @@ T GBRBM<T>::logProbability(const std::vector< math::vertex<T> >& samples)
 }
 
 
+template <typename T>
+T GBRBM<T>::logPartitionFunction(const std::vector< math::vertex<T> >& samples, T& stderror,
+				 const unsigned int CHAINS, const unsigned int NTemp) const
+{
+	math::vertex<T> m, s;
+
+	if(gbrbm_data_statistics(samples, m, s) == false || CHAINS == 0 || NTemp < 2){
+		stderror = T(INFINITY);
+		return T(INFINITY);
+	}
+
+	std::vector<T> logw;
+	ais_chains(logw, NULL, CHAINS, NTemp, m, s, W, a, b, z);
+
+	return ais_logz(logw, s, stderror);
+}
+
+
 template <typename T>
 bool GBRBM<T>::sample(const unsigned int SAMPLES, std::vector< math::vertex<T> >& samples,
 		const std::vector< math::vertex<T> >& statistics_training_data)
@@ -2310,56 +2588,12 @@ void GBRBM<T>::ais_sampling(std::vector< math::vertex<T> >& vs, const unsigned i
 		const math::vertex<T>& m, const math::vertex<T>& s,
 		const math::matrix<T>& W, const math::vertex<T>& a, const math::vertex<T>& b, const math::vertex<T>& z) const
 {
-	std::vector< math::vertex<T> > v, h;
-
-	std::vector< GBRBM<T> > ais_rbm;
 	const unsigned int NTemp = 100; // number of different temperatures (values below <100, or below 10 do not work very well)..
 
-	math::vertex<T> vz(z.size());
-	for(unsigned int i=0;i<vz.size();i++)
-		vz[i] = math::exp(z[i]); // sigma^2
-
-	if(ais_rbm.size() != NTemp){
-		ais_rbm.resize(NTemp);
-		for(unsigned int i=0;i<NTemp;i++)
-			ais_rbm[i].resize(a.size(), b.size());
-	}
-
-	for(unsigned int i=0;i<NTemp;i++){
-		const T beta = T(i/((double)(NTemp - 1)));
-		ais_rbm[i].setParameters(beta*W,  beta*a + (T(1.0)-beta)*m, beta*b, beta*vz + (T(1.0)-beta)*s);
-	}
-
-
-	std::vector<T> logRs;
-	// unsigned int iter = 0;
-
-	{
-		vs.resize(SAMPLES);
-
-		// TODO parallelize this to use thread-safe random number generators..
-#pragma omp parallel for schedule(dynamic)
-		for(unsigned int i=0;i<SAMPLES;i++){
-			math::vertex<T> vv;
-
-			// generates N(m,s) distributed variable [level 0]
-			vv = normalrnd(m, s);
-
-			math::vertex<T> hh;
-
-			for(unsigned int j=1;j<(NTemp-1);j++){
-				// T(v,v') transition operation
-				ais_rbm[j].sampleHidden(hh, vv);
-				ais_rbm[j].sampleVisible(vv, hh);
-			}
-
-			{
-				vs[i] = vv;
-			}
-		}
-
-	}
+	std::vector<T> logw;
 
+	vs.clear();
+	ais_chains(logw, &vs, SAMPLES, NTemp, m, s, W, a, b, z);
 }
 
 // calculates log(P-ratio): log(P(data1)/P(data2)) using geometric mean of probabilities
@@ -2394,110 +2628,212 @@ T GBRBM<T>::p_ratio(const std::vector< math::vertex<T> >& data1, const std::vect
 }
 
 
-// estimates partition function Z and samples v ~ p(v) for a given GBRBM(W,a,b,z)
-// using Parallel Tempering Annihilated Importance Sampling
+// estimates partition function Z for a given GBRBM(W,a,b,z) using
+// Annealed Importance Sampling from N(m,s) distribution
 template <typename T>
-T GBRBM<T>::ais(T& logZ,
+T GBRBM<T>::ais(T& logZ, T& stderror,
 		const math::vertex<T>& m, const math::vertex<T>& s,
 		const math::matrix<T>& W, const math::vertex<T>& a, const math::vertex<T>& b, const math::vertex<T>& z) const
 {
-	// parallel tempering RBM stack
-	std::vector< GBRBM<T> > rbm;
-	const unsigned int NTemp = 1000; // number of different temperatures (10.000 might be a good choice)
+	const unsigned int NTemp = 1000;  // number of different temperatures
+	const unsigned int CHAINS = 1024; // number of chains added per iteration
+	const unsigned int ITERLIMIT = 10;
 
-	math::vertex<T> vz(z.size());
-	for(unsigned int i=0;i<vz.size();i++)
-		vz[i] = math::exp(z[i]); // sigma^2
+	std::vector<T> logw;
+
+	for(unsigned int iter=0;iter<ITERLIMIT;iter++){
+		ais_chains(logw, NULL, CHAINS, NTemp, m, s, W, a, b, z);
 
-	rbm.resize(NTemp);
-	for(unsigned int i=0;i<NTemp;i++){
-		const T beta = T(i/((double)(NTemp - 1)));
-		rbm[i].resize(this->getVisibleNodes(), this->getHiddenNodes());
-		rbm[i].setParameters(beta*W,  beta*a + (T(1.0)-beta)*m, beta*b, beta*vz + (T(1.0)-beta)*s);
+		logZ = ais_logz(logw, s, stderror);
+
+		if(stderror < T(0.05))
+			break; // only stop until statistics tell we have 5% error in Z
 	}
 
-	const unsigned int SAMPLES = 1000; // base number of samples
+	return logZ;
+}
 
-	std::vector<T> logRs;
-	unsigned int iter = 0;
 
-	do{
+template <typename T>
+void GBRBM<T>::ais_chains(std::vector<T>& logw, std::vector< math::vertex<T> >* vs,
+			  const unsigned int CHAINS, const unsigned int NTemp,
+			  const math::vertex<T>& m, const math::vertex<T>& s,
+			  const math::matrix<T>& W, const math::vertex<T>& a, const math::vertex<T>& b, const math::vertex<T>& z) const
+{
+	// k:th intermediate distribution is GBRBM(beta*W, beta*a + (1-beta)*m, beta*b, beta*exp(z) + (1-beta)*s)
+	// with beta = k/(NTemp-1). 0th distribution is N(m,s) and the last one is GBRBM(W,a,b,z)
+
+	const unsigned int NV = a.size();
+	const unsigned int NH = b.size();
+	const unsigned int BLOCK = 32; // chains per block
 
-		for(unsigned int i=0;i<SAMPLES;i++){
-			auto vv = normalrnd(m, s); // generates N(m,s) distributed variable [level 0]
-			math::vertex<T> h;
+	if(CHAINS == 0 || NTemp < 2) return;
 
-			T logR = rbm[1].unscaled_log_probability(vv) - rbm[0].unscaled_log_probability(vv);
+	const unsigned int index0 = logw.size();
+	logw.resize(index0 + CHAINS);
 
-			for(unsigned int j=1;j<(NTemp-1);j++){
-				// T(v,v') transition operation
-				rbm[j].sampleHidden(h, vv);
-				rbm[j].sampleVisible(vv, h);
+	if(vs){
+		vs->resize(index0 + CHAINS);
+		for(unsigned int i=0;i<CHAINS;i++)
+			(*vs)[index0 + i].resize(NV);
+	}
+
+	math::vertex<T> vz(NV);
+	for(unsigned int i=0;i<NV;i++)
+		vz[i] = math::exp(z[i]); // sigma^2
+
+	// each block has its own random number stream so results don't depend on scheduling
+	const unsigned long long seed = rng.rand64();
+
+	const T* Wp = &(W(0,0));
+
+	whiteice::thread_pool::global().parallel_for(0, CHAINS, BLOCK, [&](unsigned int slot, unsigned long long c0)
+	{
+		const unsigned int R = (CHAINS - c0 < BLOCK) ? (CHAINS - c0) : BLOCK;
 
-				logR += rbm[(j+1)].unscaled_log_probability(vv) - rbm[j].unscaled_log_probability(vv);
+		const RNG<T> gen(seed, c0/BLOCK);
+
+		std::vector<T> V(R*NV), X(R*NV), M(R*NV), A(R*NH), logr(R, T(0.0f));
+		std::vector<T> ak(NV), isd(NV), sd(NV), bk(NH), zero(NH, T(0.0f));
+
+		// sets parameters of k:th distribution
+		auto parameters = [&](const unsigned int k) -> T
+		{
+			const T beta = T(k/((double)(NTemp - 1)));
+
+			for(unsigned int i=0;i<NV;i++){
+				ak[i]  = beta*a[i] + (T(1.0) - beta)*m[i];
+				sd[i]  = math::sqrt(beta*vz[i] + (T(1.0) - beta)*s[i]);
+				isd[i] = T(1.0)/sd[i];
 			}
 
-			// v.push_back(vv); // do not store samples?
-			logRs.push_back(logR);
-		}
+			for(unsigned int j=0;j<NH;j++)
+				bk[j] = beta*b[j];
+
+			return beta;
+		};
+
+		// logr += sign*log(p*_k(v)), A = beta*(v*S^-0.5*W + b)
+		auto unscaled_log_probability = [&](const T beta, const T sign)
+		{
+			for(unsigned int r=0;r<R;r++){
+				T e = T(0.0);
+
+				for(unsigned int i=0;i<NV;i++){
+					X[r*NV + i] = V[r*NV + i]*isd[i];
+					const T d = (V[r*NV + i] - ak[i])*isd[i];
+					e += d*d;
+				}
+
+				logr[r] -= sign*T(0.5)*e;
+			}
 
-		// calculates mean because only it is guaranteed by theory to give correct values
-		// also causes expected error of logR by calculating sample variance and calculates its percentage of the mean (var/mean)
-		T logR = T(0.0);
-		T varR = T(0.0);
-		for(const auto& lr : logRs){
-			auto r = math::exp(lr);
-			logR +=  r / T(logRs.size());
-			varR += (r * r) / T(logRs.size());
+			math::gemm(false, false, R, NH, NV, 1.0f, X.data(), NV, Wp, NH, 0.0f, A.data(), NH);
+
+			for(unsigned int r=0;r<R;r++){
+				T sum = T(0.0);
+
+				for(unsigned int j=0;j<NH;j++){
+					const T x = beta*A[r*NH + j] + bk[j];
+					A[r*NH + j] = x;
+
+					// log(1+exp(x)) = max(x,0) + log(1+exp(-|x|))
+					if(x > T(0.0)) sum += x + math::log(T(1.0) + math::exp(-x));
+					else sum += math::log(T(1.0) + math::exp(x));
+				}
+
+				logr[r] += sign*sum;
+			}
+		};
+
+		// level 0: v ~ N(m,s)
+		parameters(0);
+		gen.normal(V.data(), R*NV);
+
+		for(unsigned int j=0;j<R*NV;j++)
+			V[j] = sd[j % NV]*V[j] + ak[j % NV];
+
+		for(unsigned int k=1;k<NTemp;k++){
+			// logr += log(p*_k(v)) - log(p*_{k-1}(v))
+			T beta = parameters(k-1);
+			unscaled_log_probability(beta, T(-1.0));
+
+			beta = parameters(k);
+			unscaled_log_probability(beta, T(+1.0));
+
+			if(k == NTemp-1) break;
+
+			// T_k(v,v') transition: h ~ p_k(h|v), v ~ p_k(v|h)
+			rbm_minibatch::sigmoid(A.data(), zero.data(), R, NH); // A has bias terms already
+			rbm_minibatch::bernoulli(A.data(), R*NH, gen);
+
+			math::gemm(false, true, R, NV, NH, 1.0f, A.data(), NH, Wp, NH, 0.0f, M.data(), NV);
+			gen.normal(V.data(), R*NV);
+
+			for(unsigned int j=0;j<R*NV;j++){
+				const unsigned int i = j % NV;
+				V[j] = sd[i]*(beta*M[j] + V[j]) + ak[i];
+			}
 		}
 
-		varR = varR - logR*logR;
-		varR /= T(logRs.size()); // sample variance
+		for(unsigned int r=0;r<R;r++){
+			logw[index0 + c0 + r] = logr[r];
 
-		auto pError = T(100.0)*math::sqrt(varR)/logR;
+			if(vs){
+				auto& v = (*vs)[index0 + c0 + r];
+				for(unsigned int i=0;i<NV;i++)
+					v[i] = V[r*NV + i];
+			}
+		}
+	});
+}
 
-		std::cout << iter << ": Expected error in R (Z) (%): " << pError << std::endl;
-		iter++;
 
-		if(pError < 5.0)
-			break; // only stop until statistics tell we have 5% error
+template <typename T>
+T GBRBM<T>::ais_logz(const std::vector<T>& logw, const math::vertex<T>& s, T& stderror) const
+{
+	// Z/Z0 = E[w], log(E[w]) is calculated using log-sum-exp and
+	// st.err(log(Z)) = st.err(E[w])/E[w]
+	T maxw = T(-INFINITY);
+	unsigned int N = 0;
+
+	for(const auto& lw : logw){
+		if(whiteice::math::isnan(lw) || whiteice::math::isinf(lw)) continue;
+		if(lw > maxw) maxw = lw;
+		N++;
 	}
-	while(1);
 
-#if 0
-	// calculates final logR (mean value) [we use geometric mean because it is easiest to calculate]
-	T logR = T(0.0);
-	for(const auto& lr : logRs)
-		logR += lr / T(logRs.size());
-#endif
-	// calculates mean because only it is guaranteed by theory to give correct values
-	// also causes expected error of logR by calculating sample variance and calculates its percentage of the mean (var/mean)
-	T logR = T(0.0);
-	T varR = T(0.0);
-	for(const auto& lr : logRs){
-		auto r = math::exp(lr);
-		logR +=  r / T(logRs.size());
-		varR += (r * r) / T(logRs.size());
+	if(N < 2){
+		stderror = T(INFINITY);
+		return T(INFINITY);
 	}
 
-	varR = varR - logR*logR;
-	varR /= T(logRs.size()); // sample variance
+	T mw = T(0.0), vw = T(0.0);
 
-	std::cout << "Expected error in R (Z) (%): " << T(100.0)*math::sqrt(varR)/logR << std::endl;
+	for(const auto& lw : logw){
+		if(whiteice::math::isnan(lw) || whiteice::math::isinf(lw)) continue;
+		const T w = math::exp(lw - maxw);
+		mw += w;
+		vw += w*w;
+	}
 
-	logR = math::log(logR); // transforms back to logarithms
+	mw /= T(N);
+	vw /= T(N);
+	vw -= mw*mw;
+	vw *= T((double)N/((double)N - 1.0)); // sample variance
 
+	if(vw < T(0.0)) vw = T(0.0);
 
-	// logR = log(Z) - log(Z0), Z0 = Z of N(m,s) distribution
-	T NlogZ = T(m.size()/2.0)*math::log(T(2.0)*M_PI);
+	stderror = math::sqrt(vw/T(N))/mw;
 
-	for(unsigned int i=0;i<m.size();i++)
-		NlogZ += T(0.5)*z[i];
+	// log(Z0) of N(m,s) base distribution which has unscaled
+	// probability exp(-0.5*(v-m)^T S^-1 (v-m)) * 2^hidden
+	T logZ0 = T(s.size()/2.0)*math::log(T(2.0*M_PI)) + T(b.size())*math::log(T(2.0));
 
-	logZ = logR + NlogZ;
-	// logZ = NlogZ - logR;
+	for(unsigned int i=0;i<s.size();i++)
+		logZ0 += T(0.5)*math::log(s[i]);
 
-	return logZ;
+	return (logZ0 + maxw + math::log(mw));
 }
 
 
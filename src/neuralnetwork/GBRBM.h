@@ -90,9 +90,33 @@ namespace whiteice {
   T learnWeights(const std::vector< math::vertex<T> >& samples,
 		 const unsigned int EPOCHS, const int verbose = 0,
 		 const bool* running = NULL);
+
+  // minibatch CD-k (or persistent CD if persistent = true) using momentum
+  // gradient descent, log-variance z is learnt using lrate/10.
+  // minibatch states are matrices and products with W are calculated
+  // using GEMM, minibatch is divided between threads.
+  // returns reconstruction error
+  T learnWeightsBatch(const std::vector< math::vertex<T> >& samples,
+		      const unsigned int EPOCHS = 1,
+		      const unsigned int CDk = 1,
+		      const bool persistent = false,
+		      const unsigned int batchsize = 128,
+		      const T lrate = T(0.01),
+		      const int verbose = 0,
+		      const bool* running = NULL);
   
   // estimates log(P(samples|params)) of the RBM
   T logProbability(const std::vector< math::vertex<T> >& samples);
+
+  // also returns standard error of the estimate (standard error of log(Z))
+  T logProbability(const std::vector< math::vertex<T> >& samples, T& stderror);
+
+  // estimates log partition function log(Z) using CHAINS parallel AIS chains
+  // and NTemp intermediate distributions. samples are used to select
+  // N(m,s) base distribution of the annealing
+  T logPartitionFunction(const std::vector< math::vertex<T> >& samples, T& stderror,
+			 const unsigned int CHAINS = 1024,
+			 const unsigned int NTemp = 1000) const;
   
   bool setDataStatistics(const std::vector< math::vertex<T> >& samples);
   
@@ -167,10 +191,23 @@ namespace whiteice {
 		    const math::vertex<T>& m, const math::vertex<T>& s,
 		    const math::matrix<T>& W, const math::vertex<T>& a, const math::vertex<T>& b, const math::vertex<T>& z) const;
   
-  // parallel tempering annealed importance sampling estimation of logZ and samples v from distribution p(v)
-  T ais(T& logZ,
+  // annealed importance sampling estimation of logZ (and its standard error),
+  // adds chains until standard error is small
+  T ais(T& logZ, T& stderror,
 	const math::vertex<T>& m, const math::vertex<T>& s,
 	const math::matrix<T>& W, const math::vertex<T>& a, const math::vertex<T>& b, const math::vertex<T>& z) const;
+
+  // runs CHAINS AIS chains from N(m,s) to GBRBM(W,a,b,z) in parallel. chains are
+  // processed in blocks (states are matrices, one chain per row) with their own
+  // random number generators. appends log importance weights to logw and
+  // final states of the chains to vs (if not NULL)
+  void ais_chains(std::vector<T>& logw, std::vector< math::vertex<T> >* vs,
+		  const unsigned int CHAINS, const unsigned int NTemp,
+		  const math::vertex<T>& m, const math::vertex<T>& s,
+		  const math::matrix<T>& W, const math::vertex<T>& a, const math::vertex<T>& b, const math::vertex<T>& z) const;
+
+  // calculates log(Z) and its standard error from AIS log importance weights
+  T ais_logz(const std::vector<T>& logw, const math::vertex<T>& s, T& stderror) const;
   
   T unscaled_log_probability(const math::vertex<T>& v) const;
   
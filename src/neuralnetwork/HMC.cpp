@@ -4,10 +4,13 @@
 
 #include "HMC.h"
 #include "NNGradDescent.h"
+#include "Log.h"
 
 #include <random>
 #include <list>
 #include <chrono>
+#include <functional>
+#include <memory>
 
 
 namespace whiteice
@@ -15,13 +18,17 @@ namespace whiteice
 	template <typename T>
 	HMC<T>::HMC(const whiteice::nnetwork<T>& net,
 			const whiteice::dataset<T>& ds,
-			bool adaptive, T alpha, bool store) : nnet(net), data(ds)
+			bool adaptive, T alpha, bool store) : nnet(net), data(&ds), source(nullptr)
 	{
 		this->adaptive = adaptive;
 		this->alpha = alpha;
 		this->temperature = T(1.0);
 		this->store = store;
+		this->float16 = false;
 		this->sigma2 = T(1.0);
+		this->sghmc = false;
+		this->batchsize = 256;
+		this->friction = T(0.05);
 
 		sum_N = 0;
 		sum_mean.zero();
@@ -29,6 +36,31 @@ namespace whiteice
 
 		running = false;
 		paused = false;
+		stream_failed = false;
+	}
+
+
+	template <typename T>
+	HMC<T>::HMC(const whiteice::nnetwork<T>& net,
+			const whiteice::minibatch_source<T>& s,
+			bool adaptive, T alpha, bool store) : nnet(net), data(nullptr), source(&s)
+	{
+		this->adaptive = adaptive;
+		this->alpha = alpha;
+		this->temperature = T(1.0);
+		this->store = store;
+		this->float16 = false;
+		this->sigma2 = T(1.0);
+		this->sghmc = false;
+		this->batchsize = 256;
+		this->friction = T(0.05);
+
+		sum_N = 0;
+		sum_mean.zero();
+
+		running = false;
+		paused = false;
+		stream_failed = false;
 	}
 
 
@@ -40,9 +72,9 @@ namespace whiteice
 		if(running){
 			running = false;
 
-			for(auto t : sampling_thread){
-				t->join();
-				delete t;
+			for(auto& t : sampling_thread){
+				try{ t.join(); }
+				catch(...){ } // destructor must not throw
 			}
 
 			sampling_thread.clear();
@@ -65,35 +97,83 @@ namespace whiteice
 	}
   
 
+	template <typename T>
+	bool HMC<T>::setSGHMC(const bool sghmc, const unsigned int batchsize, const T friction)
+	{
+		std::lock_guard<std::mutex> lock(start_lock);
+
+		if(running) return false;
+		if(batchsize == 0) return false;
+		if(friction <= T(0.0) || friction >= T(1.0)) return false;
+
+		this->sghmc = sghmc;
+		this->batchsize = batchsize;
+		this->friction = friction;
+
+		return true;
+	}
+
+
+	template <typename T>
+	std::vector<typename HMC<T>::scratch>& HMC<T>::get_scratch(std::unique_lock<std::mutex>& lock,
+								     std::vector<scratch>& local) const
+	{
+		lock = std::unique_lock<std::mutex>(scratch_mutex, std::try_to_lock);
+		
+		std::vector<scratch>& s = lock.owns_lock() ? scratches : local;
+		
+		if(s.size() < whiteice::thread_pool::global().concurrency())
+			s.resize(whiteice::thread_pool::global().concurrency());
+		
+		return s;
+	}
+	
+
 	template <typename T>
 	T HMC<T>::U(const math::vertex<T>& q, bool useRegulizer) const
 	{
 		T E = T(0.0f);
+		const unsigned int BATCHSIZE = 256; // minibatch size of batched calculations
 
-		// E = SUM 0.5*e(i)^2
-#pragma omp parallel shared(E)
-		{
-			whiteice::nnetwork<T> nnet(this->nnet);
-			nnet.importdata(q);
+		std::unique_lock<std::mutex> lock;
+		std::vector<scratch> local;
+		std::vector<scratch>& thread_scratch = get_scratch(lock, local);
 
-			math::vertex<T> err;
-			T e = T(0.0f);
+		if(source){
+			if(stream_error(q, E, nullptr, thread_scratch[0].ws) == false)
+				stream_failed = true;
+			
+			E /= sigma2;
+			E /= temperature;
+			E += T(0.5)*alpha*(q*q)[0];
+			return (E);
+		}
 
-#pragma omp for nowait schedule(dynamic)
-			for(unsigned int i=0;i<data.size(0);i++){
-				nnet.input() = data.access(0, i);
-				nnet.calculate(false);
-				err = data.access(1, i) - nnet.output();
-				// T inv = T(1.0f/err.size());
-				err = (err*err);
-				e = e  + T(0.5f)*err[0];
-			}
+		// E = SUM 0.5*e(i)^2
+		std::vector<T> e(thread_scratch.size(), T(0.0f));
+		const unsigned int OUT = nnet.output_size();
 
-#pragma omp critical
+		// calculates minibatches of data using batched GEMM calculations
+		whiteice::thread_pool::global().parallel_for(0, data->size(0), BATCHSIZE,
+			[&](unsigned int slot, unsigned long long i)
 			{
-				E = E + e;
-			}
-		}
+				auto& ws = thread_scratch[slot].ws;
+				const unsigned int N = (i + BATCHSIZE <= data->size(0)) ? BATCHSIZE : (data->size(0) - i);
+				
+				nnet.calculate(q, data->begin(0) + i, data->begin(0) + i + N, ws);
+				
+				for(unsigned int n=0;n<N;n++){
+					const auto& y = data->access(1, i + n);
+					
+					for(unsigned int k=0;k<y.size();k++){
+						const T err = y[k] - ws.output[n*OUT + k];
+						e[slot] = e[slot] + T(0.5f)*err*err;
+					}
+				}
+			}, thread_scratch.size());
+
+		for(const auto& ei : e)
+			E = E + ei;
 
 		E /= sigma2;
 
@@ -111,43 +191,59 @@ namespace whiteice
 		math::vertex<T> sum;
 		sum.resize(q.size());
 		sum.zero();
+		
+		const unsigned int BATCHSIZE = 256; // minibatch size of batched calculations
 
-		// positive gradient
-#pragma omp parallel shared(sum)
-		{
-			// const T ninv = T(1.0f); // T(1.0f/data.size(0));
-			math::vertex<T> sumgrad, grad, err;
-			sumgrad.resize(q.size());
-			sumgrad.zero();
-
-			whiteice::nnetwork<T> nnet(this->nnet);
-			nnet.importdata(q);
-
-#pragma omp for nowait schedule(dynamic)
-			for(unsigned int i=0;i<data.size(0);i++){
-				nnet.input() = data.access(0, i);
-				nnet.calculate(true);
-				err = data.access(1,i) - nnet.output();
+		std::unique_lock<std::mutex> lock;
+		std::vector<scratch> local;
+		std::vector<scratch>& thread_scratch = get_scratch(lock, local);
 
-				if(nnet.gradient(err, grad) == false){
-					std::cout << "gradient failed." << std::endl;
-					assert(0); // FIXME
-				}
+		if(source){
+			T e = T(0.0f);
+			if(stream_error(q, e, &sum, thread_scratch[0].ws) == false)
+				stream_failed = true;
+			
+			sum /= sigma2;
+			sum /= temperature;
+			sum.add_scaled(q, T(0.5)*alpha);
+			return (sum);
+		}
 
-				sumgrad += grad;
-			}
+		// positive gradient
+		for(auto& s : thread_scratch){
+			s.sumgrad.resize(q.size());
+			s.sumgrad.zero();
+		}
 
-#pragma omp critical
-			{
-				sum += sumgrad;
-			}
+		// calculates minibatch gradient sums using batched GEMM backward pass
+		try{
+			whiteice::thread_pool::global().parallel_for(0, data->size(0), BATCHSIZE,
+				[&](unsigned int slot, unsigned long long i)
+				{
+					auto& s = thread_scratch[slot];
+					const unsigned int N = (i + BATCHSIZE <= data->size(0)) ? BATCHSIZE : (data->size(0) - i);
+					
+					if(nnet.gradient(q, data->begin(0) + i, data->begin(0) + i + N,
+							 data->begin(1) + i, s.grad, s.ws) == false)
+						throw std::runtime_error("HMC: calculating gradient failed");
+					
+					s.sumgrad += s.grad;
+				}, thread_scratch.size());
+		}
+		catch(std::exception& e){
+			// parallel_for() rethrows exception of a worker, sampler stops
+			whiteice::logging.error(e.what());
+			stream_failed = true;
 		}
+
+		for(const auto& s : thread_scratch)
+			sum += s.sumgrad;
 		
 #if 0		
 		// negative gradient
 #pragma omp parallel shared(sum)
 		{
-			// const T ninv = T(1.0f); // T(1.0f/data.size(0));
+			// const T ninv = T(1.0f); // T(1.0f/data->size(0));
 			math::vertex<T> sumgrad, grad, err;
 			sumgrad.resize(q.size());
 			sumgrad.zero();
@@ -156,9 +252,9 @@ namespace whiteice
 			nnet.importdata(q);
 
 #pragma omp for nowait schedule(dynamic)
-			for(unsigned int i=0;i<data.size(0);i++){
+			for(unsigned int i=0;i<data->size(0);i++){
 			        // generates negative particle
-			        auto x = data.access(0, rng.rand() % data.size(0));
+			        auto x = data->access(0, rng.rand() % data->size(0));
 				 
 				nnet.input() = x;
 				nnet.calculate(true);
@@ -190,7 +286,7 @@ namespace whiteice
 		sum /= temperature; // scales gradient with temperature
 
 		
-		sum += T(0.5)*alpha*q;
+		sum.add_scaled(q, T(0.5)*alpha);
 		
 		// sum.normalize();
 
@@ -199,6 +295,62 @@ namespace whiteice
   
   
   
+	template <typename T>
+	unsigned long long HMC<T>::data_size() const
+	{
+		if(source) return source->size();
+		else return data->size(0);
+	}
+
+
+	template <typename T>
+	bool HMC<T>::stream_error(const math::vertex<T>& q, T& e, math::vertex<T>* grad,
+				  typename whiteice::nnetwork<T>::workspace& ws) const
+	{
+		// data is read in order in background using batched calculations
+		whiteice::minibatch_prefetcher<T> batches(*source, 256, false);
+		whiteice::minibatch<T> batch;
+
+		math::vertex<T> g;
+		e = T(0.0f);
+
+		if(grad){
+			grad->resize(q.size());
+			grad->zero();
+		}
+
+		while(batches.next(batch)){
+			if(grad){
+				if(nnet.gradient(q, batch.input, batch.output, g, ws) == false){
+					whiteice::logging.error("HMC: calculating gradient failed");
+					return false;
+				}
+
+				(*grad) += g;
+			}
+			else{
+				nnet.calculate(q, batch.input, ws);
+
+				const unsigned int OUT = batch.output.xsize();
+
+				for(unsigned int n=0;n<batch.output.ysize();n++){
+					for(unsigned int k=0;k<OUT;k++){
+						const T err = batch.output(n, k) - ws.output[n*OUT + k];
+						e = e + T(0.5f)*err*err;
+					}
+				}
+			}
+		}
+
+		if(batches.good() == false){
+			whiteice::logging.error("HMC: reading data source failed");
+			return false;
+		}
+
+		return true;
+	}
+  
+  
         // calculates z-ratio between data likelihood distributions
         template <typename T>
 	T HMC<T>::zratio(const math::vertex<T>& q1, const math::vertex<T>& q2) const
@@ -223,8 +375,8 @@ namespace whiteice
 	    for(unsigned int index=0;index<BLOCKSIZE;index++){
 	      // generates negative particle (x side)
 	      
-	      const unsigned int data_index = rng.rand() % data.size(0);
-	      auto x = data.access(0, data_index);
+	      const unsigned int data_index = rng.rand() % data->size(0);
+	      auto x = data->access(0, data_index);
 	      
 	      // generates negative particle (y side) from input data [x => y]
 	      math::vertex<T> y(nnet2.output_size());
@@ -282,7 +434,7 @@ namespace whiteice
 	      
 	      // printf("zratio number of iterations: %d\n", (int)zratio.size());
 	      
-	      mr = math::pow(mr, T(data.size(0)));
+	      mr = math::pow(mr, T(data->size(0)));
 	      
 	      return mr;
 	    }
@@ -317,19 +469,19 @@ namespace whiteice
 	  S.zero();
 	  m.zero();
 	  
-	  for(unsigned int i=0;i<data.size(0);i++){
-	    const auto& x = data.access(0, i);
+	  for(unsigned int i=0;i<data->size(0);i++){
+	    const auto& x = data->access(0, i);
 	    math::vertex<T> fx;
 	    
 	    nnet.calculate(x, fx);
-	    auto z =  data.access(1, i) - fx;
+	    auto z =  data->access(1, i) - fx;
 	      
 	    S += z.outerproduct();
 	    m += z;
 	  }
 	  
-	  S /= T(data.size(0));
-	  m /= T(data.size(0));
+	  S /= T(data->size(0));
+	  m /= T(data->size(0));
 	  
 	  S -= m.outerproduct();
 	  
@@ -366,19 +518,19 @@ namespace whiteice
 	    math::matrix<T> Ln(DIM, DIM);
 	    Ln = PRIOR; 
 	    
-	    for(unsigned int i=0;i<data.size(0);i++){
-	      const auto& x = data.access(0, i);
+	    for(unsigned int i=0;i<data->size(0);i++){
+	      const auto& x = data->access(0, i);
 	      math::vertex<T> fx;
 	      
 	      nnet.calculate(x, fx);
-	      auto z =  data.access(1, i) - fx;
+	      auto z =  data->access(1, i) - fx;
 	      
 	      Ln += z.outerproduct();
 	    }
 	    
 	    unsigned int vn = 0;
 	    
-	    if(data.size(0) <= nnet.output_size()){
+	    if(data->size(0) <= nnet.output_size()){
 	      vn = nnet.output_size();
 	      math::matrix<T> L0(nnet.output_size(), nnet.output_size());
 	      L0.identity();
@@ -386,7 +538,7 @@ namespace whiteice
 	      Ln += L0;
 	    }
 	    else{
-	      vn = data.size(0) - 1;
+	      vn = data->size(0) - 1;
 	    }
 	    
 	    if(Ln.inv() == false){
@@ -459,40 +611,53 @@ namespace whiteice
 		if(running)
 			return false; // already running
     
-		if(data.size(0) != data.size(1))
-			return false;
+		if(source){
+			if(source->good() == false || source->size() == 0)
+				return false;
+		}
+		else{
+			if(data->size(0) != data->size(1))
+				return false;
 
-		if(data.size(0) <= 0)
-			return false;
+			if(data->size(0) <= 0)
+				return false;
+		}
 
 		// nnet.randomize(); // initally random
 		nnet.exportdata(q); // initial position q
     
 		running = true;
 		paused = false;
+		stream_failed = false;
 
 		sum_N = 0;
 		sum_mean.zero();
 		
 		sigma2 = T(1.0);
 
+		{
+			// thread scratch memory is allocated once per sampler
+			std::lock_guard<std::mutex> slock(scratch_mutex);
+			scratches.clear();
+			scratches.resize(whiteice::thread_pool::global().concurrency());
+		}
+
 		sampling_thread.clear();
 
 		for(unsigned int i=0;i<NUM_THREADS;i++){
 
 			try{
-			        std::thread* t = new std::thread(&HMC<T>::sampler_loop, this);
-				// t->detach();
-				sampling_thread.push_back(t);
+				if(sghmc)
+					sampling_thread.push_back(whiteice::thread_pool::global().start(std::bind(&HMC<T>::sghmc_loop, this)));
+				else
+					sampling_thread.push_back(whiteice::thread_pool::global().start(std::bind(&HMC<T>::sampler_loop, this)));
 			}
 			catch(std::system_error e){
 				running = false;
 				paused = false;
 
-				for(auto t : sampling_thread){
-					t->join();
-					delete t;
-				}
+				for(auto& t : sampling_thread)
+					t.join();
 
 				sampling_thread.clear();
 
@@ -502,6 +667,7 @@ namespace whiteice
 
 
 		samples.clear();
+		halfsamples.clear();
 		sum_mean.zero();
 		// sum_covariance.zero();
 		sum_N = 0;
@@ -539,10 +705,8 @@ namespace whiteice
 		running = false;
 		paused = false;
 
-		for(auto t : sampling_thread){
-			t->join();
-			delete t;
-		}
+		for(auto& t : sampling_thread)
+			t.join();
 
 		sampling_thread.clear();
 		return true;
@@ -571,10 +735,9 @@ namespace whiteice
 	{
 		std::lock_guard<std::mutex> lock(solution_lock);
 
-		samples = this->samples;
-		unsigned int N = this->samples.size();
+		copy_samples(0, samples);
 
-		return N;
+		return samples.size();
 	}
 
 
@@ -582,10 +745,64 @@ namespace whiteice
 	unsigned int HMC<T>::getNumberOfSamples() const
 	{
 		std::lock_guard<std::mutex> lock(solution_lock);
-		unsigned int N = samples.size();
+		unsigned int N = stored_samples();
 
 		return N;
 	}
+
+
+	template <typename T>
+	void HMC<T>::setFloat16Storage(const bool f16)
+	{
+		std::lock_guard<std::mutex> lock(solution_lock);
+
+		if(f16 == float16) return;
+
+		if(f16){
+			halfsamples.resize(samples.size());
+			for(unsigned int i=0;i<samples.size();i++)
+				halfsamples[i].importdata(samples[i]);
+			samples.clear();
+		}
+		else{
+			samples.resize(halfsamples.size());
+			for(unsigned int i=0;i<halfsamples.size();i++)
+				halfsamples[i].exportdata(samples[i]);
+			halfsamples.clear();
+		}
+
+		float16 = f16;
+	}
+
+
+	template <typename T>
+	void HMC<T>::store_sample(const math::vertex<T>& s)
+	{
+		if(float16) halfsamples.push_back(math::float16_vector(s));
+		else samples.push_back(s);
+	}
+
+
+	template <typename T>
+	unsigned int HMC<T>::stored_samples() const
+	{
+		return (float16 ? halfsamples.size() : samples.size());
+	}
+
+
+	template <typename T>
+	void HMC<T>::copy_samples(const unsigned int first,
+				  std::vector< math::vertex<T> >& out) const
+	{
+		const unsigned int N = stored_samples();
+
+		out.resize(N > first ? N - first : 0);
+
+		for(unsigned int i=first;i<N;i++){
+			if(float16) halfsamples[i].exportdata(out[i-first]);
+			else out[i-first] = samples[i];
+		}
+	}
   
   
 	template <typename T>
@@ -593,20 +810,21 @@ namespace whiteice
 	{
 		std::lock_guard<std::mutex> lock(solution_lock);
 
-		if(samples.size() <= 0)
+		const unsigned int N = stored_samples();
+
+		if(N <= 0)
 		        return false;
 
-		if(latestN == 0) latestN = samples.size();
+		if(latestN == 0 || latestN > N) latestN = N;
 
-		if(latestN == samples.size()){
+		if(latestN == N && !float16){
 		  if(bnn.importSamples(nnet, samples) == false)
 			return false;
 		}
 		else{
 		  std::vector< math::vertex<T> > temp;
 
-		  for(unsigned int i=samples.size()-latestN;i<samples.size();i++)
-		    temp.push_back(samples[i]);
+		  copy_samples(N - latestN, temp);
 
 		  if(bnn.importSamples(nnet, temp) == false)
 		    return false;
@@ -674,19 +892,37 @@ namespace whiteice
 	  {
 	    std::lock_guard<std::mutex> lock(solution_lock);
 	    
-	    if(!latestN) latestN = samples.size();
-	    if(latestN > samples.size()) latestN = samples.size();
+	    const unsigned int N = stored_samples();
 	    
-	    for(unsigned int i=samples.size()-latestN;i<samples.size();i++){
-	      sample.push_back(samples[i]);
-	    }
+	    if(!latestN) latestN = N;
+	    if(latestN > N) latestN = N;
+	    
+	    copy_samples(N - latestN, sample);
 	  }
 	  
 
     	T sumErr = T(0.0f);
+	typename whiteice::nnetwork<T>::workspace ws;
 
     	for(unsigned int i=0;i<sample.size();i++)
 	{
+	  if(source){
+	    T e = T(0.0f);
+	    
+	    if(stream_error(sample[i], e, nullptr, ws) == false){
+	      // mean error of the samples calculated using all data
+	      if(i > 0){
+		sumErr /= T((float)i);
+		sumErr /= T((float)data_size());
+	      }
+	      
+	      return sumErr;
+	    }
+	    
+	    sumErr += e;
+	    continue;
+	  }
+	  
 	  T E = T(0.0f);
 	  
 	  // E = SUM 0.5*e(i)^2
@@ -699,10 +935,10 @@ namespace whiteice
 	    T e = T(0.0f);
 	    
 #pragma omp for nowait schedule(dynamic)
-	    for(unsigned int i=0;i<data.size(0);i++){
-	      nnet.input() = data.access(0, i);
+	    for(unsigned int i=0;i<data->size(0);i++){
+	      nnet.input() = data->access(0, i);
 	      nnet.calculate(false);
-	      err = data.access(1, i) - nnet.output();
+	      err = math::lazy(data->access(1, i)) - nnet.output();
 	      // T inv = T(1.0f/err.size());
 	      err = (err*err);
 	      e = e  + T(0.5f)*err[0];
@@ -720,7 +956,7 @@ namespace whiteice
 	
 	if(sample.size() > 0){
 	  sumErr /= T((float)sample.size());
-	  sumErr /= T((float)data.size(0));
+	  sumErr /= T((float)data_size());
 	}
 
     	return sumErr;
@@ -731,17 +967,17 @@ namespace whiteice
     template <typename T>
     void HMC<T>::leapfrog(math::vertex<T>& p, math::vertex<T>& q, const T epsilon, const unsigned int L) const
     {
-      p -= T(0.5f) * epsilon * Ugrad(q);
+      p.add_scaled(Ugrad(q), T(-0.5f)*epsilon);
       
       for(unsigned int i=0;i<L;i++){
-	q += epsilon * p;
+	q.add_scaled(p, epsilon);
 	if(i != L-1)
-	  p -= epsilon*Ugrad(q);
+	  p.add_scaled(Ugrad(q), -epsilon);
       }
       
-      p -= T(0.5f) * epsilon * Ugrad(q);
+      p.add_scaled(Ugrad(q), T(-0.5f)*epsilon);
       
-      p = -p;
+      p *= T(-1.0f);
     }
 
   
@@ -765,7 +1001,7 @@ namespace whiteice
 	
 #if 1
 	{
-	  epsilon /= T(data.size(0)); // gradient sum is now "divided by number of datapoints"
+	  epsilon /= T((float)data_size()); // gradient sum is now "divided by number of datapoints"
 	}
 #endif
 	
@@ -857,6 +1093,14 @@ namespace whiteice
     		T current_U  = U(old_q);
     		T proposed_U = U(q);
 
+		if(stream_failed){
+			// energies/gradients don't cover all data, stops sampling
+			q = old_q;
+			updating_sample.unlock();
+			running = false;
+			break;
+		}
+
 		
 		T logZratio  = T(0.0);
 #if 0
@@ -897,7 +1141,7 @@ namespace whiteice
 			  }
 			  
 			  if(store)
-			    samples.push_back(q);
+			    store_sample(q);
 			  
 			  solution_lock.unlock();
 			}
@@ -929,7 +1173,7 @@ namespace whiteice
 			  }
 			  
 			  if(store)
-			    samples.push_back(q);
+			    store_sample(q);
 			  
 			  solution_lock.unlock();
 			}
@@ -979,6 +1223,118 @@ namespace whiteice
     	}
 
     }
+
+
+    // stochastic gradient HMC with friction (Chen, Fox, Guestrin 2014):
+    //
+    //   v <- (1-a)*v - eta*grad U~(q) + N(0, 2*a*eta), q <- q + v
+    //
+    // grad U~(q) is the minibatch gradient scaled to the whole dataset and
+    // the friction a compensates the minibatch noise (noise estimate B = 0)
+    template <typename T>
+    void HMC<T>::sghmc_loop()
+    {
+	math::vertex<T> q, v, n, grad, g;
+
+	{
+	  std::lock_guard<std::mutex> lock(updating_sample);
+	  nnet.exportdata(this->q); // initial position q
+	  q = this->q;
+	}
+
+	sample_covariance_matrix(q);
+
+	// step length is scaled so that eta*grad U~ is learning rate times
+	// the average gradient of a single datapoint
+	const T learning_rate = T(0.001f);
+	const T eta = learning_rate*sigma2/T((float)data_size());
+	const T noise = math::sqrt(T(2.0f)*friction*eta);
+	const unsigned int L = 10; // steps between stored samples
+
+	v.resize(q.size());
+	n.resize(q.size());
+	rng.normal(v);
+	v *= math::sqrt(eta);
+
+	// minibatches are sampled from data or read from out-of-core source in background
+	std::unique_ptr< whiteice::minibatch_source<T> > local;
+	if(source == nullptr) local.reset(new whiteice::dataset_minibatch_source<T>(*data));
+
+	whiteice::minibatch_prefetcher<T> batches(source ? *source : *local, batchsize, true);
+	whiteice::minibatch<T> batch;
+	typename whiteice::nnetwork<T>::workspace ws;
+
+	// the first samples are used as burn-in
+	unsigned int iterations = 0;
+	const unsigned int BURNIN = 5;
+
+	while(running) // keep sampling forever or until stopped
+	{
+	  {
+	    std::lock_guard<std::mutex> lock(updating_sample);
+	    q = this->q; // setCurrentSample() may have changed q
+	  }
+
+	  for(unsigned int l=0;l<L && running;l++){
+	    if(batches.next(batch) == false){
+	      if(batches.good() == false){
+		whiteice::logging.error("HMC: reading data source failed");
+		running = false;
+		break;
+	      }
+
+	      continue; // new epoch
+	    }
+
+	    if(nnet.gradient(q, batch.input, batch.output, g, ws) == false){
+	      whiteice::logging.error("HMC: calculating minibatch gradient failed");
+	      continue; // skips the step
+	    }
+
+	    // scales minibatch gradient to the whole dataset (same as Ugrad())
+	    grad = g;
+	    grad *= T((float)data_size())/T((float)batch.size());
+	    grad /= sigma2;
+	    grad /= temperature;
+	    grad.add_scaled(q, T(0.5)*alpha);
+
+	    rng.normal(n);
+
+	    v *= (T(1.0f) - friction);
+	    v.add_scaled(grad, -eta);
+	    v.add_scaled(n, noise);
+
+	    q += v;
+	  }
+
+	  {
+	    std::lock_guard<std::mutex> lock(updating_sample);
+	    this->q = q;
+	  }
+
+	  iterations++;
+
+	  if(iterations > BURNIN){
+	    std::lock_guard<std::mutex> lock(solution_lock);
+
+	    if(sum_N > 0){
+	      sum_mean += q;
+	      sum_N++;
+	    }
+	    else{
+	      sum_mean = q;
+	      sum_N++;
+	    }
+
+	    if(store)
+	      store_sample(q);
+	  }
+
+	  while(paused && running){ // pause
+	    std::this_thread::sleep_for(std::chrono::milliseconds(500)); // sleep for 500ms
+	  }
+	}
+    }
   
   
 };
@@ -14,14 +14,17 @@
 
 #include <thread>
 #include <mutex>
+#include <atomic>
 
 #include "vertex.h"
 #include "matrix.h"
 #include "dataset.h"
+#include "minibatch_source.h"
 #include "dinrhiw_blas.h"
 #include "nnetwork.h"
 #include "bayesian_nnetwork.h"
 #include "RNG.h"
+#include "thread_pool.h"
 
 
 namespace whiteice
@@ -32,6 +35,10 @@ namespace whiteice
     	public:
 
 		HMC(const whiteice::nnetwork<T>& net, const whiteice::dataset<T>& ds, bool adaptive=false, T alpha = T(0.5), bool store = true);
+
+		// out-of-core data: U() and Ugrad() read data from the source in background
+		// while calculating, source must exist while the sampler is running
+		HMC(const whiteice::nnetwork<T>& net, const whiteice::minibatch_source<T>& source, bool adaptive=false, T alpha = T(0.5), bool store = true);
 		~HMC();
 
 		bool setTemperature(const T t); // set "temperature" for probability distribution [default T = 1 => no temperature]
@@ -69,6 +76,22 @@ namespace whiteice
 		T getMeanError(unsigned int latestN = 0) const;
 
 		bool getAdaptive() const throw(){ return adaptive; }
+
+		// stores samples as half precision numbers (less memory bandwidth
+		// and memory for long chains), samples are converted back to T
+		// when they are used. changing storage converts stored samples
+		void setFloat16Storage(const bool float16);
+		bool getFloat16Storage() const throw(){ return float16; }
+
+		// stochastic gradient HMC (SGHMC): gradient is estimated from random
+		// minibatches of batchsize samples and friction term compensates the
+		// gradient noise (no Metropolis step). scales to large datasets.
+		// must be set before startSampler()
+		bool setSGHMC(const bool sghmc, const unsigned int batchsize = 256,
+			      const T friction = T(0.05));
+		bool getSGHMC() const throw(){ return sghmc; }
+		unsigned int getSGHMCBatchSize() const throw(){ return batchsize; }
+		T getSGHMCFriction() const throw(){ return friction; }
 	
     	private:
 	        // performs leapfrog operation (keeps probability function constant)
@@ -89,34 +112,73 @@ namespace whiteice
 	
 	        // calculates z-ratio between data likelihood distributions
 	        T zratio(const math::vertex<T>& q1, const math::vertex<T>& q2) const;
+
+	        // number of datapoints
+	        unsigned long long data_size() const;
+
+	        // sum of 0.5*||y - f(x|q)||^2 over all out-of-core data
+	        // or its gradient (if grad is non-null), returns false
+	        // if reading the data or calculating the gradient failed
+	        bool stream_error(const math::vertex<T>& q, T& e, math::vertex<T>* grad,
+				  typename whiteice::nnetwork<T>::workspace& ws) const;
+
+	        // per-thread scratch memory of U() and Ugrad(), parameters q are
+	        // shared by all threads and are not copied to network
+	        struct scratch {
+		  typename whiteice::nnetwork<T>::workspace ws;
+		  math::vertex<T> grad, sumgrad;
+		};
+
+	        // gets thread scratch space (allocated once by startSampler()) or
+	        // local one if another call is already using it
+	        std::vector<scratch>& get_scratch(std::unique_lock<std::mutex>& lock,
+						  std::vector<scratch>& local) const;
+	
+	        mutable std::vector<scratch> scratches;
+	        mutable std::mutex scratch_mutex;
 	
 		whiteice::nnetwork<T> nnet;
-	        const whiteice::dataset<T>& data;
+	        const whiteice::dataset<T>* data;
+	        const whiteice::minibatch_source<T>* source; // out-of-core data (if non-null)
 		math::vertex<T> q;
 		mutable std::mutex updating_sample;
 	
 	        T sigma2;
 	
 	        std::vector< math::vertex<T> > samples;
+	        std::vector< math::float16_vector > halfsamples; // float16 storage
+	        bool float16;
+
+	        // stores sample and copies samples [first, N) (solution_lock must be held)
+	        void store_sample(const math::vertex<T>& s);
+	        unsigned int stored_samples() const;
+	        void copy_samples(const unsigned int first,
+				  std::vector< math::vertex<T> >& out) const;
 
 		T alpha; // prior distribution parameter for neural networks (gaussian prior)
 		T temperature; // temperature parameter for the probability function
 		bool adaptive;
 		bool store;
 
+		bool sghmc; // stochastic gradient HMC
+		unsigned int batchsize;
+		T friction;
+
 		// used to calculate statistics when needed
 		math::vertex<T> sum_mean;
 		// math::matrix<T> sum_covariance;
 		unsigned int sum_N;
 
 		volatile bool running, paused;
+		mutable std::atomic<bool> stream_failed; // U() or Ugrad() didn't see all data
 
-		mutable std::vector<std::thread*> sampling_thread; // threads
+		mutable std::vector<whiteice::thread_pool::job> sampling_thread; // jobs
 		mutable std::mutex solution_lock, start_lock;
 	
 	        whiteice::RNG<T> rng;
 
 		void sampler_loop();
+		void sghmc_loop();
 	};
 
 };
@@ -14,6 +14,9 @@ namespace whiteice
 	{
 		this->adaptive = adaptive;
 		this->storeSamples = storeSamples;
+		this->sghmc = false;
+		this->batchsize = 256;
+		this->friction = T(0.05);
 
 		sum_N = 0;
 		sum_mean.zero();
@@ -62,7 +65,9 @@ namespace whiteice
 
 		try{
 			starting_position(q); // initializes starting position before starting the thread here just to be sure..
-			std::thread* t = new std::thread(&HMC_abstract<T>::sampler_loop, this);
+			std::thread* t = nullptr;
+			if(sghmc) t = new std::thread(&HMC_abstract<T>::sghmc_loop, this);
+			else t = new std::thread(&HMC_abstract<T>::sampler_loop, this);
 			sampling_thread.push_back(t);
 
 			return true;
@@ -84,6 +89,24 @@ namespace whiteice
 	}
   
   
+	template <typename T>
+	bool HMC_abstract<T>::setSGHMC(const bool sghmc, const unsigned int batchsize, const T friction)
+	{
+		std::lock_guard<std::mutex> lock(start_lock);
+
+		if(running) return false;
+		if(batchsize == 0) return false;
+		if(friction <= T(0.0) || friction >= T(1.0)) return false;
+		if(sghmc && has_stochastic_Ugrad() == false) return false;
+
+		this->sghmc = sghmc;
+		this->batchsize = batchsize;
+		this->friction = friction;
+
+		return true;
+	}
+
+
 	template <typename T>
 	bool HMC_abstract<T>::pauseSampler()
 	{
@@ -252,19 +275,12 @@ namespace whiteice
 		// sum_covariance.zero();
 		sum_N = 0;
 
-		// q = location, p = momentum, H(q,p) = hamiltonian
-		math::vertex<T> p; // q is global variable
-
 		{
 			std::lock_guard<std::mutex> lock(updating_sample);
 			// starting_position(q); // random starting position q [ALREADY DONE WHEN THE THREAD STARTS!]
 			q_updated = true;
-
-			p.resize(q.size()); // momentum is initially zero
 		}
 
-		p.zero();
-
 		// epsilon = epsilon0/sqrt(D) in order to keep distance ||x(n+1) - x(n)|| = epsilon0 for all dimensions dim(x) = D
 		T epsilon = T(0.01f); ///math::sqrt(q.size()); .. NOT!!
 		unsigned int L = 20;
@@ -284,8 +300,6 @@ namespace whiteice
 		unsigned int number_of_accepts = 0;
 		const unsigned int EPSILON_LEARNING_ACCEPT_LIMIT = 5;
 		const T MAX_EPSILON = T(1.0f);
-		
-		const bool use_difference = true;
 
 
 		while(running) // keep sampling forever
@@ -297,132 +311,28 @@ namespace whiteice
 				q_overwritten = false; // detect if somebody have changed q during computation
 			}
 
-			rng.normal(p); // Normal distribution
-
-			math::vertex<T> old_q = q;
-			math::vertex<T> current_p = p;
-
-			p -= T(0.5f) * epsilon * Ugrad(q);
-
-			for(unsigned int i=0;i<L;i++){
-				q += epsilon * p;
-				if(i != L-1) p -= epsilon*Ugrad(q);
-			}
-
-			p -= T(0.5f) * epsilon * Ugrad(q);
-
-			p = -p;
-
-			T deltaU = T(0.0);
-
-			if(use_difference == false){
-				T current_U  = U(old_q);
-				T proposed_U = U(q);
-				deltaU = current_U - proposed_U;
-			}
-			else{
-				deltaU = -Udiff(q, old_q);
-#if 0
-				// we approximate difference: deltaU = U(q) - U(q_old) ~ (q-q_old)*grad(U(q_old))
-				auto deltaq = q - old_q;
-				auto gU = Ugrad(old_q);
-				deltaU = (deltaq*gU)[0];
-#endif
-			}
-
-			T current_K  = T(0.0f);
-			T proposed_K = T(0.0f);
-
-			for(unsigned int i=0;i<p.size();i++){
-				current_K  += T(0.5f)*current_p[i]*current_p[i];
-				proposed_K += T(0.5f)*p[i]*p[i];
-			}
-
-			T r = rng.uniform();
-			T p_accept = exp(deltaU+current_K-proposed_K);
+			const bool accepted = iterate(q, epsilon, L, rng, false);
 
-			if(r <= p_accept && !whiteice::math::isnan(p_accept))
 			{
-				// accept (q)
-				{
-					std::lock_guard<std::mutex> lock(updating_sample);
-
-					if(q_overwritten == false){
-						this->q = q; // writes the global q
-					}
-
-					q_updated = true;
-				}
-				// std::cout << "ACCEPT" << std::endl;
-				
-				number_of_accepts++;
-				
-				if(number_of_accepts > EPSILON_LEARNING_ACCEPT_LIMIT){
-				  std::lock_guard<std::mutex> lock(solution_lock);
-				  
-				  if(sum_N > 0){
-				    sum_mean += q;
-				    // sum_covariance += q.outerproduct();
-				    sum_N++;
-				  }
-				  else{
-				    sum_mean = q;
-				    // sum_covariance = q.outerproduct();
-				    sum_N++;
-				  }
-	
-				  if(storeSamples)
-				    samples.push_back(q);
-				}
-
-				if(adaptive){
-					accept_rate++;
-					accept_rate_samples++;
-				}
-			}
-			else{
-				// reject (keep old_q)
-				// printf("REJECT\n");
-				{
-					std::lock_guard<std::mutex> lock(updating_sample);
-					if(q_overwritten == false){
-						this->q = old_q; // writes the global q
-					}
+				std::lock_guard<std::mutex> lock(updating_sample);
 
-					q_updated = true;
-				}
-				
-				
-				if(number_of_accepts > EPSILON_LEARNING_ACCEPT_LIMIT){
-				  std::lock_guard<std::mutex> lock(solution_lock);
-				  
-				  if(sum_N > 0){
-				    sum_mean += q;
-				    // sum_covariance += q.outerproduct();
-				    sum_N++;
-				  }
-				  else{
-				    sum_mean = q;
-				    // sum_covariance = q.outerproduct();
-				    sum_N++;
-				  }
-				  
-				  
-				  if(storeSamples)
-				    samples.push_back(q);
+				if(q_overwritten == false){
+					this->q = q; // writes the global q
 				}
 
-				if(adaptive){
-					// accept_rate;
-					accept_rate_samples++;
-				}
+				q_updated = true;
 			}
 
+			if(accepted)
+				number_of_accepts++;
 
-			updating_sample.unlock();
-
+			if(number_of_accepts > EPSILON_LEARNING_ACCEPT_LIMIT)
+				add_sample(q);
 
 			if(adaptive){
+				if(accepted) accept_rate++;
+				accept_rate_samples++;
+
 				// use accept rate to adapt epsilon
 				// adapt sampling rate every N iteration (sample)
 				if(accept_rate_samples >= 50)
@@ -472,6 +382,159 @@ namespace whiteice
 		}
 
 	}
+
+
+	template <typename T>
+	bool HMC_abstract<T>::iterate(math::vertex<T>& q, const T epsilon, const unsigned int L,
+				      whiteice::RNG<T>& rng, const bool store)
+	{
+		// q = location, p = momentum, H(q,p) = hamiltonian
+		math::vertex<T> p(q.size());
+
+		rng.normal(p); // Normal distribution
+
+		const math::vertex<T> old_q = q;
+		const math::vertex<T> current_p = p;
+
+		p.add_scaled(Ugrad(q), T(-0.5f)*epsilon);
+
+		for(unsigned int i=0;i<L;i++){
+			q.add_scaled(p, epsilon);
+			if(i != L-1) p.add_scaled(Ugrad(q), -epsilon);
+		}
+
+		p.add_scaled(Ugrad(q), T(-0.5f)*epsilon);
+
+		p *= T(-1.0f);
+
+		const T deltaU = -Udiff(q, old_q);
+
+		T current_K  = T(0.0f);
+		T proposed_K = T(0.0f);
+
+		for(unsigned int i=0;i<p.size();i++){
+			current_K  += T(0.5f)*current_p[i]*current_p[i];
+			proposed_K += T(0.5f)*p[i]*p[i];
+		}
+
+		const T r = rng.uniform();
+		const T p_accept = exp(deltaU+current_K-proposed_K);
+
+		const bool accept = (r <= p_accept && !whiteice::math::isnan(p_accept));
+
+		if(!accept)
+			q = old_q; // reject (keep old_q)
+
+		if(store)
+			add_sample(q);
+
+		return accept;
+	}
+
+
+	template <typename T>
+	void HMC_abstract<T>::add_sample(const math::vertex<T>& q)
+	{
+		std::lock_guard<std::mutex> lock(solution_lock);
+
+		if(sum_N > 0){
+			sum_mean += q;
+			// sum_covariance += q.outerproduct();
+			sum_N++;
+		}
+		else{
+			sum_mean = q;
+			// sum_covariance = q.outerproduct();
+			sum_N++;
+		}
+
+		if(storeSamples)
+			samples.push_back(q);
+	}
+
+
+	// stochastic gradient HMC with friction (Chen, Fox, Guestrin 2014):
+	// v <- (1-a)*v - eta*grad U~(q) + N(0, 2*a*eta), q <- q + v
+	// where eta = epsilon^2 (minibatch noise estimate B = 0)
+	template <typename T>
+	void HMC_abstract<T>::sghmc_loop()
+	{
+		samples.clear();
+		sum_mean.zero();
+		sum_N = 0;
+
+		math::vertex<T> q, v, n;
+
+		{
+			std::lock_guard<std::mutex> lock(updating_sample);
+			q_updated = true;
+			q = this->q;
+		}
+
+		const T epsilon = T(0.01f);
+		const T eta = epsilon*epsilon;
+		const T noise = math::sqrt(T(2.0f)*friction*eta);
+		const unsigned int L = 20; // steps between samples
+
+		whiteice::RNG<T> rng;
+
+		v.resize(q.size());
+		n.resize(q.size());
+		rng.normal(v);
+		v *= epsilon;
+
+		unsigned int iterations = 0;
+		const unsigned int BURNIN = 5;
+
+		while(running) // keep sampling forever
+		{
+			{
+				std::lock_guard<std::mutex> lock(updating_sample);
+				q = this->q; // reads the global q
+				q_overwritten = false;
+			}
+
+			for(unsigned int i=0;i<L && running;i++){
+				rng.normal(n);
+
+				v *= (T(1.0f) - friction);
+				v.add_scaled(stochastic_Ugrad(q, batchsize), -eta);
+				v.add_scaled(n, noise);
+
+				q += v;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(updating_sample);
+
+				if(q_overwritten == false)
+					this->q = q; // writes the global q
+
+				q_updated = true;
+			}
+
+			iterations++;
+
+			if(iterations > BURNIN){
+				std::lock_guard<std::mutex> lock(solution_lock);
+
+				if(sum_N > 0){
+					sum_mean += q;
+					sum_N++;
+				}
+				else{
+					sum_mean = q;
+					sum_N++;
+				}
+
+				if(storeSamples)
+					samples.push_back(q);
+			}
+
+			while(paused && running) // pause
+				sleep(1);
+		}
+	}
   
   
 };
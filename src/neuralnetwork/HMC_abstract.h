@@ -14,6 +14,7 @@
 #include "vertex.h"
 #include "matrix.h"
 #include "dinrhiw_blas.h"
+#include "RNG.h"
 
 #include <thread>
 #include <mutex>
@@ -51,6 +52,16 @@ namespace whiteice
 
 		virtual math::vertex<T> Ugrad(const math::vertex<T>& q) = 0;
 
+		// noisy gradient of U(q) estimated using batchsize datapoints,
+		// used by SGHMC sampling. inheritor providing it must also
+		// return true from has_stochastic_Ugrad()
+		virtual math::vertex<T> stochastic_Ugrad(const math::vertex<T>& q, const unsigned int batchsize)
+		{
+			return Ugrad(q);
+		}
+
+		virtual bool has_stochastic_Ugrad() const { return false; }
+
 		// a starting point q for the sampler (may not be random)
 		virtual void starting_position(math::vertex<T>& q) const = 0;
 
@@ -79,8 +90,29 @@ namespace whiteice
 
 		bool getAdaptive() const throw(){ return adaptive; }
 
+		// single HMC iteration (L leapfrog steps and Metropolis test) started
+		// from q without the sampler thread: q is replaced by the next sample
+		// which is also stored if store is true. returns true if the proposal
+		// was accepted. used by parallel tempering which keeps replica states
+		bool iterate(math::vertex<T>& q, const T epsilon, const unsigned int L,
+			     whiteice::RNG<T>& rng, const bool store);
+
+		// stochastic gradient HMC (SGHMC): uses minibatch gradient
+		// stochastic_Ugrad(q, batchsize) and friction term compensating the gradient
+		// noise instead of Metropolis step. must be set before startSampler().
+		// fails if inheritor doesn't implement stochastic_Ugrad()
+		bool setSGHMC(const bool sghmc, const unsigned int batchsize = 256,
+			      const T friction = T(0.05));
+		bool getSGHMC() const throw(){ return sghmc; }
+		unsigned int getSGHMCBatchSize() const throw(){ return batchsize; }
+		T getSGHMCFriction() const throw(){ return friction; }
+
     	private:
 
+		bool sghmc; // stochastic gradient HMC
+		unsigned int batchsize;
+		T friction;
+
 		bool adaptive;
 
 		bool storeSamples;
@@ -101,7 +133,10 @@ namespace whiteice
 		mutable std::vector<std::thread*> sampling_thread;
 		mutable std::mutex solution_lock, start_lock;
 
+		void add_sample(const math::vertex<T>& q);
+
 		void sampler_loop(); // worker thread loop
+		void sghmc_loop();   // SGHMC worker thread loop
 	};
 
 
@@ -3,6 +3,7 @@
 #include "deep_ica_network_priming.h"
 
 #include "eig.h"
+#include "Log.h"
 
 
 namespace whiteice
@@ -10,15 +11,17 @@ namespace whiteice
 
   template <typename T>
   LBFGS_nnetwork<T>::LBFGS_nnetwork(const nnetwork<T>& nn, const dataset<T>& d, bool overfit, bool negativefeedback) :
-    whiteice::math::LBFGS<T>(overfit), net(nn), data(d)
+    whiteice::math::LBFGS<T>(overfit), net(nn), data(&d)
   {
 	  this->negativefeedback = negativefeedback;
+	  this->source = nullptr;
+	  this->ntrain = 0;
 
 	  // divides data to to training and testing sets
 	  ///////////////////////////////////////////////
 
-	  dtrain = data;
-	  dtest  = data;
+	  dtrain = d;
+	  dtest  = d;
     
 	  dtrain.clearData(0);
 	  dtrain.clearData(1);
@@ -26,19 +29,19 @@ namespace whiteice
 	  dtest.clearData(1);
     
 
-	  for(unsigned int i=0;i<data.size(0);i++){
+	  for(unsigned int i=0;i<d.size(0);i++){
 		  const unsigned int r = (rand() & 1);
 
 		  if(r == 0){
-			  math::vertex<T> in  = data.access(0,i);
-			  math::vertex<T> out = data.access(1,i);
+			  math::vertex<T> in  = d.access(0,i);
+			  math::vertex<T> out = d.access(1,i);
 
 			  dtrain.add(0, in,  true);
 			  dtrain.add(1, out, true);
 		  }
 		  else{
-			  math::vertex<T> in  = data.access(0,i);
-			  math::vertex<T> out = data.access(1,i);
+			  math::vertex<T> in  = d.access(0,i);
+			  math::vertex<T> out = d.access(1,i);
 	
 			  dtest.add(0, in,  true);
 			  dtest.add(1, out, true);
@@ -49,12 +52,28 @@ namespace whiteice
 	  // in such a small cases (very little data) we just use
 	  // all the data both for training and testing and overfit
 	  if(dtrain.size(0) == 0 || dtest.size(0) == 0){
-		  dtrain = data;
-		  dtest  = data;
+		  dtrain = d;
+		  dtest  = d;
 	  }
 
   }
 
+
+  template <typename T>
+  LBFGS_nnetwork<T>::LBFGS_nnetwork(const nnetwork<T>& nn,
+				    const minibatch_source<T>& s,
+				    bool overfit, bool negativefeedback) :
+    whiteice::math::LBFGS<T>(overfit), net(nn), data(nullptr)
+  {
+    // negative feedback heuristic needs data in memory
+    this->negativefeedback = false;
+    this->source = &s;
+    
+    // the last 10% of the data is used for testing
+    // (or all data if there is very little data)
+    ntrain = s.size() - s.size()/10;
+  }
+
   
   template <typename T>
   LBFGS_nnetwork<T>::~LBFGS_nnetwork()
@@ -65,37 +84,40 @@ namespace whiteice
   template <typename T>
   T LBFGS_nnetwork<T>::getError(const math::vertex<T>& x) const
   {
+    if(source){
+      const unsigned long long N = source->size();
+      const unsigned long long begin = (ntrain < N) ? ntrain : 0;
+      
+      if(N == 0) return T(0.0f);
+      
+      return stream_error(x, begin, N, nullptr) / T((float)(N - begin));
+    }
+    
     T e = T(0.0f);
     
-#pragma omp parallel shared(e)
-    {
-      whiteice::nnetwork<T> nnet(this->net);
+    const unsigned int SLOTS = thread_pool::global().concurrency();
+    std::vector< whiteice::nnetwork<T> > nnets(SLOTS, this->net);
+    std::vector<T> esum(SLOTS, T(0.0f));
+    
+    for(auto& nnet : nnets)
       nnet.importdata(x);
-      
-      math::vertex<T> err;
-      T esum = T(0.0f);
-      
-      
-      // E = SUM 0.5*e(i)^2
-#pragma omp for nowait schedule(dynamic)
-      for(unsigned int i=0;i<dtest.size(0);i++){
-	// std::cout << "data in  = " << dtest.access(0, i) << std::endl;
-	// std::cout << "data out = " << dtest.access(1, i) << std::endl;
+    
+    // E = SUM 0.5*e(i)^2
+    thread_pool::global().parallel_for(0, dtest.size(0), 1,
+      [&](unsigned int slot, unsigned long long i)
+      {
+	whiteice::nnetwork<T>& nnet = nnets[slot];
 	
 	nnet.input() = dtest.access(0, i);
 	nnet.calculate(false);
-	err = dtest.access(1, i) - nnet.output();
+	math::vertex<T> err = dtest.access(1, i) - nnet.output();
 	
 	err = (err*err);
-	esum += T(0.5f)*err[0];
-      }
-
-#pragma omp critical
-      {
-	e += esum;
-      }
-
-    }
+	esum[slot] += T(0.5f)*err[0];
+      }, SLOTS);
+    
+    for(const auto& es : esum)
+      e += es;
     
     e /= T( (float)dtest.size(0) ); // per N
     
@@ -106,32 +128,41 @@ namespace whiteice
   template <typename T>
   T LBFGS_nnetwork<T>::U(const math::vertex<T>& x) const
   {
+    if(source){
+      T e = stream_error(x, 0, ntrain, nullptr);
+      
+      T alpha = T(0.01);   // regularizer exp(-0.5*||w||^2) term, w ~ Normal(0,I)
+      e += (T(0.5)*alpha*(x*x))[0];
+      
+      if(ntrain > 0) e /= T((float)ntrain);
+      
+      return e;
+    }
+    
     T e = T(0.0f);
     
-#pragma omp parallel
-    {
-      whiteice::nnetwork<T> nnet(this->net);
-      
+    const unsigned int SLOTS = thread_pool::global().concurrency();
+    std::vector< whiteice::nnetwork<T> > nnets(SLOTS, this->net);
+    std::vector<T> esum(SLOTS, T(0.0f));
+    
+    for(auto& nnet : nnets)
       nnet.importdata(x);
-      math::vertex<T> err;
-      T esum = T(0.0f);
     
-      // E = SUM 0.5*e(i)^2
-#pragma omp for nowait schedule(dynamic)
-      for(unsigned int i=0;i<dtrain.size(0);i++){
+    // E = SUM 0.5*e(i)^2
+    thread_pool::global().parallel_for(0, dtrain.size(0), 1,
+      [&](unsigned int slot, unsigned long long i)
+      {
+	whiteice::nnetwork<T>& nnet = nnets[slot];
+	
 	nnet.input() = dtrain.access(0, i);
 	nnet.calculate(false);
-	err = dtrain.access(1, i) - nnet.output();
+	math::vertex<T> err = dtrain.access(1, i) - nnet.output();
 	err = (err*err); // /T(dtrain.size(0));
-	esum += T(0.5f)*err[0];
-      }
-      
-#pragma omp critical
-      {
-	e += esum;
-      }
-      
-    }
+	esum[slot] += T(0.5f)*err[0];
+      }, SLOTS);
+    
+    for(const auto& es : esum)
+      e += es;
 
 #if 1    
     {
@@ -154,6 +185,17 @@ namespace whiteice
     sumgrad = x;
     sumgrad.zero();
 
+    if(source){
+      stream_error(x, 0, ntrain, &sumgrad);
+      
+      T alpha = T(0.01f);
+      sumgrad.add_scaled(x, alpha);
+      
+      if(ntrain > 0) sumgrad /= T((float)ntrain);
+      
+      return sumgrad;
+    }
+
 #if 0
     math::matrix<T> sigma2;
     sigma2.resize(net.output_size(), net.output_size());
@@ -164,53 +206,41 @@ namespace whiteice
 #endif
 
     // positive phase/gradient
-#pragma omp parallel shared(sumgrad)
     {
-      whiteice::nnetwork<T> nnet(this->net);
-      nnet.importdata(x);
-      
-      math::vertex<T> sgrad, grad, err;
-
-#if 0
-      math::matrix<T> sum_sigma2;
-      sum_sigma2.resize(net.output_size(), net.output_size());
-      sum_sigma2.zero();
-      
-      math::vertex<T> sum_m(net.output_size());
-      sum_m.zero();
-#endif
+      const unsigned int SLOTS = thread_pool::global().concurrency();
+      std::vector< whiteice::nnetwork<T> > nnets(SLOTS, this->net);
+      std::vector< math::vertex<T> > sgrad(SLOTS), grad(SLOTS);
       
-      sgrad = x;
-      sgrad.zero();
-
-#pragma omp for nowait schedule(dynamic)
-      for(unsigned int i=0;i<dtrain.size(0);i++){
-	nnet.input() = dtrain.access(0, i);
-	nnet.calculate(true);
-	err = dtrain.access(1,i) - nnet.output();
-
-	if(nnet.gradient(err, grad) == false){
-	  std::cout << "gradient failed." << std::endl;
-	  assert(0); // FIXME
-	}
-
-#if 0
-	sum_sigma2 += err.outerproduct(err);
-	// sum_m += err;
-#endif
-	
-	sgrad += grad; // /T(dtrain.size(0));
+      for(unsigned int k=0;k<SLOTS;k++){
+	nnets[k].importdata(x);
+	sgrad[k] = x;
+	sgrad[k].zero();
       }
       
-#pragma omp critical
-      {
-	sumgrad += sgrad;
-#if 0
-	sigma2 += sum_sigma2;
-	m += sum_m;
-#endif
+      try{
+	thread_pool::global().parallel_for(0, dtrain.size(0), 1,
+	  [&](unsigned int slot, unsigned long long i)
+	  {
+	    whiteice::nnetwork<T>& nnet = nnets[slot];
+	    
+	    nnet.input() = dtrain.access(0, i);
+	    nnet.calculate(true);
+	    math::vertex<T> err = dtrain.access(1,i) - nnet.output();
+	    
+	    if(nnet.gradient(err, grad[slot]) == false)
+	      throw std::runtime_error("LBFGS_nnetwork: calculating gradient failed");
+	    
+	    sgrad[slot] += grad[slot]; // /T(dtrain.size(0));
+	  }, SLOTS);
       }
-
+      catch(std::exception& e){
+	// parallel_for() rethrows exception of a worker, LBFGS stops
+	whiteice::logging.error(e.what());
+	throw;
+      }
+      
+      for(const auto& g : sgrad)
+	sumgrad += g;
     }
 
 #if 0
@@ -300,7 +330,7 @@ namespace whiteice
   template <typename T>
   bool LBFGS_nnetwork<T>::heuristics(math::vertex<T>& x) const
   {
-    if(negativefeedback){
+    if(negativefeedback && source == nullptr){
       whiteice::nnetwork<T> nnet(this->net);
       nnet.importdata(x);
       
@@ -314,6 +344,59 @@ namespace whiteice
   }
   
   
+  template <typename T>
+  T LBFGS_nnetwork<T>::stream_error(const math::vertex<T>& w,
+				    const unsigned long long begin,
+				    const unsigned long long end,
+				    math::vertex<T>* grad) const
+  {
+    whiteice::nnetwork<T> nnet(this->net);
+    nnet.importdata(w);
+    
+    // data is read in order using batched (GEMM) calculations
+    whiteice::minibatch_prefetcher<T> batches(*source, 256, false, 65536, begin, end);
+    whiteice::minibatch<T> batch;
+    
+    math::matrix<T> out;
+    math::vertex<T> g;
+    T e = T(0.0f);
+    
+    if(grad){
+      grad->resize(nnet.exportdatasize());
+      grad->zero();
+    }
+    
+    while(batches.next(batch)){
+      if(grad){
+	if(nnet.gradient(batch.input, batch.output, g) == false){
+	  whiteice::logging.error("LBFGS_nnetwork: calculating gradient failed");
+	  throw std::runtime_error("LBFGS_nnetwork: calculating gradient failed");
+	}
+	
+	(*grad) += g;
+      }
+      else{
+	nnet.calculate(batch.input, out);
+	
+	for(unsigned int n=0;n<out.ysize();n++){
+	  for(unsigned int k=0;k<out.xsize();k++){
+	    const T err = batch.output(n,k) - out(n,k);
+	    e += T(0.5f)*err*err;
+	  }
+	}
+      }
+    }
+    
+    if(batches.good() == false){
+      // partial sums cannot be used as the error or the gradient
+      whiteice::logging.error("LBFGS_nnetwork: reading data source failed");
+      throw std::runtime_error("LBFGS_nnetwork: reading data source failed");
+    }
+    
+    return e;
+  }
+  
+  
   template class LBFGS_nnetwork< float >;
   template class LBFGS_nnetwork< double >;
   template class LBFGS_nnetwork< math::blas_real<float> >;
@@ -10,6 +10,7 @@
 #include "LBFGS.h"
 #include "nnetwork.h"
 #include "dataset.h"
+#include "minibatch_source.h"
 #include "vertex.h"
 
 #include "RNG.h"
@@ -22,6 +23,12 @@ namespace whiteice
     public:
       LBFGS_nnetwork(const nnetwork<T>& net,
 		     const dataset<T>& d, bool overfit=false, bool negativefeedback=false);
+
+      // out-of-core data: the last 10% of source's samples are used
+      // as testing data, source must exist during optimization
+      LBFGS_nnetwork(const nnetwork<T>& net,
+		     const minibatch_source<T>& source,
+		     bool overfit=false, bool negativefeedback=false);
     
       virtual ~LBFGS_nnetwork();
     
@@ -42,8 +49,20 @@ namespace whiteice
       T getError(const math::vertex<T>& x) const;
 
     private:
+      // sum of 0.5*||y - f(x|w)||^2 over source samples [begin,end)
+      // or its gradient (if grad is non-null) which is read in the background.
+      // throws std::runtime_error if reading data or calculating gradient fails
+      T stream_error(const math::vertex<T>& w,
+		     const unsigned long long begin,
+		     const unsigned long long end,
+		     math::vertex<T>* grad) const;
+      
       const nnetwork<T> net;
-      const dataset<T>& data;
+      const dataset<T>* data;
+      
+      // out-of-core data, samples [0,ntrain) are training data
+      const minibatch_source<T>* source;
+      unsigned long long ntrain;
     
       bool negativefeedback;
     
@@ -24,6 +24,8 @@ namespace whiteice
       best_pure_error = T(INFINITY);
       iterations = 0;
       data = NULL;
+      source = NULL;
+      ntrain = 0;
       NTHREADS = 0;
       thread_is_running = 0;
       
@@ -33,6 +35,12 @@ namespace whiteice
 
       dropout = false;
 
+      hogwild = false;
+      hogwild_batchsize = 64;
+      hogwild_threads = 0;
+      hogwild_lrate = 0.01;
+      hogwild_done = false;
+
       running = false;
       nn = NULL;
 
@@ -50,8 +58,10 @@ namespace whiteice
     {
       best_error = grad.best_error;
       best_pure_error = grad.best_pure_error;
-      iterations = grad.iterations;
+      iterations = grad.iterations.load();
       data = grad.data;
+      source = grad.source;
+      ntrain = grad.ntrain;
       NTHREADS = grad.NTHREADS;
       MAXITERS = grad.MAXITERS;      
       
@@ -62,6 +72,12 @@ namespace whiteice
       dropout = grad.dropout;
       regularizer = grad.regularizer;
 
+      hogwild = grad.hogwild;
+      hogwild_batchsize = grad.hogwild_batchsize;
+      hogwild_threads = 0;
+      hogwild_lrate = 0.01;
+      hogwild_done = false;
+
       running = grad.running;
 
       bestx = grad.bestx;
@@ -88,9 +104,8 @@ namespace whiteice
       if(running){
 	running = false;
 	for(unsigned int i=0;i<optimizer_thread.size();i++){
-	  optimizer_thread[i]->join();
-	  delete optimizer_thread[i];
-	  optimizer_thread[i] = nullptr;
+	  try{ optimizer_thread[i].join(); }
+	  catch(...){ } // destructor must not throw
 	}
       }
 
@@ -141,6 +156,8 @@ namespace whiteice
       
       
       this->data = &data;
+      this->source = NULL;
+      this->ntrain = 0;
       this->NTHREADS = NTHREADS;
       this->MAXITERS = MAXITERS;
       best_error = T(INFINITY);
@@ -162,12 +179,50 @@ namespace whiteice
       
       this->dropout = dropout;
 
+      if(hogwild){
+	// all threads share the same training/testing split and parameters
+	hogwild_train = data;
+	hogwild_test  = data;
+
+	hogwild_train.clearData(0);
+	hogwild_train.clearData(1);
+	hogwild_test.clearData(0);
+	hogwild_test.clearData(1);
+
+	while(hogwild_train.size(0) == 0 || hogwild_test.size(0) == 0){
+	  hogwild_train.clearData(0);
+	  hogwild_train.clearData(1);
+	  hogwild_test.clearData(0);
+	  hogwild_test.clearData(1);
+
+	  for(unsigned int i=0;i<data.size(0);i++){
+	    whiteice::dataset<T>& d = (rand() & 1) ? hogwild_test : hogwild_train;
+	    
+	    d.add(0, data.access(0,i), true);
+	    d.add(1, data.access(1,i), true);
+	  }
+	}
+
+	nnetwork<T> net(nn);
+
+	if(initiallyUseNN == false){
+	  net.randomize();
+	  if(heuristics) normalize_weights_to_unity(net);
+	}
+
+	net.exportdata(hogwild_x);
+	
+	hogwild_threads = 0;
+	hogwild_lrate = 0.01;
+	hogwild_done = false;
+      }
+
       optimizer_thread.resize(NTHREADS);
       
       for(unsigned int i=0;i<optimizer_thread.size();i++){
 	optimizer_thread[i] =
-	  new thread(std::bind(&NNGradDescent<T>::optimizer_loop,
-			       this));
+	  whiteice::thread_pool::global().start(std::bind(&NNGradDescent<T>::optimizer_loop,
+							  this));
       }
 
       {
@@ -184,6 +239,96 @@ namespace whiteice
 
       return true;
     }
+
+
+    template <typename T>
+    bool NNGradDescent<T>::startOptimize(const whiteice::minibatch_source<T>& source,
+					 const whiteice::nnetwork<T>& nn,
+					 unsigned int NTHREADS,
+					 unsigned int MAXITERS,
+					 bool dropout,
+					 bool initiallyUseNN)
+    {
+      if(source.good() == false) return false;
+
+      // need at least 10 datapoints
+      if(source.size() <= 10) return false;
+
+      if(source.input_size() != nn.input_size() ||
+	 source.output_size() != nn.output_size())
+	return false;
+
+      start_lock.lock();
+
+      {
+	std::lock_guard<std::mutex> lock(thread_is_running_mutex);
+	if(thread_is_running > 0){
+	  start_lock.unlock();
+	  return false;
+	}
+      }
+
+      // the last 10% of data is testing data
+      this->data = NULL;
+      this->source = &source;
+      this->ntrain = source.size() - source.size()/10;
+      this->NTHREADS = NTHREADS;
+      this->MAXITERS = MAXITERS;
+      best_error = T(INFINITY);
+      best_pure_error = T(INFINITY);
+      iterations = 0;
+      running = true;
+      thread_is_running = 0;
+
+      {
+	std::lock_guard<std::mutex> lock(first_time_lock);
+	// first thread uses weights from user supplied NN
+	first_time = initiallyUseNN;
+      }
+
+      this->nn = new nnetwork<T>(nn); // copies network (settings)
+      nn.exportdata(bestx);
+      best_error = getError(nn, source, ntrain, source.size());
+      best_pure_error = getError(nn, source, ntrain, source.size(), false);
+
+      this->dropout = dropout;
+
+      optimizer_thread.resize(NTHREADS);
+
+      for(unsigned int i=0;i<optimizer_thread.size();i++){
+	optimizer_thread[i] =
+	  whiteice::thread_pool::global().start(std::bind(&NNGradDescent<T>::optimizer_loop,
+							  this));
+      }
+
+      {
+	std::unique_lock<std::mutex> lock(thread_is_running_mutex);
+
+	while(thread_is_running == 0)
+	  thread_is_running_cond.wait(lock);
+      }
+
+      start_lock.unlock();
+
+      return true;
+    }
+    
+    template <typename T>
+    bool NNGradDescent<T>::setHogwild(const bool hogwild, const unsigned int batchsize)
+    {
+      if(batchsize == 0) return false;
+      
+      std::lock_guard<std::mutex> lock1(start_lock);
+      std::lock_guard<std::mutex> lock2(thread_is_running_mutex);
+
+      if(thread_is_running > 0) return false;
+
+      this->hogwild = hogwild;
+      this->hogwild_batchsize = batchsize;
+
+      return true;
+    }
+
     
     template <typename T>
     bool NNGradDescent<T>::isRunning()
@@ -288,21 +433,16 @@ namespace whiteice
     {
       T error = T(0.0);
       
-      // calculates initial error
-#pragma omp parallel
-      {
-	T esum = T(0.0f);
-	
-	const whiteice::nnetwork<T>& nnet = net;
-	math::vertex<T> err;
-
-	// calculates error from the testing dataset
-#pragma omp for nowait schedule(dynamic)	    	    
-	for(unsigned int i=0;i<dtest.size(0);i++){
-	  math::vertex<T> out;
+      // calculates error from the testing dataset
+      std::vector<T> esum(thread_pool::global().concurrency(), T(0.0f));
+      
+      thread_pool::global().parallel_for(0, dtest.size(0), 1,
+	[&](unsigned int slot, unsigned long long i)
+	{
+	  math::vertex<T> out, err;
 	  const auto& doi = dtest.access(1, i);
 	  
-	  nnet.calculate(dtest.access(0, i), out);
+	  net.calculate(dtest.access(0, i), out);
 
 	  if(errorTerms == false){
 	    err = doi - out;
@@ -318,16 +458,62 @@ namespace whiteice
 	    }
 	  }
 
-	  for(unsigned int i=0;i<err.size();i++)
-	    esum += T(0.5)*(err[i]*err[i]);
-	}
-	
-	esum /= T((float)dtest.size(0));
-	
-#pragma omp critical
-	{
-	  error += esum;
+	  for(unsigned int k=0;k<err.size();k++)
+	    esum[slot] += T(0.5)*(err[k]*err[k]);
+	}, esum.size());
+
+      for(const auto& e : esum)
+	error += e;
+      
+      error /= T((float)dtest.size(0));
+
+      if(regularize){
+	whiteice::math::vertex<T> w;
+
+	net.exportdata(w);
+
+	error += regularizer * T(0.5) * (w*w)[0];
+      }
+
+      return error;
+    }
+
+
+    template <typename T>
+    T NNGradDescent<T>::getError(const whiteice::nnetwork<T>& net,
+				 const whiteice::minibatch_source<T>& src,
+				 const unsigned long long begin,
+				 const unsigned long long end,
+				 bool regularize)
+    {
+      T error = T(0.0);
+
+      {
+	// reads data in order (no shuffling) using batched calculations
+	whiteice::minibatch_prefetcher<T> batches(src, 256, false, 65536, begin, end);
+	whiteice::minibatch<T> batch;
+	math::matrix<T> out;
+
+	while(batches.next(batch)){
+	  net.calculate(batch.input, out);
+
+	  for(unsigned int n=0;n<batch.output.ysize();n++){
+	    for(unsigned int k=0;k<batch.output.xsize();k++){
+	      // NaNs are used to signal as not used fields/dimensions
+	      if(errorTerms && whiteice::math::isnan(batch.output(n,k)))
+		continue;
+
+	      const T e = batch.output(n,k) - out(n,k);
+	      error += T(0.5)*e*e;
+	    }
+	  }
 	}
+
+	if(batches.good() == false)
+	  whiteice::logging.error("NNGradDescent: reading data source failed");
+
+	if(end > begin)
+	  error /= T((float)(end - begin));
       }
 
       if(regularize){
@@ -369,6 +555,16 @@ namespace whiteice
 #endif	
       }
 
+      if(source != NULL){
+	optimizer_loop_stream(); // data is not in memory
+	return;
+      }
+
+      if(hogwild){
+	optimizer_loop_hogwild();
+	return;
+      }
+
       
       // 1. divides data to to training and testing sets
       ///////////////////////////////////////////////////
@@ -435,7 +631,7 @@ namespace whiteice
 
 	{
 	  char buffer[128];
-	  snprintf(buffer, 128, "NNGradDescent: %d/%d reset/fresh neural network", iterations, MAXITERS);
+	  snprintf(buffer, 128, "NNGradDescent: %d/%d reset/fresh neural network", iterations.load(), MAXITERS);
 	  whiteice::logging.info(buffer);
 	}
 
@@ -532,48 +728,50 @@ namespace whiteice
 	    sumgrad.resize(nn->exportdatasize());
 	    sumgrad.zero();
 
-#pragma omp parallel shared(sumgrad)
 	    {
-	      T ninv = T(1.0f/dtrain.size(0));
-	      math::vertex<T> sgrad, grad;
-	      sgrad.resize(nn->exportdatasize());
-	      sgrad.zero();
-
-	      whiteice::nnetwork<T> nnet(*nn);
-	      math::vertex<T> err;
+	      const T ninv = T(1.0f/dtrain.size(0));
+	      const unsigned int SLOTS = thread_pool::global().concurrency();
 	      
-#pragma omp for nowait schedule(dynamic)
-	      for(unsigned int i=0;i<dtrain.size(0);i++){
-
-		if(dropout) nnet.setDropOut();
-		
-		nnet.input() = dtrain.access(0, i);
-		nnet.calculate(true);
-
-		if(errorTerms == false){
-		  err = dtrain.access(1,i) - nnet.output();
-		}
-		else{
-		  const auto& doi = dtrain.access(1,i);
-		  err.resize(doi.size());
-		  err.zero();
-		  
-		  for(unsigned int k=0;k<doi.size();k++)
-		    if(whiteice::math::isnan(doi[k]) == false)
-		      err[k] = doi[k] - nnet.output()[k];
-		}
-		
-		if(nnet.gradient(err, grad) == false)
-		  std::cout << "gradient failed." << std::endl;
-		
-		sgrad += ninv*grad;
-	      }
-
-#pragma omp critical
-	      {
-		sumgrad += sgrad;
+	      // each slot has its own copy of the network (dropout changes it)
+	      std::vector< whiteice::nnetwork<T> > nnets(SLOTS, *nn);
+	      std::vector< math::vertex<T> > sgrad(SLOTS), grad(SLOTS), err(SLOTS);
+	      
+	      for(auto& g : sgrad){
+		g.resize(nn->exportdatasize());
+		g.zero();
 	      }
 	      
+	      thread_pool::global().parallel_for(0, dtrain.size(0), 1,
+		[&](unsigned int slot, unsigned long long i)
+		{
+		  whiteice::nnetwork<T>& nnet = nnets[slot];
+		  
+		  if(dropout) nnet.setDropOut();
+		  
+		  nnet.input() = dtrain.access(0, i);
+		  nnet.calculate(true);
+		  
+		  if(errorTerms == false){
+		    err[slot] = dtrain.access(1,i) - nnet.output();
+		  }
+		  else{
+		    const auto& doi = dtrain.access(1,i);
+		    err[slot].resize(doi.size());
+		    err[slot].zero();
+		    
+		    for(unsigned int k=0;k<doi.size();k++)
+		      if(whiteice::math::isnan(doi[k]) == false)
+			err[slot][k] = doi[k] - nnet.output()[k];
+		  }
+		  
+		  if(nnet.gradient(err[slot], grad[slot]) == false)
+		    std::cout << "gradient failed." << std::endl;
+		  
+		  sgrad[slot] += ninv*grad[slot];
+		}, SLOTS);
+
+	      for(const auto& g : sgrad)
+		sumgrad += g;
 	    }
 
 	    {
@@ -581,7 +779,7 @@ namespace whiteice
 	      double tmp = 0.0;
 	      whiteice::math::convert(tmp, sumgrad.norm());
 	      
-	      snprintf(buffer, 80, "NNGradDescent: %d/%d gradient norm: %f", iterations, MAXITERS, tmp);
+	      snprintf(buffer, 80, "NNGradDescent: %d/%d gradient norm: %f", iterations.load(), MAXITERS, tmp);
 	      whiteice::logging.info(buffer);
 	    }
 
@@ -654,7 +852,7 @@ namespace whiteice
 		whiteice::math::convert(tmp4, ratio);
 		whiteice::math::convert(tmp3, lrate);
 		
-		snprintf(buffer, 128, "NNGradDescent: %d/%d linesearch error: %f delta-error: %f ratio: %f lrate: %e", iterations, MAXITERS, tmp1, tmp2, tmp4, tmp3);
+		snprintf(buffer, 128, "NNGradDescent: %d/%d linesearch error: %f delta-error: %f ratio: %f lrate: %e", iterations.load(), MAXITERS, tmp1, tmp2, tmp4, tmp3);
 		whiteice::logging.info(buffer);
 	      }
 	    }
@@ -668,7 +866,7 @@ namespace whiteice
 	      whiteice::math::convert(tmp4, ratio);
 	      whiteice::math::convert(tmp3, lrate);
 	      
-	      snprintf(buffer, 128, "NNGradDescent: %d/%d linesearch STOP error: %f delta-error: %f ratio: %f lrate: %e", iterations, MAXITERS, tmp1, tmp2, tmp4, tmp3);
+	      snprintf(buffer, 128, "NNGradDescent: %d/%d linesearch STOP error: %f delta-error: %f ratio: %f lrate: %e", iterations.load(), MAXITERS, tmp1, tmp2, tmp4, tmp3);
 	      whiteice::logging.info(buffer);
 	    }
 	    
@@ -738,6 +936,297 @@ namespace whiteice
     }
 
 
+
+    template <typename T>
+    void NNGradDescent<T>::optimizer_loop_stream()
+    {
+      // source samples [0,ntrain) are training data and [ntrain,size) testing data
+      const unsigned long long N = source->size();
+      const unsigned int BATCHSIZE = 256;
+      
+      {
+	std::lock_guard<std::mutex> lock(thread_is_running_mutex);
+	thread_is_running++;
+	thread_is_running_cond.notify_all();
+      }
+
+      // acquires lock temporally to wait for startOptimizer() to finish
+      {
+	start_lock.lock();
+	start_lock.unlock();
+      }
+
+      // shuffled minibatches of training data are read in background
+      whiteice::minibatch_prefetcher<T> batches(*source, BATCHSIZE, true, 65536, 0, ntrain);
+      whiteice::minibatch<T> batch;
+      
+      
+      while(running && iterations < MAXITERS){
+	// keep looking for solution forever
+	
+	// starting location for neural network
+	std::unique_ptr< nnetwork<T> > nn(new nnetwork<T>(*(this->nn)));
+
+	{
+	  char buffer[128];
+	  snprintf(buffer, 128, "NNGradDescent: %d/%d reset/fresh neural network (out-of-core data)", iterations.load(), MAXITERS);
+	  whiteice::logging.info(buffer);
+	}
+
+	{
+	  std::lock_guard<std::mutex> lock(first_time_lock);
+
+	  // deep pretraining needs dataset in memory and is not used
+	  if(first_time == false){
+	    nn->randomize();
+
+	    if(heuristics)
+	      normalize_weights_to_unity(*nn);
+	  }
+	  else{
+	    first_time = false;
+	  }
+	}
+
+	math::vertex<T> weights, w0, grad;
+	math::matrix<T> out;
+	
+	nn->exportdata(w0);
+	
+	T error = getError(*nn, *source, ntrain, N);
+	T prev_error = error;
+	T lrate = T(0.01f);
+
+	do{
+	  // one epoch of minibatch gradient descent
+	  weights = w0;
+	  whiteice::nnetwork<T> nnet(*nn);
+	  
+	  while(running && batches.next(batch)){
+	    nnet.importdata(weights);
+	    
+	    if(dropout) nnet.setDropOut();
+
+	    if(errorTerms){
+	      // NaN outputs are not used: sets them to network's outputs (zero error)
+	      nnet.calculate(batch.input, out);
+
+	      for(unsigned int n=0;n<batch.output.ysize();n++)
+		for(unsigned int k=0;k<batch.output.xsize();k++)
+		  if(whiteice::math::isnan(batch.output(n,k)))
+		    batch.output(n,k) = out(n,k);
+	    }
+
+	    if(nnet.gradient(batch.input, batch.output, grad) == false){
+	      whiteice::logging.error("NNGradDescent: gradient failed");
+	      break;
+	    }
+	    
+	    grad *= T(1.0f/batch.size());
+	    grad.add_scaled(weights, regularizer);
+	    
+	    weights.add_scaled(grad, -lrate);
+	  }
+
+	  if(batches.good() == false){
+	    whiteice::logging.error("NNGradDescent: reading data source failed");
+	    running = false;
+	  }
+
+	  // cancellation point
+	  if(running == false){
+	    std::lock_guard<std::mutex> lock(thread_is_running_mutex);
+	    thread_is_running--;
+	    thread_is_running_cond.notify_all();
+	    return; // cancels execution
+	  }
+	  
+	  nn->importdata(weights);
+	  
+	  // dropout-trained weights are scaled before using the network
+	  whiteice::nnetwork<T> enet(*nn);
+	  if(dropout) enet.removeDropOut();
+	  
+	  error = getError(enet, *source, ntrain, N);
+	  
+	  if(error > prev_error){
+	    // epoch increased error: goes back and reduces learning rate
+	    nn->importdata(w0);
+	    error = prev_error;
+	    lrate *= T(0.50);
+	  }
+	  else{
+	    w0 = weights;
+	    prev_error = error;
+
+	    solution_lock.lock();
+	    
+	    if(error < best_error){
+	      // improvement (smaller error with early stopping)
+	      best_error = error;
+	      best_pure_error = getError(enet, *source, ntrain, N, false);
+	      enet.exportdata(bestx);
+	    }
+	    
+	    solution_lock.unlock();
+	  }
+
+	  {
+	    char buffer[128];
+	    double tmp1, tmp2;
+	    whiteice::math::convert(tmp1, error);
+	    whiteice::math::convert(tmp2, lrate);
+	    
+	    snprintf(buffer, 128, "NNGradDescent: %d/%d epoch error: %f lrate: %e", iterations.load(), MAXITERS, tmp1, tmp2);
+	    whiteice::logging.info(buffer);
+	  }
+	  
+	  iterations++;
+	}
+	while(error > T(0.00001f) && 
+	      lrate >= T(10e-30) && 
+	      iterations < MAXITERS && 
+	      running);
+      }
+
+      
+      std::lock_guard<std::mutex> lock(thread_is_running_mutex);
+      thread_is_running--;
+      thread_is_running_cond.notify_all();
+      
+      return;
+    }
+
+
+    template <typename T>
+    void NNGradDescent<T>::optimizer_loop_hogwild()
+    {
+      const unsigned int id = hogwild_threads++;
+      const unsigned int K = NTHREADS;
+      
+      {
+	std::lock_guard<std::mutex> lock(thread_is_running_mutex);
+	thread_is_running++;
+	thread_is_running_cond.notify_all();
+      }
+
+      // acquires lock temporally to wait for startOptimizer() to finish
+      {
+	start_lock.lock();
+	start_lock.unlock();
+      }
+
+      // thread's own part of training data: samples id, id+K, id+2K, ..
+      const unsigned int N = hogwild_train.size(0);
+      const unsigned int shard = (N > id) ? (N - id + K - 1)/K : 0;
+      const unsigned int B = (hogwild_batchsize < shard) ? hogwild_batchsize : shard;
+
+      math::matrix<T> input, output;
+      math::vertex<T> grad, w, w0;
+      typename nnetwork<T>::workspace ws;
+      
+      T error = T(INFINITY), prev_error = T(INFINITY);
+
+      if(B > 0){
+	input.resize(B, hogwild_train.dimension(0));
+	output.resize(B, hogwild_train.dimension(1));
+      }
+      
+      if(id == 0){
+	w0 = hogwild_x;
+	nnetwork<T> enet(*nn);
+	enet.importdata(w0);
+	prev_error = getError(enet, hogwild_test);
+      }
+
+      while(B > 0 && running && !hogwild_done && iterations < MAXITERS){
+	// one epoch: all threads together go through training data once
+	for(unsigned int s=0;s<shard && running && !hogwild_done;s+=B){
+
+	  for(unsigned int b=0;b<B;b++){
+	    const unsigned int j = id + K*(rand() % shard);
+	    input.rowcopyfrom(hogwild_train.access(0, j), b);
+	    output.rowcopyfrom(hogwild_train.access(1, j), b);
+	  }
+
+	  if(errorTerms){
+	    // NaN outputs are not used: sets them to network's outputs (zero error)
+	    nn->calculate(hogwild_x, input, ws);
+
+	    for(unsigned int n=0;n<output.ysize();n++)
+	      for(unsigned int k=0;k<output.xsize();k++)
+		if(whiteice::math::isnan(output(n,k)))
+		  output(n,k) = ws.output[n*output.xsize() + k];
+	  }
+
+	  // parameters may change while gradient is calculated (Hogwild)
+	  if(nn->gradient(hogwild_x, input, output, grad, ws) == false){
+	    whiteice::logging.error("NNGradDescent: gradient failed");
+	    break;
+	  }
+
+	  grad *= T(1.0f/B);
+	  grad.add_scaled(hogwild_x, regularizer);
+	  
+	  hogwild_x.add_scaled(grad, T(-hogwild_lrate.load())); // no locking
+	}
+
+	if(id != 0) continue;
+
+	// the first thread checks error and adjusts learning rate after epoch
+	w = hogwild_x;
+
+	nnetwork<T> enet(*nn);
+	enet.importdata(w);
+	
+	error = getError(enet, hogwild_test);
+
+	if(error > prev_error){
+	  // epoch increased error: goes back and reduces learning rate
+	  hogwild_x = w0;
+	  hogwild_lrate = 0.5*hogwild_lrate;
+	  error = prev_error;
+	}
+	else{
+	  w0 = w;
+	  prev_error = error;
+
+	  solution_lock.lock();
+	  
+	  if(error < best_error){
+	    // improvement (smaller error with early stopping)
+	    best_error = error;
+	    best_pure_error = getError(enet, hogwild_test, false);
+	    bestx = w;
+	  }
+	  
+	  solution_lock.unlock();
+	}
+
+	{
+	  char buffer[128];
+	  double tmp1;
+	  whiteice::math::convert(tmp1, error);
+	  
+	  snprintf(buffer, 128, "NNGradDescent: %d/%d hogwild epoch error: %f lrate: %e",
+		   iterations.load(), MAXITERS, tmp1, hogwild_lrate.load());
+	  whiteice::logging.info(buffer);
+	}
+
+	iterations++;
+
+	if(error <= T(0.00001f) || hogwild_lrate < 10e-30)
+	  hogwild_done = true; // converged
+      }
+
+      
+      std::lock_guard<std::mutex> lock(thread_is_running_mutex);
+      thread_is_running--;
+      thread_is_running_cond.notify_all();
+      
+      return;
+    }
+    
     
     template class NNGradDescent< float >;
     template class NNGradDescent< double >;
@@ -4,6 +4,9 @@
  * - keeps looking for the best possible solution forever
  *   (fresh restart after convergence to local minima)
  *
+ * - hogwild mode: all threads train a single network by updating
+ *   shared parameters without locking (asynchronous data-parallel SGD)
+ *
  *
  */
 
@@ -11,11 +14,14 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
 
 #include "dinrhiw_blas.h"
 #include "dataset.h"
 #include "dinrhiw.h"
 #include "nnetwork.h"
+#include "minibatch_source.h"
+#include "thread_pool.h"
 
 #ifndef NNGradDescent_h
 #define NNGradDescent_h
@@ -61,6 +67,37 @@ namespace whiteice
 			 unsigned int MAXITERS = 10000,
 			 bool dropout = false,
 			 bool initiallyUseNN = true);
+
+      /*
+       * out-of-core version of startOptimize(): data is read from the
+       * source (for example file_minibatch_source) as shuffled minibatches
+       * which are prefetched in a background thread. The network is trained
+       * using minibatch gradient descent and the last 10% of the source's
+       * samples are used as testing data (early stopping).
+       *
+       * source must exist until the optimization has been stopped.
+       */
+      bool startOptimize(const whiteice::minibatch_source<T>& source,
+			 const whiteice::nnetwork<T>& nn,
+			 unsigned int NTHREADS,
+			 unsigned int MAXITERS = 10000,
+			 bool dropout = false,
+			 bool initiallyUseNN = true);
+      
+      /*
+       * asynchronous data-parallel training (Hogwild): instead of independent
+       * restarts, all NTHREADS threads optimize the same network. each thread
+       * takes random minibatches of batchsize samples from its own disjoint
+       * part of the training data and updates the shared parameter vector
+       * without locks. the first thread measures testing error after each
+       * epoch and reduces learning rate if the error grows.
+       *
+       * must be set before startOptimize() and is only used with in-memory
+       * datasets (dropout and deep pretraining are not used).
+       */
+      bool setHogwild(const bool hogwild, const unsigned int batchsize = 64);
+      bool getHogwild() const throw(){ return hogwild; }
+      unsigned int getHogwildBatchSize() const throw(){ return hogwild_batchsize; }
       
       /*
        * Returns true if optimizer is running
@@ -88,6 +125,13 @@ namespace whiteice
       T getError(const whiteice::nnetwork<T>& net,
 		 const whiteice::dataset<T>& dtest,
 		 bool regularize = true);
+
+      // error of samples [begin,end) of the source
+      T getError(const whiteice::nnetwork<T>& net,
+		 const whiteice::minibatch_source<T>& src,
+		 const unsigned long long begin,
+		 const unsigned long long end,
+		 bool regularize = true);
       
       
       whiteice::nnetwork<T>* nn; // network architecture and settings
@@ -99,9 +143,13 @@ namespace whiteice
       vertex<T> bestx;
       T best_error;
       T best_pure_error;
-      unsigned int iterations;
+      std::atomic<unsigned int> iterations; // shared by optimizer threads
       
       const whiteice::dataset<T>* data;
+
+      // out-of-core data, samples [0,ntrain) are used for training
+      const whiteice::minibatch_source<T>* source;
+      unsigned long long ntrain;
       
       // flag to indicate this is the first thread to start optimization
       bool first_time;
@@ -115,7 +163,7 @@ namespace whiteice
       
       unsigned int NTHREADS;
       unsigned int MAXITERS;
-      std::vector<std::thread*> optimizer_thread;
+      std::vector<whiteice::thread_pool::job> optimizer_thread;
       mutable std::mutex solution_lock, start_lock;
       
       bool running;
@@ -124,7 +172,18 @@ namespace whiteice
       std::mutex thread_is_running_mutex;
       std::condition_variable thread_is_running_cond;
       
+      // hogwild mode: parameters and data split shared by all threads
+      bool hogwild;
+      unsigned int hogwild_batchsize;
+      vertex<T> hogwild_x;
+      whiteice::dataset<T> hogwild_train, hogwild_test;
+      std::atomic<unsigned int> hogwild_threads; // gives thread ids
+      std::atomic<double> hogwild_lrate;
+      std::atomic<bool> hogwild_done;
+      
       void optimizer_loop();
+      void optimizer_loop_stream(); // out-of-core optimization
+      void optimizer_loop_hogwild(); // shared parameters
       
       };
     
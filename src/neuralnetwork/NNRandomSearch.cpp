@@ -176,7 +176,7 @@ namespace whiteice
 	  for(unsigned int i=0;i<data->size(0);i++){
 	    nn.input() = data->access(0, i);
 	    nn.calculate(false);
-	    err = data->access(1,i) - nn.output();
+	    err = math::lazy(data->access(1,i)) - nn.output();
 	      
 	    for(unsigned int i=0;i<err.size();i++)
 	      error += (err[i]*err[i]) / T((float)err.size());
@@ -16,10 +16,12 @@ template <typename T>
 PTHMC_abstract<T>::PTHMC_abstract(unsigned int deepness_, bool adaptive_) :
 	deepness(deepness_), adaptive(adaptive_)
 {
-	parallel_tempering_thread = nullptr;
 	running = false;
 	paused  = false;
 
+	barrier_count = 0;
+	barrier_generation = 0;
+
 	accepts = 0.0;
 	total_tries = 0.0;
 }
@@ -28,7 +30,8 @@ PTHMC_abstract<T>::PTHMC_abstract(unsigned int deepness_, bool adaptive_) :
 template <typename T>
 PTHMC_abstract<T>::~PTHMC_abstract()
 {
-	stopSampler(); // if needed
+	try{ stopSampler(); } // if needed
+	catch(...){ } // destructor must not throw
 }
 
 
@@ -39,38 +42,71 @@ bool PTHMC_abstract<T>::startSampler()
 	if(running) return false; // already running
 
 	hmc.clear();
+	state.clear();
+
+	unsigned int R = deepness;
+
+	if(R == 0){ // one replica per thread
+		R = whiteice::thread_pool::global().concurrency();
+		if(R < 2) R = 2;
+	}
 
 	try{
 
-		for(unsigned int i=0;i<deepness;i++){
-			T temperature = T(((double)i)/((double)(deepness-1)));
-			temperature = T(1.0) - temperature;
+		for(unsigned int i=0;i<R;i++){
+			T temperature = T(1.0);
+			if(R > 1)
+				temperature = T(1.0) - T(((double)i)/((double)(R-1)));
 			bool storeSamples = (i==0);
 			// only store samples of the "bottom" sampler [no temperature]
 			auto h = newHMC(storeSamples, adaptive);
 			h->setTemperature(temperature);
 			hmc.push_back(h);
+
+			math::vertex<T> q;
+			h->starting_position(q);
+			state.push_back(q);
 		}
 
-		for(auto h : hmc)
-			if(h->startSampler() == false)
-				throw std::runtime_error("Cannot start sampler");
+		index.reset(new std::atomic<unsigned int>[R]);
+
+		for(unsigned int i=0;i<R;i++)
+			index[i] = i;
 	}
 	catch(std::exception& e){
 		hmc.clear();
+		state.clear();
 
 		return false;
 	}
 
-	// starts parallel tempering thread which swaps samples between different temperature samplers
+	accepts = 0.0;
+	total_tries = 0.0;
+
+	barrier_count = 0;
+	barrier_generation = 0;
+
+	running = true;
+	paused = false;
+
+	// each temperature replica is run by its own thread
 	try{
-		running = true;
-		paused = false;
-		parallel_tempering_thread = new std::thread(&PTHMC_abstract<T>::parallel_tempering, this);
+		replica_thread.resize(R);
+
+		for(unsigned int r=0;r<R;r++){
+			replica_thread[r] =
+				whiteice::thread_pool::global().start(std::bind(&PTHMC_abstract<T>::replica_loop, this, r));
+		}
 	}
 	catch(std::exception& e){
-		hmc.clear();
-		parallel_tempering_thread = nullptr;
+		running = false;
+
+		for(auto& t : replica_thread)
+			if(t.joinable()) t.join();
+
+		replica_thread.clear();
+
+		return false;
 	}
 
 	return true;
@@ -81,17 +117,11 @@ template <typename T>
 bool PTHMC_abstract<T>::pauseSampler()
 {
 	std::lock_guard<std::mutex> lock(sampler_lock);
-	if(hmc.size() <= 0) return false; // not running
-
-	bool ok = true;
-
-	for(auto h : hmc){
-		ok = ok && h->pauseSampler();
-	}
+	if(!running) return false; // not running
 
 	paused = true;
 
-	return ok;
+	return true;
 }
 
 
@@ -99,17 +129,11 @@ template <typename T>
 bool PTHMC_abstract<T>::continueSampler()
 {
 	std::lock_guard<std::mutex> lock(sampler_lock);
-	if(hmc.size() <= 0) return false; // not running
-
-	bool ok = true;
-
-	for(auto h : hmc){
-		ok = ok && h->continueSampler();
-	}
+	if(!running) return false; // not running
 
 	paused = false;
 
-	return ok;
+	return true;
 }
 
 
@@ -117,21 +141,17 @@ template <typename T>
 bool PTHMC_abstract<T>::stopSampler()
 {
 	std::lock_guard<std::mutex> lock(sampler_lock);
-	if(hmc.size() <= 0) return false; // not running
+	if(!running) return false; // not running
 
 	running = false;
 	paused = false;
 
-	for(auto h : hmc){
-		h->stopSampler();
-	}
-
-	hmc.clear();
+	for(auto& t : replica_thread)
+		t.join();
 
-	parallel_tempering_thread->join();
-	delete parallel_tempering_thread;
-	parallel_tempering_thread = nullptr;
+	replica_thread.clear();
 
+	// samplers are kept so that samples can be still accessed
 	return true;
 }
 
@@ -188,241 +208,112 @@ math::vertex<T> PTHMC_abstract<T>::getMean() const
 }
 
 
+// waits until all replicas have called barrier() [or sampler is stopped]
 template <typename T>
-void PTHMC_abstract<T>::parallel_tempering()
+void PTHMC_abstract<T>::barrier()
 {
-	double hz = 1.0;
-	unsigned int ms = (unsigned int)(1000.0/hz);
-
-	whiteice::RNG<T> rng; // random number generator
+	const unsigned int generation = barrier_generation;
 
-	// global swap accept probability between all chains:
-	// easy way to see if the parallel tempering is working more or less correctly
-	accepts = 0;
-	total_tries = 0;
-
-	// on average we want to jump between every 10 samples so we measure
-	// how long it seems take to get 10 samples
-	unsigned int delay = 0;
-	while(hmc.front()->getNumberOfSamples() < 10 && running){
-		std::this_thread::sleep_for(std::chrono::milliseconds(100)); // waits for 100ms
-		delay += 100;
+	if(++barrier_count == hmc.size()){
+		barrier_count = 0;
+		barrier_generation++;
 	}
+	else{
+		while(barrier_generation == generation && running)
+			std::this_thread::yield();
+	}
+}
 
-	ms = delay/10;
-	hz = 1000.0/ms;
-
-	// algorithm for keeping jump probabilities between HMC samplers good:
-	// we measure sample exchange probability between chain i and j, if Pij < 10%
-	// then new sampler with temperature = (temperature_i + temperature_j)/2 is added
-	// on the other and, if exchange probability Pij is over 50% (?) then j is removed
-	// from the chain and jumping will happen between states i and (j+1) from this point on.
-	// This is a bit tricky to implement but is rather simple way to keep temperature range
-	// healthy so that there is not too many or too small number of chains. Additionally, we
-	// always keep at least 2 different temperatures: 1 (bottom) and 0 (top level) and have
-	// maximum number of temperatures so that we cannot run out of resources.
-	this->dynamic_pt = true;
-
-	std::list< std::list<T> > acceptRate; // keeps track of accept rates between chains
-	acceptRate.resize(hmc.size()-1);
-
-
-	while(running){
-		// pauses sampling for each thread
-		// for(auto h : hmc) h->pauseSampler();
-
-		math::vertex<T> w1, w2;
-
-		auto startTime = std::chrono::system_clock::now();
-		auto arate = acceptRate.begin();
-		auto h1 = hmc.begin();
-		auto h2 = hmc.begin();
-		h2++;
-
-		// std::cout << "Number of PT chains: " << hmc.size() << std::endl;
-
-		for(int i=0;i<(int)(hmc.size()-1);){
-			// tries to do MCMC swap between samples..
-
-			// not a bulletproof test but skips chains which didn't produce useful data since last check..
-			if((h1->get()->getUpdated() == false) && (h2->get()->getUpdated() == false)){
-				// no new samples since the last check, skip this one..
-				i++;
-				h1++;
-				h2++;
-				arate++;
-				continue;
-			}
-
-			h1->get()->getCurrentSample(w1);
-			h2->get()->getCurrentSample(w2);
-
-			h1->get()->setUpdated(false);
-			// h2->get()->setUpdated(false);
 
-#if 0
-			T E11 = h1->get()->U(w1);
-			T E22 = h2->get()->U(w2);
-			T E12 = h1->get()->U(w2);
-			T E21 = h2->get()->U(w1);
+template <typename T>
+void PTHMC_abstract<T>::replica_loop(const unsigned int r)
+{
+	// on average we want to jump between every 10 samples
+	const unsigned int ITERATIONS = 10;
+	const unsigned int BURNIN = 5; // rounds before samples are stored
+	const unsigned int L = 20;
 
-			T p = math::exp( (E11 + E22) - (E12 + E21) );
-#endif
-			T diffE1 = h1->get()->Udiff(w2, w1); // E12 - E11
-			T diffE2 = h2->get()->Udiff(w1, w2); // E21 - E22
+	HMC_abstract<T>& h = *(hmc[r]);
+	const unsigned int R = hmc.size();
 
-			T p = math::exp( (-diffE1) + (-diffE2) );
+	whiteice::RNG<T> rng; // random number generator
 
+	// adaptive step length targets 50% accept rate (see HMC_abstract)
+	T epsilon = T(0.01f);
+	const T MAX_EPSILON = T(1.0f);
+	T accept_rate = T(0.0f);
+	unsigned int accept_rate_samples = 0;
 
-			if(p >= T(1.0))
-				p = T(1.0);
+	for(unsigned int round=0;running;round++){
 
-#if 0
-			if(i <= 0){
-				std::cout << "p(" << i << "," << (i+1) << ") = " << p << " ";
-				std::cout << "E11 = " << E11 << " E22 = " << E22 << " ";
-				std::cout << "E21 = " << E21 << " E12 = " << E12 << std::endl;
-			}
-#endif
+		// 1. samples the current state at replica's own temperature
+		{
+			math::vertex<T>& q = state[index[r]];
 
-			if(rng.uniform() <= p){
-				accepts++;
+			for(unsigned int i=0;i<ITERATIONS && running;i++){
+				const bool accepted = h.iterate(q, epsilon, L, rng, r == 0 && round >= BURNIN);
 
-#if 0
-				if(i <= 0){
-					std::cout << "SWAP! " << i << " p = " << p << std::endl;
-					fflush(stdout);
-				}
-#endif
-				h2->get()->setCurrentSample(w1);
-				h1->get()->setCurrentSample(w2);
-			}
+				if(adaptive){
+					if(accepted) accept_rate++;
+					accept_rate_samples++;
 
-			if(dynamic_pt){
+					if(accept_rate_samples >= 50){
+						accept_rate /= accept_rate_samples;
 
-				arate->push_back(p);
-				while(arate->size() > 100) // keeps only the last 10 accept probabilities
-					arate->pop_front();
+						if(accept_rate < T(0.50f)){
+							epsilon = T(0.8)*epsilon;
+						}
+						else if(accept_rate > T(0.50f)){
+							auto new_epsilon = T(1.0/0.8)*epsilon;
+							if(new_epsilon < MAX_EPSILON)
+								epsilon = new_epsilon;
+						}
 
-				// calculates average accept rate between (i) and (i+1)
-				T avg_accept_rate = T(0.0);
-				for(auto& a : *arate){
-					avg_accept_rate += a;
+						accept_rate = T(0.0f);
+						accept_rate_samples = 0;
+					}
 				}
-				avg_accept_rate /= T(arate->size());
-
-				// according to research article optimal swap accept rate is 23% but I have seen higher numbers
-				// so code here targets values between 10%-75%
-
-				if(avg_accept_rate <= T(0.10) && arate->size() >= 100){ // too low accept rate: insert new chain between (i-1) and i
-					// std::cout << "Too low accept rate between chains " << i << " and " << i+1 << std::endl;
-					// std::cout << "Temperatures: " << h1->get()->getTemperature() << " and " << h2->get()->getTemperature() << std::endl;
-					// std::cout << "Accept rate = " << avg_accept_rate << std::endl;
-
-					std::lock_guard<std::mutex> lock(sampler_lock);
-
-					auto h = newHMC(false, adaptive);
-					const T temperature = (h1->get()->getTemperature() + h2->get()->getTemperature())/T(2.0);
-					h->setTemperature(temperature);
-
-					h->startSampler();
-
-					// invalidates current accept rates h1->h2 (we will have h1->h->h2)
-					arate->clear();
-
-					// also generates new empty accept ratio list about accept p-values
-					std::list<T> new_aratios_list;
-
-					arate++; // h2->h3 accept rate list
-					acceptRate.insert(arate, new_aratios_list); // inserts new empty accept rate list for h->h2
-					arate--; // h->h2 (new empty list)
-					arate--; // h1->h (invalid now)
-
-					hmc.insert(h2, h); // h1->h->h2
+			}
 
-					// tricky here: updates iterators and indexes for the for-loop
-					h2--;
-					total_tries++;
-					// retry at h1: h1->h->h3 now
+			if(r == 0)
+				h.setCurrentSample(q); // the latest sample of real (T=1) sampler
+		}
 
-					// randomly selects starting point between neighbouring chains
-					if(rng.rand()%1 == 0)
-						h->setCurrentSample(w1);
-					else
-						h->setCurrentSample(w2);
+		barrier();
+		if(!running) break;
 
-					continue;
-				}
-#if 1
-				else if(avg_accept_rate >= T(0.75) && arate->size() >= 100){ // too high accept: remove chain h2
-					// std::cout << "Too high accept rate between chains " << i << " and " << i+1 << std::endl;
-					// std::cout << "Temperatures: " << h1->get()->getTemperature() << " and " << h2->get()->getTemperature() << std::endl;
-					// std::cout << "Accept rate = " << avg_accept_rate << std::endl;
+		// 2. exchanges states between pairs (i,i+1), pairs alternate between rounds
+		if(r+1 < R && (r & 1) == (round & 1)){
+			const unsigned int a = index[r];
+			const unsigned int b = index[r+1];
 
-					std::lock_guard<std::mutex> lock(sampler_lock);
+			T diffE1 = hmc[r]->Udiff(state[b], state[a]);   // E12 - E11
+			T diffE2 = hmc[r+1]->Udiff(state[a], state[b]); // E21 - E22
 
-					auto h = h2;
-					h++;
-
-					if(h != hmc.end()){ // h2 is not the last valid element (there is h3 after h2)
-						h2->get()->stopSampler();
-						h2 = hmc.erase(h2); // moves h2 to h3
-						arate->clear(); // invalidates accept rates from h1 to h2
-						arate++;
-						arate = acceptRate.erase(arate); // removes accept rates h2->h3 because h2 was deleted
-						arate--; // moves back to h1 accept rate (now h1->h3)
+			T p = math::exp( (-diffE1) + (-diffE2) );
 
-						total_tries++;
+			if(p >= T(1.0))
+				p = T(1.0);
 
-						continue; // rerun checks for h1->h3 jumps
-					}
-					else if(h1 != hmc.begin()){
-						// h2 is the last valid element (highest inverse temperature T=0), remove h1 instead
-						// but DO NOT remove h1 if it is the first element of the list [always keep T=0 and T=1]
-						arate = acceptRate.erase(arate); // remove h1->h2 accept rate table because there is no h1->h3
-						arate--;
-						arate->clear(); // invalidates h0->h1 accept rate table because h1 was deleted
-						arate++;
-						h1->get()->stopSampler();
-						h1 = hmc.erase(h1); // remove h1 and make it point to h2 (normal progress forward)
-
-						h2++; // moves h2 to theoretical h3 (end() iterator instead)
-						i++;  // does not really matter now but guarantees we stop processing
-
-						total_tries++;
-
-						continue;
-					}
-					// else [there is only two elements do not remove anything]
+			const bool swap = (rng.uniform() <= p);
 
-				}
-#endif
+			if(swap){
+				index[r] = b;
+				index[r+1] = a;
 			}
 
-			i++;
-			h1++;
-			h2++;
-			arate++;
-			total_tries++;
+			{
+				std::lock_guard<std::mutex> lock(stats_lock);
+				if(swap) accepts++;
+				total_tries++;
+			}
 		}
 
-		auto endTime = std::chrono::system_clock::now();
-		auto loopDuration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
-
-		// continue sampling in each thread
-		// for(auto h : hmc) h->continueSampler();
+		barrier();
 
-		if(paused){
-			while(paused && running){
-				std::this_thread::sleep_for(std::chrono::milliseconds(100));
-			}
-		}
-		else{
-			if(ms > loopDuration.count())
-				std::this_thread::sleep_for(std::chrono::milliseconds(ms - loopDuration.count()));
-		}
+		while(paused && running)
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
 	}
-
 }
 
 
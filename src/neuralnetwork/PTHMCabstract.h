@@ -10,12 +10,14 @@
 
 #include "vertex.h"
 #include "HMC_abstract.h"
+#include "thread_pool.h"
 
 #include <exception>
 #include <stdexcept>
 #include <thread>
 #include <chrono>
 #include <mutex>
+#include <atomic>
 #include <memory>
 
 
@@ -23,6 +25,11 @@ namespace whiteice {
 
 /**
  * Parallel Tempering class for HMC_abstract HMC sampler
+ *
+ * each temperature replica runs in its own thread_pool job. replicas do
+ * HMC iterations in rounds and between rounds neighbouring temperatures
+ * try to exchange states. replica states are kept in a shared table and
+ * exchange only swaps (atomic) state indices, states are never copied.
  */
 template <typename T = math::blas_real<float> >
 class PTHMC_abstract {
@@ -30,7 +37,8 @@ protected:
         const unsigned int deepness;
         const bool adaptive;
 public:
-	// deepness = the number of different temperatures
+	// deepness = the number of different temperatures,
+	// 0 = one replica per thread pool thread (at least 2)
 	PTHMC_abstract(unsigned int deepness, bool adaptive);
 	virtual ~PTHMC_abstract();
 
@@ -65,15 +73,23 @@ public:
 
 protected:
 	mutable std::mutex sampler_lock;
-	std::list < std::shared_ptr< whiteice::HMC_abstract<T> > > hmc;
-	bool dynamic_pt; // does we add and remove new temperatures if accept rates are too high/low?
+	std::vector< std::shared_ptr< whiteice::HMC_abstract<T> > > hmc; // hmc[0] has temperature 1
+
+	std::vector< math::vertex<T> > state;                // replica states
+	std::unique_ptr< std::atomic<unsigned int>[] > index; // state index of each temperature
 
-	std::thread* parallel_tempering_thread; // FIXME uses raw pointers
+	std::vector< whiteice::thread_pool::job > replica_thread;
 	volatile bool running;
 	volatile bool paused;
 
-	void parallel_tempering();
+	// barrier between sampling and exchange phases
+	std::atomic<unsigned int> barrier_count;
+	std::atomic<unsigned int> barrier_generation;
+	void barrier();
+
+	void replica_loop(const unsigned int r);
 
+	std::mutex stats_lock;
 	double accepts;
 	double total_tries;
 
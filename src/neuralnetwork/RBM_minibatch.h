@@ -0,0 +1,79 @@
+/*
+ * helper functions for minibatch contrastive divergence training
+ * (BBRBM::learnWeightsBatch() and GBRBM::learnWeightsBatch()).
+ *
+ * states of the minibatch are kept as row-major B x N matrices
+ * (one sample per row) so that W*v and W^t*h of the whole minibatch
+ * are single math::gemm() calls. random noise is generated in bulk using
+ * per-thread RNG streams.
+ */
+
+#ifndef RBM_minibatch_h
+#define RBM_minibatch_h
+
+#include <vector>
+#include <typeinfo>
+
+#include "dinrhiw_blas.h"
+#include "blade_math.h"
+#include "RNG.h"
+#include "nnetwork_kernels.h"
+
+
+namespace whiteice
+{
+  namespace rbm_minibatch
+  {
+    // x[i] = sigmoid(x[i] + bias[i % D]), x is N x D matrix
+    template <typename T>
+      inline void sigmoid(T* x, const T* bias,
+			  const unsigned int N, const unsigned int D)
+    {
+      for(unsigned int n=0;n<N;n++)
+	for(unsigned int i=0;i<D;i++)
+	  x[n*D + i] += bias[i];
+
+      if(typeid(T) == typeid(float) || typeid(T) == typeid(math::blas_real<float>)){
+	nnkernels::activation(nnkernels::SIGMOID, (float*)x, N*D);
+      }
+      else if(typeid(T) == typeid(double) || typeid(T) == typeid(math::blas_real<double>)){
+	nnkernels::activation(nnkernels::SIGMOID, (double*)x, N*D);
+      }
+      else{
+	for(unsigned int i=0;i<N*D;i++)
+	  x[i] = T(1.0f)/(T(1.0f) + math::exp(-x[i]));
+      }
+    }
+
+
+    // x[i] = 1 with probability x[i] and 0 otherwise
+    template <typename T>
+      inline void bernoulli(T* x, const unsigned int N, const RNG<T>& rng)
+    {
+      T u[256];
+
+      for(unsigned int i=0;i<N;i+=256){
+	const unsigned int n = (N - i < 256) ? (N - i) : 256;
+	rng.uniform(u, n);
+
+	for(unsigned int j=0;j<n;j++)
+	  x[i+j] = (u[j] < x[i+j]) ? T(1.0f) : T(0.0f);
+      }
+    }
+
+
+    // s[i] += sum(x[n*D + i]), x is N x D matrix
+    template <typename T>
+      inline void colsum(const T* x, const unsigned int N, const unsigned int D,
+			 T* s, const T& alpha = T(1.0f))
+    {
+      for(unsigned int n=0;n<N;n++)
+	for(unsigned int i=0;i<D;i++)
+	  s[i] += alpha*x[n*D + i];
+    }
+
+  };
+};
+
+
+#endif
@@ -4,6 +4,7 @@
 
 #include "UHMC.h"
 #include "NNGradDescent.h"
+#include "Log.h"
 
 #include <random>
 #include <list>
@@ -21,6 +22,9 @@ namespace whiteice
 		this->alpha = alpha;
 		this->temperature = T(1.0);
 		this->store = store;
+		this->sghmc = false;
+		this->batchsize = 256;
+		this->friction = T(0.05);
 
 		sum_N = 0;
 		sum_mean.zero();
@@ -64,6 +68,23 @@ namespace whiteice
 	}
   
 
+	template <typename T>
+	bool UHMC<T>::setSGHMC(const bool sghmc, const unsigned int batchsize, const T friction)
+	{
+		std::lock_guard<std::mutex> lock(start_lock);
+
+		if(running) return false;
+		if(batchsize == 0) return false;
+		if(friction <= T(0.0) || friction >= T(1.0)) return false;
+
+		this->sghmc = sghmc;
+		this->batchsize = batchsize;
+		this->friction = friction;
+
+		return true;
+	}
+
+
 	template <typename T>
 	T UHMC<T>::U(const math::vertex<T>& q, bool useRegulizer) const
 	{
@@ -82,7 +103,7 @@ namespace whiteice
 			for(unsigned int i=0;i<data.size(0);i++){
 				nnet.input() = data.access(0, i);
 				nnet.calculate(false);
-				err = data.access(1, i) - nnet.output();
+				err = math::lazy(data.access(1, i)) - nnet.output();
 				// T inv = T(1.0f/err.size());
 				err = (err*err);
 				e = e  + T(0.5f)*err[0];
@@ -126,7 +147,7 @@ namespace whiteice
 			for(unsigned int i=0;i<data.size(0);i++){
 				nnet.input() = data.access(0, i);
 				nnet.calculate(true);
-				err = data.access(1,i) - nnet.output();
+				err = math::lazy(data.access(1,i)) - nnet.output();
 
 				if(nnet.gradient(err, grad) == false){
 					std::cout << "gradient failed." << std::endl;
@@ -147,7 +168,7 @@ namespace whiteice
 		sum /= temperature; // scales gradient with temperature
 
 		
-		sum += T(0.5)*alpha*q;
+		sum.add_scaled(q, T(0.5)*alpha);
 		
 		sum.normalize();
 
@@ -156,6 +177,40 @@ namespace whiteice
   
   
   
+	template <typename T>
+	bool UHMC<T>::minibatch_Ugrad(const math::vertex<T>& q,
+				      math::matrix<T>& x, math::matrix<T>& y,
+				      typename whiteice::nnetwork<T>::workspace& ws,
+				      math::vertex<T>& sum) const
+	{
+		x.resize(batchsize, data.dimension(0));
+		y.resize(batchsize, data.dimension(1));
+
+		for(unsigned int b=0;b<batchsize;b++){
+			const unsigned int index = rng.rand() % data.size(0);
+			x.rowcopyfrom(data.access(0, index), b);
+			y.rowcopyfrom(data.access(1, index), b);
+		}
+
+		// batched gradient uses shared parameters q (network is not copied)
+		if(nnet.gradient(q, x, y, sum, ws) == false){
+			whiteice::logging.error("UHMC: calculating minibatch gradient failed");
+			return false;
+		}
+
+		// scales minibatch sum to the whole dataset
+		sum *= T((float)data.size(0))/T((float)batchsize);
+
+		sum /= sigma2;
+
+		sum /= temperature;
+
+		sum.add_scaled(q, T(0.5)*alpha);
+
+		return true;
+	}
+
+
         // calculates z-ratio between data likelihood distributions
         template <typename T>
 	T UHMC<T>::zratio(const math::vertex<T>& q1, const math::vertex<T>& q2) const
@@ -425,7 +480,9 @@ namespace whiteice
 		for(unsigned int i=0;i<NUM_THREADS;i++){
 
 			try{
-			        std::thread* t = new std::thread(&UHMC<T>::sampler_loop, this);
+			        std::thread* t = nullptr;
+				if(sghmc) t = new std::thread(&UHMC<T>::sghmc_loop, this);
+				else t = new std::thread(&UHMC<T>::sampler_loop, this);
 				// t->detach();
 				sampling_thread.push_back(t);
 			}
@@ -622,7 +679,7 @@ namespace whiteice
 	    for(unsigned int i=0;i<data.size(0);i++){
 	      nnet.input() = data.access(0, i);
 	      nnet.calculate(false);
-	      err = data.access(1, i) - nnet.output();
+	      err = math::lazy(data.access(1, i)) - nnet.output();
 	      // T inv = T(1.0f/err.size());
 	      err = (err*err);
 	      e = e  + T(0.5f)*err[0];
@@ -706,17 +763,17 @@ namespace whiteice
     		math::vertex<T> old_q = q;
     		math::vertex<T> current_p = p;
 
-    		p -= T(0.5f) * epsilon * Ugrad(q);
+    		p.add_scaled(Ugrad(q), T(-0.5f)*epsilon);
 
     		for(unsigned int i=0;i<L;i++){
-    			q += epsilon * p;
+    			q.add_scaled(p, epsilon);
     			if(i != L-1)
-    				p -= epsilon*Ugrad(q);
+    				p.add_scaled(Ugrad(q), -epsilon);
     		}
 
-    		p -= T(0.5f) * epsilon * Ugrad(q);
+    		p.add_scaled(Ugrad(q), T(-0.5f)*epsilon);
 
-    		p = -p;
+    		p *= T(-1.0f);
 
     		T current_U  = U(old_q);
     		T proposed_U = U(q);
@@ -837,6 +894,88 @@ namespace whiteice
     	}
 
 	}
+
+
+    // stochastic gradient HMC with friction (Chen, Fox, Guestrin 2014):
+    // v <- (1-a)*v - eta*grad U~(q) + N(0, 2*a*eta), q <- q + v
+    // (minibatch noise estimate B = 0)
+    template <typename T>
+    void UHMC<T>::sghmc_loop()
+    {
+	math::vertex<T> q, v, n, grad;
+	math::matrix<T> x, y;
+	typename whiteice::nnetwork<T>::workspace ws;
+
+	{
+	  std::lock_guard<std::mutex> lock(updating_sample);
+	  nnet.exportdata(this->q); // initial position q
+	  q = this->q;
+	}
+
+	sample_covariance_matrix(q);
+
+	// eta*grad U~ is learning rate times average gradient of a datapoint
+	const T learning_rate = T(0.001f);
+	const T eta = learning_rate*sigma2/T((float)data.size(0));
+	const T noise = math::sqrt(T(2.0f)*friction*eta);
+	const unsigned int L = 10; // steps between stored samples
+
+	v.resize(q.size());
+	n.resize(q.size());
+	rng.normal(v);
+	v *= math::sqrt(eta);
+
+	unsigned int iterations = 0;
+	const unsigned int BURNIN = 5;
+
+	while(running) // keep sampling forever or until stopped
+	{
+	  {
+	    std::lock_guard<std::mutex> lock(updating_sample);
+	    q = this->q; // setCurrentSample() may have changed q
+	  }
+
+	  for(unsigned int l=0;l<L && running;l++){
+	    if(minibatch_Ugrad(q, x, y, ws, grad) == false)
+	      continue; // skips the step
+	    
+	    rng.normal(n);
+
+	    v *= (T(1.0f) - friction);
+	    v.add_scaled(grad, -eta);
+	    v.add_scaled(n, noise);
+
+	    q += v;
+	  }
+
+	  {
+	    std::lock_guard<std::mutex> lock(updating_sample);
+	    this->q = q;
+	  }
+
+	  iterations++;
+
+	  if(iterations > BURNIN){
+	    std::lock_guard<std::mutex> lock(solution_lock);
+
+	    if(sum_N > 0){
+	      sum_mean += q;
+	      sum_N++;
+	    }
+	    else{
+	      sum_mean = q;
+	      sum_N++;
+	    }
+
+	    if(store)
+	      samples.push_back(q);
+	  }
+
+	  while(paused && running){ // pause
+	    std::this_thread::sleep_for(std::chrono::milliseconds(500)); // sleep for 500ms
+	  }
+	}
+    }
   
   
 };
@@ -68,8 +68,25 @@ namespace whiteice
 		T getMeanError(unsigned int latestN = 0) const;
 
 		bool getAdaptive() const throw(){ return adaptive; }
+
+		// stochastic gradient HMC (SGHMC): gradient is estimated from
+		// batchsize randomly chosen datapoints and friction term compensates
+		// the gradient noise (no Metropolis step). must be set before startSampler()
+		bool setSGHMC(const bool sghmc, const unsigned int batchsize = 256,
+			      const T friction = T(0.05));
+		bool getSGHMC() const throw(){ return sghmc; }
+		unsigned int getSGHMCBatchSize() const throw(){ return batchsize; }
+		T getSGHMCFriction() const throw(){ return friction; }
 	
     	private:
+	        // minibatch estimate of Ugrad() (not normalized) using
+	        // batchsize random datapoints copied to x and y,
+	        // returns false if calculating the gradient failed
+	        bool minibatch_Ugrad(const math::vertex<T>& q,
+				     math::matrix<T>& x, math::matrix<T>& y,
+				     typename whiteice::nnetwork<T>::workspace& ws,
+				     math::vertex<T>& sum) const;
+
 	        // calculates negative phase gradient
 	        bool negative_phase(const math::vertex<T>& xx, const math::vertex<T>& yy,
 				    math::vertex<T>& grad, 
@@ -100,6 +117,10 @@ namespace whiteice
 		bool adaptive;
 		bool store;
 
+		bool sghmc; // stochastic gradient HMC
+		unsigned int batchsize;
+		T friction;
+
 		// used to calculate statistics when needed
 		math::vertex<T> sum_mean;
 		// math::matrix<T> sum_covariance;
@@ -113,6 +134,7 @@ namespace whiteice
 	        whiteice::RNG<T> rng;
 
 		void sampler_loop();
+		void sghmc_loop();
 	};
 
 };
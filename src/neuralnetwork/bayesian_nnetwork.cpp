@@ -10,11 +10,14 @@
 #include <stdexcept>
 #include <typeinfo>
 #include <set>
+#include <atomic>
 
 #include "nnetwork.h"
+#include "nnetwork_file.h"
 #include "dataset.h"
 #include "dinrhiw_blas.h"
 #include "Log.h"
+#include "thread_pool.h"
 
 
 namespace whiteice
@@ -429,6 +432,179 @@ namespace whiteice
   }
 
 
+  template <typename T>
+  bool bayesian_nnetwork<T>::calculate(const math::matrix<T>& input,
+				       math::matrix<T>& mean,
+				       std::vector< math::matrix<T> >& covariance,
+				       unsigned int SIMULATION_DEPTH,
+				       int latestN,
+				       unsigned int maxSamples) const
+  {
+    return calculate_batch(input, mean, &covariance,
+			   SIMULATION_DEPTH, latestN, maxSamples);
+  }
+
+
+  template <typename T>
+  bool bayesian_nnetwork<T>::calculate(const math::matrix<T>& input,
+				       math::matrix<T>& mean,
+				       unsigned int SIMULATION_DEPTH,
+				       int latestN,
+				       unsigned int maxSamples) const
+  {
+    return calculate_batch(input, mean, nullptr,
+			   SIMULATION_DEPTH, latestN, maxSamples);
+  }
+
+
+  template <typename T>
+  bool bayesian_nnetwork<T>::calculate_batch(const math::matrix<T>& input,
+					     math::matrix<T>& mean,
+					     std::vector< math::matrix<T> >* covariance,
+					     unsigned int SIMULATION_DEPTH,
+					     int latestN, unsigned int maxSamples) const
+  {
+    if(nnets.size() <= 0) return false;
+    if(latestN > (signed)nnets.size()) return false;
+    if(latestN <= 0) latestN = nnets.size();
+    if(SIMULATION_DEPTH == 0) SIMULATION_DEPTH = 1;
+
+    const unsigned int IN = nnets[0]->input_size();
+    const unsigned int D = nnets[0]->output_size();
+    const unsigned int N = input.ysize();
+    
+    if(SIMULATION_DEPTH > 1){
+      if(D + input.xsize() != IN)
+	return false;
+    }
+    else{
+      if(input.xsize() != IN)
+	return false;
+    }
+
+    // evenly spaced subset of the latest samples
+    const unsigned int first = nnets.size() - latestN;
+    unsigned int S = latestN;
+    if(maxSamples > 0 && maxSamples < S) S = maxSamples;
+
+    mean.resize(N, D);
+    mean.zero();
+
+    if(covariance){
+      covariance->resize(N);
+      
+      for(auto& C : *covariance){
+	C.resize(D, D);
+	C.zero();
+      }
+    }
+
+    if(N == 0) return true;
+
+    // per slot sums of outputs and their second moments
+    struct slot_sums {
+      typename nnetwork<T>::workspace ws;
+      math::matrix<T> x;
+      std::vector<T> m, c;
+    };
+
+    whiteice::thread_pool& pool = whiteice::thread_pool::global();
+    std::vector<slot_sums> sums(pool.concurrency());
+    std::atomic<bool> failed(false);
+
+    pool.parallel_for(0, S, 1, [&](unsigned int slot, unsigned long long k)
+    {
+      slot_sums& s = sums[slot];
+      const nnetwork<T>* net = nnets[first + (unsigned int)((k*latestN)/S)];
+
+      if(s.m.size() == 0){
+	s.m.resize(N*D, T(0.0f));
+	if(covariance) s.c.resize(N*D*D, T(0.0f));
+      }
+
+      if(SIMULATION_DEPTH > 1){
+	// recurrent calculations: outputs are fed back after the input section
+	s.x.resize(N, IN);
+	s.x.zero();
+
+	for(unsigned int n=0;n<N;n++)
+	  for(unsigned int i=0;i<input.xsize();i++)
+	    s.x(n, i) = input(n, i);
+
+	for(unsigned int d=0;d<SIMULATION_DEPTH;d++){
+	  if(d > 0){
+	    for(unsigned int n=0;n<N;n++)
+	      for(unsigned int i=0;i<D;i++)
+		s.x(n, input.xsize() + i) = s.ws.output[n*D + i];
+	  }
+
+	  if(net->calculate(s.x, s.ws) == false){
+	    failed = true;
+	    return;
+	  }
+	}
+      }
+      else if(net->calculate(input, s.ws) == false){
+	failed = true;
+	return;
+      }
+
+      const T* y = s.ws.output.data();
+
+      for(unsigned int i=0;i<N*D;i++)
+	s.m[i] += y[i];
+
+      if(covariance){
+	for(unsigned int n=0;n<N;n++){
+	  const T* yn = y + n*D;
+	  T* cn = &(s.c[n*D*D]);
+	  
+	  for(unsigned int i=0;i<D;i++)
+	    for(unsigned int j=0;j<D;j++)
+	      cn[i*D + j] += yn[i]*yn[j];
+	}
+      }
+    }, sums.size());
+
+    if(failed) return false;
+
+    const T ninv = T(1.0f/S);
+
+    for(const auto& s : sums){
+      if(s.m.size() == 0) continue;
+
+      for(unsigned int n=0;n<N;n++)
+	for(unsigned int i=0;i<D;i++)
+	  mean(n, i) += ninv*s.m[n*D + i];
+
+      if(covariance){
+	for(unsigned int n=0;n<N;n++)
+	  for(unsigned int i=0;i<D;i++)
+	    for(unsigned int j=0;j<D;j++)
+	      (*covariance)[n](i, j) += ninv*s.c[(n*D + i)*D + j];
+      }
+    }
+
+    if(covariance){
+      for(unsigned int n=0;n<N;n++){
+	math::matrix<T>& C = (*covariance)[n];
+	
+	// should divide by N-1 but we ignore this in order to have a result for N=1
+	for(unsigned int i=0;i<D;i++)
+	  for(unsigned int j=0;j<D;j++)
+	    C(i, j) -= mean(n, i)*mean(n, j);
+
+	if(S <= D){
+	  for(unsigned int i=0;i<D;i++)
+	    C(i, i) += T(1.0f); // regularizer term for small datasize
+	}
+      }
+    }
+
+    return true;
+  }
+
+
   template <typename T>
   unsigned int bayesian_nnetwork<T>::outputSize() const throw()
   {
@@ -458,6 +634,19 @@ namespace whiteice
   template <typename T>
   bool bayesian_nnetwork<T>::load(const std::string& filename) throw()
   {
+    if(nnetwork_file<T>::isBinary(filename)){
+      std::vector< nnetwork<T>* > nets;
+      if(nnetwork_file<T>::load(filename, nets) == false)
+	return false;
+      
+      for(unsigned int i=0;i<nnets.size();i++)
+	delete nnets[i]; // deletes old networks
+      
+      nnets = nets;
+      
+      return true;
+    }
+    
     try{
       // whiteice::conffile configuration;
       whiteice::dataset<T> configuration;
@@ -651,8 +840,14 @@ namespace whiteice
   
   
   template <typename T>
-  bool bayesian_nnetwork<T>::save(const std::string& filename) const throw()
+  bool bayesian_nnetwork<T>::save(const std::string& filename,
+				  const bool binary, const bool float16) const throw()
   {
+    if(binary){
+      std::vector< const nnetwork<T>* > nets(nnets.begin(), nnets.end());
+      return nnetwork_file<T>::save(filename, nets, float16);
+    }
+    
     try{
       if(nnets.size() <= 0) return false;
 
@@ -67,16 +67,43 @@ namespace whiteice
 		   unsigned int SIMULATION_DEPTH /* = 1 */, // for recurrent use of nnetworks..
 		   int latestN /*= 0 */) const;
 
+    // batched calculate(): rows of mean are E[y|x_i] and covariance[i] = Var[y|x_i]
+    // for each row x_i of input. Each sample network calculates all inputs with
+    // GEMMs and samples are processed in parallel. If maxSamples > 0 only
+    // maxSamples evenly spaced samples of the latestN samples are used
+    // (less accurate but faster)
+    bool calculate(const math::matrix<T>& input,
+		   math::matrix<T>& mean,
+		   std::vector< math::matrix<T> >& covariance,
+		   unsigned int SIMULATION_DEPTH = 1,
+		   int latestN = 0,
+		   unsigned int maxSamples = 0) const;
+
+    // batched E[y|x] only (skips covariance calculations)
+    bool calculate(const math::matrix<T>& input,
+		   math::matrix<T>& mean,
+		   unsigned int SIMULATION_DEPTH = 1,
+		   int latestN = 0,
+		   unsigned int maxSamples = 0) const;
+
     unsigned int outputSize() const throw();
     unsigned int inputSize() const throw();
 
-    // stores and loads bayesian nnetwork to a dataset file
+    // stores and loads bayesian nnetwork to a dataset file or
+    // to a binary file (nnetwork_file.h) which is detected by load()
     // (saves all samples into files)
     bool load(const std::string& filename) throw();
-    bool save(const std::string& filename) const throw();
+    bool save(const std::string& filename,
+	      const bool binary = false, const bool float16 = false) const throw();
 
     private:
 
+    bool calculate_batch(const math::matrix<T>& input,
+			 math::matrix<T>& mean,
+			 std::vector< math::matrix<T> >* covariance,
+			 unsigned int SIMULATION_DEPTH,
+			 int latestN, unsigned int maxSamples) const;
+
     std::vector< nnetwork<T>* > nnets;
       
       
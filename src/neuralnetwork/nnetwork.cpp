@@ -11,6 +11,8 @@
 #include <typeinfo>
 
 #include "nnetwork.h"
+#include "nnetwork_file.h"
+#include "nnetwork_kernels.h"
 #include "dinrhiw_blas.h"
 #include "Log.h"
 
@@ -418,10 +420,7 @@ namespace whiteice
 	}
 
 	// s = g(v)
-
-	for(unsigned int i=0;i<arch[aindex+1];i++){
-	  state[i] = nonlin(state[i], aindex, i);
-	}
+	nonlin_layer(&(state[0]), arch[aindex+1], 1, aindex);
 	
 	dptr += (arch[aindex] + 1)*arch[aindex+1]; // matrix W and bias b
 	
@@ -449,10 +448,7 @@ namespace whiteice
 		   arch[aindex+1], &(state[0]), dptr + arch[aindex]*arch[aindex+1]);
 	
 	// s = g(v)
-
-	for(unsigned int i=0;i<arch[aindex+1];i++){
-	  state[i] = nonlin(state[i], aindex, i);
-	}
+	nonlin_layer(&(state[0]), arch[aindex+1], 1, aindex);
 
 	dptr += (arch[aindex] + 1)*arch[aindex+1]; // matrix W and bias b
 	aindex++; // next layer
@@ -514,11 +510,7 @@ namespace whiteice
 		   arch[aindex+1], &(state[0]), dptr + arch[aindex]*arch[aindex+1]);
 	
 	// s = g(v)
-	  
-	for(unsigned int i=0;i<arch[aindex+1];i++){
-	  // state[i] = nonlin(state[i], aindex + 1, i);
-	  state[i] = nonlin(state[i], aindex, i);
-	}
+	nonlin_layer(&(state[0]), arch[aindex+1], 1, aindex);
 	
 	dptr += (arch[aindex] + 1)*arch[aindex+1]; // matrix W and bias b
 	aindex++; // next layer
@@ -536,6 +528,235 @@ namespace whiteice
     
     return true;
   }
+  
+  
+  // batched calculation: rows of input are samples and each layer is calculated
+  // using single GEMM call [thread-safe]
+  template <typename T>
+  bool nnetwork<T>::calculate(const math::matrix<T>& input, math::matrix<T>& output) const
+  {
+    if(input.xsize() != arch[0])
+      return false; // input vectors have wrong dimension
+    
+    const unsigned int N = input.ysize();
+    
+    if(output.resize(N, arch[arch.size()-1]) == false)
+      return false;
+
+    if(N == 0) return true;
+    
+    workspace ws;
+    
+    if(calculate_batch(&(data[0]), &(input(0,0)), N, ws) == false)
+      return false;
+    
+    memcpy(&(output(0,0)), ws.output.data(), N*arch[arch.size()-1]*sizeof(T));
+    
+    return true;
+  }
+
+
+  template <typename T>
+  bool nnetwork<T>::calculate(typename std::vector< math::vertex<T> >::const_iterator begin,
+			      typename std::vector< math::vertex<T> >::const_iterator end,
+			      math::matrix<T>& output) const
+  {
+    workspace ws;
+
+    if(pack_batch(begin, end, arch[0], ws.input) == false)
+      return false;
+
+    const unsigned int N = (unsigned int)(end - begin);
+    
+    if(output.resize(N, arch[arch.size()-1]) == false)
+      return false;
+
+    if(N == 0) return true;
+    
+    if(calculate_batch(&(data[0]), ws.input.data(), N, ws) == false)
+      return false;
+    
+    memcpy(&(output(0,0)), ws.output.data(), N*arch[arch.size()-1]*sizeof(T));
+
+    return true;
+  }
+
+
+  template <typename T>
+  bool nnetwork<T>::calculate(const math::vertex<T>& w, const math::matrix<T>& input,
+			      workspace& ws) const
+  {
+    if(w.size() != size || input.xsize() != arch[0])
+      return false;
+
+    const unsigned int N = input.ysize();
+
+    if(N == 0){
+      ws.output.clear();
+      return true;
+    }
+
+    return calculate_batch(&(w[0]), &(input(0,0)), N, ws);
+  }
+
+
+  template <typename T>
+  bool nnetwork<T>::calculate(const math::vertex<T>& w,
+			      typename std::vector< math::vertex<T> >::const_iterator begin,
+			      typename std::vector< math::vertex<T> >::const_iterator end,
+			      workspace& ws) const
+  {
+    if(w.size() != size)
+      return false;
+
+    if(pack_batch(begin, end, arch[0], ws.input) == false)
+      return false;
+
+    const unsigned int N = (unsigned int)(end - begin);
+
+    if(N == 0){
+      ws.output.clear();
+      return true;
+    }
+
+    return calculate_batch(&(w[0]), ws.input.data(), N, ws);
+  }
+
+
+  template <typename T>
+  bool nnetwork<T>::calculate(const math::matrix<T>& input, workspace& ws) const
+  {
+    if(input.xsize() != arch[0])
+      return false;
+
+    const unsigned int N = input.ysize();
+
+    if(N == 0){
+      ws.output.clear();
+      return true;
+    }
+
+    return calculate_batch(&(data[0]), &(input(0,0)), N, ws);
+  }
+
+
+  template <typename T>
+  bool nnetwork<T>::calculate_batch(const T* w, const T* input, const unsigned int N,
+				    workspace& ws) const
+  {
+    // ping-pong buffers for layer inputs and outputs
+    std::vector<T>& in = ws.activations;
+    std::vector<T>& out = ws.fields;
+    
+    in.resize(N*maxwidth);
+    out.resize(N*maxwidth);
+    
+    memcpy(in.data(), input, N*arch[0]*sizeof(T));
+    
+    const T* dptr = w;
+    
+    for(unsigned int l=0;l+1<arch.size();l++){
+      const unsigned int rows = arch[l+1];
+      const unsigned int cols = arch[l];
+      
+      // V = [b ... b]^T + X*W^T
+      const T* bias = dptr + rows*cols;
+      
+      for(unsigned int n=0;n<N;n++)
+	memcpy(&(out[n*rows]), bias, rows*sizeof(T));
+      
+      math::gemm(false, true, N, rows, cols, 1.0f,
+	         in.data(), cols, dptr, cols,
+	         1.0f, out.data(), rows);
+      
+      // X = g(V)
+      nonlin_layer(out.data(), rows, N, l);
+      
+      std::swap(in, out);
+      
+      dptr += (cols + 1)*rows; // matrix W and bias b
+    }
+    
+    ws.output.resize(N*arch[arch.size()-1]);
+    memcpy(ws.output.data(), in.data(), N*arch[arch.size()-1]*sizeof(T));
+    
+    return true;
+  }
+
+
+  // batched forward pass which saves data needed by the batched backward pass
+  template <typename T>
+  bool nnetwork<T>::forward_batch(const T* w, const T* input, const unsigned int N,
+				  workspace& ws) const
+  {
+    unsigned int asize = 0, fsize = 0;
+    
+    for(unsigned int i=0;i<arch.size();i++){
+      asize += N*arch[i];
+      if(i > 0) fsize += N*arch[i];
+    }
+    
+    ws.activations.resize(asize);
+    ws.fields.resize(fsize);
+    
+    memcpy(ws.activations.data(), input, N*arch[0]*sizeof(T));
+    
+    const T* dptr = w;
+    T* aptr = ws.activations.data();
+    T* vptr = ws.fields.data();
+    
+    for(unsigned int l=0;l+1<arch.size();l++){
+      const unsigned int rows = arch[l+1];
+      const unsigned int cols = arch[l];
+      
+      // V = [b ... b]^T + A*W^T
+      const T* bias = dptr + rows*cols;
+      
+      for(unsigned int n=0;n<N;n++)
+	memcpy(vptr + n*rows, bias, rows*sizeof(T));
+      
+      math::gemm(false, true, N, rows, cols, 1.0f,
+	         aptr, cols, dptr, cols,
+	         1.0f, vptr, rows);
+      
+      // next layer's input A = g(V)
+      T* next = aptr + N*cols;
+      
+      memcpy(next, vptr, N*rows*sizeof(T));
+      nonlin_layer(next, rows, N, l);
+      
+      dptr += (cols + 1)*rows; // matrix W and bias b
+      aptr = next;
+      vptr += N*rows;
+    }
+    
+    return true;
+  }
+  
+
+  template <typename T>
+  bool nnetwork<T>::pack_batch(typename std::vector< math::vertex<T> >::const_iterator begin,
+			       typename std::vector< math::vertex<T> >::const_iterator end,
+			       const unsigned int dim, std::vector<T>& M)
+  {
+    if(end < begin) return false;
+    
+    const unsigned int N = (unsigned int)(end - begin);
+    
+    M.resize(N*dim);
+    
+    unsigned int n = 0;
+    
+    for(auto i = begin;i != end;i++, n++){
+      if(i->size() != dim)
+	return false;
+      
+      if(i->exportData(&(M[n*dim]), dim, 0) == false)
+	return false;
+    }
+    
+    return true;
+  }
 
 
   template <typename T> // number of layers
@@ -653,10 +874,7 @@ namespace whiteice
     const T* bptr = _bpdata;
 
     // calculates local gradient
-    for(unsigned int i=0;i<arch[arch.size()-1];i++){
-      lgrad[i] *= Dnonlin(*bptr, layer , i);
-      bptr++;
-    }
+    Dnonlin_layer(bptr, lgrad, arch[arch.size()-1], 1, layer, true);
   
     const T* _data = &(data[0]);
     
@@ -686,12 +904,14 @@ namespace whiteice
       const T* dptr = _data;
       
       {
+	// input activations of this layer g(v) (temp is free until next lgrad)
+	memcpy(temp, _bpdata, cols*sizeof(T));
+	nonlin_layer(temp, cols, 1, layer-1);
+	
 	// matrix W gradients
 	for(unsigned int y=0;y<rows;y++){
-	  const T* bptr = _bpdata;
 	  for(unsigned int x=0;x<cols;x++,gindex++){
-	    grad[gindex] = -lgrad[y] * nonlin(*bptr, layer-1, x);
-	    bptr++;
+	    grad[gindex] = -lgrad[y] * temp[x];
 	  }
 	}
 	
@@ -726,10 +946,7 @@ namespace whiteice
 		    1.0f, (float*)_data, cols, (float*)lgrad, 1,
 		    0.0f, (float*)temp, 1);
 	
-	for(unsigned int x=0;x<cols;x++){
-	  temp[x] *= Dnonlin(*bptr, layer - 1, x);
-	  bptr++;
-	}
+	Dnonlin_layer(bptr, temp, cols, 1, layer - 1, true);
 	
       }
       else if(typeid(T) == typeid(whiteice::math::blas_real<double>)){
@@ -739,10 +956,7 @@ namespace whiteice
 		    1.0f, (double*)_data, cols, (double*)lgrad, 1,
 		    0.0f, (double*)temp, 1);
 	
-	for(unsigned int x=0;x<cols;x++){
-	  temp[x] *= Dnonlin(*bptr, layer - 1, x);
-	  bptr++;
-	}
+	Dnonlin_layer(bptr, temp, cols, 1, layer - 1, true);
 	
       }
       else
@@ -752,11 +966,10 @@ namespace whiteice
 	  for(unsigned int y=0;y<rows;y++)
 	    sum += lgrad[y]*_data[x + y*cols];
 	  
-	  sum *= Dnonlin(*bptr, layer - 1, x);
-	  
 	  temp[x] = sum;
-	  bptr++;
 	}
+	
+	Dnonlin_layer(bptr, temp, cols, 1, layer - 1, true);
       }
       
       // swaps memory pointers
@@ -987,6 +1200,208 @@ namespace whiteice
 
     return true;
   }
+
+
+  // batched gradient: sum of gradients of 0.5*||output_i - f(input_i|w)||^2
+  template <typename T>
+  bool nnetwork<T>::gradient(const math::matrix<T>& input,
+			     const math::matrix<T>& output,
+			     math::vertex<T>& grad) const
+  {
+    if(input.xsize() != input_size() || output.xsize() != output_size())
+      return false;
+
+    if(input.ysize() != output.ysize())
+      return false;
+
+    const unsigned int N = input.ysize();
+    
+    grad.resize(size);
+    
+    if(N == 0){
+      grad.zero();
+      return true;
+    }
+    
+    workspace ws;
+    
+    if(forward_batch(&(data[0]), &(input(0,0)), N, ws) == false)
+      return false;
+
+    return backward_batch(&(data[0]), &(output(0,0)), N, grad, ws);
+  }
+
+
+  template <typename T>
+  bool nnetwork<T>::gradient(typename std::vector< math::vertex<T> >::const_iterator ibegin,
+			     typename std::vector< math::vertex<T> >::const_iterator iend,
+			     typename std::vector< math::vertex<T> >::const_iterator obegin,
+			     math::vertex<T>& grad) const
+  {
+    workspace ws;
+    
+    if(data.size() != size)
+      return false;
+    
+    math::vertex<T> w;
+    w.view(const_cast<T*>(&(data[0])), size);
+    
+    return gradient(w, ibegin, iend, obegin, grad, ws);
+  }
+
+
+  template <typename T>
+  bool nnetwork<T>::gradient(const math::vertex<T>& w,
+			     const math::matrix<T>& input, const math::matrix<T>& output,
+			     math::vertex<T>& grad, workspace& ws) const
+  {
+    if(w.size() != size)
+      return false;
+    
+    if(input.xsize() != input_size() || output.xsize() != output_size())
+      return false;
+
+    if(input.ysize() != output.ysize())
+      return false;
+
+    const unsigned int N = input.ysize();
+    
+    grad.resize(size);
+    
+    if(N == 0){
+      grad.zero();
+      return true;
+    }
+    
+    if(forward_batch(&(w[0]), &(input(0,0)), N, ws) == false)
+      return false;
+
+    return backward_batch(&(w[0]), &(output(0,0)), N, grad, ws);
+  }
+
+
+  template <typename T>
+  bool nnetwork<T>::gradient(const math::vertex<T>& w,
+			     typename std::vector< math::vertex<T> >::const_iterator ibegin,
+			     typename std::vector< math::vertex<T> >::const_iterator iend,
+			     typename std::vector< math::vertex<T> >::const_iterator obegin,
+			     math::vertex<T>& grad, workspace& ws) const
+  {
+    if(w.size() != size)
+      return false;
+    
+    if(pack_batch(ibegin, iend, input_size(), ws.input) == false)
+      return false;
+    
+    if(pack_batch(obegin, obegin + (iend - ibegin), output_size(), ws.output) == false)
+      return false;
+
+    const unsigned int N = (unsigned int)(iend - ibegin);
+    
+    grad.resize(size);
+    
+    if(N == 0){
+      grad.zero();
+      return true;
+    }
+    
+    if(forward_batch(&(w[0]), ws.input.data(), N, ws) == false)
+      return false;
+    
+    return backward_batch(&(w[0]), ws.output.data(), N, grad, ws);
+  }
+
+
+  /*
+   * batched backward pass: calculates sum of gradients of
+   * 0.5*||output_i - f(input_i|w)||^2 over the minibatch.
+   *
+   * local gradients of all samples are kept as rows of a (N x width)
+   * matrix so weight gradients become delta^T * A and the next local
+   * gradients (delta * W) .* g'(v) [both are GEMMs]
+   */
+  template <typename T>
+  bool nnetwork<T>::backward_batch(const T* w, const T* output, const unsigned int N,
+				   math::vertex<T>& grad, workspace& ws) const
+  {
+    const std::vector<T>& activations = ws.activations;
+    const std::vector<T>& fields = ws.fields;
+    
+    std::vector<T>& delta = ws.delta;
+    std::vector<T>& temp = ws.temp;
+    delta.resize(N*maxwidth);
+    temp.resize(N*maxwidth);
+
+    grad.resize(size);
+
+    int layer = arch.size() - 2;
+    
+    // initial (last layer) local gradient: (f(x) - y) .* g'(v)
+    {
+      const unsigned int rows = arch[layer+1];
+      const T* aptr = activations.data() + activations.size() - N*rows;
+      const T* vptr = fields.data() + fields.size() - N*rows;
+      
+      for(unsigned int n=0;n<N;n++){
+	for(unsigned int i=0;i<rows;i++){
+	  delta[n*rows + i] = (aptr[n*rows + i] - output[n*rows + i]);
+	}
+      }
+      
+      Dnonlin_layer(vptr, delta.data(), rows, N, layer, true);
+    }
+    
+    const T* aptr = activations.data() + activations.size() - N*arch[arch.size()-1];
+    const T* vptr = fields.data() + fields.size() - N*arch[arch.size()-1];
+    const T* dptr = w + size;
+    unsigned int gindex = size;
+    
+    while(layer >= 0){
+      const unsigned int rows = arch[layer+1];
+      const unsigned int cols = arch[layer];
+      
+      aptr   -= N*cols; // input activations of this layer
+      dptr   -= rows*cols + rows;
+      gindex -= rows*cols + rows;
+      
+      if(frozen[layer]){
+	memset(&(grad[gindex]), 0, sizeof(T)*(rows*cols + rows));
+      }
+      else{
+	// delta W = delta^T * A
+	math::gemm(true, false, rows, cols, N, 1.0f,
+	           delta.data(), rows, aptr, cols,
+	           0.0f, &(grad[gindex]), cols);
+	
+	// delta b = SUM(delta)
+	for(unsigned int y=0;y<rows;y++){
+	  T sum = T(0.0f);
+	  for(unsigned int n=0;n<N;n++)
+	    sum += delta[n*rows + y];
+	  grad[gindex + rows*cols + y] = sum;
+	}
+      }
+      
+      if(layer > 0){
+	// next local gradient: (delta * W) .* g'(v)
+	vptr -= N*cols;
+	
+	math::gemm(false, false, N, cols, rows, 1.0f,
+	           delta.data(), rows, dptr, cols,
+	           0.0f, temp.data(), cols);
+	
+	Dnonlin_layer(vptr, temp.data(), cols, N, layer - 1, true);
+	
+	std::swap(delta, temp);
+      }
+      
+      layer--;
+    }
+    
+    assert(gindex == 0);
+    
+    return true;
+  }
   
   
   template <typename T> // non-linearity used in neural network
@@ -1186,6 +1601,83 @@ namespace whiteice
   }
 
   
+  template <typename T> // non-linearity of a whole layer using vectorized kernels
+  void nnetwork<T>::nonlin_layer(T* x, const unsigned int rows, const unsigned int N,
+				 const unsigned int layer) const
+  {
+    assert(layer < getLayers());
+    assert(rows == getNeurons(layer));
+    
+    const nnkernels::nonlinearity nl = (nnkernels::nonlinearity)nonlinearity[layer];
+    
+    if(typeid(T) == typeid(whiteice::math::blas_real<float>) || typeid(T) == typeid(float)){
+      nnkernels::activation(nl, (float*)x, rows*N);
+    }
+    else if(typeid(T) == typeid(whiteice::math::blas_real<double>) || typeid(T) == typeid(double)){
+      nnkernels::activation(nl, (double*)x, rows*N);
+    }
+    else{
+      for(unsigned int n=0;n<N;n++)
+	for(unsigned int i=0;i<rows;i++)
+	  x[n*rows + i] = nonlin(x[n*rows + i], layer, i);
+      
+      return;
+    }
+    
+    if(nonlinearity[layer] == stochasticSigmoid){
+      for(unsigned int i=0;i<rows*N;i++){
+	const T r = T(((double)rand())/((double)RAND_MAX));
+	if(x[i] > r) x[i] = T(1.0);
+	else x[i] = T(0.0);
+      }
+    }
+    
+    if(dropout.size() > 0){
+      for(unsigned int i=0;i<rows;i++){
+	if(dropout[layer][i])
+	  for(unsigned int n=0;n<N;n++)
+	    x[n*rows + i] = T(0.0);
+      }
+    }
+  }
+  
+  
+  template <typename T> // derivate of non-linearity of a whole layer using vectorized kernels
+  void nnetwork<T>::Dnonlin_layer(const T* v, T* d, const unsigned int rows, const unsigned int N,
+				  const unsigned int layer, const bool multiply) const
+  {
+    assert(layer < getLayers());
+    assert(rows == getNeurons(layer));
+    
+    const nnkernels::nonlinearity nl = (nnkernels::nonlinearity)nonlinearity[layer];
+    
+    if(typeid(T) == typeid(whiteice::math::blas_real<float>) || typeid(T) == typeid(float)){
+      nnkernels::dactivation(nl, (const float*)v, (float*)d, rows*N, multiply);
+    }
+    else if(typeid(T) == typeid(whiteice::math::blas_real<double>) || typeid(T) == typeid(double)){
+      nnkernels::dactivation(nl, (const double*)v, (double*)d, rows*N, multiply);
+    }
+    else{
+      for(unsigned int n=0;n<N;n++){
+	for(unsigned int i=0;i<rows;i++){
+	  if(multiply) d[n*rows + i] *= Dnonlin(v[n*rows + i], layer, i);
+	  else d[n*rows + i] = Dnonlin(v[n*rows + i], layer, i);
+	}
+      }
+      
+      return;
+    }
+    
+    if(dropout.size() > 0){
+      for(unsigned int i=0;i<rows;i++){
+	if(dropout[layer][i])
+	  for(unsigned int n=0;n<N;n++)
+	    d[n*rows + i] = T(0.0);
+      }
+    }
+  }
+  
+  
   template <typename T>
   inline T nnetwork<T>::inv_nonlin(const T& input, unsigned int layer, unsigned int neuron) const throw()
   {
@@ -1269,7 +1761,14 @@ namespace whiteice
   //////////////////////////////////////////////////////////////////////
 
   template <typename T>
-  bool nnetwork<T>::save(const std::string& filename) const throw(){
+  bool nnetwork<T>::save(const std::string& filename,
+			 const bool binary, const bool float16) const throw(){
+    if(binary){
+      std::vector< const nnetwork<T>* > nets;
+      nets.push_back(this);
+      return nnetwork_file<T>::save(filename, nets, float16);
+    }
+    
     try{
       whiteice::conffile configuration;
       
@@ -1382,6 +1881,19 @@ namespace whiteice
   // load neuralnetwork data from file
   template <typename T>
   bool nnetwork<T>::load(const std::string& filename) throw(){
+    if(nnetwork_file<T>::isBinary(filename)){
+      std::vector< nnetwork<T>* > nets;
+      if(nnetwork_file<T>::load(filename, nets) == false)
+	return false;
+      
+      bool ok = (nets.size() == 1);
+      if(ok) *this = *nets[0];
+      
+      for(auto& n : nets) delete n;
+      
+      return ok;
+    }
+    
     try{
       whiteice::conffile configuration;
       std::vector<std::string> strings;
@@ -1587,6 +2099,34 @@ namespace whiteice
   }
   
   
+  template <typename T>
+  bool nnetwork<T>::exportdata(math::float16_vector& v) const throw(){
+    try{
+      v.resize(size);
+      if(size > 0) math::to_half(&(data[0]), v.data(), size);
+      return true;
+    }
+    catch(std::exception& e){ return false; }
+  }
+  
+  template <typename T>
+  bool nnetwork<T>::importdata(const math::float16_vector& v) throw(){
+    if(v.size() != size)
+      return false;
+    
+    math::from_half(v.data(), &(data[0]), size);
+    
+    // "safebox" (infinities of float16 are not allowed)
+    for(unsigned int i=0;i<data.size();i++){
+      if(whiteice::math::isnan(data[i])) data[i] = T(0.0);
+      if(data[i] < T(-10000.0)) data[i] = T(-10000.0);
+      else if(data[i] > T(10000.0)) data[i] = T(10000.0);
+    }
+    
+    return true;
+  }
+  
+  
   // number of dimensions used by import/export
   template <typename T>
   unsigned int nnetwork<T>::exportdatasize() const throw(){
@@ -2048,8 +2588,8 @@ namespace whiteice
     }
 
   }
-  
-  
+
+
   ////////////////////////////////////////////////////////////
   // can be used to decrease memory usage
   
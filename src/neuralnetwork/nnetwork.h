@@ -18,6 +18,7 @@
 
 #include "dinrhiw_blas.h"
 #include "vertex.h"
+#include "float16.h"
 #include "conffile.h"
 #include "compressable.h"
 #include "MemoryCompressor.h"
@@ -34,6 +35,14 @@ namespace whiteice
     {
     public:
 
+    // scratch memory of batched calculations. Reusing the same workspace
+    // (one per thread) makes repeated batched calls allocation free
+    struct workspace {
+      std::vector<T> input, output;       // packed input and output batches
+      std::vector<T> activations, fields; // layer activations and local fields
+      std::vector<T> delta, temp;         // local gradients
+    };
+
     enum nonLinearity {
       sigmoid = 0, // uses sigmoid non-linearity as the default (0) [output: [0,+1] input (-inf,inf)]
       stochasticSigmoid = 1, // clipped to 0/1 values.. (1)
@@ -91,6 +100,17 @@ namespace whiteice
     // simple thread-safe version [parallelizable version of calculate: don't calculate gradient nor collect samples]
     bool calculate(const math::vertex<T>& input, math::vertex<T>& output) const;
 
+    // batched (minibatch) version of calculate(): rows of input matrix are input samples
+    // and rows of output matrix are the corresponding outputs. Each layer is computed
+    // using a single GEMM call with bias terms and non-linearity fused [thread-safe]
+    bool calculate(const math::matrix<T>& input, math::matrix<T>& output) const;
+
+    // batched calculation of inputs in range [begin,end), for example a slice of
+    // dataset cluster: calculate(data.begin(0)+i, data.begin(0)+i+N, output)
+    bool calculate(typename std::vector< math::vertex<T> >::const_iterator begin,
+		   typename std::vector< math::vertex<T> >::const_iterator end,
+		   math::matrix<T>& output) const;
+
     unsigned int length() const; // number of layers
     
     bool randomize();
@@ -102,20 +122,64 @@ namespace whiteice
     // calculates gradient of parameter weights w f(v|w)
     bool gradient(const math::vertex<T>& input, math::matrix<T>& grad) const;
 
+    // batched backward pass: calculates sum of squared error gradients over the minibatch
+    // grad = SUM_i grad(0.5*||output_i - f(input_i|w)||^2), rows of matrices are samples.
+    // does its own forward pass so calculate(gradInfo=true) is not needed [thread-safe]
+    bool gradient(const math::matrix<T>& input, const math::matrix<T>& output,
+		  math::vertex<T>& grad) const;
+
+    // batched gradient of samples in input range [ibegin,iend) and outputs starting from obegin
+    bool gradient(typename std::vector< math::vertex<T> >::const_iterator ibegin,
+		  typename std::vector< math::vertex<T> >::const_iterator iend,
+		  typename std::vector< math::vertex<T> >::const_iterator obegin,
+		  math::vertex<T>& grad) const;
+
     // calculates gradient of input v, grad f(v) while keeping weights w constant
     bool gradient_value(const math::vertex<T>& input, math::matrix<T>& grad) const;
 
+    // batched calculate() and gradient() which use parameters w (in exportdata() format)
+    // directly instead of the network's own parameters. w is only read so threads
+    // can share the same parameter vector without copying nnetwork, and all scratch
+    // memory is taken from thread's own workspace ws [thread-safe].
+    // calculate() puts results to ws.output as rows of (N x output_size()) matrix
+    bool calculate(const math::vertex<T>& w, const math::matrix<T>& input,
+		   workspace& ws) const;
+    
+    bool calculate(const math::vertex<T>& w,
+		   typename std::vector< math::vertex<T> >::const_iterator begin,
+		   typename std::vector< math::vertex<T> >::const_iterator end,
+		   workspace& ws) const;
+    
+    bool gradient(const math::vertex<T>& w,
+		  const math::matrix<T>& input, const math::matrix<T>& output,
+		  math::vertex<T>& grad, workspace& ws) const;
+    
+    bool gradient(const math::vertex<T>& w,
+		  typename std::vector< math::vertex<T> >::const_iterator ibegin,
+		  typename std::vector< math::vertex<T> >::const_iterator iend,
+		  typename std::vector< math::vertex<T> >::const_iterator obegin,
+		  math::vertex<T>& grad, workspace& ws) const;
+
+    // batched calculate() using network's own parameters and workspace ws
+    bool calculate(const math::matrix<T>& input, workspace& ws) const;
+
      ////////////////////////////////////////////////////////////
     
-    // load & saves neuralnetwork data from file
+    // load & saves neuralnetwork data from file. load() detects binary
+    // files (nnetwork_file.h), binary save can store parameters as float16
     bool load(const std::string& filename) throw();
-    bool save(const std::string& filename) const throw();
+    bool save(const std::string& filename,
+	      const bool binary = false, const bool float16 = false) const throw();
 
     ////////////////////////////////////////////////////////////
     
     // exports and imports neural network parameters to/from vertex
     bool exportdata(math::vertex<T>& v) const throw();
     bool importdata(const math::vertex<T>& v) throw();
+
+    // parameter snapshots in half precision (compact storage)
+    bool exportdata(math::float16_vector& v) const throw();
+    bool importdata(const math::float16_vector& v) throw();
     
     // number of dimensions used by import/export
     unsigned int exportdatasize() const throw();
@@ -177,6 +241,14 @@ namespace whiteice
     T inv_nonlin(const T& input, unsigned int layer, unsigned int neuron) const throw(); // inverse of non-linearity used [not really used]
     
     private:
+
+    // calculates non-linearity x = g(x) of a whole layer for N samples (rows neurons per sample)
+    void nonlin_layer(T* x, const unsigned int rows, const unsigned int N,
+		      const unsigned int layer) const;
+
+    // calculates d = g'(v) (or d .*= g'(v) if multiply is true) of a whole layer for N samples
+    void Dnonlin_layer(const T* v, T* d, const unsigned int rows, const unsigned int N,
+		       const unsigned int layer, const bool multiply) const;
     
     inline void gemv(unsigned int yd, unsigned int xd, T* W, T* x, T* y);
     inline void gvadd(unsigned int dim, T* s, T* b);
@@ -185,7 +257,25 @@ namespace whiteice
     inline void gemv_gvadd(unsigned int yd, unsigned int xd, 
 			   const T* W, T* x, T* y,
 			   unsigned int dim, T* s, const T* b) const;
-    
+
+    // batched forward pass of N samples using parameters w, result is in ws.output
+    bool calculate_batch(const T* w, const T* input, const unsigned int N,
+			 workspace& ws) const;
+
+    // batched forward pass which stores all layers' input activations (first block
+    // is input itself) and local fields (v = Wx+b) to ws for the backward pass
+    bool forward_batch(const T* w, const T* input, const unsigned int N,
+		       workspace& ws) const;
+
+    // batched backward pass after forward_batch(): squared error gradient sum
+    bool backward_batch(const T* w, const T* output, const unsigned int N,
+			math::vertex<T>& grad, workspace& ws) const;
+
+    // packs vertexes [begin,end) into rows of row-major (N x dim) matrix M
+    static bool pack_batch(typename std::vector< math::vertex<T> >::const_iterator begin,
+			   typename std::vector< math::vertex<T> >::const_iterator end,
+			   const unsigned int dim, std::vector<T>& M);
+
     
     // data structures which are part of
     // interface
@@ -0,0 +1,297 @@
+
+#include "nnetwork_file.h"
+#include "MMAP.h"
+#include "float16.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <typeinfo>
+#include <memory>
+
+
+namespace whiteice
+{
+  static const char NNETWORK_FILE_MAGIC[8] = { 'D','N','N','B','I','N','\0','\0' };
+  static const unsigned int NNETWORK_FILE_FLOAT16 = 1; // parameters are float16
+  static const unsigned long long NNETWORK_FILE_ALIGN = 64;
+
+  struct nnetwork_file_header
+  {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint32_t elemsize;  // bytes per parameter (2, 4 or 8)
+    uint32_t layers;    // number of entries in architecture table
+    uint64_t samples;   // number of parameter blocks
+    uint64_t params;    // parameters per block
+    uint64_t offset;    // file offset of the first parameter block
+    char reserved[16];
+  };
+
+
+  static inline unsigned long long nnetwork_file_align(const unsigned long long n)
+  {
+    return ((n + NNETWORK_FILE_ALIGN - 1)/NNETWORK_FILE_ALIGN)*NNETWORK_FILE_ALIGN;
+  }
+
+
+  // number format of T (4 = float, 8 = double)
+  template <typename T>
+  static inline unsigned int nnetwork_file_native()
+  {
+    if(typeid(T) == typeid(float) || typeid(T) == typeid(math::blas_real<float>))
+      return 4;
+    else if(typeid(T) == typeid(double) || typeid(T) == typeid(math::blas_real<double>))
+      return 8;
+    else
+      return 0;
+  }
+
+
+  template <typename T>
+  bool nnetwork_file<T>::isBinary(const std::string& filename) throw()
+  {
+    FILE* fp = fopen(filename.c_str(), "rb");
+    if(fp == 0) return false;
+
+    char magic[8];
+    const bool ok = (fread(magic, sizeof(magic), 1, fp) == 1 &&
+		     memcmp(magic, NNETWORK_FILE_MAGIC, sizeof(magic)) == 0);
+
+    fclose(fp);
+
+    return ok;
+  }
+
+
+  template <typename T>
+  bool nnetwork_file<T>::save(const std::string& filename,
+			      const std::vector< const nnetwork<T>* >& nets,
+			      const bool float16) throw()
+  {
+    if(nets.size() == 0 || nets[0] == nullptr) return false;
+
+    try{
+      std::vector<unsigned int> arch;
+      nets[0]->getArchitecture(arch);
+
+      const unsigned int native = nnetwork_file_native<T>();
+
+      nnetwork_file_header h;
+      memset(&h, 0, sizeof(h));
+      memcpy(h.magic, NNETWORK_FILE_MAGIC, sizeof(h.magic));
+      h.version = VERSION;
+      h.flags = float16 ? NNETWORK_FILE_FLOAT16 : 0;
+      h.elemsize = float16 ? 2 : (native ? native : 4);
+      h.layers = arch.size();
+      h.samples = nets.size();
+      h.params = nets[0]->exportdatasize();
+
+      // architecture, nonlinearity and frozen tables
+      std::vector<uint32_t> tables;
+
+      for(const auto& a : arch)
+	tables.push_back(a);
+
+      for(unsigned int l=0;l+1<arch.size();l++){
+	const typename nnetwork<T>::nonLinearity nl = nets[0]->getNonlinearity(l);
+
+	if(nl == nnetwork<T>::sigmoid) tables.push_back(0);
+	else if(nl == nnetwork<T>::stochasticSigmoid) tables.push_back(1);
+	else if(nl == nnetwork<T>::halfLinear) tables.push_back(2);
+	else if(nl == nnetwork<T>::pureLinear) tables.push_back(3);
+	else if(nl == nnetwork<T>::tanh) tables.push_back(4);
+	else return false;
+      }
+
+      for(unsigned int l=0;l+1<arch.size();l++)
+	tables.push_back(nets[0]->getFrozen(l) ? 1 : 0);
+
+      h.offset = nnetwork_file_align(sizeof(h) + tables.size()*sizeof(uint32_t));
+
+      const unsigned long long blocksize = h.params*h.elemsize;
+      const unsigned long long stride = nnetwork_file_align(blocksize);
+
+      std::vector<char> padding(NNETWORK_FILE_ALIGN, 0);
+      std::vector<char> buffer;
+
+      FILE* fp = fopen(filename.c_str(), "wb");
+      if(fp == 0) return false;
+
+      bool ok = true;
+
+      ok = ok && (fwrite(&h, sizeof(h), 1, fp) == 1);
+      ok = ok && (fwrite(tables.data(), sizeof(uint32_t), tables.size(), fp) == tables.size());
+      ok = ok && (fwrite(padding.data(), 1,
+			 h.offset - sizeof(h) - tables.size()*sizeof(uint32_t), fp) ==
+		  h.offset - sizeof(h) - tables.size()*sizeof(uint32_t));
+
+      math::vertex<T> w;
+
+      for(unsigned int s=0;s<nets.size() && ok;s++){
+	if(nets[s] == nullptr || nets[s]->exportdata(w) == false || w.size() != h.params){
+	  ok = false;
+	  break;
+	}
+
+	const char* ptr = nullptr;
+
+	if(h.elemsize == native){
+	  ptr = (const char*)&(w[0]); // same number format as T
+	}
+	else{
+	  buffer.resize(blocksize);
+
+	  if(h.elemsize == 2){
+	    math::to_half(&(w[0]), (unsigned short*)buffer.data(), h.params);
+	  }
+	  else{
+	    for(unsigned long long i=0;i<h.params;i++){
+	      if(h.elemsize == 4)
+		math::convert(((float*)buffer.data())[i], w[i]);
+	      else
+		math::convert(((double*)buffer.data())[i], w[i]);
+	    }
+	  }
+
+	  ptr = buffer.data();
+	}
+
+	ok = ok && (fwrite(ptr, 1, blocksize, fp) == blocksize);
+	ok = ok && (fwrite(padding.data(), 1, stride - blocksize, fp) == stride - blocksize);
+      }
+
+      if(fclose(fp) != 0) ok = false;
+
+      return ok;
+    }
+    catch(std::exception& e){
+      return false;
+    }
+  }
+
+
+  template <typename T>
+  bool nnetwork_file<T>::load(const std::string& filename,
+			      std::vector< nnetwork<T>* >& nets) throw()
+  {
+    std::vector< nnetwork<T>* > loaded;
+
+    try{
+      FileMMAP m(filename);
+      const unsigned char* ptr = m.data();
+
+      if(m.size() < sizeof(nnetwork_file_header)) return false;
+
+      nnetwork_file_header h;
+      memcpy(&h, ptr, sizeof(h));
+
+      if(memcmp(h.magic, NNETWORK_FILE_MAGIC, sizeof(h.magic)) != 0) return false;
+      if(h.version != VERSION) return false;
+      if(h.layers < 2 || h.samples == 0) return false;
+
+      if(h.flags & NNETWORK_FILE_FLOAT16){
+	if(h.elemsize != 2) return false;
+      }
+      else if(h.elemsize != 4 && h.elemsize != 8) return false;
+
+      const unsigned long long tablesize = (3ULL*h.layers - 2)*sizeof(uint32_t);
+
+      if(sizeof(h) + tablesize > h.offset || h.offset > m.size()) return false;
+
+      const uint32_t* tables = (const uint32_t*)(ptr + sizeof(h));
+
+      std::vector<unsigned int> arch(h.layers);
+      std::vector< typename nnetwork<T>::nonLinearity > nl(h.layers - 1);
+      std::vector<bool> frozen(h.layers - 1);
+
+      unsigned long long params = 0;
+
+      for(unsigned int i=0;i<arch.size();i++){
+	arch[i] = tables[i];
+	if(arch[i] == 0) return false;
+	if(i > 0) params += (arch[i-1] + 1ULL)*arch[i];
+      }
+
+      if(params != h.params) return false;
+
+      for(unsigned int l=0;l<nl.size();l++){
+	switch(tables[h.layers + l]){
+	case 0: nl[l] = nnetwork<T>::sigmoid; break;
+	case 1: nl[l] = nnetwork<T>::stochasticSigmoid; break;
+	case 2: nl[l] = nnetwork<T>::halfLinear; break;
+	case 3: nl[l] = nnetwork<T>::pureLinear; break;
+	case 4: nl[l] = nnetwork<T>::tanh; break;
+	default: return false;
+	}
+
+	frozen[l] = (tables[2*h.layers - 1 + l] != 0);
+      }
+
+      const unsigned long long blocksize = h.params*h.elemsize;
+      const unsigned long long stride = nnetwork_file_align(blocksize);
+
+      if(h.samples - 1 > (m.size() - h.offset)/stride ||
+	 h.offset + (h.samples - 1)*stride + blocksize > m.size())
+	return false;
+
+      const bool direct = (h.elemsize == nnetwork_file_native<T>());
+      math::vertex<T> w;
+      bool ok = true;
+
+      if(!direct) w.resize(h.params);
+
+      for(unsigned long long s=0;s<h.samples && ok;s++){
+	const unsigned char* block = ptr + h.offset + s*stride;
+
+	std::unique_ptr< nnetwork<T> > nn(new nnetwork<T>(arch));
+
+	ok = nn->setNonlinearity(nl) && nn->setFrozen(frozen);
+
+	if(direct){
+	  // parameters are imported directly from the mapped file
+	  math::vertex<T> v;
+	  v.view((T*)block, h.params);
+
+	  ok = ok && nn->importdata(v);
+	}
+	else if(h.elemsize == 2){
+	  math::from_half((const unsigned short*)block, &(w[0]), h.params);
+	  ok = ok && nn->importdata(w);
+	}
+	else{
+	  for(unsigned long long i=0;i<h.params;i++){
+	    if(h.elemsize == 4)
+	      w[i] = T(((const float*)block)[i]);
+	    else
+	      w[i] = T(((const double*)block)[i]);
+	  }
+
+	  ok = ok && nn->importdata(w);
+	}
+
+	if(ok) loaded.push_back(nn.release());
+      }
+
+      if(!ok){
+	for(auto& n : loaded) delete n;
+	return false;
+      }
+
+      nets = loaded;
+
+      return true;
+    }
+    catch(std::exception& e){
+      for(auto& n : loaded) delete n;
+      return false;
+    }
+  }
+
+
+  template class nnetwork_file< float >;
+  template class nnetwork_file< double >;
+  template class nnetwork_file< math::blas_real<float> >;
+  template class nnetwork_file< math::blas_real<double> >;
+};
@@ -0,0 +1,56 @@
+/*
+ * binary file format for nnetwork and bayesian_nnetwork
+ *
+ * 64 byte header (magic, version, flags, element size, number of
+ * layers, number of parameter samples, parameters per sample and
+ * offset of the first parameter block) is followed by architecture,
+ * nonlinearity and frozen layer tables (32bit integers) and one
+ * parameter block per sample. Parameter blocks are aligned to 64 bytes
+ * and contain parameters in exportdata() order as native float,
+ * double or float16 values so the file can be memory mapped and
+ * parameters copied directly to networks.
+ */
+
+#ifndef nnetwork_file_h
+#define nnetwork_file_h
+
+#include <vector>
+#include <string>
+
+#include "nnetwork.h"
+
+
+namespace whiteice
+{
+  template < typename T = math::blas_real<float> >
+    class nnetwork_file
+    {
+    public:
+      // file format version
+      static const unsigned int VERSION = 1;
+
+      // true if file starts with binary nnetwork file header
+      static bool isBinary(const std::string& filename) throw();
+
+      // saves architecture of nets[0] and parameters of all nets
+      // (nets must have the same architecture). If float16 is true
+      // parameters are stored in half precision.
+      static bool save(const std::string& filename,
+		       const std::vector< const nnetwork<T>* >& nets,
+		       const bool float16 = false) throw();
+
+      // loads all parameter samples as separate networks
+      // (caller must delete nets)
+      static bool load(const std::string& filename,
+		       std::vector< nnetwork<T>* >& nets) throw();
+    };
+
+
+  extern template class nnetwork_file< float >;
+  extern template class nnetwork_file< double >;
+  extern template class nnetwork_file< math::blas_real<float> >;
+  extern template class nnetwork_file< math::blas_real<double> >;
+};
+
+
+#endif
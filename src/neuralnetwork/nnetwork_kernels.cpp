@@ -0,0 +1,123 @@
+/*
+ * nnetwork activation kernels: generic implementation and
+ * runtime selection of the instruction set specific implementation
+ */
+
+#include "nnetwork_kernels.h"
+
+#include <math.h>
+
+
+namespace whiteice
+{
+  namespace nnkernels
+  {
+    namespace generic
+    {
+      // "vector" of a single scalar value
+      template <typename F>
+      struct vscalar
+      {
+	typedef F reg;
+	typedef F scalar;
+	static const unsigned int width = 1;
+
+	static inline reg load(const F* p){ return *p; }
+	static inline void store(F* p, reg x){ *p = x; }
+	static inline reg set1(F x){ return x; }
+	static inline reg add(reg a, reg b){ return a + b; }
+	static inline reg sub(reg a, reg b){ return a - b; }
+	static inline reg mul(reg a, reg b){ return a * b; }
+	static inline reg div(reg a, reg b){ return a / b; }
+	static inline reg fmadd(reg a, reg b, reg c){ return a*b + c; }
+	static inline reg min(reg a, reg b){ return (a < b) ? a : b; }
+	static inline reg max(reg a, reg b){ return (a > b) ? a : b; }
+	static inline reg abs(reg a){ return (a < F(0.0)) ? -a : a; }
+	static inline reg round(reg a){ return (F)::nearbyint(a); }
+	static inline reg pow2n(reg n){ return (F)::ldexp(F(1.0), (int)n); }
+	static inline reg select_gt(reg a, reg b, reg x, reg y){ return (a > b) ? x : y; }
+      };
+
+      typedef vscalar<float> vfloat;
+      typedef vscalar<double> vdouble;
+
+#include "nnetwork_kernels_simd.h"
+    };
+
+
+    // selects implementation once using CPUID
+    struct kernel_table
+    {
+      void (*activation_f)(const nonlinearity, float*, const unsigned int);
+      void (*activation_d)(const nonlinearity, double*, const unsigned int);
+      void (*dactivation_f)(const nonlinearity, const float*, float*,
+			    const unsigned int, const bool);
+      void (*dactivation_d)(const nonlinearity, const double*, double*,
+			    const unsigned int, const bool);
+      const char* name;
+
+      kernel_table()
+      {
+	activation_f = &generic::activation;
+	activation_d = &generic::activation;
+	dactivation_f = &generic::dactivation;
+	dactivation_d = &generic::dactivation;
+	name = "generic";
+
+#ifdef NNKERNELS_X86
+	__builtin_cpu_init();
+
+	if(__builtin_cpu_supports("avx512f")){
+	  activation_f = &avx512::activation;
+	  activation_d = &avx512::activation;
+	  dactivation_f = &avx512::dactivation;
+	  dactivation_d = &avx512::dactivation;
+	  name = "avx512f";
+	}
+	else if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){
+	  activation_f = &avx2::activation;
+	  activation_d = &avx2::activation;
+	  dactivation_f = &avx2::dactivation;
+	  dactivation_d = &avx2::dactivation;
+	  name = "avx2";
+	}
+#endif
+      }
+    };
+
+    static const kernel_table& kernels()
+    {
+      static const kernel_table table;
+      return table;
+    }
+
+
+    void activation(const nonlinearity nl, float* x, const unsigned int N)
+    {
+      kernels().activation_f(nl, x, N);
+    }
+
+    void activation(const nonlinearity nl, double* x, const unsigned int N)
+    {
+      kernels().activation_d(nl, x, N);
+    }
+
+    void dactivation(const nonlinearity nl, const float* v, float* d,
+		     const unsigned int N, const bool multiply)
+    {
+      kernels().dactivation_f(nl, v, d, N, multiply);
+    }
+
+    void dactivation(const nonlinearity nl, const double* v, double* d,
+		     const unsigned int N, const bool multiply)
+    {
+      kernels().dactivation_d(nl, v, d, N, multiply);
+    }
+
+    const char* instruction_set()
+    {
+      return kernels().name;
+    }
+
+  };
+};
@@ -0,0 +1,67 @@
+/*
+ * whole-layer activation function kernels used by nnetwork
+ *
+ * non-linearities are calculated for a whole layer (or minibatch
+ * of layers) at once using fast polynomial exp() approximation.
+ * AVX2 or AVX-512 implementation is selected at runtime (CPUID)
+ * and generic C++ code is used when they are not available.
+ */
+
+#ifndef nnetwork_kernels_h
+#define nnetwork_kernels_h
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define NNKERNELS_X86 1
+#endif
+
+
+namespace whiteice
+{
+  namespace nnkernels
+  {
+    // activation functions, values are same as in nnetwork<T>::nonLinearity
+    enum nonlinearity {
+      SIGMOID = 0,
+      STOCHASTIC_SIGMOID = 1, // kernels calculate sigmoid, caller does the sampling
+      HALF_LINEAR = 2,
+      PURE_LINEAR = 3,
+      TANH = 4
+    };
+
+    // x[i] = g(x[i]), i = 0..N-1
+    void activation(const nonlinearity nl, float* x, const unsigned int N);
+    void activation(const nonlinearity nl, double* x, const unsigned int N);
+
+    // d[i] = g'(v[i]) or d[i] *= g'(v[i]) if multiply is true
+    void dactivation(const nonlinearity nl, const float* v, float* d,
+		     const unsigned int N, const bool multiply = false);
+    void dactivation(const nonlinearity nl, const double* v, double* d,
+		     const unsigned int N, const bool multiply = false);
+
+    // instruction set selected at runtime: "avx512f", "avx2" or "generic"
+    const char* instruction_set();
+
+
+    // per instruction set implementations (used by dispatcher)
+#define NNKERNELS_DECLARE(ISA)						\
+    namespace ISA {							\
+      void activation(const nonlinearity nl, float* x, const unsigned int N); \
+      void activation(const nonlinearity nl, double* x, const unsigned int N); \
+      void dactivation(const nonlinearity nl, const float* v, float* d, \
+		       const unsigned int N, const bool multiply);	\
+      void dactivation(const nonlinearity nl, const double* v, double* d, \
+		       const unsigned int N, const bool multiply);	\
+    }
+
+    NNKERNELS_DECLARE(generic)
+#ifdef NNKERNELS_X86
+    NNKERNELS_DECLARE(avx2)
+    NNKERNELS_DECLARE(avx512)
+#endif
+
+#undef NNKERNELS_DECLARE
+  };
+};
+
+
+#endif
@@ -0,0 +1,105 @@
+/*
+ * AVX2 + FMA implementation of nnetwork activation kernels
+ * (selected at runtime by nnetwork_kernels.cpp)
+ */
+
+#include "nnetwork_kernels.h"
+
+#ifdef NNKERNELS_X86
+
+#include <immintrin.h>
+
+// all code below is compiled for AVX2 and FMA instruction sets
+#ifdef __clang__
+#pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif
+
+
+namespace whiteice
+{
+  namespace nnkernels
+  {
+    namespace avx2
+    {
+      struct vfloat
+      {
+	typedef __m256 reg;
+	typedef float scalar;
+	static const unsigned int width = 8;
+
+	static inline reg load(const float* p){ return _mm256_loadu_ps(p); }
+	static inline void store(float* p, reg x){ _mm256_storeu_ps(p, x); }
+	static inline reg set1(float x){ return _mm256_set1_ps(x); }
+	static inline reg add(reg a, reg b){ return _mm256_add_ps(a, b); }
+	static inline reg sub(reg a, reg b){ return _mm256_sub_ps(a, b); }
+	static inline reg mul(reg a, reg b){ return _mm256_mul_ps(a, b); }
+	static inline reg div(reg a, reg b){ return _mm256_div_ps(a, b); }
+	static inline reg fmadd(reg a, reg b, reg c){ return _mm256_fmadd_ps(a, b, c); }
+	static inline reg min(reg a, reg b){ return _mm256_min_ps(a, b); }
+	static inline reg max(reg a, reg b){ return _mm256_max_ps(a, b); }
+	static inline reg abs(reg a){ return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+
+	static inline reg round(reg a){
+	  return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	}
+
+	static inline reg pow2n(reg n){
+	  __m256i e = _mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127));
+	  return _mm256_castsi256_ps(_mm256_slli_epi32(e, 23));
+	}
+
+	static inline reg select_gt(reg a, reg b, reg x, reg y){
+	  return _mm256_blendv_ps(y, x, _mm256_cmp_ps(a, b, _CMP_GT_OQ));
+	}
+      };
+
+
+      struct vdouble
+      {
+	typedef __m256d reg;
+	typedef double scalar;
+	static const unsigned int width = 4;
+
+	static inline reg load(const double* p){ return _mm256_loadu_pd(p); }
+	static inline void store(double* p, reg x){ _mm256_storeu_pd(p, x); }
+	static inline reg set1(double x){ return _mm256_set1_pd(x); }
+	static inline reg add(reg a, reg b){ return _mm256_add_pd(a, b); }
+	static inline reg sub(reg a, reg b){ return _mm256_sub_pd(a, b); }
+	static inline reg mul(reg a, reg b){ return _mm256_mul_pd(a, b); }
+	static inline reg div(reg a, reg b){ return _mm256_div_pd(a, b); }
+	static inline reg fmadd(reg a, reg b, reg c){ return _mm256_fmadd_pd(a, b, c); }
+	static inline reg min(reg a, reg b){ return _mm256_min_pd(a, b); }
+	static inline reg max(reg a, reg b){ return _mm256_max_pd(a, b); }
+	static inline reg abs(reg a){ return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+
+	static inline reg round(reg a){
+	  return _mm256_round_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	}
+
+	static inline reg pow2n(reg n){
+	  __m256i e = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(n));
+	  e = _mm256_add_epi64(e, _mm256_set1_epi64x(1023));
+	  return _mm256_castsi256_pd(_mm256_slli_epi64(e, 52));
+	}
+
+	static inline reg select_gt(reg a, reg b, reg x, reg y){
+	  return _mm256_blendv_pd(y, x, _mm256_cmp_pd(a, b, _CMP_GT_OQ));
+	}
+      };
+
+#include "nnetwork_kernels_simd.h"
+    };
+  };
+};
+
+
+#ifdef __clang__
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#endif
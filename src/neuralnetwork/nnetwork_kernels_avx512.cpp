@@ -0,0 +1,105 @@
+/*
+ * AVX-512 (AVX512F) implementation of nnetwork activation kernels
+ * (selected at runtime by nnetwork_kernels.cpp)
+ */
+
+#include "nnetwork_kernels.h"
+
+#ifdef NNKERNELS_X86
+
+#include <immintrin.h>
+
+// all code below is compiled for AVX-512 (AVX512F) instruction set
+#ifdef __clang__
+#pragma clang attribute push (__attribute__((target("avx512f"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#endif
+
+
+namespace whiteice
+{
+  namespace nnkernels
+  {
+    namespace avx512
+    {
+      struct vfloat
+      {
+	typedef __m512 reg;
+	typedef float scalar;
+	static const unsigned int width = 16;
+
+	static inline reg load(const float* p){ return _mm512_loadu_ps(p); }
+	static inline void store(float* p, reg x){ _mm512_storeu_ps(p, x); }
+	static inline reg set1(float x){ return _mm512_set1_ps(x); }
+	static inline reg add(reg a, reg b){ return _mm512_add_ps(a, b); }
+	static inline reg sub(reg a, reg b){ return _mm512_sub_ps(a, b); }
+	static inline reg mul(reg a, reg b){ return _mm512_mul_ps(a, b); }
+	static inline reg div(reg a, reg b){ return _mm512_div_ps(a, b); }
+	static inline reg fmadd(reg a, reg b, reg c){ return _mm512_fmadd_ps(a, b, c); }
+	static inline reg min(reg a, reg b){ return _mm512_min_ps(a, b); }
+	static inline reg max(reg a, reg b){ return _mm512_max_ps(a, b); }
+	static inline reg abs(reg a){ return _mm512_abs_ps(a); }
+
+	static inline reg round(reg a){
+	  return _mm512_roundscale_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	}
+
+	static inline reg pow2n(reg n){
+	  __m512i e = _mm512_add_epi32(_mm512_cvtps_epi32(n), _mm512_set1_epi32(127));
+	  return _mm512_castsi512_ps(_mm512_slli_epi32(e, 23));
+	}
+
+	static inline reg select_gt(reg a, reg b, reg x, reg y){
+	  return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(a, b, _CMP_GT_OQ), y, x);
+	}
+      };
+
+
+      struct vdouble
+      {
+	typedef __m512d reg;
+	typedef double scalar;
+	static const unsigned int width = 8;
+
+	static inline reg load(const double* p){ return _mm512_loadu_pd(p); }
+	static inline void store(double* p, reg x){ _mm512_storeu_pd(p, x); }
+	static inline reg set1(double x){ return _mm512_set1_pd(x); }
+	static inline reg add(reg a, reg b){ return _mm512_add_pd(a, b); }
+	static inline reg sub(reg a, reg b){ return _mm512_sub_pd(a, b); }
+	static inline reg mul(reg a, reg b){ return _mm512_mul_pd(a, b); }
+	static inline reg div(reg a, reg b){ return _mm512_div_pd(a, b); }
+	static inline reg fmadd(reg a, reg b, reg c){ return _mm512_fmadd_pd(a, b, c); }
+	static inline reg min(reg a, reg b){ return _mm512_min_pd(a, b); }
+	static inline reg max(reg a, reg b){ return _mm512_max_pd(a, b); }
+	static inline reg abs(reg a){ return _mm512_abs_pd(a); }
+
+	static inline reg round(reg a){
+	  return _mm512_roundscale_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	}
+
+	static inline reg pow2n(reg n){
+	  __m512i e = _mm512_cvtepi32_epi64(_mm512_cvtpd_epi32(n));
+	  e = _mm512_add_epi64(e, _mm512_set1_epi64(1023));
+	  return _mm512_castsi512_pd(_mm512_slli_epi64(e, 52));
+	}
+
+	static inline reg select_gt(reg a, reg b, reg x, reg y){
+	  return _mm512_mask_blend_pd(_mm512_cmp_pd_mask(a, b, _CMP_GT_OQ), y, x);
+	}
+      };
+
+#include "nnetwork_kernels_simd.h"
+    };
+  };
+};
+
+
+#ifdef __clang__
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#endif
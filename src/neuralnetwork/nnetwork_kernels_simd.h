@@ -0,0 +1,241 @@
+/*
+ * generic implementation of nnetwork activation kernels.
+ *
+ * THIS FILE IS INCLUDED INSIDE OF INSTRUCTION SET SPECIFIC NAMESPACE
+ * by nnetwork_kernels*.cpp files which first define vector types
+ * vfloat and vdouble with operations:
+ *
+ *   reg, scalar, width, load(), store(), set1(), add(), sub(), mul(),
+ *   fmadd(a,b,c) = a*b+c, div(), min(), max(), abs(), round(),
+ *   pow2n(n) = 2^n (n is integer valued), select_gt(a,b,x,y) = a > b ? x : y
+ *
+ * the file must not include any headers (they would be compiled using
+ * the target instruction set of the including file).
+ */
+
+
+// exp(x) = 2^n * exp(r), |r| <= ln(2)/2, exp(r) is calculated
+// with taylor polynomial (relative error < 1e-8 (float) or < 1e-16 (double))
+template <typename F>
+struct exp_coefs { };
+
+template <>
+struct exp_coefs<float>
+{
+  static constexpr unsigned int degree = 7;
+  static constexpr float lo = -87.0f, hi = 88.0f;
+  static constexpr float ln2_hi = 0.693359375f, ln2_lo = -2.12194440e-4f;
+  static constexpr float c[degree+1] = { // 1/k!
+    1.0f, 1.0f, 1.0f/2.0f, 1.0f/6.0f, 1.0f/24.0f, 1.0f/120.0f, 1.0f/720.0f, 1.0f/5040.0f
+  };
+};
+
+constexpr float exp_coefs<float>::c[];
+
+template <>
+struct exp_coefs<double>
+{
+  static constexpr unsigned int degree = 13;
+  static constexpr double lo = -708.0, hi = 709.0;
+  static constexpr double ln2_hi = 0.693145751953125, ln2_lo = 1.42860682030941723212e-6;
+  static constexpr double c[degree+1] = { // 1/k!
+    1.0, 1.0, 1.0/2.0, 1.0/6.0, 1.0/24.0, 1.0/120.0, 1.0/720.0, 1.0/5040.0,
+    1.0/40320.0, 1.0/362880.0, 1.0/3628800.0, 1.0/39916800.0, 1.0/479001600.0,
+    1.0/6227020800.0
+  };
+};
+
+constexpr double exp_coefs<double>::c[];
+
+
+template <typename V>
+static inline typename V::reg vexp(typename V::reg x)
+{
+  typedef typename V::scalar F;
+  typedef exp_coefs<F> C;
+
+  x = V::min(V::max(x, V::set1(C::lo)), V::set1(C::hi));
+
+  const typename V::reg n = V::round(V::mul(x, V::set1(F(1.44269504088896340736))));
+
+  typename V::reg r = V::fmadd(n, V::set1(-C::ln2_hi), x);
+  r = V::fmadd(n, V::set1(-C::ln2_lo), r);
+
+  // horner evaluation of 1 + r + r^2/2! + ... + r^degree/degree!
+  typename V::reg p = V::set1(C::c[C::degree]);
+
+  for(unsigned int k=C::degree;k>0;k--)
+    p = V::fmadd(p, r, V::set1(C::c[k-1]));
+
+  return V::mul(p, V::pow2n(n));
+}
+
+
+// activation functions and their derivatives
+
+template <typename V>
+struct op_sigmoid
+{
+  typedef typename V::reg reg;
+  typedef typename V::scalar F;
+
+  static inline reg f(reg x){
+    const reg one = V::set1(F(1.0));
+    return V::div(one, V::add(one, vexp<V>(V::sub(V::set1(F(0.0)), x))));
+  }
+
+  static inline reg df(reg x){
+    const reg one = V::set1(F(1.0));
+    const reg e = vexp<V>(V::sub(V::set1(F(0.0)), x));
+    const reg s = V::add(one, e);
+    return V::select_gt(V::abs(x), V::set1(F(60.0)),
+			V::set1(F(0.0)), V::div(e, V::mul(s, s)));
+  }
+};
+
+
+template <typename V>
+struct op_tanh
+{
+  typedef typename V::reg reg;
+  typedef typename V::scalar F;
+
+  // tanh(x) = (e^2x - 1)/(e^2x + 1) for |x| <= 10, otherwise +1 or -1
+  static inline reg tanh(reg x){
+    const reg one = V::set1(F(1.0));
+    const reg ten = V::set1(F(10.0));
+    const reg cx = V::min(V::max(x, V::set1(F(-10.0))), ten);
+    const reg e2x = vexp<V>(V::add(cx, cx));
+    const reg t = V::div(V::sub(e2x, one), V::add(e2x, one));
+    return V::select_gt(x, ten, one,
+			V::select_gt(V::set1(F(-10.0)), x, V::set1(F(-1.0)), t));
+  }
+
+  // 1 - tanh(x)^2 for |x| <= 10, otherwise 0
+  static inline reg dtanh(reg x){
+    const reg t = tanh(x);
+    return V::select_gt(V::abs(x), V::set1(F(10.0)), V::set1(F(0.0)),
+			V::sub(V::set1(F(1.0)), V::mul(t, t)));
+  }
+
+  static inline reg f(reg x){ return tanh(x); }
+  static inline reg df(reg x){ return dtanh(x); }
+};
+
+
+template <typename V>
+struct op_halflinear
+{
+  typedef typename V::reg reg;
+  typedef typename V::scalar F;
+
+  // tanh(x) + 0.5x
+  static inline reg f(reg x){
+    return V::fmadd(V::set1(F(0.5)), x, op_tanh<V>::tanh(x));
+  }
+
+  static inline reg df(reg x){
+    return V::add(op_tanh<V>::dtanh(x), V::set1(F(0.5)));
+  }
+};
+
+
+// applies operator to N elements, the last partial vector is processed
+// through a temporary buffer so that all elements get the same results
+template <typename V, typename OP>
+static void apply_f(typename V::scalar* x, const unsigned int N)
+{
+  unsigned int i = 0;
+
+  for(;i+V::width<=N;i+=V::width)
+    V::store(x + i, OP::f(V::load(x + i)));
+
+  if(i < N){
+    typename V::scalar buf[V::width];
+    for(unsigned int j=0;j<V::width;j++) buf[j] = (i+j<N) ? x[i+j] : typename V::scalar(0);
+    V::store(buf, OP::f(V::load(buf)));
+    for(unsigned int j=0;i+j<N;j++) x[i+j] = buf[j];
+  }
+}
+
+
+template <typename V, typename OP>
+static void apply_df(const typename V::scalar* v, typename V::scalar* d,
+		     const unsigned int N, const bool multiply)
+{
+  unsigned int i = 0;
+
+  if(multiply){
+    for(;i+V::width<=N;i+=V::width)
+      V::store(d + i, V::mul(V::load(d + i), OP::df(V::load(v + i))));
+  }
+  else{
+    for(;i+V::width<=N;i+=V::width)
+      V::store(d + i, OP::df(V::load(v + i)));
+  }
+
+  if(i < N){
+    typename V::scalar buf[V::width];
+    for(unsigned int j=0;j<V::width;j++) buf[j] = (i+j<N) ? v[i+j] : typename V::scalar(0);
+    V::store(buf, OP::df(V::load(buf)));
+
+    if(multiply) for(unsigned int j=0;i+j<N;j++) d[i+j] *= buf[j];
+    else         for(unsigned int j=0;i+j<N;j++) d[i+j] = buf[j];
+  }
+}
+
+
+template <typename V>
+static void layer_activation(const nonlinearity nl, typename V::scalar* x, const unsigned int N)
+{
+  if(nl == SIGMOID || nl == STOCHASTIC_SIGMOID)
+    apply_f< V, op_sigmoid<V> >(x, N);
+  else if(nl == TANH)
+    apply_f< V, op_tanh<V> >(x, N);
+  else if(nl == HALF_LINEAR)
+    apply_f< V, op_halflinear<V> >(x, N);
+
+  // PURE_LINEAR: g(x) = x
+}
+
+
+template <typename V>
+static void layer_dactivation(const nonlinearity nl,
+			      const typename V::scalar* v, typename V::scalar* d,
+			      const unsigned int N, const bool multiply)
+{
+  typedef typename V::scalar F;
+
+  if(nl == SIGMOID || nl == STOCHASTIC_SIGMOID)
+    apply_df< V, op_sigmoid<V> >(v, d, N, multiply);
+  else if(nl == TANH)
+    apply_df< V, op_tanh<V> >(v, d, N, multiply);
+  else if(nl == HALF_LINEAR)
+    apply_df< V, op_halflinear<V> >(v, d, N, multiply);
+  else if(!multiply){ // PURE_LINEAR: g'(x) = 1
+    for(unsigned int i=0;i<N;i++) d[i] = F(1.0);
+  }
+}
+
+
+void activation(const nonlinearity nl, float* x, const unsigned int N)
+{
+  layer_activation<vfloat>(nl, x, N);
+}
+
+void activation(const nonlinearity nl, double* x, const unsigned int N)
+{
+  layer_activation<vdouble>(nl, x, N);
+}
+
+void dactivation(const nonlinearity nl, const float* v, float* d,
+		 const unsigned int N, const bool multiply)
+{
+  layer_dactivation<vfloat>(nl, v, d, N, multiply);
+}
+
+void dactivation(const nonlinearity nl, const double* v, double* d,
+		 const unsigned int N, const bool multiply)
+{
+  layer_dactivation<vdouble>(nl, v, d, N, multiply);
+}
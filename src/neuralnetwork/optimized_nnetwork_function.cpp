@@ -55,7 +55,7 @@ namespace whiteice
     for(unsigned int i=0;i<ds.size(0);i++){
       nn.input() = ds.access(0, i);
       nn.calculate();
-      err = ds.access(1,i) - nn.output();
+      err = math::lazy(ds.access(1,i)) - nn.output();
       
       for(unsigned int i=0;i<err.size();i++)
 	error += (err[i]*err[i]) / T((float)err.size());
@@ -93,7 +93,7 @@ namespace whiteice
 	
     nn.input() = ds.access(0, 0);
     nn.calculate(true);
-    err = ds.access(1, 0) - nn.output();
+    err = math::lazy(ds.access(1, 0)) - nn.output();
     
     if(nn.gradient(err, grad) == false)
       return 0;
@@ -109,7 +109,7 @@ namespace whiteice
 	
     nn.input() = ds.access(0, 0);
     nn.calculate(true);
-    err = ds.access(1, 0) - nn.output();
+    err = math::lazy(ds.access(1, 0)) - nn.output();
     
     if(nn.gradient(err, grad) == false)
       return false;
@@ -133,7 +133,7 @@ namespace whiteice
     for(unsigned int i=0;i<ds.size(0);i++){
       nn.input() = ds.access(0, i);
       nn.calculate(true);
-      err = ds.access(1,i) - nn.output();
+      err = math::lazy(ds.access(1,i)) - nn.output();
 	    
       if(nn.gradient(err, grad) == false)
 	std::cout << "gradient failed." << std::endl;
@@ -196,7 +196,7 @@ namespace whiteice
     for(unsigned int i=0;i<data.size(0);i++){
       nnet.input() = data.access(0, i);
       nnet.calculate(false);
-      err = data.access(1, i) - nnet.output();
+      err = math::lazy(data.access(1, i)) - nnet.output();
       T inv = T(1.0f/err.size());
       err = inv*(err*err);
       e += err[0];
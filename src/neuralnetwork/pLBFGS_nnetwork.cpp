@@ -131,8 +131,8 @@ namespace whiteice
     thread_is_running_mutex.unlock();
     
     try{
-      updater_thread = std::thread(std::bind(&pLBFGS_nnetwork<T>::updater_loop, this));
-      updater_thread.detach();
+      updater_thread =
+	whiteice::thread_pool::global().start(std::bind(&pLBFGS_nnetwork<T>::updater_loop, this));
       
       // FIXME: should check that thread actually started?
     }
@@ -199,7 +199,7 @@ namespace whiteice
     for(unsigned int i=0;i<data.size(0);i++){
       nnet.input() = data.access(0, i);
       nnet.calculate(false);
-      err = data.access(1, i) - nnet.output();
+      err = math::lazy(data.access(1, i)) - nnet.output();
       T inv = T(1.0f/err.size());
       err = inv*(err*err);
       e += err[0];
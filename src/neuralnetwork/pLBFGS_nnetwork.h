@@ -9,6 +9,7 @@
 #include "LBFGS_nnetwork.h"
 #include "LBFGS.h"
 #include "vertex.h"
+#include "thread_pool.h"
 #include <vector>
 #include <thread>
 #include <mutex>
@@ -58,7 +59,7 @@ namespace whiteice
     mutable std::mutex thread_is_running_mutex;
     mutable std::condition_variable thread_is_running_cond;
 
-    std::thread updater_thread;
+    whiteice::thread_pool::job updater_thread;
     
     mutable std::mutex bfgs_mutex;
     mutable std::mutex thread_mutex;
@@ -104,7 +104,7 @@ namespace whiteice
 	for(unsigned int i=0;i<dtest.size(0);i++){
 	  nnet.input() = dtest.access(0, i);
 	  nnet.calculate(false);
-	  err = dtest.access(1, i) - nnet.output();
+	  err = math::lazy(dtest.access(1, i)) - nnet.output();
 	  
 	  err = (err*err);
 	  esum += T(0.5f)*err[0];
@@ -144,7 +144,7 @@ namespace whiteice
 	    input.write_subvertex(nnet.output(), dtest.dimension(0));
 	  }
 	  
-	  err = dtest.access(1, i) - nnet.output();
+	  err = math::lazy(dtest.access(1, i)) - nnet.output();
 	  err = (err*err);
 	  esum += T(0.5f)*err[0];
 	}
@@ -182,7 +182,7 @@ namespace whiteice
 	for(unsigned int i=0;i<dtrain.size(0);i++){
 	  nnet.input() = dtrain.access(0, i);
 	  nnet.calculate(false);
-	  err = dtrain.access(1, i) - nnet.output();
+	  err = math::lazy(dtrain.access(1, i)) - nnet.output();
 	  err = (err*err); // /T(dtrain.size(0));
 	  esum += T(0.5f)*err[0];
 	}
@@ -218,7 +218,7 @@ namespace whiteice
 	  for(unsigned int d = 0;d<deepness;d++){
 	    nnet.input() = input;
 	    nnet.calculate(false);
-	    err = dtrain.access(1, i) - nnet.output();
+	    err = math::lazy(dtrain.access(1, i)) - nnet.output();
 	    
 	    err = (err*err);
 	    esum += T(0.5f)*err[0];
@@ -302,7 +302,7 @@ namespace whiteice
 	for(unsigned int i=0;i<dtrain.size(0);i++){
 	  nnet.input() = dtrain.access(0, i);
 	  nnet.calculate(true);
-	  err = dtrain.access(1,i) - nnet.output();
+	  err = math::lazy(dtrain.access(1,i)) - nnet.output();
 	  
 	  if(nnet.gradient(err, grad) == false){
 	    std::cout << "gradient failed." << std::endl;
@@ -377,7 +377,7 @@ namespace whiteice
 	  {
 	    nnet.input() = dtrain.access(0, i);
 	    nnet.calculate(true);
-	    err = dtrain.access(1,i) - nnet.output();
+	    err = math::lazy(dtrain.access(1,i)) - nnet.output();
 	    
 	    if(nnet.gradient(err, grad) == false){
 	      std::cout << "gradient failed." << std::endl;
@@ -542,7 +542,7 @@ namespace whiteice
 	  for(unsigned int d=0;d<deepness;d++){
 	    nnet.input() = input;
 	    nnet.calculate(true);
-	    err = dtrain.access(1,i) - nnet.output();
+	    err = math::lazy(dtrain.access(1,i)) - nnet.output();
 	    
 	    if(nnet.gradient(err, grad) == false){
 	      std::cout << "gradient failed." << std::endl;
@@ -637,7 +637,7 @@ namespace whiteice
 	    for(unsigned int d=0;d<deepness;d++){
 	      nnet.input() = input;
 	      nnet.calculate(true);
-	      err = dtrain.access(1,i) - nnet.output();
+	      err = math::lazy(dtrain.access(1,i)) - nnet.output();
 	      
 	      if(nnet.gradient(err, grad) == false){
 		std::cout << "gradient failed." << std::endl;
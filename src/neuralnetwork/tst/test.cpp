@@ -14,6 +14,7 @@
 #include "odd_sigmoid.h"
 
 #include "nnetwork.h"
+#include "nnetwork_kernels.h"
 #include "lreg_nnetwork.h"
 #include "GDALogic.h"
 
@@ -82,6 +83,8 @@ void mixture_nnetwork_test();
 void ensemble_means_test();
 
 void nnetwork_gradient_test();
+void nnetwork_batch_test();
+void nnetwork_kernels_test();
   
 void rbm_test();
 
@@ -124,6 +127,10 @@ int main()
   
   try{
     nnetwork_gradient_test();
+
+    nnetwork_batch_test();
+
+    nnetwork_kernels_test();
     
     bbrbm_test();
     
@@ -333,6 +340,195 @@ void nnetwork_gradient_test()
 }
 
 
+void nnetwork_batch_test()
+{
+  std::cout << "NNetwork batched calculate() and gradient() test" << std::endl;
+
+  whiteice::RNG< whiteice::math::blas_real<double> > rng;
+
+  for(unsigned int e=0;e<10;e++) // number of tests
+  {
+    std::vector<unsigned int> arch;
+
+    const unsigned int dimInput = rng.rand() % 10 + 3;
+    const unsigned int dimOutput = rng.rand() % 10 + 3;
+    const unsigned int layers = rng.rand() % 5 + 2;
+    const unsigned int N = rng.rand() % 100 + 1;
+
+    arch.push_back(dimInput);
+    for(unsigned int i=0;i<layers;i++)
+      arch.push_back(rng.rand() % 10 + 1);
+    arch.push_back(dimOutput);
+
+    whiteice::nnetwork< whiteice::math::blas_real<double> >::nonLinearity nl;
+    
+    if(e & 1) nl = whiteice::nnetwork< whiteice::math::blas_real<double> >::sigmoid;
+    else nl = whiteice::nnetwork< whiteice::math::blas_real<double> >::halfLinear;
+
+    whiteice::nnetwork< whiteice::math::blas_real<double> > nn(arch, nl);
+
+    std::vector< whiteice::math::vertex< whiteice::math::blas_real<double> > > xs, ys;
+
+    for(unsigned int n=0;n<N;n++){
+      whiteice::math::vertex< whiteice::math::blas_real<double> > x(dimInput);
+      whiteice::math::vertex< whiteice::math::blas_real<double> > y(dimOutput);
+      rng.normal(x);
+      rng.normal(y);
+      xs.push_back(x);
+      ys.push_back(y);
+    }
+
+    // calculates per sample results
+    whiteice::math::vertex< whiteice::math::blas_real<double> > sumgrad, grad;
+    std::vector< whiteice::math::vertex< whiteice::math::blas_real<double> > > outputs;
+    sumgrad.resize(nn.gradient_size());
+    sumgrad.zero();
+
+    for(unsigned int n=0;n<N;n++){
+      nn.input() = xs[n];
+      nn.calculate(true, false);
+      outputs.push_back(nn.output());
+
+      auto error = ys[n] - nn.output();
+
+      if(nn.gradient(error, grad) == false){
+	printf("ERROR: nn::gradient() FAILED.\n");
+	continue;
+      }
+
+      sumgrad += grad;
+    }
+
+    // batched versions
+    whiteice::math::matrix< whiteice::math::blas_real<double> > Y;
+
+    if(nn.calculate(xs.begin(), xs.end(), Y) == false){
+      printf("ERROR: batched nn::calculate() FAILED.\n");
+      continue;
+    }
+
+    whiteice::math::blas_real<double> err = 0.0;
+
+    for(unsigned int n=0;n<N;n++)
+      for(unsigned int i=0;i<dimOutput;i++)
+	err += abs(Y(n,i) - outputs[n][i]);
+
+    err /= ((double)(N*dimOutput));
+
+    if(err > 0.0001)
+      printf("ERROR: batched output difference is too large (%f)!\n", err.c[0]);
+
+    if(nn.gradient(xs.begin(), xs.end(), ys.begin(), grad) == false){
+      printf("ERROR: batched nn::gradient() FAILED.\n");
+      continue;
+    }
+
+    if(grad.size() != sumgrad.size()){
+      printf("ERROR: batched nn::gradient sizes mismatch!\n");
+      continue;
+    }
+
+    err = 0.0;
+
+    for(unsigned int i=0;i<grad.size();i++)
+      err += abs(grad[i] - sumgrad[i]);
+
+    err /= ((double)grad.size());
+
+    if(err > 0.0001)
+      printf("ERROR: batched gradient difference is too large (%f)!\n", err.c[0]);
+
+    // parameters given as shared vector to another network with workspace
+    whiteice::math::vertex< whiteice::math::blas_real<double> > w, wgrad;
+    whiteice::nnetwork< whiteice::math::blas_real<double> >::workspace ws;
+    whiteice::nnetwork< whiteice::math::blas_real<double> > nn2(nn);
+    nn.exportdata(w);
+    nn2.randomize();
+
+    if(nn2.calculate(w, xs.begin(), xs.end(), ws) == false){
+      printf("ERROR: nn::calculate() with workspace FAILED.\n");
+      continue;
+    }
+
+    err = 0.0;
+    
+    for(unsigned int n=0;n<N;n++)
+      for(unsigned int i=0;i<dimOutput;i++)
+	err += abs(ws.output[n*dimOutput + i] - Y(n,i));
+    
+    if(nn2.gradient(w, xs.begin(), xs.end(), ys.begin(), wgrad, ws) == false){
+      printf("ERROR: nn::gradient() with workspace FAILED.\n");
+      continue;
+    }
+    
+    for(unsigned int i=0;i<grad.size();i++)
+      err += abs(wgrad[i] - grad[i]);
+    
+    if(err > 0.0001)
+      printf("ERROR: workspace calculation results differ (%f)!\n", err.c[0]);
+  }
+  
+}
+
+
+/************************************************************/
+
+template <typename T>
+void nnetwork_kernels_test(const double tolerance)
+{
+  typedef typename whiteice::nnetwork<T>::nonLinearity NL;
+  
+  const NL nls[4] = { whiteice::nnetwork<T>::sigmoid,
+		      whiteice::nnetwork<T>::tanh,
+		      whiteice::nnetwork<T>::halfLinear,
+		      whiteice::nnetwork<T>::pureLinear };
+  
+  const unsigned int N = 1003; // not divisible by vector width
+
+  std::vector<unsigned int> arch;
+  arch.push_back(1);
+  arch.push_back(N);
+  
+  for(unsigned int k=0;k<4;k++){
+    whiteice::nnetwork<T> nn(arch, nls[k]);
+    
+    std::vector<T> x(N), y(N), d(N);
+
+    for(unsigned int i=0;i<N;i++) // [-25,25] range includes clipped values
+      x[i] = T(50.0*(((double)rand())/((double)RAND_MAX)) - 25.0);
+    
+    y = x;
+    whiteice::nnkernels::activation((whiteice::nnkernels::nonlinearity)nls[k], y.data(), N);
+    whiteice::nnkernels::dactivation((whiteice::nnkernels::nonlinearity)nls[k], x.data(), d.data(), N);
+
+    double ferr = 0.0, derr = 0.0;
+    
+    for(unsigned int i=0;i<N;i++){
+      const double f  = (double)nn.nonlin(x[i], 0, i);
+      const double df = (double)nn.Dnonlin(x[i], 0, i);
+      
+      ferr = std::max(ferr, std::fabs((double)y[i] - f)/(1.0 + std::fabs(f)));
+      derr = std::max(derr, std::fabs((double)d[i] - df)/(1.0 + std::fabs(df)));
+    }
+
+    if(ferr > tolerance || derr > tolerance){
+      printf("ERROR: activation kernel %d (%s) differs from nonlin(): %e %e\n",
+	     (int)nls[k], whiteice::nnkernels::instruction_set(), ferr, derr);
+    }
+  }
+}
+
+
+void nnetwork_kernels_test()
+{
+  std::cout << "NNetwork vectorized activation kernels test ("
+	    << whiteice::nnkernels::instruction_set() << ")" << std::endl;
+
+  nnetwork_kernels_test<float>(1e-5);
+  nnetwork_kernels_test<double>(1e-12);
+}
+
+
 /************************************************************/
 
 void ensemble_means_test()
@@ -700,6 +896,23 @@ void bbrbm_test()
 	      << error << std::endl;
     
   }
+
+  // minibatch CD-1 and PCD must decrease reconstruction error
+  {
+    for(unsigned int p=0;p<2;p++){
+      whiteice::BBRBM< math::blas_real<double> > rbm(DIMENSION, HIDDEN_DIMENSION);
+      
+      auto start_error = rbm.reconstructionError(samples, 1000);
+      auto error = rbm.learnWeightsBatch(samples, 10, 1, p == 1, 128);
+      
+      std::cout << "BBRBM minibatch " << (p ? "PCD" : "CD-1")
+		<< " reconstruction error = " << error << std::endl;
+      
+      if(error >= start_error)
+	std::cout << "ERROR: BBRBM::learnWeightsBatch() did not decrease reconstruction error ("
+		  << start_error << " => " << error << ")" << std::endl;
+    }
+  }
   
 #else
 
@@ -967,6 +1180,21 @@ void dbn_test()
 
 /************************************************************/
 
+class PTHMC_gaussian : public PTHMC_abstract< math::blas_real<float> >
+{
+public:
+  PTHMC_gaussian(unsigned int deepness, unsigned int dimension) :
+    PTHMC_abstract< math::blas_real<float> >(deepness, false), dimension(dimension){ }
+
+  std::shared_ptr< HMC_abstract< math::blas_real<float> > > newHMC(bool storeSamples, bool adaptive){
+    return std::make_shared< HMC_gaussian< math::blas_real<float> > >(dimension);
+  }
+
+private:
+  const unsigned int dimension;
+};
+
+
 void hmc_test()
 {
   std::cout << "HMC SAMPLING TEST (Normal distribution)" << std::endl;
@@ -993,6 +1221,10 @@ void hmc_test()
 
   {
     HMC_gaussian<> sampler(2);
+
+    // HMC_gaussian doesn't implement stochastic_Ugrad()
+    if(sampler.setSGHMC(true, 32) == true || sampler.getSGHMC() == true)
+      std::cout << "ERROR: setSGHMC() accepted sampler without minibatch gradient" << std::endl;
     
     time_t start_time = time(0);
     unsigned int counter = 0;
@@ -1036,6 +1268,40 @@ void hmc_test()
     
   }
 
+  
+  {
+    // parallel tempering with one replica per thread (temperature is
+    // not supported by HMC_gaussian so all swaps should be accepted)
+    PTHMC_gaussian sampler(0, 2);
+
+    if(sampler.startSampler() == false)
+      std::cout << "ERROR: PTHMC startSampler() failed" << std::endl;
+
+    if(sampler.getNumberOfTemperatures() < 2)
+      std::cout << "ERROR: PTHMC has less than two temperatures" << std::endl;
+
+    sleep(5);
+
+    sampler.stopSampler();
+
+    std::cout << "PTHMC: " << sampler.getNumberOfTemperatures() << " temperatures, "
+	      << sampler.getNumberOfSamples() << " samples, swap accept rate "
+	      << sampler.getAcceptRate() << std::endl;
+
+    if(sampler.getNumberOfSamples() == 0)
+      std::cout << "ERROR: PTHMC did not produce samples" << std::endl;
+
+    if(sampler.getAcceptRate() < 0.99f)
+      std::cout << "ERROR: PTHMC rejected swaps between equal distributions" << std::endl;
+
+    auto m = sampler.getMean();
+
+    std::cout << "PTHMC mean = " << m << " (should be zero)" << std::endl;
+
+    if(m.norm() > 0.5f)
+      std::cout << "ERROR: PTHMC mean is not zero" << std::endl;
+  }
+
   std::cout << "HMC sampling test DONE." << std::endl;
   
   
@@ -1309,6 +1575,69 @@ void rbm_test()
           
 	}
 
+	// parallel AIS estimate of log(Z) must agree with exact value
+	// (calculated by summing over all hidden states)
+	{
+	  std::cout << "Unit testing GBRBM::logPartitionFunction() (AIS).." << std::endl;
+
+	  const unsigned int NV = 4, NH = 5;
+	  whiteice::RNG< math::blas_real<double> > rng;
+	  whiteice::GBRBM< math::blas_real<double> > rbm(NV, NH);
+
+	  math::matrix< math::blas_real<double> > W(NV, NH);
+	  math::vertex< math::blas_real<double> > a(NV), b(NH), var(NV);
+
+	  for(unsigned int i=0;i<NV;i++){
+	    a[i] = rng.normal();
+	    var[i] = rng.uniform() + 0.5;
+	    for(unsigned int j=0;j<NH;j++)
+	      W(i,j) = 0.5*rng.normal();
+	  }
+
+	  for(unsigned int j=0;j<NH;j++)
+	    b[j] = rng.normal();
+
+	  rbm.setParameters(W, a, b, var);
+
+	  // Z = sum_h exp(b^t h) prod_i sqrt(2*pi*var_i) exp(a_i*c_i/sigma_i + 0.5*c_i^2), c = W*h
+	  double Z = 0.0;
+
+	  for(unsigned int hbits=0;hbits<(1U<<NH);hbits++){
+	    double t = 0.0;
+
+	    for(unsigned int j=0;j<NH;j++)
+	      if(hbits & (1U<<j)) t += b[j].c[0];
+
+	    for(unsigned int i=0;i<NV;i++){
+	      double c = 0.0;
+	      for(unsigned int j=0;j<NH;j++)
+		if(hbits & (1U<<j)) c += W(i,j).c[0];
+
+	      const double sigma = sqrt(var[i].c[0]);
+	      t += log(sqrt(2.0*M_PI)*sigma) + a[i].c[0]*c/sigma + 0.5*c*c;
+	    }
+
+	    Z += exp(t);
+	  }
+
+	  std::vector< math::vertex< math::blas_real<double> > > samples;
+
+	  for(unsigned int n=0;n<100;n++){
+	    math::vertex< math::blas_real<double> > v(NV);
+	    rng.normal(v);
+	    samples.push_back(a + math::blas_real<double>(2.0)*v);
+	  }
+
+	  math::blas_real<double> stderror;
+	  auto logZ = rbm.logPartitionFunction(samples, stderror, 1024, 1000);
+
+	  std::cout << "AIS log(Z) = " << logZ << " +- " << stderror
+		    << " (exact: " << log(Z) << ")" << std::endl;
+
+	  if(math::abs(logZ - log(Z)) > 5.0*stderror + 0.01)
+	    std::cout << "ERROR: GBRBM AIS log(Z) estimate is incorrect." << std::endl;
+	}
+
 
 #if 0
 
@@ -4437,6 +4766,272 @@ void bayesian_nnetwork_test()
   }  
 
   
+  try{
+    std::cout << "BAYES NNETWORK TEST 2: BATCHED CALCULATE() TEST"
+	      << std::endl;
+
+    // second network is recurrent (2 outputs are fed back to input)
+    for(unsigned int r=0;r<2;r++){
+      const unsigned int DEPTH = r ? 3 : 1;
+      std::vector<unsigned int> arch;
+      arch.push_back(r ? 5 : 3);
+      arch.push_back(10);
+      arch.push_back(2);
+
+      nnetwork<> nn(arch);
+      bayesian_nnetwork<> bnn;
+      std::vector< math::vertex<> > weights(20);
+
+      for(auto& w : weights){
+	nn.randomize();
+	nn.exportdata(w);
+      }
+
+      if(bnn.importSamples(nn, weights) == false){
+	std::cout << "ERROR: BNN importSamples() failed" << std::endl;
+	return;
+      }
+
+      math::matrix<> X(50, 3), M;
+      std::vector< math::matrix<> > C;
+
+      for(unsigned int n=0;n<X.ysize();n++)
+	for(unsigned int i=0;i<X.xsize();i++)
+	  X(n,i) = ((float)rand())/RAND_MAX - 0.5f;
+
+      if(bnn.calculate(X, M, C, DEPTH, 15) == false ||
+	 M.ysize() != X.ysize() || C.size() != X.ysize()){
+	std::cout << "ERROR: batched BNN calculate() failed" << std::endl;
+	return;
+      }
+
+      math::blas_real<float> err = 0.0f;
+
+      for(unsigned int n=0;n<X.ysize();n++){
+	math::vertex<> x(3), m;
+	math::matrix<> c;
+
+	for(unsigned int i=0;i<3;i++) x[i] = X(n,i);
+
+	if(bnn.calculate(x, m, c, DEPTH, 15) == false){
+	  std::cout << "ERROR: BNN calculate() failed" << std::endl;
+	  return;
+	}
+
+	for(unsigned int i=0;i<m.size();i++){
+	  err += abs(m[i] - M(n,i));
+	  for(unsigned int j=0;j<m.size();j++)
+	    err += abs(c(i,j) - C[n](i,j));
+	}
+      }
+
+      if(err > 0.01f){
+	std::cout << "ERROR: batched BNN calculate() differs from calculate() ("
+		  << err << ")" << std::endl;
+	return;
+      }
+
+      // subsampling
+      if(bnn.calculate(X, M, DEPTH, 0, 4) == false || M.ysize() != X.ysize()){
+	std::cout << "ERROR: subsampled BNN calculate() failed" << std::endl;
+	return;
+      }
+    }
+
+    std::cout << "BAYES NNETWORK BATCHED CALCULATE() TEST OK." << std::endl;
+  }
+  catch(std::exception& e){
+    std::cout << "Unexpected exception: " << e.what() << std::endl;
+  }
+
+
+  try{
+    std::cout << "BAYES NNETWORK TEST 3: BINARY SAVE/LOAD TEST"
+	      << std::endl;
+
+    std::vector<unsigned int> arch;
+    arch.push_back(4);
+    arch.push_back(13);
+    arch.push_back(3);
+
+    nnetwork<> nn(arch);
+    nn.setNonlinearity(0, nnetwork<>::tanh);
+    nn.setFrozen(1, true);
+
+    bayesian_nnetwork<> bnn;
+    std::vector< math::vertex<> > weights(7);
+
+    for(auto& w : weights){
+      nn.randomize();
+      nn.exportdata(w);
+    }
+
+    if(bnn.importSamples(nn, weights) == false){
+      std::cout << "ERROR: BNN importSamples() failed" << std::endl;
+      return;
+    }
+
+    // float16 only approximates parameters
+    for(unsigned int f=0;f<2;f++){
+      const bool float16 = (f == 1);
+      const float tolerance = float16 ? 0.01f : 0.0f;
+
+      nnetwork<> loaded_nn;
+      bayesian_nnetwork<> loaded_bnn;
+
+      if(nn.save("nnbinary.dat", true, float16) == false ||
+	 loaded_nn.load("nnbinary.dat") == false){
+	std::cout << "ERROR: binary nnetwork save/load failed" << std::endl;
+	return;
+      }
+
+      math::vertex<> w1, w2;
+      nn.exportdata(w1);
+      loaded_nn.exportdata(w2);
+
+      if(w1.size() != w2.size() || (w1 - w2).norm() > tolerance ||
+	 loaded_nn.getNonlinearity(0) != nnetwork<>::tanh ||
+	 loaded_nn.getFrozen(1) != true){
+	std::cout << "ERROR: binary nnetwork save/load mismatch" << std::endl;
+	return;
+      }
+
+      if(bnn.save("bnnbinary.dat", true, float16) == false ||
+	 loaded_bnn.load("bnnbinary.dat") == false){
+	std::cout << "ERROR: binary BNN save/load failed" << std::endl;
+	return;
+      }
+
+      std::vector< math::vertex<> > loaded_weights;
+      nnetwork<> tmp;
+
+      if(loaded_bnn.exportSamples(tmp, loaded_weights) == false ||
+	 loaded_weights.size() != weights.size()){
+	std::cout << "ERROR: binary BNN sample count mismatch" << std::endl;
+	return;
+      }
+
+      for(unsigned int i=0;i<weights.size();i++){
+	if((weights[i] - loaded_weights[i]).norm() > tolerance){
+	  std::cout << "ERROR: binary BNN weights mismatch" << std::endl;
+	  return;
+	}
+      }
+    }
+
+    // float16 parameter snapshots
+    {
+      math::float16_vector snapshot;
+      math::vertex<> w1, w2;
+      nnetwork<> copy(nn);
+
+      nn.exportdata(w1);
+      copy.randomize();
+
+      if(nn.exportdata(snapshot) == false || copy.importdata(snapshot) == false ||
+	 copy.exportdata(w2) == false || (w1 - w2).norm() > 0.01f){
+	std::cout << "ERROR: float16 nnetwork snapshot failed" << std::endl;
+	return;
+      }
+    }
+
+    // text format files are still loaded
+    nnetwork<> loaded_nn;
+
+    if(nn.save("nntext.cfg") == false || loaded_nn.load("nntext.cfg") == false){
+      std::cout << "ERROR: nnetwork text format save/load failed" << std::endl;
+      return;
+    }
+
+    std::cout << "BAYES NNETWORK BINARY SAVE/LOAD TEST OK." << std::endl;
+  }
+  catch(std::exception& e){
+    std::cout << "Unexpected exception: " << e.what() << std::endl;
+  }
+
+
+  try{
+    std::cout << "BAYES NNETWORK TEST 4: SGHMC SAMPLING TEST"
+	      << std::endl;
+
+    std::vector<unsigned int> arch;
+    arch.push_back(2);
+    arch.push_back(10);
+    arch.push_back(2);
+
+    nnetwork<> nn(arch);
+    nn.randomize();
+
+    dataset<> data;
+    data.createCluster("input", 2);
+    data.createCluster("output", 2);
+
+    for(unsigned int i=0;i<2000;i++){
+      math::vertex<> x(2), y(2);
+      x[0] = ((float)rand())/((float)RAND_MAX) - 0.5f;
+      x[1] = ((float)rand())/((float)RAND_MAX) - 0.5f;
+      y[0] = x[0] - math::blas_real<float>(0.2f)*x[1];
+      y[1] = math::blas_real<float>(-0.12f)*x[0] + math::blas_real<float>(0.1f)*x[1];
+
+      data.add(0, x);
+      data.add(1, y);
+    }
+
+    // mean error of the starting point
+    math::blas_real<float> error0 = 0.0f;
+
+    for(unsigned int i=0;i<data.size(0);i++){
+      math::vertex<> y;
+      nn.calculate(data.access(0, i), y);
+      auto e = data.access(1, i) - y;
+      error0 += math::blas_real<float>(0.5f)*(e*e)[0];
+    }
+
+    error0 /= math::blas_real<float>((float)data.size(0));
+
+    HMC<> hmc(nn, data);
+
+    if(hmc.setSGHMC(true, 32) == false || hmc.getSGHMC() == false){
+      std::cout << "ERROR: setSGHMC() failed" << std::endl;
+      return;
+    }
+
+    hmc.startSampler();
+
+    if(hmc.setSGHMC(false) == true)
+      std::cout << "ERROR: setSGHMC() changed running sampler" << std::endl;
+
+    unsigned int counter = 0;
+    while(hmc.getNumberOfSamples() < 500 && counter < 60){
+      sleep(1);
+      counter++;
+    }
+
+    hmc.stopSampler();
+
+    bayesian_nnetwork<> bnn;
+
+    if(hmc.getNumberOfSamples() < 500 || hmc.getNetwork(bnn, 100) == false){
+      std::cout << "ERROR: SGHMC sampler did not produce samples" << std::endl;
+      return;
+    }
+
+    const math::blas_real<float> error = hmc.getMeanError(100);
+
+    std::cout << "SGHMC error: " << error0 << " => " << error << std::endl;
+
+    if(error >= error0){
+      std::cout << "ERROR: SGHMC sampling did not reduce error" << std::endl;
+      return;
+    }
+
+    std::cout << "BAYES NNETWORK SGHMC TEST OK." << std::endl;
+  }
+  catch(std::exception& e){
+    std::cout << "Unexpected exception: " << e.what() << std::endl;
+  }
+
+  
   try{
     std::cout << "BAYES NNETWORK TEST 1: HMC BAYESIAN NEURAL NETWORK TEST"
 	      << std::endl;
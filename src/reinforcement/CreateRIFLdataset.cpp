@@ -16,17 +16,15 @@
 namespace whiteice
 {
   
-  // calculates reinforcement learning training dataset from database
-  // using database_lock
+  // calculates reinforcement learning training dataset from replay
+  // buffer (database). updates priorities of prioritized replay buffer
   template <typename T>
   CreateRIFLdataset<T>::CreateRIFLdataset(RIFL_abstract<T> const & rifl_,
-					  std::vector< std::vector< rifl_datapoint<T> > > const & database_,
-					  std::mutex & database_mutex_,
+					  RIFL_replay<T> & database_,
 					  unsigned int const & epoch_,
 					  whiteice::dataset<T>& data_) :
     rifl(rifl_), 
     database(database_),
-    database_mutex(database_mutex_),
     epoch(epoch_),
     data(data_)
   {
@@ -159,14 +157,12 @@ namespace whiteice
       if(running == false) // we don't do anything anymore..
 	continue; // exits OpenMP loop..
 
-      database_mutex.lock();
-      
-      const unsigned int action = rifl.rng.rand() % rifl.numActions;
-      const unsigned int index = rifl.rng.rand() % database[action].size();
-
-      const auto datum = database[action][index];
+      rifl_datapoint<T> datum;
+      unsigned int action = 0, index = 0;
 
-      database_mutex.unlock();
+      // lock-free, actor thread can add new datapoints concurrently
+      if(database.sample(datum, action, index, rifl.rng) == false)
+	continue;
       
       whiteice::math::vertex<T> in;
       whiteice::math::vertex<T> feature;
@@ -235,6 +231,24 @@ namespace whiteice
 	    datum.reinforcement;
 	}
       }
+
+      // updates priority of the datapoint using TD error |Q_new - Q(s,a)|
+      if(database.isPrioritized()){
+	std::lock_guard<std::mutex> lock(rifl.model_mutex);
+	
+	whiteice::math::vertex<T> input(in);
+	whiteice::math::matrix<T> e;
+	T q = T(0.0);
+
+	rifl.preprocess.preprocess(0, input);
+
+	if(rifl.model.calculate(input, u, e, 1, 0) == true && u.size() == 1){
+	  rifl.preprocess.invpreprocess(1, u);
+	  q = u[0];
+	}
+
+	database.setPriority(action, index, unew_value - q);
+      }
       
       out[0] = unew_value;
       
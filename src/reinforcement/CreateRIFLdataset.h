@@ -11,6 +11,7 @@
 #include "dataset.h"
 #include "dinrhiw_blas.h"
 #include "RIFL_abstract.h"
+#include "RIFL_replay.h"
 
 namespace whiteice
 {
@@ -20,11 +21,10 @@ namespace whiteice
     {
     public:
 
-    // calculates reinforcement learning training dataset from database
-    // using database_lock
+    // calculates reinforcement learning training dataset from replay
+    // buffer (database). updates priorities of prioritized replay buffer
     CreateRIFLdataset(RIFL_abstract<T> const & rifl, 
-		      std::vector< std::vector< rifl_datapoint<T> > > const & database,
-		      std::mutex & database_mutex,
+		      RIFL_replay<T> & database,
 		      unsigned int const& epoch, 
 		      whiteice::dataset<T>& data);
 
@@ -49,8 +49,7 @@ namespace whiteice
     
     RIFL_abstract<T> const & rifl;
     
-    std::vector< std::vector< rifl_datapoint<T> > > const & database;    
-    std::mutex & database_mutex;
+    RIFL_replay<T> & database;
 
     unsigned int const& epoch;
 
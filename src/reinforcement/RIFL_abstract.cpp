@@ -20,6 +20,7 @@ namespace whiteice
       epsilon = T(0.66);
 
       learningMode = true;
+      prioritizedReplay = false;
       hasModel = 0;
       
       this->numActions        = numActions;
@@ -179,6 +180,21 @@ namespace whiteice
     return hasModel;
   }
 
+
+  template <typename T>
+  bool RIFL_abstract<T>::setPrioritizedReplay(bool prioritized) throw()
+  {
+    if(thread_is_running != 0) return false;
+    prioritizedReplay = prioritized;
+    return true;
+  }
+
+  template <typename T>
+  bool RIFL_abstract<T>::getPrioritizedReplay() const throw()
+  {
+    return prioritizedReplay;
+  }
+
   
   // saves learnt Reinforcement Learning Model to file
   template <typename T>
@@ -241,9 +257,6 @@ namespace whiteice
   template <typename T>
   void RIFL_abstract<T>::loop()
   {
-    std::vector< std::vector< rifl_datapoint<T> > > database;
-    std::mutex database_mutex;
-    
     whiteice::dataset<T> data;
 
     // FIXME/DEBUG disable??? (heuristics keep weights at unity..)
@@ -263,9 +276,10 @@ namespace whiteice
 
     // keep 100% of the new network weights (was 30%)
     const T tau = T(1.0); // T tau = T(0.3);
-    
 
-    database.resize(numActions);
+    // replay buffer, DATASIZE latest datapoints for each action
+    // (CreateRIFLdataset samples it without blocking this thread)
+    RIFL_replay<T> database(numActions, numStates, DATASIZE, prioritizedReplay);
 
     bool firstTime = true;
     whiteice::math::vertex<T> state;
@@ -407,26 +421,9 @@ namespace whiteice
 	continue; // we do not do learning
       }
 
-      // 6. updates database
+      // 6. updates database (overwrites the oldest datapoint when full)
       {
-	struct rifl_datapoint<T> datum;
-
-	datum.state = state;
-	datum.newstate = newstate;
-	datum.reinforcement = reinforcement;
-
-	// for synchronizing access to database datastructure
-	// (also used by CreateRIFLdataset class/thread)
-	std::lock_guard<std::mutex> lock(database_mutex);
-	
-	if(database[action].size() >= DATASIZE){
-	  const unsigned int index = rng.rand() % database[action].size();
-	  database[action][index] = datum;
-	}
-	else{
-	  database[action].push_back(datum);
-	}
-	
+	database.add(action, state, newstate, reinforcement);
       }
       
 
@@ -435,9 +432,9 @@ namespace whiteice
 	unsigned int samples = 0;
 	bool allHasSamples = true;
 
-	for(unsigned int i=0;i<database.size();i++){
-	  samples += database[i].size();
-	  if(database[i].size() == 0){
+	for(unsigned int i=0;i<numActions;i++){
+	  samples += database.size(i);
+	  if(database.size(i) == 0){
 	    allHasSamples = false;
 	  }
 	}
@@ -544,7 +541,6 @@ namespace whiteice
 	      
 	      dataset_thread = new CreateRIFLdataset<T>(*this,
 							database,
-							database_mutex,
 							epoch,
 							data);
 	      dataset_thread->start(samples);
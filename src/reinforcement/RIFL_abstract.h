@@ -83,6 +83,14 @@ namespace whiteice
     void setHasModel(unsigned int hasModel) throw();
     unsigned int getHasModel() throw();
 
+    /*
+     * prioritized experience replay samples training datapoints
+     * according to their TD errors (default: uniform sampling).
+     * must be set before start()
+     */
+    bool setPrioritizedReplay(bool prioritized) throw();
+    bool getPrioritizedReplay() const throw();
+
     // saves learnt Reinforcement Learning Model to file
     bool save(const std::string& filename) const;
     
@@ -114,6 +122,7 @@ namespace whiteice
 
     unsigned int hasModel;
     bool learningMode;
+    bool prioritizedReplay;
     
     T epsilon;
     T gamma;
@@ -0,0 +1,261 @@
+
+#include "RIFL_replay.h"
+#include "RIFL_abstract.h"
+
+#include <math.h>
+
+
+namespace whiteice
+{
+
+  template <typename T>
+  RIFL_replay<T>::RIFL_replay(const unsigned int numActions_,
+			      const unsigned int numStates_,
+			      const unsigned int capacity_,
+			      const bool prioritized_,
+			      const T alpha_) :
+    numActions(numActions_), numStates(numStates_),
+    capacity(capacity_ > 0 ? capacity_ : 1),
+    prioritized(prioritized_)
+  {
+    math::convert(alpha, alpha_);
+
+    states.resize(numActions*capacity*numStates);
+    newstates.resize(numActions*capacity*numStates);
+    reinforcements.resize(numActions*capacity);
+
+    sequence.reset(new std::atomic<unsigned int>[numActions*capacity]);
+    for(unsigned int i=0;i<numActions*capacity;i++)
+      sequence[i] = 0;
+
+    counts.reset(new std::atomic<unsigned int>[numActions]);
+    for(unsigned int a=0;a<numActions;a++)
+      counts[a] = 0;
+
+    heads.resize(numActions, 0);
+
+    leaves = 1;
+    while(leaves < capacity) leaves <<= 1;
+
+    if(prioritized){
+      tree.reset(new std::atomic<double>[2*leaves*numActions]);
+      for(unsigned int i=0;i<2*leaves*numActions;i++)
+	tree[i] = 0.0;
+    }
+
+    maxPriority = 1.0;
+  }
+
+
+  template <typename T>
+  RIFL_replay<T>::~RIFL_replay()
+  {
+  }
+
+
+  template <typename T>
+  unsigned int RIFL_replay<T>::size(const unsigned int action) const throw()
+  {
+    if(action >= numActions) return 0;
+    return counts[action].load(std::memory_order_acquire);
+  }
+
+
+  template <typename T>
+  unsigned int RIFL_replay<T>::size() const throw()
+  {
+    unsigned int sum = 0;
+
+    for(unsigned int a=0;a<numActions;a++)
+      sum += counts[a].load(std::memory_order_acquire);
+
+    return sum;
+  }
+
+
+  template <typename T>
+  bool RIFL_replay<T>::add(const unsigned int action,
+			   const math::vertex<T>& state,
+			   const math::vertex<T>& newstate,
+			   const T& reinforcement)
+  {
+    if(action >= numActions) return false;
+    if(state.size() != numStates || newstate.size() != numStates) return false;
+
+    const unsigned int index = heads[action];
+    const unsigned int slot = action*capacity + index;
+
+    // odd sequence number marks slot being written
+    const unsigned int seq = sequence[slot].load(std::memory_order_relaxed);
+    sequence[slot].store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    T* s  = &(states[slot*numStates]);
+    T* ns = &(newstates[slot*numStates]);
+
+    for(unsigned int i=0;i<numStates;i++){
+      s[i] = state[i];
+      ns[i] = newstate[i];
+    }
+
+    reinforcements[slot] = reinforcement;
+
+    sequence[slot].store(seq + 2, std::memory_order_release);
+
+    if(prioritized)
+      setLeaf(action, index, maxPriority.load(std::memory_order_relaxed));
+
+    heads[action] = (index + 1) % capacity;
+
+    const unsigned int count = counts[action].load(std::memory_order_relaxed);
+    if(count < capacity)
+      counts[action].store(count + 1, std::memory_order_release);
+
+    return true;
+  }
+
+
+  template <typename T>
+  bool RIFL_replay<T>::sample(rifl_datapoint<T>& datum,
+			      unsigned int& action,
+			      unsigned int& index,
+			      const RNG<T>& rng) const
+  {
+    if(numActions == 0) return false;
+
+    datum.state.resize(numStates);
+    datum.newstate.resize(numStates);
+
+    // retries if selected slot was overwritten during copying
+    for(unsigned int tries=0;tries<100;tries++){
+
+      if(prioritized){
+	double total = 0.0;
+	for(unsigned int a=0;a<numActions;a++)
+	  total += getTotal(a);
+
+	if(total <= 0.0) return false;
+
+	double u = 0.0;
+	math::convert(u, rng.uniform());
+	u *= total;
+
+	action = 0;
+	while(action+1 < numActions && u >= getTotal(action)){
+	  u -= getTotal(action);
+	  action++;
+	}
+
+	index = findLeaf(action, u);
+      }
+      else{
+	action = rng.rand() % numActions;
+
+	const unsigned int count = counts[action].load(std::memory_order_acquire);
+	if(count == 0) continue;
+
+	index = rng.rand() % count;
+      }
+
+      if(index >= counts[action].load(std::memory_order_acquire))
+	continue;
+
+      const unsigned int slot = action*capacity + index;
+
+      const unsigned int seq = sequence[slot].load(std::memory_order_acquire);
+      if(seq & 1) continue;
+
+      const T* s  = &(states[slot*numStates]);
+      const T* ns = &(newstates[slot*numStates]);
+
+      for(unsigned int i=0;i<numStates;i++){
+	datum.state[i] = s[i];
+	datum.newstate[i] = ns[i];
+      }
+
+      datum.reinforcement = reinforcements[slot];
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+
+      if(sequence[slot].load(std::memory_order_relaxed) == seq)
+	return true;
+    }
+
+    return false;
+  }
+
+
+  template <typename T>
+  void RIFL_replay<T>::setPriority(const unsigned int action,
+				   const unsigned int index,
+				   const T& tderror)
+  {
+    if(!prioritized || action >= numActions || index >= capacity) return;
+
+    double e = 0.0;
+    math::convert(e, tderror);
+
+    const double p = pow(fabs(e) + 1e-3, alpha);
+
+    double m = maxPriority.load(std::memory_order_relaxed);
+    while(p > m && !maxPriority.compare_exchange_weak(m, p));
+
+    setLeaf(action, index, p);
+  }
+
+
+  template <typename T>
+  double RIFL_replay<T>::getTotal(const unsigned int action) const throw()
+  {
+    const double total =
+      tree[2*leaves*action + 1].load(std::memory_order_relaxed);
+
+    return (total > 0.0) ? total : 0.0;
+  }
+
+
+  template <typename T>
+  void RIFL_replay<T>::setLeaf(const unsigned int action,
+			       const unsigned int index,
+			       const double p) throw()
+  {
+    std::atomic<double>* t = &(tree[2*leaves*action]);
+
+    unsigned int node = leaves + index;
+    const double delta = p - t[node].exchange(p);
+
+    // concurrent updates of other leaves add their own deltas
+    for(node >>= 1;node >= 1;node >>= 1){
+      double v = t[node].load(std::memory_order_relaxed);
+      while(!t[node].compare_exchange_weak(v, v + delta));
+    }
+  }
+
+
+  template <typename T>
+  unsigned int RIFL_replay<T>::findLeaf(const unsigned int action,
+					double u) const throw()
+  {
+    const std::atomic<double>* t = &(tree[2*leaves*action]);
+
+    unsigned int node = 1;
+
+    while(node < leaves){
+      const double left = t[2*node].load(std::memory_order_relaxed);
+
+      if(u < left || t[2*node+1].load(std::memory_order_relaxed) <= 0.0){
+	node = 2*node;
+      }
+      else{
+	u -= left;
+	node = 2*node + 1;
+      }
+    }
+
+    return node - leaves;
+  }
+
+
+  template class RIFL_replay< math::blas_real<float> >;
+  template class RIFL_replay< math::blas_real<double> >;
+};
@@ -0,0 +1,111 @@
+/*
+ * experience replay buffer for RIFL_abstract
+ *
+ * fixed capacity ring buffer for each action. states are kept
+ * in a contiguous array (capacity x numStates). one actor thread
+ * appends datapoints and learner threads sample from the buffer
+ * concurrently without locks: each slot has a sequence number
+ * (seqlock) and readers retry if the slot was overwritten while
+ * it was copied.
+ *
+ * prioritized sampling (optional) selects datapoints with
+ * probability p_i/sum(p) where p_i = (|TD error| + eps)^alpha.
+ * priorities are kept in a sum-tree which is updated with atomic
+ * operations. new datapoints get the largest priority seen so far.
+ */
+
+#ifndef whiteice_RIFL_replay_h
+#define whiteice_RIFL_replay_h
+
+#include <vector>
+#include <atomic>
+#include <memory>
+
+#include "dinrhiw_blas.h"
+#include "vertex.h"
+#include "RNG.h"
+
+
+namespace whiteice
+{
+  template <typename T>
+    struct rifl_datapoint;
+
+
+  template <typename T = math::blas_real<float> >
+    class RIFL_replay
+    {
+    public:
+
+    RIFL_replay(const unsigned int numActions,
+		const unsigned int numStates,
+		const unsigned int capacity,
+		const bool prioritized = false,
+		const T alpha = T(0.6));
+    ~RIFL_replay();
+
+    unsigned int getNumberOfActions() const throw(){ return numActions; }
+    unsigned int getCapacity() const throw(){ return capacity; }
+    bool isPrioritized() const throw(){ return prioritized; }
+
+    // number of datapoints stored for action
+    unsigned int size(const unsigned int action) const throw();
+
+    // number of datapoints stored for all actions
+    unsigned int size() const throw();
+
+    // adds datapoint (overwrites the oldest one when full).
+    // only one thread may call add() at the same time
+    bool add(const unsigned int action,
+	     const math::vertex<T>& state,
+	     const math::vertex<T>& newstate,
+	     const T& reinforcement);
+
+    /*
+     * samples datapoint (can be called concurrently with add()).
+     * without prioritization action is selected uniformly and then
+     * datapoint uniformly from the action's buffer. returns action
+     * and index of the datapoint which can be used to update priority
+     */
+    bool sample(rifl_datapoint<T>& datum,
+		unsigned int& action,
+		unsigned int& index,
+		const RNG<T>& rng) const;
+
+    // sets priority of sampled datapoint from its TD error
+    void setPriority(const unsigned int action,
+		     const unsigned int index,
+		     const T& tderror);
+
+    protected:
+
+    // sum-tree helpers (leaf i is tree[leaves + i])
+    double getTotal(const unsigned int action) const throw();
+    void setLeaf(const unsigned int action, const unsigned int index,
+		 const double p) throw();
+    unsigned int findLeaf(const unsigned int action, double u) const throw();
+
+    const unsigned int numActions, numStates, capacity;
+    const bool prioritized;
+    double alpha;
+
+    // per action ring buffers (data of action a starts at a*capacity)
+    std::vector<T> states, newstates, reinforcements;
+    std::unique_ptr< std::atomic<unsigned int>[] > sequence;
+    std::unique_ptr< std::atomic<unsigned int>[] > counts;
+    std::vector<unsigned int> heads; // used only by add()
+
+    // sum-trees of priorities (2*leaves nodes for each action)
+    unsigned int leaves;
+    std::unique_ptr< std::atomic<double>[] > tree;
+    std::atomic<double> maxPriority;
+
+    };
+
+
+  extern template class RIFL_replay< math::blas_real<float> >;
+  extern template class RIFL_replay< math::blas_real<double> >;
+};
+
+
+#endif
@@ -8,9 +8,17 @@
 #include "CartPole.h"
 #include "CartPole2.h"
 #include "RIFL_abstract.h"
+#include "RIFL_replay.h"
 #include "Log.h"
 
 #include <fenv.h>
+#include <math.h>
+#include <thread>
+#include <atomic>
+#include <vector>
+
+
+void replay_test();
 
 
 
@@ -65,6 +73,9 @@ int main(int argc, char** argv)
     system.stop();
     
   }
+  else if(strcmp(argv[1], "replay") == 0){
+    replay_test();
+  }
   else if(strcmp(argv[1], "use") == 0){
 
     whiteice::CartPole< whiteice::math::blas_real<double> > system;
@@ -89,3 +100,202 @@ int main(int argc, char** argv)
 
   return 0;
 }
+
+
+/*
+ * RIFL_replay tests: ring buffer wrap-around, concurrent add() and
+ * sample()/setPriority() calls and prioritized sampling frequencies.
+ * datapoint k has state[i] = k+i, newstate[i] = -(k+i), reinforcement k
+ * and action k % NUMACTIONS so torn copies can be detected.
+ */
+void replay_test()
+{
+  typedef whiteice::math::blas_real<double> T;
+
+  printf("RIFL_replay tests\n");
+
+  const unsigned int STATES = 64;
+
+  auto datapoint = [STATES](const unsigned int k,
+			    whiteice::math::vertex<T>& s,
+			    whiteice::math::vertex<T>& ns)
+    {
+      s.resize(STATES);
+      ns.resize(STATES);
+
+      for(unsigned int i=0;i<STATES;i++){
+	s[i] = T(k+i);
+	ns[i] = -T(k+i);
+      }
+    };
+
+  // returns k or -1 if datapoint is not consistent
+  auto check = [STATES](const whiteice::rifl_datapoint<T>& d,
+			const unsigned int action,
+			const unsigned int numActions)
+    {
+      if(d.state.size() != STATES || d.newstate.size() != STATES)
+	return -1.0;
+
+      const double k = d.reinforcement.c[0];
+
+      for(unsigned int i=0;i<STATES;i++){
+	if(d.state[i].c[0] != k+i || d.newstate[i].c[0] != -(k+i))
+	  return -1.0;
+      }
+
+      if(((unsigned int)k) % numActions != action)
+	return -1.0;
+
+      return k;
+    };
+
+
+  // 1. ring buffer wraps around at capacity
+  {
+    const unsigned int CAPACITY = 50, N = 120;
+
+    whiteice::RIFL_replay<T> replay(1, STATES, CAPACITY);
+    whiteice::RNG<T> rng;
+    whiteice::math::vertex<T> s, ns;
+
+    for(unsigned int k=0;k<N;k++){
+      datapoint(k, s, ns);
+      if(replay.add(0, s, ns, T(k)) == false)
+	printf("ERROR: RIFL_replay::add() failed\n");
+    }
+
+    if(replay.size(0) != CAPACITY || replay.size() != CAPACITY)
+      printf("ERROR: RIFL_replay size is not capacity after wrap-around\n");
+
+    std::vector<unsigned int> seen(CAPACITY, 0);
+    whiteice::rifl_datapoint<T> d;
+    unsigned int action = 0, index = 0;
+
+    for(unsigned int n=0;n<10000;n++){
+      if(replay.sample(d, action, index, rng) == false){
+	printf("ERROR: RIFL_replay::sample() failed\n");
+	break;
+      }
+
+      const double k = check(d, action, 1);
+
+      if(k < 0.0 || k < N - CAPACITY || k >= N ||
+	 index >= CAPACITY || ((unsigned int)k) % CAPACITY != index){
+	printf("ERROR: RIFL_replay sampled wrong datapoint after wrap-around (%f, index %d)\n",
+	       k, index);
+	break;
+      }
+
+      seen[index]++;
+    }
+
+    for(unsigned int i=0;i<CAPACITY;i++){
+      if(seen[i] == 0){
+	printf("ERROR: RIFL_replay never sampled slot %d\n", i);
+	break;
+      }
+    }
+  }
+
+
+  // 2. one thread adds datapoints while others sample and update priorities
+  {
+    const unsigned int ACTIONS = 3, CAPACITY = 64, N = 1000000;
+
+    whiteice::RIFL_replay<T> replay(ACTIONS, STATES, CAPACITY, true);
+
+    std::atomic<bool> done(false);
+    std::atomic<unsigned int> torn(0), samples(0);
+
+    std::thread writer([&]()
+      {
+	whiteice::math::vertex<T> s, ns;
+
+	for(unsigned int k=0;k<N;k++){
+	  datapoint(k, s, ns);
+	  replay.add(k % ACTIONS, s, ns, T(k));
+	}
+
+	done = true;
+      });
+
+    auto reader = [&]()
+      {
+	whiteice::RNG<T> rng;
+	whiteice::rifl_datapoint<T> d;
+	unsigned int action = 0, index = 0;
+
+	while(!done){
+	  if(replay.sample(d, action, index, rng) == false)
+	    continue;
+
+	  if(check(d, action, ACTIONS) < 0.0) torn++;
+	  samples++;
+
+	  replay.setPriority(action, index, rng.uniform());
+	}
+      };
+
+    std::thread reader1(reader), reader2(reader);
+
+    writer.join();
+    reader1.join();
+    reader2.join();
+
+    if(torn > 0)
+      printf("ERROR: RIFL_replay returned %d torn datapoints (%d samples)\n",
+	     torn.load(), samples.load());
+
+    if(samples == 0)
+      printf("ERROR: RIFL_replay sampling failed during concurrent add()\n");
+
+    for(unsigned int a=0;a<ACTIONS;a++)
+      if(replay.size(a) != CAPACITY)
+	printf("ERROR: RIFL_replay action %d buffer is not full\n", a);
+  }
+
+
+  // 3. prioritized sampling frequency is proportional to priority
+  {
+    const unsigned int CAPACITY = 4, N = 200000;
+
+    whiteice::RIFL_replay<T> replay(1, STATES, CAPACITY, true, T(1.0));
+    whiteice::RNG<T> rng;
+    whiteice::math::vertex<T> s, ns;
+
+    for(unsigned int k=0;k<CAPACITY;k++){
+      datapoint(k, s, ns);
+      replay.add(0, s, ns, T(k));
+    }
+
+    // priorities (|e| + 1e-3)^alpha
+    double p[CAPACITY], sum = 0.0;
+
+    for(unsigned int i=0;i<CAPACITY;i++){
+      replay.setPriority(0, i, T(i + 1.0));
+      p[i] = (i + 1.0) + 1e-3;
+      sum += p[i];
+    }
+
+    unsigned int count[CAPACITY] = { 0 };
+    whiteice::rifl_datapoint<T> d;
+    unsigned int action = 0, index = 0;
+
+    for(unsigned int n=0;n<N;n++){
+      if(replay.sample(d, action, index, rng) && index < CAPACITY)
+	count[index]++;
+    }
+
+    for(unsigned int i=0;i<CAPACITY;i++){
+      const double f = count[i]/((double)N);
+
+      if(fabs(f - p[i]/sum) > 0.01){
+	printf("ERROR: RIFL_replay sampling frequency %f != priority %f\n",
+	       f, p[i]/sum);
+      }
+    }
+  }
+
+  printf("RIFL_replay tests DONE\n");
+}
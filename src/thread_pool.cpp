@@ -0,0 +1,423 @@
+#include "thread_pool.h"
+
+#include <atomic>
+#include <pthread.h>
+
+
+namespace whiteice
+{
+  // worker thread's pool and index (used to push tasks to own deque)
+  static thread_local thread_pool* current_pool = nullptr;
+  static thread_local unsigned int current_worker = 0;
+
+
+  struct thread_pool::job::state {
+    std::mutex lock;
+    std::condition_variable cond;
+    bool done;
+    std::exception_ptr error; // exception thrown by the job
+  };
+
+
+  thread_pool::job::job()
+  {
+  }
+
+  bool thread_pool::job::joinable() const throw()
+  {
+    return (s != nullptr);
+  }
+
+  bool thread_pool::job::finished() const throw()
+  {
+    if(!s) return true;
+    std::lock_guard<std::mutex> lock(s->lock);
+    return s->done;
+  }
+
+  void thread_pool::job::join()
+  {
+    if(!s) return;
+
+    std::exception_ptr error;
+
+    {
+      std::unique_lock<std::mutex> lock(s->lock);
+      while(s->done == false)
+	s->cond.wait(lock);
+
+      error = s->error;
+    }
+
+    s.reset();
+
+    if(error)
+      std::rethrow_exception(error);
+  }
+
+
+  //////////////////////////////////////////////////////////////////////
+
+
+  thread_pool& thread_pool::global()
+  {
+    // never deleted so that jobs still running at exit don't block
+    static thread_pool* pool = new thread_pool();
+    return *pool;
+  }
+
+
+  thread_pool::thread_pool(const unsigned int workers)
+  {
+    pending = 0;
+    stopping = false;
+
+    start_workers(workers);
+  }
+
+
+  thread_pool::~thread_pool()
+  {
+    stop_workers();
+
+    std::list<job_thread*> threads;
+
+    {
+      std::lock_guard<std::mutex> lock(job_mutex);
+
+      for(auto& t : job_threads)
+	t->quit = true;
+
+      threads.swap(job_threads);
+      job_cond.notify_all();
+    }
+
+    for(auto& t : threads){
+      t->thread->join();
+      delete t->thread;
+      delete t;
+    }
+  }
+
+
+  void thread_pool::set_workers(unsigned int workers)
+  {
+    std::lock_guard<std::mutex> config(config_mutex);
+
+    stop_workers();
+    start_workers(workers);
+  }
+
+
+  unsigned int thread_pool::workers() const throw()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return worker_threads.size();
+  }
+
+
+  unsigned int thread_pool::concurrency() const throw()
+  {
+    return workers() + 1;
+  }
+
+
+  void thread_pool::start_workers(unsigned int N)
+  {
+    if(N == 0) N = std::thread::hardware_concurrency();
+    if(N == 0) N = 1;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    stopping = false;
+
+    queues.clear();
+    for(unsigned int i=0;i<N;i++)
+      queues.push_back(std::unique_ptr<worker_queue>(new worker_queue));
+
+    for(unsigned int i=0;i<N;i++)
+      worker_threads.push_back(new std::thread(&thread_pool::worker_loop, this, i));
+  }
+
+
+  void thread_pool::stop_workers()
+  {
+    std::vector<std::thread*> threads;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+      threads.swap(worker_threads);
+      cond.notify_all();
+    }
+
+    for(auto& t : threads){
+      t->join();
+      delete t;
+    }
+
+    // tasks that were not started are moved to the shared queue
+    std::lock_guard<std::mutex> slock(shared.lock);
+
+    for(auto& q : queues){
+      for(auto& t : q->tasks)
+	shared.tasks.push_back(t);
+      q->tasks.clear();
+    }
+  }
+
+
+  void thread_pool::worker_loop(const unsigned int index)
+  {
+    current_pool = this;
+    current_worker = index;
+
+    std::function<void()> task;
+
+    while(1){
+      if(pop_task(index, task)){
+	task();
+	task = nullptr;
+	continue;
+      }
+
+      std::unique_lock<std::mutex> lock(mutex);
+
+      if(stopping) break;
+
+      if(pending <= 0)
+	cond.wait(lock);
+
+      if(stopping) break;
+    }
+
+    current_pool = nullptr;
+  }
+
+
+  void thread_pool::push_task(const std::function<void()>& task)
+  {
+    if(current_pool == this){
+      std::lock_guard<std::mutex> lock(queues[current_worker]->lock);
+      queues[current_worker]->tasks.push_back(task);
+    }
+    else{
+      std::lock_guard<std::mutex> lock(shared.lock);
+      shared.tasks.push_back(task);
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      pending++;
+    }
+
+    cond.notify_one();
+  }
+
+
+  bool thread_pool::pop_task(const unsigned int index, std::function<void()>& task)
+  {
+    bool found = false;
+
+    // newest task of own deque (LIFO keeps data in cache)
+    {
+      std::lock_guard<std::mutex> lock(queues[index]->lock);
+
+      if(queues[index]->tasks.size() > 0){
+	task = queues[index]->tasks.back();
+	queues[index]->tasks.pop_back();
+	found = true;
+      }
+    }
+
+    if(!found){
+      std::lock_guard<std::mutex> lock(shared.lock);
+
+      if(shared.tasks.size() > 0){
+	task = shared.tasks.front();
+	shared.tasks.pop_front();
+	found = true;
+      }
+    }
+
+    // steals the oldest task of other workers
+    for(unsigned int k=1;k<queues.size() && !found;k++){
+      worker_queue& q = *queues[(index + k) % queues.size()];
+      std::lock_guard<std::mutex> lock(q.lock);
+
+      if(q.tasks.size() > 0){
+	task = q.tasks.front();
+	q.tasks.pop_front();
+	found = true;
+      }
+    }
+
+    if(found){
+      std::lock_guard<std::mutex> lock(mutex);
+      pending--;
+    }
+
+    return found;
+  }
+
+
+  //////////////////////////////////////////////////////////////////////
+
+
+  thread_pool::job thread_pool::start(const std::function<void()>& f)
+  {
+    job j;
+    j.s = std::make_shared<job::state>();
+    j.s->done = false;
+
+    std::lock_guard<std::mutex> lock(job_mutex);
+
+    for(auto& t : job_threads){
+      if(!t->s && !t->quit){
+	t->f = f;
+	t->s = j.s;
+	job_cond.notify_all();
+	return j;
+      }
+    }
+
+    job_thread* t = new job_thread;
+    t->f = f;
+    t->s = j.s;
+    t->quit = false;
+
+    try{
+      t->thread = new std::thread(&thread_pool::job_loop, this, t);
+    }
+    catch(std::exception& e){
+      delete t;
+      throw;
+    }
+
+    job_threads.push_back(t);
+
+    return j;
+  }
+
+
+  void thread_pool::job_loop(job_thread* t)
+  {
+    std::unique_lock<std::mutex> lock(job_mutex);
+
+    while(1){
+      while(!t->s && !t->quit)
+	job_cond.wait(lock);
+
+      if(t->quit) return;
+
+      std::function<void()> f = t->f;
+      std::shared_ptr<job::state> s = t->s;
+
+      lock.unlock();
+
+      // jobs may change thread's scheduling priority
+      sched_param params;
+      int policy = SCHED_OTHER;
+      pthread_getschedparam(pthread_self(), &policy, &params);
+
+      std::exception_ptr error;
+
+      try{ f(); }
+      catch(...){ error = std::current_exception(); }
+
+      pthread_setschedparam(pthread_self(), policy, &params);
+
+      {
+	std::lock_guard<std::mutex> slock(s->lock);
+	s->error = error;
+	s->done = true;
+	s->cond.notify_all();
+      }
+
+      lock.lock();
+
+      t->f = nullptr;
+      t->s.reset();
+    }
+  }
+
+
+  //////////////////////////////////////////////////////////////////////
+
+
+  void thread_pool::parallel_for(const unsigned long long begin,
+				 const unsigned long long end,
+				 const unsigned long long step,
+				 const std::function<void(unsigned int, unsigned long long)>& f,
+				 unsigned int maxslots)
+  {
+    if(end <= begin) return;
+
+    const unsigned long long s = step ? step : 1;
+
+    struct group {
+      std::atomic<unsigned long long> next, done;
+      unsigned long long N, begin, step;
+      const std::function<void(unsigned int, unsigned long long)>* f;
+
+      std::mutex lock;
+      std::condition_variable cond;
+      std::exception_ptr error;
+      std::atomic<bool> failed;
+    };
+
+    std::shared_ptr<group> g = std::make_shared<group>();
+    g->next = 0;
+    g->done = 0;
+    g->N = (end - begin + s - 1)/s;
+    g->begin = begin;
+    g->step = s;
+    g->f = &f;
+    g->failed = false;
+
+    // slot processes items until all of them have been taken
+    auto process = [](std::shared_ptr<group> g, const unsigned int slot)
+    {
+      unsigned long long i;
+
+      while((i = g->next++) < g->N){
+	if(g->failed == false){
+	  try{
+	    (*g->f)(slot, g->begin + i*g->step);
+	  }
+	  catch(...){
+	    std::lock_guard<std::mutex> lock(g->lock);
+	    if(g->failed == false) g->error = std::current_exception();
+	    g->failed = true;
+	  }
+	}
+
+	if(++g->done == g->N){
+	  std::lock_guard<std::mutex> lock(g->lock);
+	  g->cond.notify_all();
+	}
+      }
+    };
+
+    if(maxslots == 0) maxslots = concurrency();
+
+    unsigned long long helpers = workers();
+    if(helpers + 1 > maxslots) helpers = maxslots - 1;
+    if(helpers + 1 > g->N) helpers = g->N - 1;
+
+    for(unsigned int slot=1;slot<=helpers;slot++)
+      push_task(std::bind(process, g, slot));
+
+    process(g, 0);
+
+    {
+      std::unique_lock<std::mutex> lock(g->lock);
+      while(g->done < g->N)
+	g->cond.wait(lock);
+    }
+
+    if(g->failed)
+      std::rethrow_exception(g->error);
+  }
+
+};
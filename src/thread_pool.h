@@ -0,0 +1,136 @@
+/*
+ * process-wide thread pool
+ *
+ * optimizers and samplers start their long running loops as jobs
+ * and calculate data-parallel parts using parallel_for() so that
+ * concurrently running trainings share the same set of worker threads
+ * instead of each one creating their own threads.
+ *
+ * parallel_for() tasks are kept in per-worker deques: worker takes
+ * tasks from the back of its own deque and steals from the front of
+ * other workers' deques when it has nothing to do.
+ */
+
+#ifndef thread_pool_h
+#define thread_pool_h
+
+#include <vector>
+#include <deque>
+#include <list>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+
+namespace whiteice
+{
+  class thread_pool
+  {
+  public:
+
+    // handle to job started using thread_pool::start()
+    class job
+    {
+    public:
+      job();
+
+      // true if the job has not been joined yet
+      bool joinable() const throw();
+
+      // true if the job's function has returned
+      bool finished() const throw();
+
+      // waits for the job to finish, rethrows exception thrown by the job
+      void join();
+
+    private:
+      struct state;
+      std::shared_ptr<state> s;
+
+      friend class thread_pool;
+    };
+
+
+    // pool shared by all optimizers and samplers of the process
+    static thread_pool& global();
+
+    thread_pool(const unsigned int workers = 0);
+    ~thread_pool();
+
+    // number of worker threads executing parallel_for() tasks,
+    // 0 means std::thread::hardware_concurrency() threads
+    void set_workers(unsigned int workers);
+    unsigned int workers() const throw();
+
+    // maximum number of concurrently running parallel_for() slots
+    // (workers + calling thread)
+    unsigned int concurrency() const throw();
+
+    // starts long running job (optimizer or sampler loop),
+    // job threads are reused after the previous job has finished
+    job start(const std::function<void()>& f);
+
+    // calls f(slot, i) for i = begin, begin+step, ... < end in parallel and
+    // returns after all calls have finished. Calls with the same slot number
+    // are never run concurrently so slot can index per-thread scratch memory,
+    // slot < maxslots (0 = concurrency()). Calling thread also processes items.
+    // The first exception thrown by f is rethrown in the calling thread.
+    void parallel_for(const unsigned long long begin,
+		      const unsigned long long end,
+		      const unsigned long long step,
+		      const std::function<void(unsigned int, unsigned long long)>& f,
+		      unsigned int maxslots = 0);
+
+  private:
+    thread_pool(const thread_pool&);
+    thread_pool& operator=(const thread_pool&);
+
+    struct worker_queue {
+      std::mutex lock;
+      std::deque< std::function<void()> > tasks;
+    };
+
+    struct job_thread;
+
+    void worker_loop(const unsigned int index);
+    void job_loop(job_thread* t);
+
+    // queues task to the current worker's deque (or to a shared queue)
+    void push_task(const std::function<void()>& task);
+
+    // takes a task from worker's own deque, shared queue or steals one
+    bool pop_task(const unsigned int index, std::function<void()>& task);
+
+    void start_workers(const unsigned int N);
+    void stop_workers();
+
+    std::vector< std::unique_ptr<worker_queue> > queues;
+    worker_queue shared;
+    std::vector<std::thread*> worker_threads;
+
+    long long pending; // number of queued tasks
+    bool stopping;
+    mutable std::mutex mutex; // protects pending, stopping and workers
+    std::condition_variable cond;
+
+    std::mutex config_mutex; // serializes set_workers() calls
+
+    struct job_thread {
+      std::thread* thread;
+      std::function<void()> f;
+      std::shared_ptr<job::state> s;
+      bool quit;
+    };
+
+    std::list<job_thread*> job_threads;
+    std::mutex job_mutex;
+    std::condition_variable job_cond;
+  };
+
+};
+
+
+#endif
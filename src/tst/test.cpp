@@ -11,7 +11,11 @@
 #include <math.h>
 #include <time.h>
 #include <vector>
+#include <limits>
+#include <algorithm>
 #include <errno.h>
+#include <atomic>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -32,10 +36,14 @@
 #include "binary_tree.h"
 #include "avltree.h"
 #include "dataset.h"
+#include "float16.h"
 #include "unique_id.h"
 #include "conffile.h"
 #include "list_source.h"
+#include "minibatch_source.h"
+#include "thread_pool.h"
 #include "MemoryCompressor.h"
+#include "fastpca.h"
 
 #else
 // eclipse has different build process we test with ready compiled library
@@ -66,6 +74,8 @@ void test_uniqueid();
 void test_conffile();
 void test_compression();
 void test_list_source();
+void test_minibatch_source();
+void test_thread_pool();
 
 
 // void test_optimum_binary_tree();
@@ -121,6 +131,8 @@ int main()
   test_conffile();
   test_compression();
   test_list_source();
+  test_minibatch_source();
+  test_thread_pool();
   
   
   return 0;
@@ -781,7 +793,7 @@ void dynamic_bitset_test()
 	  b[i].set(j, 0);
 	}
 	catch(std::out_of_range& e){
-	  throw test_exception("operator[]throws exception on a correct range");
+	  throw test_exception("operator[]�throws exception on a correct range");
 	}
       }
       
@@ -1841,7 +1853,157 @@ void test_dataset()
     printf("DATASET BASIC SAVE&LOAD() IS OK\n");
 
   }
+
+
+  // memory mapped binary format (version 2) save & load
+  {
+    dataset<float> A;
+    std::vector<math::vertex<float> > data;
+    data.resize(1000);
+
+    for(unsigned int i=0;i<data.size();i++){
+      data[i].resize(13);
+      for(unsigned int j=0;j<data[i].size();j++)
+	data[i][j] = ((float)rand())/((float)RAND_MAX);
+    }
+
+    A.createCluster("mapped", 13);
+    A.createCluster("empty", 3);
+
+    if(A.add(0, data) == false){
+      std::cout << "dataset error: adding new data failed." << std::endl;
+      return;
+    }
+
+    A.preprocess(0);
+
+    if(A.save("dataset_mmap.bin", true) == false){
+      std::cout << "dataset error: mmap format saving failed." << std::endl;
+      return;
+    }
+
+    dataset<float> B;
+
+    if(B.load("dataset_mmap.bin") == false){
+      std::cout << "dataset error: mmap format loading failed." << std::endl;
+      return;
+    }
+
+    if(B.getNumberOfClusters() != 2 || B.size(0) != A.size(0) ||
+       B.size(1) != 0 || B.dimension(1) != 3 ||
+       B.getName(0) != "mapped"){
+      std::cout << "dataset error: mmap format cluster information mismatch." << std::endl;
+      return;
+    }
+
+    if(B[0].isview() == false)
+      std::cout << "dataset error: mmap loaded data is not a view to the file." << std::endl;
+
+    for(unsigned int i=0;i<A.size(0);i++){
+      for(unsigned int j=0;j<A[i].size();j++){
+	if(A[i][j] != B[i][j]){
+	  std::cout << "dataset error: mmap format data corruption" << std::endl;
+	  j = A[i].size();
+	  i = A.size(0);
+	}
+      }
+    }
+
+    // preprocessings must be restored too
+    math::vertex<float> v = data[0];
+
+    if(B.preprocess(0, v) == false || (v - B[0]).norm() > 0.0001f)
+      std::cout << "dataset error: mmap format preprocessing mismatch." << std::endl;
+
+    // modifying data of a mapped dataset must not change the file
+    B.clearData(0);
+
+    if(B.load("dataset_mmap.bin") == false || B.size(0) != data.size())
+      std::cout << "dataset error: mmap format reloading failed." << std::endl;
+
+    // loading old format file over mapped data must not use unmapped memory
+    if(A.save("dataset_v1.bin") == false || B.load("dataset_v1.bin") == false ||
+       B.size(0) != A.size(0) || B[0].isview() || (B[0] - A[0]).norm() > 0.0001f)
+      std::cout << "dataset error: loading v1 format over mmap dataset failed." << std::endl;
+
+    // resize() to same size must detach vertex from the viewed memory
+    {
+      float buf[4] = { 1.0f, 2.0f, 3.0f, 4.0f };
+      math::vertex<float> w;
+      w.view(buf, 4);
+      w.resize(4);
+      w[0] = 5.0f;
+      
+      if(w.isview() || buf[0] != 1.0f || w[3] != 4.0f)
+	std::cout << "dataset error: resize() of vertex view didn't copy the data." << std::endl;
+    }
+
+    printf("DATASET MMAP SAVE&LOAD() IS OK\n");
+  }
+
   
+  // float16 conversions and dataset format 3 (float16 data)
+  {
+    std::vector<float> x(1027), y(x.size());
+    std::vector<unsigned short> h(x.size());
+
+    for(unsigned int i=0;i<x.size();i++)
+      x[i] = 100.0f*(((float)rand())/((float)RAND_MAX) - 0.5f);
+
+    x[0] = 0.0f; x[1] = -0.0f; x[2] = 65504.0f; x[3] = 1e6f;
+    x[4] = 1e-6f; x[5] = -1e-8f; x[6] = std::numeric_limits<float>::infinity();
+
+    math::float_to_half(x.data(), h.data(), x.size());
+    math::half_to_float(h.data(), y.data(), x.size());
+
+    for(unsigned int i=0;i<x.size();i++){
+      if(h[i] != math::float_to_half(x[i]) || y[i] != math::half_to_float(h[i])){
+	std::cout << "dataset error: float16 kernel (" << math::float16_instruction_set()
+		  << ") and scalar conversions differ." << std::endl;
+	break;
+      }
+    }
+
+    if(y[2] != 65504.0f || h[3] != 0x7C00 || h[6] != 0x7C00 || h[5] != 0x8000 ||
+       fabs(y[4] - 1e-6f) > 1e-7f || fabs(y[10] - x[10]) > 0.05f)
+      std::cout << "dataset error: bad float16 conversion results." << std::endl;
+
+    dataset<float> A;
+    A.createCluster("half", 7);
+
+    for(unsigned int i=0;i<500;i++){
+      math::vertex<float> v(7);
+      for(unsigned int j=0;j<v.size();j++)
+	v[j] = ((float)rand())/((float)RAND_MAX) - 0.5f;
+      A.add(0, v);
+    }
+
+    A.preprocess(0, dataset<float>::dnMeanVarianceNormalization);
+
+    dataset<float> B;
+
+    if(A.save("dataset_f16.bin", true, true) == false ||
+       B.load("dataset_f16.bin") == false || B.size(0) != A.size(0)){
+      std::cout << "dataset error: float16 format save/load failed." << std::endl;
+    }
+    else{
+      float err = 0.0f;
+
+      for(unsigned int i=0;i<A.size(0);i++)
+	for(unsigned int j=0;j<7;j++)
+	  err = std::max(err, (float)fabs(A[i][j] - B[i][j]));
+
+      if(err > 0.005f)
+	std::cout << "dataset error: float16 format data mismatch ("
+		  << err << ")." << std::endl;
+
+      if(B.hasPreprocess(0, dataset<float>::dnMeanVarianceNormalization) == false)
+	std::cout << "dataset error: float16 format preprocessing mismatch." << std::endl;
+    }
+
+    printf("DATASET FLOAT16 SAVE&LOAD() IS OK\n");
+  }
+
   
   
   // multicluster dataset tests
@@ -4065,3 +4227,310 @@ void test_list_source()
 }
 
 /********************************************************************************/
+
+
+void test_minibatch_source()
+{
+  try{
+    std::cout << "MINIBATCH_SOURCE TESTS" << std::endl;
+
+    // output of each sample is (2*x[0], index) so pairs can be checked
+    const unsigned int N = 1013;
+    dataset< math::blas_real<float> > data;
+    data.createCluster("input", 3);
+    data.createCluster("output", 2);
+
+    for(unsigned int i=0;i<N;i++){
+      math::vertex< math::blas_real<float> > x(3), y(2);
+      x[0] = (float)i; x[1] = 1.0f; x[2] = -(float)i;
+      y[0] = 2.0f*i; y[1] = (float)i;
+
+      data.add(0, x);
+      data.add(1, y);
+    }
+
+    if(data.save("minibatch_source.ds", true) == false){
+      std::cout << "ERROR: saving dataset failed" << std::endl;
+      return;
+    }
+
+    file_minibatch_source< math::blas_real<float> > fs("minibatch_source.ds");
+    dataset_minibatch_source< math::blas_real<float> > ds(data);
+
+    if(fs.good() == false || fs.size() != N ||
+       fs.input_size() != 3 || fs.output_size() != 2 ||
+       fs.getHeader().getName(1) != "output"){
+      std::cout << "ERROR: file_minibatch_source has bad data information" << std::endl;
+      return;
+    }
+
+    minibatch< math::blas_real<float> > a, b;
+
+    if(fs.read(500, 100, a) == false || ds.read(500, 100, b) == false){
+      std::cout << "ERROR: reading minibatch failed" << std::endl;
+      return;
+    }
+
+    for(unsigned int n=0;n<100;n++){
+      if(a.input(n,0) != b.input(n,0) || a.input(n,2) != b.input(n,2) ||
+	 a.output(n,1) != b.output(n,1) || a.input(n,0) != (float)(500+n)){
+	std::cout << "ERROR: file and dataset sources gave different data" << std::endl;
+	return;
+      }
+    }
+
+    if(fs.read(N-10, 11, a) == true){
+      std::cout << "ERROR: reading past end of data didn't fail" << std::endl;
+      return;
+    }
+
+    // float16 data is converted when read (small integers are exact)
+    {
+      if(data.save("minibatch_source16.ds", true, true) == false){
+	std::cout << "ERROR: saving float16 dataset failed" << std::endl;
+	return;
+      }
+
+      file_minibatch_source< math::blas_real<float> > fs16("minibatch_source16.ds");
+
+      if(fs16.good() == false || fs16.size() != N ||
+	 fs16.read(500, 100, a) == false){
+	std::cout << "ERROR: reading float16 minibatch failed" << std::endl;
+	return;
+      }
+
+      for(unsigned int n=0;n<100;n++){
+	if(a.input(n,0) != b.input(n,0) || a.input(n,2) != b.input(n,2) ||
+	   a.output(n,0) != b.output(n,0) || a.output(n,1) != b.output(n,1)){
+	  std::cout << "ERROR: float16 source gave different data" << std::endl;
+	  return;
+	}
+      }
+    }
+
+    // each sample must be seen exactly once per shuffled epoch
+    minibatch_prefetcher< math::blas_real<float> > prefetcher(fs, 32, true, 100);
+
+    for(unsigned int epoch=0;epoch<3;epoch++){
+      std::vector<unsigned int> seen(N, 0);
+      unsigned int batches = 0;
+
+      while(prefetcher.next(a)){
+	batches++;
+
+	if(a.size() == 0 || a.size() > 32){
+	  std::cout << "ERROR: bad minibatch size" << std::endl;
+	  return;
+	}
+
+	for(unsigned int n=0;n<a.size();n++){
+	  const unsigned int i = (unsigned int)(a.input(n,0).c[0]);
+
+	  if(i >= N || a.output(n,0) != 2.0f*i || a.output(n,1) != (float)i){
+	    std::cout << "ERROR: minibatch input and output don't match" << std::endl;
+	    return;
+	  }
+
+	  seen[i]++;
+	}
+      }
+
+      for(unsigned int i=0;i<N;i++){
+	if(seen[i] != 1){
+	  std::cout << "ERROR: prefetcher epoch didn't contain all samples once" << std::endl;
+	  return;
+	}
+      }
+
+      if(batches < N/32){
+	std::cout << "ERROR: too few minibatches per epoch" << std::endl;
+	return;
+      }
+    }
+
+    if(prefetcher.good() == false){
+      std::cout << "ERROR: prefetcher reported failure" << std::endl;
+      return;
+    }
+
+    // out-of-core PCA of file data gives the same subspace as in-memory PCA
+    {
+      const unsigned int D = 5, M = 2;
+      const float scale[D] = { 5.0f, 3.0f, 1.0f, 0.5f, 0.1f };
+
+      dataset< math::blas_real<float> > pcadata;
+      std::vector< math::vertex< math::blas_real<float> > > xs;
+      pcadata.createCluster("input", D);
+      pcadata.createCluster("output", 1);
+
+      for(unsigned int i=0;i<N;i++){
+	math::vertex< math::blas_real<float> > x(D), y(1);
+
+	for(unsigned int d=0;d<D;d++)
+	  x[d] = scale[(d+2) % D]*(((float)rand())/RAND_MAX - 0.5f) + 1.0f;
+	y[0] = 0.0f;
+
+	pcadata.add(0, x);
+	pcadata.add(1, y);
+	xs.push_back(x);
+      }
+
+      if(pcadata.save("minibatch_pca.ds", true) == false){
+	std::cout << "ERROR: saving PCA dataset failed" << std::endl;
+	return;
+      }
+
+      file_minibatch_source< math::blas_real<float> > pcafs("minibatch_pca.ds");
+      minibatch_input_source< math::blas_real<float> > rows(pcafs);
+      math::matrix< math::blas_real<float> > P1, P2;
+
+      if(math::fastpca(rows, M, P1, 2, 100) == false ||
+	 math::fastpca(xs, M, P2) == false ||
+	 P1.ysize() != M || P1.xsize() != D ||
+	 P2.ysize() != M || P2.xsize() != D){
+	std::cout << "ERROR: fastpca of minibatch source failed" << std::endl;
+	return;
+      }
+
+      // compares projection matrices P^t*P (signs of vectors may differ)
+      float maxerr = 0.0f;
+
+      for(unsigned int j=0;j<D;j++){
+	for(unsigned int i=0;i<D;i++){
+	  math::blas_real<float> p1 = 0.0f, p2 = 0.0f;
+
+	  for(unsigned int k=0;k<M;k++){
+	    p1 += P1(k,j)*P1(k,i);
+	    p2 += P2(k,j)*P2(k,i);
+	  }
+
+	  const float e = math::abs(p1 - p2).c[0];
+	  if(e > maxerr) maxerr = e;
+	}
+      }
+
+      if(maxerr > 0.01f){
+	std::cout << "ERROR: out-of-core and in-memory PCA differ: "
+		  << maxerr << std::endl;
+	return;
+      }
+    }
+
+    std::cout << "MINIBATCH_SOURCE TESTS PASSED" << std::endl;
+  }
+  catch(std::exception& e){
+    std::cout << "Unexcepted exception: " << e.what() << std::endl;
+  }
+}
+
+/********************************************************************************/
+
+
+void test_thread_pool()
+{
+  try{
+    std::cout << "THREAD_POOL TESTS" << std::endl;
+
+    thread_pool pool(4);
+
+    // every item is processed once and no slot is used concurrently
+    const unsigned long long N = 10007;
+    std::vector<unsigned int> seen(N, 0);
+    std::vector< std::atomic<int> > busy(pool.concurrency());
+    std::atomic<bool> ok(true);
+
+    for(auto& b : busy) b = 0;
+
+    pool.parallel_for(0, N, 1, [&](unsigned int slot, unsigned long long i)
+    {
+      if(slot >= busy.size() || busy[slot]++ != 0) ok = false;
+      seen[i]++;
+      busy[slot]--;
+    });
+
+    for(unsigned long long i=0;i<N;i++)
+      if(seen[i] != 1) ok = false;
+
+    if(!ok){
+      std::cout << "ERROR: parallel_for() didn't process items correctly" << std::endl;
+      return;
+    }
+
+    // nested loops and step sizes
+    std::atomic<unsigned long long> sum(0);
+
+    pool.parallel_for(0, 64, 1, [&](unsigned int, unsigned long long i)
+    {
+      pool.parallel_for(0, 100, 3, [&](unsigned int, unsigned long long j){ sum += j; });
+    });
+
+    if(sum != 64*1683){
+      std::cout << "ERROR: nested parallel_for() gave wrong result" << std::endl;
+      return;
+    }
+
+    // exceptions are passed to caller
+    bool thrown = false;
+
+    try{
+      pool.parallel_for(0, 1000, 1, [](unsigned int, unsigned long long i)
+      {
+	if(i == 500) throw std::runtime_error("test");
+      });
+    }
+    catch(std::runtime_error& e){ thrown = true; }
+
+    if(!thrown){
+      std::cout << "ERROR: parallel_for() didn't rethrow exception" << std::endl;
+      return;
+    }
+
+    // jobs run concurrently and job threads are reused
+    std::atomic<int> counter(0);
+    std::vector<thread_pool::job> jobs;
+
+    for(unsigned int i=0;i<8;i++)
+      jobs.push_back(pool.start([&](){ usleep(10000); counter++; }));
+
+    for(auto& j : jobs) j.join();
+
+    if(counter != 8 || jobs[0].joinable()){
+      std::cout << "ERROR: thread_pool jobs failed" << std::endl;
+      return;
+    }
+
+    thrown = false;
+
+    try{
+      pool.start([](){ throw std::runtime_error("test"); }).join();
+    }
+    catch(std::runtime_error& e){ thrown = true; }
+
+    if(!thrown){
+      std::cout << "ERROR: job::join() didn't rethrow exception" << std::endl;
+      return;
+    }
+
+    pool.set_workers(2);
+
+    if(pool.workers() != 2){
+      std::cout << "ERROR: set_workers() failed" << std::endl;
+      return;
+    }
+
+    sum = 0;
+    pool.parallel_for(0, 1000, 1, [&](unsigned int, unsigned long long i){ sum += i; });
+
+    if(sum != 999*1000/2){
+      std::cout << "ERROR: parallel_for() failed after set_workers()" << std::endl;
+      return;
+    }
+
+    std::cout << "THREAD_POOL TESTS PASSED" << std::endl;
+  }
+  catch(std::exception& e){
+    std::cout << "Unexcepted exception: " << e.what() << std::endl;
+  }
+}
+
+/********************************************************************************/
@@ -17,6 +17,9 @@ void parse_commandline(int argc, char** argv,
 		       unsigned int& threads,
 		       unsigned int& dataSize,
 		       unsigned int& SIMULATION_DEPTH,
+		       unsigned int& sghmc,
+		       bool& server,
+		       std::string& socketfile,
 		       bool& no_init,
 		       bool& load, 
 		       bool& overfit, 
@@ -446,6 +446,9 @@ int main(int argc, char** argv)
       }
       
       
+    }
+    else if(action == "mmap" && options.size() == 0){
+      // nothing to do: dataset is saved using memory mapped format
     }
     else if(action == "padd" && options.size() > 1){
       // adds preprocessing to cluster (names: meanvar, outlier, pca)
@@ -597,7 +600,7 @@ int main(int argc, char** argv)
     
     
     
-    if(data->save(datafile1) == false){
+    if(data->save(datafile1, action == "mmap") == false){
       std::cout << "Couldn't save file: " << datafile1 << std::endl;
       delete data;
       return -1;
@@ -697,6 +700,7 @@ bool parse(int argc, char** argv,
   okcmds.push_back("padd");
   okcmds.push_back("premove");
   okcmds.push_back("data");
+  okcmds.push_back("mmap");
   
   
   for(unsigned int i=0;i<okcmds.size();i++)
@@ -729,6 +733,7 @@ void print_usage()
   printf("                            preprocess names: meanvar, outlier, pca, ica\n");
   printf("                            note: ica implementation is unstable and may not work\n");
   printf(" -data:N                    jointly resamples all cluster sizes down to N datapoints\n");
+  printf(" -mmap                      converts datafile to memory mapped binary format (fast loading)\n");
   printf("\n");
   printf("This program is distributed under GPL license <tomas.ukkonen@iki.fi> (commercial license available).\n");
 } 
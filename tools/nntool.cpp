@@ -30,6 +30,7 @@
 
 #include "argparser.tab.h"
 #include "cpuid_threads.h"
+#include "nntool_server.h"
 
 #undef __STRICT_ANSI__
 #include <fenv.h>
@@ -82,6 +83,13 @@ int main(int argc, char** argv)
     // number of datapoints to be used in learning (taken randomly from the dataset)
     unsigned int dataSize = 0;
 
+    // minibatch size of stochastic gradient HMC (0 = full gradient HMC)
+    unsigned int sghmc = 0;
+
+    // persistent inference server (use): stdin/stdout or local unix socket
+    bool server = false;
+    std::string socketfile;
+
     
 #ifdef _GLIBCXX_DEBUG    
     // enables FPU exceptions
@@ -102,6 +110,9 @@ int main(int argc, char** argv)
 		      threads,
 		      dataSize,
 		      SIMULATION_DEPTH,
+		      sghmc,
+		      server,
+		      socketfile,
 		      no_init,
 		      load,
 		      overfit,
@@ -122,6 +133,16 @@ int main(int argc, char** argv)
       return 0;
     }
 
+    if(server){
+      if(lmethod != "use"){
+	fprintf(stderr, "error: server mode is only supported by 'use'.\n");
+	return -1;
+      }
+
+      if(socketfile.size() == 0)
+	verbose = false; // stdout is used for answers
+    }
+
     install_signal_handler();
 
     if(threads <= 0)
@@ -215,7 +236,8 @@ int main(int argc, char** argv)
 	}
       }
       
-      if(data.size(0) == 0 || (data.size(1) == 0 && (lmethod != "use" && lmethod != "minimize"))){
+      if((data.size(0) == 0 && !server) ||
+	 (data.size(1) == 0 && (lmethod != "use" && lmethod != "minimize"))){
 	fprintf(stderr, "error: empty datasets cannot be used for training.\n");
 	exit(-1);
       }
@@ -1435,6 +1457,7 @@ int main(int argc, char** argv)
       
 
       whiteice::HMC< whiteice::math::blas_real<double> > hmc(*nn, data, adaptive);
+      if(sghmc > 0) hmc.setSGHMC(true, sghmc);
       // whiteice::UHMC< whiteice::math::blas_real<double> > hmc(*nn, data, adaptive);
       
       // whiteice::PTHMC< whiteice::math::blas_real<double> > hmc(ptlayers, *nn, data, adaptive);
@@ -1710,7 +1733,40 @@ int main(int argc, char** argv)
 	nn = NULL;
 	return -1;
       }
+
       
+      if(server){
+	if(data.getNumberOfClusters() >= 2 && bnn->outputSize() != data.dimension(1)){
+	  std::cout << "Neural network output dimension mismatch for dataset ("
+		    << bnn->outputSize() << " != " << data.dimension(1) << ")"
+		    << std::endl;
+	  delete bnn;
+	  delete nn;
+	  return -1;
+	}
+	
+	// only preprocessings of the dataset are needed
+	for(unsigned int c=0;c<data.getNumberOfClusters();c++)
+	  data.clearData(c);
+	
+	nntool_server srv(*bnn, data, SIMULATION_DEPTH, stopsignal);
+	bool ok = true;
+	
+	if(socketfile.size() > 0){
+	  if(verbose)
+	    std::cout << "Listening requests at " << socketfile << std::endl;
+	  
+	  ok = srv.serve_socket(socketfile);
+	}
+	else{
+	  ok = srv.serve_stdio();
+	}
+	
+	delete bnn;
+	delete nn;
+	
+	return (ok ? 0 : -1);
+      }
       
       
       bool compare_clusters = false;
@@ -2091,6 +2147,9 @@ void print_usage(bool all)
   printf("--samples N    use N samples or optimize for N iterations\n");
   printf("--threads N    uses N parallel threads (pgrad, plbfgs)\n");
   printf("--data N       only use N random samples of data\n");
+  printf("--sghmc N      stochastic gradient HMC, minibatch size N (bayes)\n");
+  printf("--server       answers batched requests from stdin to stdout (use)\n");
+  printf("--socket file  answers batched requests from local unix socket (use)\n");
   printf("[data]         dstool file containing data (binary file)\n");
   printf("[arch]         architecture of net (Eg. 3-10-9)\n");
   printf("<nnfile>       used/loaded/saved neural network weights file\n");
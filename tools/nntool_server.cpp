@@ -0,0 +1,274 @@
+
+#include "nntool_server.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <signal.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <thread>
+#include <atomic>
+#include <list>
+#include <memory>
+
+
+using namespace whiteice;
+
+
+// maximum number of input vectors in a single request
+static const unsigned long NNTOOL_SERVER_MAX_REQUEST = 1048576;
+
+
+nntool_server::nntool_server(const bayesian_nnetwork< math::blas_real<double> >& bnn_,
+			     const dataset< math::blas_real<double> >& data_,
+			     const unsigned int SIMULATION_DEPTH_,
+			     volatile bool& stopsignal_) :
+  bnn(bnn_), data(data_), SIMULATION_DEPTH(SIMULATION_DEPTH_), stopsignal(stopsignal_)
+{
+}
+
+
+bool nntool_server::serve_stdio()
+{
+  serve(stdin, stdout);
+  return true;
+}
+
+
+bool nntool_server::serve_socket(const std::string& socketfile)
+{
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+
+  if(socketfile.size() == 0 || socketfile.size() >= sizeof(addr.sun_path)){
+    fprintf(stderr, "error: bad socket filename: %s\n", socketfile.c_str());
+    return false;
+  }
+
+  strncpy(addr.sun_path, socketfile.c_str(), sizeof(addr.sun_path)-1);
+
+  // writing answers to closed connections must not stop the server
+  signal(SIGPIPE, SIG_IGN);
+
+  const int s = socket(AF_UNIX, SOCK_STREAM, 0);
+  if(s < 0){
+    perror("error: socket()");
+    return false;
+  }
+
+  unlink(socketfile.c_str()); // removes old socket
+
+  if(bind(s, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(s, 16) != 0){
+    perror("error: cannot listen socket");
+    close(s);
+    return false;
+  }
+
+  struct client {
+    std::thread t;
+    int fd;
+    std::atomic<bool> done;
+  };
+
+  std::list< std::unique_ptr<client> > clients;
+
+  while(!stopsignal){
+    struct pollfd p;
+    p.fd = s;
+    p.events = POLLIN;
+    p.revents = 0;
+
+    const int r = poll(&p, 1, 500); // checks stopsignal twice per second
+
+    // joins threads of closed connections
+    for(auto i = clients.begin();i != clients.end();){
+      if((*i)->done){
+	(*i)->t.join();
+	close((*i)->fd);
+	i = clients.erase(i);
+      }
+      else i++;
+    }
+
+    if(r <= 0 || (p.revents & POLLIN) == 0) continue;
+
+    const int fd = accept(s, NULL, NULL);
+    if(fd < 0) continue;
+
+    std::unique_ptr<client> c(new client);
+    c->fd = fd;
+    c->done = false;
+
+    client* ptr = c.get();
+
+    try{
+      c->t = std::thread([this, ptr]()
+      {
+	// fd is kept open by the accept loop until the thread has been joined
+	FILE* in  = fdopen(dup(ptr->fd), "r");
+	FILE* out = fdopen(dup(ptr->fd), "w");
+
+	if(in && out) serve(in, out);
+
+	if(in) fclose(in);
+	if(out) fclose(out);
+
+	ptr->done = true;
+      });
+    }
+    catch(std::system_error& e){
+      close(fd);
+      continue;
+    }
+
+    clients.push_back(std::move(c));
+  }
+
+  // wakes up clients waiting for requests
+  for(auto& c : clients){
+    shutdown(c->fd, SHUT_RDWR);
+    c->t.join();
+    close(c->fd);
+  }
+
+  clients.clear();
+
+  close(s);
+  unlink(socketfile.c_str());
+
+  return true;
+}
+
+
+void nntool_server::serve(FILE* in, FILE* out) const
+{
+  char* line = NULL;
+  size_t len = 0;
+
+  math::matrix< math::blas_real<double> > output;
+  std::string error;
+
+  while(!stopsignal && getline(&line, &len, in) >= 0){
+    char* s = line;
+    while(isspace(*s)) s++;
+
+    if(*s == '\0') continue; // empty line
+    if(strncmp(s, "quit", 4) == 0) break;
+
+    char* end = NULL;
+    const unsigned long N = strtoul(s, &end, 10);
+    while(end && isspace(*end)) end++;
+
+    if(end == s || end == NULL || *end != '\0' || N > NNTOOL_SERVER_MAX_REQUEST){
+      fprintf(out, "ERROR bad request header\n");
+      fflush(out);
+      continue;
+    }
+
+    if(N == 0){
+      fprintf(out, "0 %d\n", bnn.outputSize());
+    }
+    else if(calculate(in, (unsigned int)N, output, error)){
+      fprintf(out, "%d %d\n", output.ysize(), output.xsize());
+
+      for(unsigned int n=0;n<output.ysize();n++){
+	for(unsigned int i=0;i<output.xsize();i++)
+	  fprintf(out, i ? " %.10g" : "%.10g", output(n, i).c[0]);
+	fprintf(out, "\n");
+      }
+    }
+    else{
+      fprintf(out, "ERROR %s\n", error.c_str());
+    }
+
+    if(fflush(out) != 0) break; // client has closed connection
+  }
+
+  free(line);
+}
+
+
+bool nntool_server::calculate(FILE* in, const unsigned int N,
+			      math::matrix< math::blas_real<double> >& output,
+			      std::string& error) const
+{
+  const unsigned int D = data.dimension(0);
+
+  math::matrix< math::blas_real<double> > input(N, D);
+  math::vertex< math::blas_real<double> > x(D);
+
+  char* line = NULL;
+  size_t len = 0;
+
+  error = "";
+
+  // all N lines are read even after an error so the next request is parsed correctly
+  for(unsigned int n=0;n<N;n++){
+    if(getline(&line, &len, in) < 0){
+      error = "unexpected end of request";
+      break;
+    }
+
+    if(error.size() > 0) continue;
+
+    char* s = line;
+    unsigned int d = 0;
+
+    while(1){
+      while(isspace(*s) || *s == ',') s++;
+      if(*s == '\0') break;
+
+      char* end = NULL;
+      const double v = strtod(s, &end);
+
+      if(end == s || d >= D){
+	d = D + 1;
+	break;
+      }
+
+      x[d] = v;
+      d++;
+      s = end;
+    }
+
+    if(d != D){
+      error = "bad input vector dimension (" + std::to_string(D) + " expected)";
+      continue;
+    }
+
+    data.preprocess(0, x);
+    input.rowcopyfrom(x, n);
+  }
+
+  free(line);
+
+  if(error.size() > 0) return false;
+
+  math::matrix< math::blas_real<double> > mean;
+
+  if(bnn.calculate(input, mean, SIMULATION_DEPTH) == false){
+    error = "calculating neural network failed";
+    return false;
+  }
+
+  output.resize(mean.ysize(), mean.xsize());
+  math::vertex< math::blas_real<double> > y(mean.xsize());
+
+  for(unsigned int n=0;n<mean.ysize();n++){
+    mean.rowcopyto(y, n);
+
+    // converts outputs back to data space
+    if(data.getNumberOfClusters() >= 2)
+      data.invpreprocess(1, y);
+
+    output.rowcopyfrom(y, n);
+  }
+
+  return true;
+}
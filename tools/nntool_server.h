@@ -0,0 +1,61 @@
+/*
+ * persistent inference server for nntool "use" mode.
+ *
+ * neural network and dataset preprocessings are loaded once and
+ * requests are answered until the input ends or nntool is stopped.
+ * requests are read from stdin (answers to stdout) or from clients
+ * connected to a local unix socket.
+ *
+ * protocol (text lines):
+ *   request:  N              number of input vectors
+ *             x1 x2 .. xD    N lines of input vectors (not preprocessed)
+ *   response: N M            number of outputs and output dimension
+ *             y1 y2 .. yM    N lines of E[y|x] (not preprocessed)
+ *   error:    ERROR <reason>
+ *   "quit" ends the connection.
+ *
+ * each request is calculated as a batch (bayesian_nnetwork batched
+ * calculate() uses thread pool), recurrent nets use SIMULATION_DEPTH.
+ */
+
+#ifndef nntool_server_h
+#define nntool_server_h
+
+#include <dinrhiw/dinrhiw.h>
+#include <string>
+#include <stdio.h>
+
+
+class nntool_server
+{
+ public:
+
+  nntool_server(const whiteice::bayesian_nnetwork< whiteice::math::blas_real<double> >& bnn,
+		const whiteice::dataset< whiteice::math::blas_real<double> >& data,
+		const unsigned int SIMULATION_DEPTH,
+		volatile bool& stopsignal);
+
+  // answers requests read from stdin to stdout
+  bool serve_stdio();
+
+  // listens local unix socket (each client has its own thread)
+  bool serve_socket(const std::string& socketfile);
+
+ private:
+
+  // answers requests until EOF, "quit" or stop signal
+  void serve(FILE* in, FILE* out) const;
+
+  // calculates answer to a single request or returns error message
+  bool calculate(FILE* in, const unsigned int N,
+		 whiteice::math::matrix< whiteice::math::blas_real<double> >& output,
+		 std::string& error) const;
+
+  const whiteice::bayesian_nnetwork< whiteice::math::blas_real<double> >& bnn;
+  const whiteice::dataset< whiteice::math::blas_real<double> >& data;
+  const unsigned int SIMULATION_DEPTH;
+  volatile bool& stopsignal;
+};
+
+
+#endif